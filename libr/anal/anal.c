@@ -155,6 +155,7 @@ R_API RAnal *r_anal_new(void) {
 	anal->os = strdup (R_SYS_OS);
 	anal->reflines = NULL;
 	anal->esil_goto_limit = R_ANAL_ESIL_GOTO_LIMIT;
+	anal->esil_compile = true;
 	anal->limit = NULL;
 	anal->opt.nopskip = true; // skip nops in code analysis
 	anal->opt.hpskip = false; // skip `mov reg,reg` and `lea reg,[reg]`
@@ -224,9 +225,13 @@ R_API RAnal *r_anal_free(RAnal *a) {
 	R_FREE (a->cpu);
 	R_FREE (a->os);
 	R_FREE (a->zign_path);
+	R_FREE (a->zign_file);
 	r_list_free (a->plugins);
 	a->fcns->free = r_anal_fcn_free;
 	r_list_free (a->fcns);
+	r_meta_fini (a);
+	ht_up_free (a->fcn_vars);
+	ht_up_free (a->refline_ops);
 	r_spaces_fini (&a->meta_spaces);
 	r_spaces_fini (&a->zign_spaces);
 	r_anal_pin_fini (a);
@@ -244,6 +249,7 @@ R_API RAnal *r_anal_free(RAnal *a) {
 		a->esil = NULL;
 	}
 	free (a->last_disasm_reg);
+	free (a->read_ahead);
 	free (a);
 	return NULL;
 }
@@ -508,6 +514,8 @@ R_API int r_anal_purge (RAnal *anal) {
 	sdb_reset (anal->sdb_zigns);
 	sdb_reset (anal->sdb_classes);
 	sdb_reset (anal->sdb_classes_attrs);
+	r_meta_rebuild (anal);
+	r_anal_var_rebuild (anal);
 	r_list_free (anal->fcns);
 	anal->fcns = r_anal_fcn_list_new ();
 	anal->fcn_tree = NULL;
@@ -7,6 +7,8 @@
 
 #define DFLT_NINSTR 3
 
+#define BB_CONTAINER(x) container_of ((RBNode*)(x), RAnalBlock, rb)
+
 R_API RAnalBlock *r_anal_bb_new() {
 	RAnalBlock *bb = R_NEW0 (RAnalBlock);
 	if (!bb) {
@@ -35,6 +37,7 @@ R_API void r_anal_bb_free(RAnalBlock *bb) {
 	if (!bb) {
 		return;
 	}
+	r_anal_bb_tree_delete (bb);
 	r_anal_cond_free (bb->cond);
 	R_FREE (bb->fingerprint);
 	r_anal_diff_free (bb->diff);
@@ -174,33 +177,101 @@ R_API inline int r_anal_bb_is_in_offset (RAnalBlock *bb, ut64 off) {
 	return (off >= bb->addr && off < bb->addr + bb->size);
 }
 
-R_API RAnalBlock *r_anal_bb_from_offset(RAnal *anal, ut64 off) {
-	RListIter *iter, *iter2;
-	RAnalFunction *fcn;
-	RAnalBlock *bb;
-	const bool x86 = anal->cur->arch && !strcmp (anal->cur->arch, "x86");
-	if (anal->opt.jmpmid && x86) {
-		RAnalBlock *nearest_bb = NULL;
-		r_list_foreach (anal->fcns, iter, fcn) {
-			r_list_foreach (fcn->bbs, iter2, bb) {
-				if (r_anal_bb_op_starts_at (bb, off)) {
-					return bb;
-				} else if (r_anal_bb_is_in_offset (bb, off)
-				           && (!nearest_bb || nearest_bb->addr < bb->addr)) {
-					nearest_bb = bb;
-				}
+// blocks sharing the same address are ordered by pointer so each one has its own node
+static int _bb_tree_cmp(const void *incoming, const RBNode *in_tree) {
+	const RAnalBlock *a = (const RAnalBlock *)incoming;
+	const RAnalBlock *b = BB_CONTAINER (in_tree);
+	if (a->rb_addr != b->rb_addr) {
+		return a->rb_addr < b->rb_addr? -1: 1;
+	}
+	if (a != b) {
+		return (size_t)a < (size_t)b? -1: 1;
+	}
+	return 0;
+}
+
+static void _bb_tree_calc_max_addr(RBNode *node) {
+	int i;
+	RAnalBlock *bb = BB_CONTAINER (node);
+	bb->rb_max_addr = bb->rb_addr + (bb->rb_size > 0? bb->rb_size - 1: 0);
+	for (i = 0; i < 2; i++) {
+		if (node->child[i]) {
+			RAnalBlock *bb1 = BB_CONTAINER (node->child[i]);
+			if (bb1->rb_max_addr > bb->rb_max_addr) {
+				bb->rb_max_addr = bb1->rb_max_addr;
 			}
 		}
-		return nearest_bb;
 	}
-	r_list_foreach (anal->fcns, iter, fcn) {
-		r_list_foreach (fcn->bbs, iter2, bb) {
-			if (r_anal_bb_is_in_offset (bb, off)) {
-				return bb;
+}
+
+R_API void r_anal_bb_tree_insert(RAnal *anal, RAnalBlock *bb) {
+	r_return_if_fail (anal && bb);
+	if (bb->rb_anal) {
+		r_anal_bb_tree_update (bb);
+		return;
+	}
+	bb->rb_addr = bb->addr;
+	bb->rb_size = bb->size;
+	r_rbtree_aug_insert (&anal->bb_tree, bb, &bb->rb, _bb_tree_cmp, _bb_tree_calc_max_addr);
+	bb->rb_anal = anal;
+}
+
+R_API void r_anal_bb_tree_delete(RAnalBlock *bb) {
+	if (bb && bb->rb_anal) {
+		r_rbtree_aug_delete (&bb->rb_anal->bb_tree, bb, _bb_tree_cmp, NULL, _bb_tree_calc_max_addr);
+		bb->rb_anal = NULL;
+	}
+}
+
+/* Must be called after changing the address or size of an indexed block */
+R_API void r_anal_bb_tree_update(RAnalBlock *bb) {
+	if (!bb || !bb->rb_anal || (bb->rb_addr == bb->addr && bb->rb_size == bb->size)) {
+		return;
+	}
+	if (bb->rb_addr != bb->addr) {
+		RAnal *anal = bb->rb_anal;
+		r_anal_bb_tree_delete (bb);
+		r_anal_bb_tree_insert (anal, bb);
+	} else {
+		bb->rb_size = bb->size;
+		r_rbtree_aug_update_sum (bb->rb_anal->bb_tree, bb, &bb->rb, _bb_tree_cmp, _bb_tree_calc_max_addr);
+	}
+}
+
+// visit the blocks containing off in address order, keeping the nearest one
+static bool _bb_tree_find(RBNode *node, ut64 off, bool jmpmid, RAnalBlock **nearest) {
+	while (node) {
+		RAnalBlock *bb = BB_CONTAINER (node);
+		if (bb->rb_max_addr < off) {
+			return false;
+		}
+		if (_bb_tree_find (node->child[0], off, jmpmid, nearest)) {
+			return true;
+		}
+		if (bb->rb_addr > off) {
+			return false;
+		}
+		if (r_anal_bb_is_in_offset (bb, off)) {
+			if (jmpmid && r_anal_bb_op_starts_at (bb, off)) {
+				*nearest = bb;
+				return true;
+			}
+			if (!*nearest || (*nearest)->addr < bb->addr) {
+				*nearest = bb;
 			}
 		}
+		node = node->child[1];
 	}
-	return NULL;
+	return false;
+}
+
+/* Returns the innermost block containing off. With jmpmid on x86 a block
+ * with an instruction starting at off is preferred. */
+R_API RAnalBlock *r_anal_bb_from_offset(RAnal *anal, ut64 off) {
+	RAnalBlock *bb = NULL;
+	const bool x86 = anal->cur->arch && !strcmp (anal->cur->arch, "x86");
+	_bb_tree_find (anal->bb_tree, off, anal->opt.jmpmid && x86, &bb);
+	return bb;
 }
 
 R_API RAnalBlock *r_anal_bb_get_jumpbb(RAnalFunction *fcn, RAnalBlock *bb) {
@@ -3,6 +3,7 @@
 #include <r_anal.h>
 #include <r_util.h>
 #include <r_diff.h>
+#include <r_th.h>
 
 R_API RAnalDiff *r_anal_diff_new() {
 	RAnalDiff *diff = R_NEW0 (RAnalDiff);
@@ -170,124 +171,443 @@ R_API bool r_anal_diff_bb(RAnal *anal, RAnalFunction *fcn, RAnalFunction *fcn2)
 	return true;
 }
 
-R_API int r_anal_diff_fcn(RAnal *anal, RList *fcns, RList *fcns2) {
-	RAnalFunction *fcn, *fcn2, *mfcn, *mfcn2;
-	RListIter *iter, *iter2;
-	ut64 maxsize, minsize;
-	double t, ot;
+/* Function matching. Instead of scoring every pair of functions, the
+ * fingerprints are indexed and only plausible pairs get the distance:
+ * - identical fingerprints, found by hash, always match with similarity 1;
+ * - the others are compared with the functions sharing a minhash band of
+ *   their 4 byte shingles (LSH), as long as the byte histograms allow a
+ *   similarity above diff_thfcn. Only the FP_SCORE_MAX ones agreeing on
+ *   most minhashes are scored.
+ * The candidates are scored on anal->diff_jobs threads and then matched in
+ * list order, each function taking the best candidate not yet matched, as
+ * the exhaustive loop did. */
+#define FP_SHINGLE 4
+#define FP_BANDS 16
+#define FP_ROWS 2
+#define FP_HASHES (FP_BANDS * FP_ROWS)
+#define FP_HIST 64
+#define FP_BUCKET_MAX 256
+#define FP_SCORE_MAX 32
+#define FP_CHUNK 64
 
-	if (!anal) {
-		return false;
+typedef struct {
+	RAnalFunction *fcn;
+	ut32 size;
+	bool indexed;
+	ut64 hash;
+	ut32 hist[FP_HIST];
+	ut32 sig[FP_HASHES];
+} DiffFp;
+
+typedef struct {
+	ut64 key;
+	int idx;
+} DiffKey;
+
+typedef struct {
+	int idx;
+	double dist;
+} DiffCand;
+
+typedef struct {
+	RAnal *anal;
+	DiffFp *a;
+	DiffFp *b;
+	int na;
+	int nb;
+	DiffKey *exact;
+	DiffKey *bands[FP_BANDS];
+	int nkeys;
+	int nband;
+	int *pairs;
+	double *dists;
+	RVector *cands;
+} DiffIndex;
+
+static int diff_key_cmp(const void *a, const void *b) {
+	const DiffKey *ka = a, *kb = b;
+	if (ka->key != kb->key) {
+		return ka->key < kb->key? -1: 1;
 	}
-	if (anal->cur && anal->cur->diff_fcn) {
-		return (anal->cur->diff_fcn (anal, fcns, fcns2));
+	return ka->idx - kb->idx;
+}
+
+static int diff_cand_cmp(const void *a, const void *b) {
+	const DiffCand *ca = a, *cb = b;
+	if (ca->dist != cb->dist) {
+		return ca->dist > cb->dist? -1: 1;
 	}
-	/* Compare functions with the same name */
-	if (fcns) {
+	return ca->idx - cb->idx;
+}
+
+static int diff_int_cmp(const void *a, const void *b) {
+	return *(const int *)a - *(const int *)b;
+}
+
+static DiffFp *diff_fps(RList *fcns, int *n) {
+	RAnalFunction *fcn;
+	RListIter *iter;
+	int i = 0;
+	DiffFp *fps = R_NEWS0 (DiffFp, r_list_length (fcns) + 1);
+	if (fps) {
 		r_list_foreach (fcns, iter, fcn) {
-			r_list_foreach (fcns2, iter2, fcn2) {
-				if (fcn->name && fcn2->name && strcmp (fcn->name, fcn2->name)) {
-					continue;
-				}
-				r_diff_buffers_distance (NULL, fcn->fingerprint, r_anal_fcn_size (fcn),
-						fcn2->fingerprint, r_anal_fcn_size (fcn2),
-						NULL, &t);
-				/* Set flag in matched functions */
-				fcn->diff->type = fcn2->diff->type = (t >= 1)
-					? R_ANAL_DIFF_TYPE_MATCH
-					: R_ANAL_DIFF_TYPE_UNMATCH;
-				fcn->diff->dist = fcn2->diff->dist = t;
-				R_FREE (fcn->fingerprint);
-				R_FREE (fcn2->fingerprint);
-				fcn->diff->addr = fcn2->addr;
-				fcn2->diff->addr = fcn->addr;
-				fcn->diff->size = r_anal_fcn_size (fcn2);
-				fcn2->diff->size = r_anal_fcn_size (fcn);
-				R_FREE (fcn->diff->name);
-				if (fcn2->name) {
-					fcn->diff->name = strdup (fcn2->name);
-				}
-				R_FREE (fcn2->diff->name);
-				if (fcn->name) {
-					fcn2->diff->name = strdup (fcn->name);
-				}
-				r_anal_diff_bb (anal, fcn, fcn2);
-				break;
+			fps[i].fcn = fcn;
+			fps[i].size = r_anal_fcn_size (fcn);
+			i++;
+		}
+	}
+	*n = i;
+	return fps;
+}
+
+static int diff_ut32_cmp(const void *a, const void *b) {
+	ut32 x = *(const ut32 *)a, y = *(const ut32 *)b;
+	return (x > y) - (x < y);
+}
+
+/* minhash of the multiset of shingles: the nth copy of a shingle is a
+ * different element, so repetitive code keeps its weight */
+static void diff_fp_sign(DiffFp *fp) {
+	const ut8 *buf = fp->fcn->fingerprint;
+	ut64 h = 0xcbf29ce484222325ULL;
+	ut32 i, k, n, nth = 0;
+	for (i = 0; i < fp->size; i++) {
+		h = (h ^ buf[i]) * 0x100000001b3ULL;
+		fp->hist[buf[i] >> 2]++;
+	}
+	fp->hash = h;
+	memset (fp->sig, 0xff, sizeof (fp->sig));
+	n = (fp->size >= FP_SHINGLE)? fp->size - FP_SHINGLE + 1: 0;
+	ut32 *sh = n? R_NEWS (ut32, n): NULL;
+	if (!sh) {
+		return;
+	}
+	for (i = 0; i < n; i++) {
+		sh[i] = r_read_le32 (buf + i);
+	}
+	qsort (sh, n, sizeof (ut32), diff_ut32_cmp);
+	for (i = 0; i < n; i++) {
+		nth = (i && sh[i] == sh[i - 1])? nth + 1: 0;
+		ut64 x = (((ut64)nth << 32) | sh[i]) * 0x9e3779b97f4a7c15ULL;
+		x ^= x >> 29;
+		for (k = 0; k < FP_HASHES; k++) {
+			ut32 v = (ut32)(((x ^ ((k + 1) * 0xc2b2ae3d27d4eb4fULL)) * 0xff51afd7ed558ccdULL) >> 32);
+			if (v < fp->sig[k]) {
+				fp->sig[k] = v;
 			}
 		}
 	}
-	/* Compare remaining functions */
-	r_list_foreach (fcns, iter, fcn) {
-/*
-		if ((fcn->type != R_ANAL_FCN_TYPE_FCN &&
-			fcn->type != R_ANAL_FCN_TYPE_SYM) ||
-			fcn->diff->type != R_ANAL_DIFF_TYPE_NULL) {
-			continue;
+	free (sh);
+}
+
+static bool diff_sign_job(void *user, int job) {
+	DiffIndex *di = user;
+	int i, end = R_MIN ((job + 1) * FP_CHUNK, di->na + di->nb);
+	for (i = job * FP_CHUNK; i < end; i++) {
+		DiffFp *fp = i < di->na? &di->a[i]: &di->b[i - di->na];
+		if (fp->indexed) {
+			diff_fp_sign (fp);
 		}
-*/
-		if (fcn->diff->type != R_ANAL_DIFF_TYPE_NULL) {
+	}
+	return true;
+}
+
+static inline ut64 diff_band_key(DiffFp *fp, int band) {
+	return ((ut64)fp->sig[band * FP_ROWS] << 32) | fp->sig[band * FP_ROWS + 1];
+}
+
+// first key not below key, or n
+static int diff_keys_find(DiffKey *keys, int n, ut64 key) {
+	int lo = 0, hi = n;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (keys[mid].key < key) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static bool diff_same_fp(DiffFp *a, DiffFp *b) {
+	return a->hash == b->hash && a->size == b->size
+		&& !memcmp (a->fcn->fingerprint, b->fcn->fingerprint, a->size);
+}
+
+/* the edit distance is at least half the L1 distance of the histograms,
+ * and at least the difference of the lengths */
+static double diff_dist_bound(DiffFp *a, DiffFp *b) {
+	ut32 i, l1 = 0;
+	ut32 len = R_MAX (a->size, b->size);
+	for (i = 0; i < FP_HIST; i++) {
+		l1 += (a->hist[i] > b->hist[i])
+			? a->hist[i] - b->hist[i]
+			: b->hist[i] - a->hist[i];
+	}
+	ut32 d = R_MAX ((l1 + 1) / 2, len - R_MIN (a->size, b->size));
+	return len? 1.0 - (double)d / len: 1.0;
+}
+
+static bool diff_cands_job(void *user, int job) {
+	DiffIndex *di = user;
+	double th = di->anal->diff_thfcn;
+	int i, end = R_MIN ((job + 1) * FP_CHUNK, di->na);
+	RVector ids, est;
+	r_vector_init (&ids, sizeof (int), NULL, NULL);
+	r_vector_init (&est, sizeof (DiffCand), NULL, NULL);
+	for (i = job * FP_CHUNK; i < end; i++) {
+		DiffFp *fa = &di->a[i];
+		int b, k, last = -1;
+		if (!fa->indexed || fa->size < FP_SHINGLE) {
 			continue;
 		}
-		ot = 0;
-		mfcn = mfcn2 = NULL;
-		r_list_foreach (fcns2, iter2, fcn2) {
-			int fcn_size = r_anal_fcn_size (fcn);
-			int fcn2_size = r_anal_fcn_size (fcn2);
-			if (fcn_size > fcn2_size) {
-				maxsize = fcn_size;
-				minsize = fcn2_size;
-			} else {
-				maxsize = fcn2_size;
-				minsize = fcn_size;
+		ids.len = 0;
+		for (b = 0; b < FP_BANDS; b++) {
+			ut64 key = diff_band_key (fa, b);
+			DiffKey *keys = di->bands[b];
+			int lo = diff_keys_find (keys, di->nband, key);
+			int hi = lo;
+			while (hi < di->nband && keys[hi].key == key) {
+				hi++;
 			}
-			if (maxsize * anal->diff_thfcn > minsize) {
-				eprintf ("Exceeded anal threshold while diffing %s and %s\n", fcn->name, fcn2->name);
+			if (hi - lo > FP_BUCKET_MAX) {
 				continue;
 			}
-			if (fcn2->diff->type != R_ANAL_DIFF_TYPE_NULL) {
-				eprintf ("Function %s already diffed\n", fcn2->name);
+			for (k = lo; k < hi; k++) {
+				r_vector_push (&ids, &keys[k].idx);
+			}
+		}
+		qsort (ids.a, ids.len, sizeof (int), diff_int_cmp);
+		// rank by the estimated similarity, only the best ones get scored
+		est.len = 0;
+		size_t j;
+		for (j = 0; j < ids.len; j++) {
+			const int *idx = r_vector_index_ptr (&ids, j);
+			if (*idx == last) {
 				continue;
 			}
-			if ((fcn2->type != R_ANAL_FCN_TYPE_FCN && fcn2->type != R_ANAL_FCN_TYPE_SYM)) {
-				eprintf ("Function %s type not supported\n", fcn2->name);
+			last = *idx;
+			DiffFp *fb = &di->b[*idx];
+			ut32 maxsize = R_MAX (fa->size, fb->size);
+			ut32 minsize = R_MIN (fa->size, fb->size);
+			if (maxsize * th > minsize || diff_same_fp (fa, fb)
+					|| diff_dist_bound (fa, fb) <= th) {
 				continue;
 			}
-			r_diff_buffers_distance (NULL, fcn->fingerprint, fcn_size, fcn2->fingerprint, fcn2_size, NULL, &t);
-			fcn->diff->dist = fcn2->diff->dist = t;
-			if (t > anal->diff_thfcn && t > ot) {
-				ot = t;
-				mfcn = fcn;
-				mfcn2 = fcn2;
-				if (t == 1) {
-					break;
-				}
+			DiffCand c = { *idx, 0 };
+			for (k = 0; k < FP_HASHES; k++) {
+				c.dist += fa->sig[k] == fb->sig[k];
 			}
+			r_vector_push (&est, &c);
 		}
-		if (mfcn && mfcn2) {
-			/* Set flag in matched functions */
-			mfcn->diff->type = mfcn2->diff->type = (ot == 1)
-				? R_ANAL_DIFF_TYPE_MATCH
-				: R_ANAL_DIFF_TYPE_UNMATCH;
-			R_FREE (mfcn->fingerprint);
-			R_FREE (mfcn2->fingerprint);
-			mfcn->diff->addr = mfcn2->addr;
-			mfcn2->diff->addr = mfcn->addr;
-			mfcn->diff->size = r_anal_fcn_size (mfcn2);
-			mfcn2->diff->size = r_anal_fcn_size (mfcn);
-			R_FREE (mfcn->diff->name);
-			if (mfcn2->name) {
-				mfcn->diff->name = strdup (mfcn2->name);
+		qsort (est.a, est.len, sizeof (DiffCand), diff_cand_cmp);
+		for (k = 0; k < R_MIN (est.len, FP_SCORE_MAX); k++) {
+			DiffCand c = { ((DiffCand *)est.a)[k].idx, 0 };
+			DiffFp *fb = &di->b[c.idx];
+			r_diff_buffers_distance (NULL, fa->fcn->fingerprint, fa->size,
+				fb->fcn->fingerprint, fb->size, NULL, &c.dist);
+			if (c.dist > th) {
+				r_vector_push (&di->cands[i], &c);
 			}
-			R_FREE (mfcn2->diff->name);
-			if (mfcn->name) {
-				mfcn2->diff->name = strdup (mfcn->name);
+		}
+		qsort (di->cands[i].a, di->cands[i].len, sizeof (DiffCand), diff_cand_cmp);
+	}
+	r_vector_clear (&ids);
+	r_vector_clear (&est);
+	return true;
+}
+
+static bool diff_name_job(void *user, int job) {
+	DiffIndex *di = user;
+	int i, end = R_MIN ((job + 1) * FP_CHUNK, di->na);
+	for (i = job * FP_CHUNK; i < end; i++) {
+		if (di->pairs[i] >= 0) {
+			DiffFp *fa = &di->a[i], *fb = &di->b[di->pairs[i]];
+			r_diff_buffers_distance (NULL, fa->fcn->fingerprint, fa->size,
+				fb->fcn->fingerprint, fb->size, NULL, &di->dists[i]);
+		}
+	}
+	return true;
+}
+
+static void diff_fcn_match(RAnal *anal, RAnalFunction *fcn, RAnalFunction *fcn2, double t) {
+	/* Set flag in matched functions */
+	fcn->diff->type = fcn2->diff->type = (t >= 1)
+		? R_ANAL_DIFF_TYPE_MATCH
+		: R_ANAL_DIFF_TYPE_UNMATCH;
+	fcn->diff->dist = fcn2->diff->dist = t;
+	R_FREE (fcn->fingerprint);
+	R_FREE (fcn2->fingerprint);
+	fcn->diff->addr = fcn2->addr;
+	fcn2->diff->addr = fcn->addr;
+	fcn->diff->size = r_anal_fcn_size (fcn2);
+	fcn2->diff->size = r_anal_fcn_size (fcn);
+	R_FREE (fcn->diff->name);
+	if (fcn2->name) {
+		fcn->diff->name = strdup (fcn2->name);
+	}
+	R_FREE (fcn2->diff->name);
+	if (fcn->name) {
+		fcn2->diff->name = strdup (fcn->name);
+	}
+	r_anal_diff_bb (anal, fcn, fcn2);
+}
+
+/* Compare functions with the same name, a nameless one matches any */
+static void diff_by_name(DiffIndex *di, RThreadPool *pool) {
+	HtPP *names = ht_pp_new0 ();
+	int i, unnamed = -1;
+	for (i = di->nb - 1; i >= 0; i--) {
+		const char *name = di->b[i].fcn->name;
+		if (name) {
+			ht_pp_update (names, name, (void *)(size_t)(i + 1));
+		} else {
+			unnamed = i;
+		}
+	}
+	for (i = 0; i < di->na; i++) {
+		const char *name = di->a[i].fcn->name;
+		int j = name? (int)(size_t)ht_pp_find (names, name, NULL) - 1: 0;
+		if (unnamed >= 0 && (j < 0 || unnamed < j)) {
+			j = unnamed;
+		}
+		di->pairs[i] = (j < di->nb)? j: -1;
+	}
+	ht_pp_free (names);
+	r_th_pool_run (pool, (di->na + FP_CHUNK - 1) / FP_CHUNK, diff_name_job, di);
+	for (i = 0; i < di->na; i++) {
+		if (di->pairs[i] >= 0) {
+			diff_fcn_match (di->anal, di->a[i].fcn, di->b[di->pairs[i]].fcn, di->dists[i]);
+		}
+	}
+}
+
+static bool diff_fp_ok(DiffFp *fp) {
+	return fp->fcn->fingerprint && fp->fcn->diff->type == R_ANAL_DIFF_TYPE_NULL;
+}
+
+/* Compare remaining functions */
+static bool diff_by_index(DiffIndex *di, RThreadPool *pool) {
+	int i, b, n = 0;
+	for (i = 0; i < di->na; i++) {
+		di->a[i].indexed = diff_fp_ok (&di->a[i]);
+	}
+	for (i = 0; i < di->nb; i++) {
+		RAnalFunction *fcn2 = di->b[i].fcn;
+		di->b[i].indexed = diff_fp_ok (&di->b[i])
+			&& (fcn2->type == R_ANAL_FCN_TYPE_FCN || fcn2->type == R_ANAL_FCN_TYPE_SYM);
+		n += di->b[i].indexed;
+	}
+	r_th_pool_run (pool, (di->na + di->nb + FP_CHUNK - 1) / FP_CHUNK, diff_sign_job, di);
+	di->exact = R_NEWS (DiffKey, n + 1);
+	di->cands = R_NEWS0 (RVector, di->na + 1);
+	if (!di->exact || !di->cands) {
+		return false;
+	}
+	for (b = 0; b < FP_BANDS; b++) {
+		if (!(di->bands[b] = R_NEWS (DiffKey, n + 1))) {
+			return false;
+		}
+	}
+	for (i = 0; i < di->nb; i++) {
+		DiffFp *fb = &di->b[i];
+		if (!fb->indexed) {
+			continue;
+		}
+		di->exact[di->nkeys++] = (DiffKey){ fb->hash, i };
+		if (fb->size >= FP_SHINGLE) {
+			for (b = 0; b < FP_BANDS; b++) {
+				di->bands[b][di->nband] = (DiffKey){ diff_band_key (fb, b), i };
 			}
-			r_anal_diff_bb (anal, mfcn, mfcn2);
+			di->nband++;
+		}
+	}
+	qsort (di->exact, di->nkeys, sizeof (DiffKey), diff_key_cmp);
+	for (b = 0; b < FP_BANDS; b++) {
+		qsort (di->bands[b], di->nband, sizeof (DiffKey), diff_key_cmp);
+	}
+	for (i = 0; i < di->na; i++) {
+		r_vector_init (&di->cands[i], sizeof (DiffCand), NULL, NULL);
+	}
+	r_th_pool_run (pool, (di->na + FP_CHUNK - 1) / FP_CHUNK, diff_cands_job, di);
+	for (i = 0; i < di->na; i++) {
+		DiffFp *fa = &di->a[i];
+		RAnalFunction *fcn2 = NULL;
+		double t = 1;
+		int k;
+		if (!fa->indexed || fa->fcn->diff->type != R_ANAL_DIFF_TYPE_NULL) {
+			continue;
+		}
+		k = (di->anal->diff_thfcn < 1)? diff_keys_find (di->exact, di->nkeys, fa->hash): di->nkeys;
+		for (; k < di->nkeys && di->exact[k].key == fa->hash; k++) {
+			DiffFp *fb = &di->b[di->exact[k].idx];
+			if (fb->fcn->diff->type == R_ANAL_DIFF_TYPE_NULL && diff_same_fp (fa, fb)) {
+				fcn2 = fb->fcn;
+				break;
+			}
+		}
+		if (!fcn2) {
+			DiffCand *c;
+			r_vector_foreach (&di->cands[i], c) {
+				if (di->b[c->idx].fcn->diff->type == R_ANAL_DIFF_TYPE_NULL) {
+					fcn2 = di->b[c->idx].fcn;
+					t = c->dist;
+					break;
+				}
+			}
+		}
+		if (fcn2) {
+			diff_fcn_match (di->anal, fa->fcn, fcn2, t);
 		}
 	}
 	return true;
 }
 
+static void diff_index_fini(DiffIndex *di) {
+	int i;
+	if (di->cands) {
+		for (i = 0; i < di->na; i++) {
+			r_vector_clear (&di->cands[i]);
+		}
+		free (di->cands);
+	}
+	for (i = 0; i < FP_BANDS; i++) {
+		free (di->bands[i]);
+	}
+	free (di->exact);
+	free (di->pairs);
+	free (di->dists);
+	free (di->a);
+	free (di->b);
+}
+
+R_API int r_anal_diff_fcn(RAnal *anal, RList *fcns, RList *fcns2) {
+	DiffIndex di = { anal };
+	bool ret = false;
+
+	if (!anal) {
+		return false;
+	}
+	if (anal->cur && anal->cur->diff_fcn) {
+		return (anal->cur->diff_fcn (anal, fcns, fcns2));
+	}
+	RThreadPool *pool = r_th_pool_new (anal->diff_jobs);
+	di.a = diff_fps (fcns, &di.na);
+	di.b = diff_fps (fcns2, &di.nb);
+	di.pairs = R_NEWS (int, di.na + 1);
+	di.dists = R_NEWS0 (double, di.na + 1);
+	if (pool && di.a && di.b && di.pairs && di.dists) {
+		if (fcns) {
+			diff_by_name (&di, pool);
+		}
+		ret = diff_by_index (&di, pool);
+	}
+	diff_index_fini (&di);
+	r_th_pool_free (pool);
+	return ret;
+}
+
 R_API int r_anal_diff_eval(RAnal *anal) {
 	if (anal && anal->cur && anal->cur->diff_eval) {
 		return (anal->cur->diff_eval (anal));
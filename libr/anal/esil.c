@@ -67,17 +67,6 @@ static bool isregornum(RAnalEsil *esil, const char *str, ut64 *num) {
 	return true;
 }
 
-/* pop Register or Number */
-static bool popRN(RAnalEsil *esil, ut64 *n) {
-	char *str = r_anal_esil_pop (esil);
-	if (str) {
-		bool ret = isregornum (esil, str, n);
-		free (str);
-		return ret;
-	}
-	return false;
-}
-
 /* R_ANAL_ESIL API */
 
 R_API RAnalEsil *r_anal_esil_new(int stacksize, int iotrap, unsigned int addrsize) {
@@ -89,10 +78,11 @@ R_API RAnalEsil *r_anal_esil_new(int stacksize, int iotrap, unsigned int addrsiz
 		free (esil);
 		return NULL;
 	}
-	if (!(esil->stack = calloc (sizeof (char *), stacksize))) {
+	if (!(esil->stack = calloc (sizeof (RAnalEsilValue), stacksize))) {
 		free (esil);
 		return NULL;
 	}
+	esil->stack_typed = true;
 	esil->verbose = false;
 	esil->stacksize = stacksize;
 	esil->parse_goto_count = R_ANAL_ESIL_GOTO_LIMIT;
@@ -116,6 +106,8 @@ R_API int r_anal_esil_set_op(RAnalEsil *esil, const char *op, RAnalEsilOp code)
 		eprintf ("can't set esil-op %s\n", op);
 		return false;
 	}
+	// compiled expressions hold resolved op pointers
+	r_anal_esil_code_flush (esil);
 	return true;
 }
 
@@ -159,6 +151,7 @@ R_API void r_anal_esil_free(RAnalEsil *esil) {
 	}
 	sdb_free (esil->ops);
 	esil->ops = NULL;
+	r_anal_esil_code_flush (esil);
 	r_anal_esil_interrupts_fini (esil);
 	r_anal_esil_sources_fini (esil);
 	sdb_free (esil->stats);
@@ -401,28 +394,6 @@ static int internal_esil_reg_write_no_null (RAnalEsil *esil, const char *regname
 	return false;
 }
 
-R_API int r_anal_esil_pushnum(RAnalEsil *esil, ut64 num) {
-	char str[64];
-	snprintf (str, sizeof (str) - 1, "0x%" PFMT64x, num);
-	return r_anal_esil_push (esil, str);
-}
-
-R_API bool r_anal_esil_push(RAnalEsil *esil, const char *str) {
-	if (!str || !esil || !*str || esil->stackptr > (esil->stacksize - 1)) {
-		return false;
-	}
-	esil->stack[esil->stackptr++] = strdup (str);
-	return true;
-}
-
-R_API char *r_anal_esil_pop(RAnalEsil *esil) {
-	r_return_val_if_fail (esil, NULL);
-	if (esil->stackptr < 1) {
-		return NULL;
-	}
-	return esil->stack[--esil->stackptr];
-}
-
 R_API int r_anal_esil_get_parm_type(RAnalEsil *esil, const char *str) {
 	int len, i;
 
@@ -523,27 +494,221 @@ R_API int r_anal_esil_reg_read(RAnalEsil *esil, const char *regname, ut64 *num,
 	return ret;
 }
 
+static void esil_val_fini(RAnalEsilValue *v) {
+	R_FREE (v->str);
+	v->type = R_ANAL_ESIL_VAL_NONE;
+}
+
+static bool esil_val_set(RAnalEsilValue *v, int type, const char *str) {
+	size_t len = strlen (str);
+	v->type = type;
+	if (len < sizeof (v->text)) {
+		memcpy (v->text, str, len + 1);
+		v->str = NULL;
+	} else {
+		*v->text = 0;
+		if (!(v->str = strdup (str))) {
+			v->type = R_ANAL_ESIL_VAL_NONE;
+			return false;
+		}
+	}
+	return true;
+}
+
+/* returns the word a string stack would hold for this value */
+static const char *esil_val_str(RAnalEsilValue *v) {
+	if (v->type == R_ANAL_ESIL_VAL_NONE) {
+		return NULL;
+	}
+	if (v->str) {
+		return v->str;
+	}
+	if (!*v->text) {
+		// computed numbers are formatted on demand
+		snprintf (v->text, sizeof (v->text), "0x%" PFMT64x, v->num);
+	}
+	return v->text;
+}
+
+static bool esil_val_from_str(RAnalEsil *esil, RAnalEsilValue *v, const char *str) {
+	int type = R_ANAL_ESIL_VAL_STR;
+	v->num = 0;
+	if (esil->stack_typed && esil->anal && esil->anal->reg) {
+		switch (r_anal_esil_get_parm_type (esil, str)) {
+		case R_ANAL_ESIL_PARM_NUM:
+			// "-1" is a number for get_parm but not for isregornum
+			if (IS_DIGIT (*str)) {
+				type = R_ANAL_ESIL_VAL_NUM;
+				v->num = r_num_get (NULL, str);
+			}
+			break;
+		case R_ANAL_ESIL_PARM_REG:
+			type = R_ANAL_ESIL_VAL_REG;
+			break;
+		}
+	}
+	return esil_val_set (v, type, str);
+}
+
+static bool esil_val_pop(RAnalEsil *esil, RAnalEsilValue *v) {
+	if (esil->stackptr < 1) {
+		v->type = R_ANAL_ESIL_VAL_NONE;
+		v->str = NULL;
+		return false;
+	}
+	RAnalEsilValue *top = &esil->stack[--esil->stackptr];
+	*v = *top;
+	top->type = R_ANAL_ESIL_VAL_NONE;
+	top->str = NULL;
+	return true;
+}
+
+/* same as r_anal_esil_get_parm_type on the word */
+static int esil_val_parm_type(RAnalEsil *esil, RAnalEsilValue *v) {
+	switch (v->type) {
+	case R_ANAL_ESIL_VAL_NUM:
+		return R_ANAL_ESIL_PARM_NUM;
+	case R_ANAL_ESIL_VAL_REG:
+		return R_ANAL_ESIL_PARM_REG;
+	case R_ANAL_ESIL_VAL_STR:
+		return r_anal_esil_get_parm_type (esil, esil_val_str (v));
+	}
+	return R_ANAL_ESIL_PARM_INVALID;
+}
+
+/* same as r_anal_esil_reg_read on the word */
+static bool esil_val_reg_read(RAnalEsil *esil, RAnalEsilValue *v, ut64 *num, int *size) {
+	if (v->type == R_ANAL_ESIL_VAL_NUM && !esil->cb.hook_reg_read
+			&& esil->cb.reg_read == internal_esil_reg_read) {
+		// no need to look up numbers in the register profile
+		if (num) {
+			*num = 0;
+		}
+		if (size) {
+			*size = esil->anal->bits;
+		}
+		return false;
+	}
+	return r_anal_esil_reg_read (esil, esil_val_str (v), num, size);
+}
+
+static int esil_val_reg_write(RAnalEsil *esil, RAnalEsilValue *v, ut64 num) {
+	return r_anal_esil_reg_write (esil, esil_val_str (v), num);
+}
+
+/* same as r_anal_esil_get_parm_size on the word */
+static bool esil_val_parm_size(RAnalEsil *esil, RAnalEsilValue *v, ut64 *num, int *size) {
+	switch (v->type) {
+	case R_ANAL_ESIL_VAL_NUM:
+		*num = v->num;
+		if (size) {
+			*size = esil->anal->bits;
+		}
+		return true;
+	case R_ANAL_ESIL_VAL_REG:
+		return r_anal_esil_reg_read (esil, esil_val_str (v), num, size);
+	case R_ANAL_ESIL_VAL_STR:
+		return r_anal_esil_get_parm_size (esil, esil_val_str (v), num, size);
+	}
+	return false;
+}
+
+static bool esil_val_parm(RAnalEsil *esil, RAnalEsilValue *v, ut64 *num) {
+	return esil_val_parm_size (esil, v, num, NULL);
+}
+
+/* same as isregornum on the word */
+static bool esil_val_regornum(RAnalEsil *esil, RAnalEsilValue *v, ut64 *num) {
+	if (v->type == R_ANAL_ESIL_VAL_NUM) {
+		if (!esil_val_reg_read (esil, v, num, NULL)) {
+			*num = v->num;
+		}
+		return true;
+	}
+	return isregornum (esil, esil_val_str (v), num);
+}
+
+/* pop Register or Number */
+static bool popRN(RAnalEsil *esil, ut64 *n) {
+	RAnalEsilValue v;
+	if (esil_val_pop (esil, &v)) {
+		bool ret = esil_val_regornum (esil, &v, n);
+		esil_val_fini (&v);
+		return ret;
+	}
+	return false;
+}
+
+R_API bool r_anal_esil_push_value(RAnalEsil *esil, const RAnalEsilValue *val) {
+	r_return_val_if_fail (esil && val, false);
+	if (val->type == R_ANAL_ESIL_VAL_NONE || esil->stackptr > (esil->stacksize - 1)) {
+		return false;
+	}
+	RAnalEsilValue *v = &esil->stack[esil->stackptr];
+	if (!esil->stack_typed && val->type != R_ANAL_ESIL_VAL_STR) {
+		RAnalEsilValue tmp = *val;
+		if (!esil_val_set (v, R_ANAL_ESIL_VAL_STR, esil_val_str (&tmp))) {
+			return false;
+		}
+	} else {
+		*v = *val;
+		if (val->str && !(v->str = strdup (val->str))) {
+			v->type = R_ANAL_ESIL_VAL_NONE;
+			return false;
+		}
+	}
+	esil->stackptr++;
+	return true;
+}
+
+R_API int r_anal_esil_pushnum(RAnalEsil *esil, ut64 num) {
+	RAnalEsilValue v = { .type = R_ANAL_ESIL_VAL_NUM, .num = num };
+	return r_anal_esil_push_value (esil, &v);
+}
+
+R_API bool r_anal_esil_push(RAnalEsil *esil, const char *str) {
+	if (!str || !esil || !*str || esil->stackptr > (esil->stacksize - 1)) {
+		return false;
+	}
+	if (!esil_val_from_str (esil, &esil->stack[esil->stackptr], str)) {
+		return false;
+	}
+	esil->stackptr++;
+	return true;
+}
+
+R_API char *r_anal_esil_pop(RAnalEsil *esil) {
+	r_return_val_if_fail (esil, NULL);
+	RAnalEsilValue v;
+	if (!esil_val_pop (esil, &v)) {
+		return NULL;
+	}
+	// long words already live in the heap, hand them over
+	return v.str? v.str: strdup (esil_val_str (&v));
+}
+
 static int esil_zf(RAnalEsil *esil) {
 	return r_anal_esil_pushnum (esil, !(esil->cur & genmask (esil->lastsz - 1)));
 }
 
 static int esil_cf(RAnalEsil *esil) {
-	char *src = r_anal_esil_pop (esil);
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src);
 
-	if (!src) {
+	if (!src.type) {
 		return 0;
 	}
 
-	if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_NUM) {
+	if (esil_val_parm_type (esil, &src) != R_ANAL_ESIL_PARM_NUM) {
 		//I'd wish we could enforce consts here
 		//I can't say why, but I feel like "al,$c" would be cancer af
 		//	- condret
-		free (src);
+		esil_val_fini (&src);
 		return 0;
 	}
 	ut64 bit;
-	r_anal_esil_get_parm (esil, src, &bit);
-	free (src);
+	esil_val_parm (esil, &src, &bit);
+	esil_val_fini (&src);
 	//carry from bit <src>
 	//range of src goes from 0 to 63
 	//
@@ -553,19 +718,20 @@ static int esil_cf(RAnalEsil *esil) {
 }
 
 static int esil_bf(RAnalEsil *esil) {
-	char *src = r_anal_esil_pop (esil);
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src);
 
-	if (!src) {
+	if (!src.type) {
 		return 0;
 	}
 
-	if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_NUM) {
-		free (src);
+	if (esil_val_parm_type (esil, &src) != R_ANAL_ESIL_PARM_NUM) {
+		esil_val_fini (&src);
 		return 0;
 	}
 	ut64 bit;
-	r_anal_esil_get_parm (esil, src, &bit);
-	free (src);
+	esil_val_parm (esil, &src, &bit);
+	esil_val_fini (&src);
 	//borrow from bit <src>
 	//range of src goes from 1 to 64
 	//	you cannot borrow from bit 0, bc bit -1 cannot not exist
@@ -647,101 +813,106 @@ static int esil_address(RAnalEsil *esil) {
 }
 
 static int esil_weak_eq(RAnalEsil *esil) {
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
 
-	if (!(dst && src && (r_anal_esil_get_parm_type(esil, dst) == R_ANAL_ESIL_PARM_REG))) {
-		free (dst);
-		free (src);
+	if (!(dst.type && src.type && (esil_val_parm_type (esil, &dst) == R_ANAL_ESIL_PARM_REG))) {
+		esil_val_fini (&dst);
+		esil_val_fini (&src);
 		return 0;
 	}
 
 	ut64 src_num;
-	if (r_anal_esil_get_parm (esil, src, &src_num)) {
-		(void)r_anal_esil_reg_write (esil, dst, src_num);
-		free (src);
-		free (dst);
+	if (esil_val_parm (esil, &src, &src_num)) {
+		(void)esil_val_reg_write (esil, &dst, src_num);
+		esil_val_fini (&src);
+		esil_val_fini (&dst);
 		return 1;
 	}
 	
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return 0;
 }
 
 static int esil_eq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (!src || !dst) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (!src.type || !dst.type) {
 		if (esil->verbose) {
 			eprintf ("Missing elements in the esil stack for '=' at 0x%08"PFMT64x"\n", esil->address);
 		}
 		return 0;
 	}
-	if (ispackedreg (esil, dst)) {
-		char *src2 = r_anal_esil_pop (esil);
-		char *newreg = r_str_newf ("%sl", dst);
-		if (r_anal_esil_get_parm (esil, src2, &num2)) {
+	if (ispackedreg (esil, esil_val_str (&dst))) {
+		RAnalEsilValue src2;
+		esil_val_pop (esil, &src2);
+		char *newreg = r_str_newf ("%sl", esil_val_str (&dst));
+		if (esil_val_parm (esil, &src2, &num2)) {
 			ret = r_anal_esil_reg_write (esil, newreg, num2);
 		}
 		free (newreg);
-		free (src2);
+		esil_val_fini (&src2);
 	}
 
-	if (src && dst && r_anal_esil_reg_read_nocallback (esil, dst, &num, NULL)) {
-		if (r_anal_esil_get_parm (esil, src, &num2)) {
-			ret = r_anal_esil_reg_write (esil, dst, num2);
+	if (src.type && dst.type && r_anal_esil_reg_read_nocallback (esil, esil_val_str (&dst), &num, NULL)) {
+		if (esil_val_parm (esil, &src, &num2)) {
+			ret = esil_val_reg_write (esil, &dst, num2);
 			esil->cur = num2;
 			esil->old = num;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+			esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
 		} else {
 			ERR ("esil_eq: invalid src");
 		}
 	} else {
 		ERR ("esil_eq: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_neg(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num;
-	char *src = r_anal_esil_pop (esil);
-	if (src) {
-		if (r_anal_esil_get_parm (esil, src, &num)) {
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src);
+	if (src.type) {
+		if (esil_val_parm (esil, &src, &num)) {
 			r_anal_esil_pushnum (esil, !num);
 			ret = 1;
 		} else {
-			if (isregornum (esil, src, &num)) {
+			if (esil_val_regornum (esil, &src, &num)) {
 				ret = 1;
 				r_anal_esil_pushnum (esil, !num);
 			} else {
-				eprintf ("0x%08"PFMT64x" esil_neg: unknown reg %s\n", esil->address, src);
+				eprintf ("0x%08"PFMT64x" esil_neg: unknown reg %s\n", esil->address, esil_val_str (&src));
 			}
 		}
 	} else {
 		ERR ("esil_neg: empty stack");
 	}
-	free (src);
+	esil_val_fini (&src);
 	return ret;
 }
 
 static int esil_negeq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num;
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_reg_read (esil, src, &num, NULL)) {
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_reg_read (esil, &src, &num, NULL)) {
 		num = !num;
-		r_anal_esil_reg_write (esil, src, num);
+		esil_val_reg_write (esil, &src, num);
 		ret = 1;
 	} else {
 		ERR ("esil_negeq: empty stack");
 	}
-	free (src);
+	esil_val_fini (&src);
 	//r_anal_esil_pushnum (esil, ret);
 	return ret;
 }
@@ -753,61 +924,64 @@ static int esil_nop(RAnalEsil *esil) {
 static int esil_andeq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_reg_read (esil, &dst, &num, NULL)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num & num2;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			r_anal_esil_reg_write (esil, dst, num & num2);
+			esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			esil_val_reg_write (esil, &dst, num & num2);
 			ret = 1;
 		} else {
 			ERR ("esil_andeq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_oreq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_reg_read (esil, &dst, &num, NULL)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num | num2;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			ret = r_anal_esil_reg_write (esil, dst, num | num2);
+			esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			ret = esil_val_reg_write (esil, &dst, num | num2);
 		} else {
 			ERR ("esil_ordeq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_xoreq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_reg_read (esil, &dst, &num, NULL)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 				esil->old = num;
 				esil->cur = num ^ num2;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			ret = r_anal_esil_reg_write (esil, dst, num ^ num2);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			ret = esil_val_reg_write (esil, &dst, num ^ num2);
 		} else {
 			ERR ("esil_xoreq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
@@ -902,25 +1076,26 @@ static int esil_interrupt(RAnalEsil *esil) {
 static int esil_cmp(RAnalEsil *esil) {
 	ut64 num, num2;
 	int ret = 0;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm (esil, &dst, &num)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = 1;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_val_parm_type (esil, &dst) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			} else if (esil_val_parm_type (esil, &src) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&src));
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
 			}
 		}
 	}
-	free (dst);
-	free (src);
+	esil_val_fini (&dst);
+	esil_val_fini (&src);
 	return ret;
 }
 
@@ -989,15 +1164,16 @@ static int esil_if(RAnalEsil *esil) {
 		esil->skip++;
 		return true;
 	}
-	char *src = r_anal_esil_pop (esil);
-	if (src) {
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src);
+	if (src.type) {
 		// TODO: check return value
-		(void)r_anal_esil_get_parm (esil, src, &num);
+		(void)esil_val_parm (esil, &src, &num);
 		// condition not matching, skipping until }
 		if (!num) {
 			esil->skip++;
 		}
-		free (src);
+		esil_val_fini (&src);
 		return true;
 	}
 	return false;
@@ -1006,10 +1182,11 @@ static int esil_if(RAnalEsil *esil) {
 static int esil_lsl(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm (esil, &dst, &num)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			if (num2 > sizeof (ut64) * 8) {
 				ERR ("esil_lsl: shift is too big");
 			} else {
@@ -1024,18 +1201,19 @@ static int esil_lsl(RAnalEsil *esil) {
 			ERR ("esil_lsl: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_lsleq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_reg_read (esil, &dst, &num, NULL)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			if (num2 > sizeof (ut64) * 8) {
 				ERR ("esil_lsleq: shift is too big");
 			} else {
@@ -1046,26 +1224,27 @@ static int esil_lsleq(RAnalEsil *esil) {
 					num <<= num2;
 				}
 				esil->cur = num;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-				r_anal_esil_reg_write (esil, dst, num);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+				esil_val_reg_write (esil, &dst, num);
 				ret = 1;
 			}
 		} else {
 			ERR ("esil_lsleq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_lsr(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm (esil, &dst, &num)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			ut64 res = num >> R_MIN (num2, 63);
 			r_anal_esil_pushnum (esil, res);
 			ret = 1;
@@ -1073,18 +1252,19 @@ static int esil_lsr(RAnalEsil *esil) {
 			ERR ("esil_lsr: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_lsreq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_reg_read (esil, &dst, &num, NULL)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			if (num2 > 63) {
 				eprintf ("Invalid shift at 0x%08"PFMT64x"\n", esil->address);
 				num2 = 63;
@@ -1092,25 +1272,26 @@ static int esil_lsreq(RAnalEsil *esil) {
 			esil->old = num;
 			num >>= num2;
 			esil->cur = num;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			r_anal_esil_reg_write (esil, dst, num);
+			esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			esil_val_reg_write (esil, &dst, num);
 			ret = 1;
 		} else {
 			ERR ("esil_lsreq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_asreq(RAnalEsil *esil) {
 	int regsize = 0, ret = 0;
 	ut64 op_num, param_num;
-	char *op = r_anal_esil_pop (esil);
-	char *param = r_anal_esil_pop (esil);
-	if (op && r_anal_esil_get_parm_size (esil, op, &op_num, &regsize)) {
-		if (param && r_anal_esil_get_parm (esil, param, &param_num)) {
+	RAnalEsilValue op, param;
+	esil_val_pop (esil, &op);
+	esil_val_pop (esil, &param);
+	if (op.type && esil_val_parm_size (esil, &op, &op_num, &regsize)) {
+		if (param.type && esil_val_parm (esil, &param, &param_num)) {
 			ut64 mask = (regsize - 1);
 			param_num &= mask;
 			bool isNegative;
@@ -1164,26 +1345,27 @@ static int esil_asreq(RAnalEsil *esil) {
 			}
 			ut64 res = op_num;
 			esil->cur = res;
-			esil->lastsz = esil_internal_sizeof_reg (esil, op);
-			r_anal_esil_reg_write (esil, op, res);
+			esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&op));
+			esil_val_reg_write (esil, &op, res);
 			// r_anal_esil_pushnum (esil, res);
 			ret = 1;
 		} else {
 			ERR ("esil_asr: empty stack");
 		}
 	}
-	free (param);
-	free (op);
+	esil_val_fini (&param);
+	esil_val_fini (&op);
 	return ret;
 }
 
 static int esil_asr(RAnalEsil *esil) {
 	int regsize = 0, ret = 0;
 	ut64 op_num = 0, param_num = 0;
-	char *op = r_anal_esil_pop (esil);
-	char *param = r_anal_esil_pop (esil);
-	if (op && r_anal_esil_get_parm_size (esil, op, &op_num, &regsize)) {
-		if (param && r_anal_esil_get_parm (esil, param, &param_num)) {
+	RAnalEsilValue op, param;
+	esil_val_pop (esil, &op);
+	esil_val_pop (esil, &param);
+	if (op.type && esil_val_parm_size (esil, &op, &op_num, &regsize)) {
+		if (param.type && esil_val_parm (esil, &param, &param_num)) {
 			if (param_num > regsize - 1) {
 				// capstone bug?
 				if (esil->verbose) {
@@ -1218,18 +1400,19 @@ static int esil_asr(RAnalEsil *esil) {
 			ERR ("esil_asr: empty stack");
 		}
 	}
-	free (param);
-	free (op);
+	esil_val_fini (&param);
+	esil_val_fini (&op);
 	return ret;
 }
 
 static int esil_ror(RAnalEsil *esil) {
 	int regsize, ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm_size (esil, dst, &num, &regsize)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm_size (esil, &dst, &num, &regsize)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			ut64 mask = (regsize - 1);
 			num2 &= mask;
 			ut64 res = (num >> num2) | (num << ((-(st64)num2) & mask));
@@ -1239,18 +1422,19 @@ static int esil_ror(RAnalEsil *esil) {
 			ERR ("esil_ror: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_rol(RAnalEsil *esil) {
 	int regsize, ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm_size (esil, dst, &num, &regsize)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm_size (esil, &dst, &num, &regsize)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			ut64 mask = (regsize - 1);
 			num2 &= mask;
 			ut64 res = (num << num2) | (num >> ((-(st64)num2) & mask));
@@ -1260,18 +1444,19 @@ static int esil_rol(RAnalEsil *esil) {
 			ERR ("esil_rol: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_and(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm (esil, &dst, &num)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			num &= num2;
 			r_anal_esil_pushnum (esil, num);
 			ret = 1;
@@ -1279,18 +1464,19 @@ static int esil_and(RAnalEsil *esil) {
 			ERR ("esil_and: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_xor(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm (esil, &dst, &num)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			num ^= num2;
 			r_anal_esil_pushnum (esil, num);
 			ret = 1;
@@ -1298,18 +1484,19 @@ static int esil_xor(RAnalEsil *esil) {
 			ERR ("esil_xor: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_or(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm (esil, &dst, &num)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			num |= num2;
 			r_anal_esil_pushnum (esil, num);
 			ret = 1;
@@ -1317,8 +1504,8 @@ static int esil_or(RAnalEsil *esil) {
 			ERR ("esil_xor: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
@@ -1359,7 +1546,7 @@ R_API int r_anal_esil_dumpstack(RAnalEsil *esil) {
 		return 0;
 	}
 	for (i = esil->stackptr - 1; i >= 0; i--) {
-		esil->anal->cb_printf ("%s\n", esil->stack[i]);
+		esil->anal->cb_printf ("%s\n", esil_val_str (&esil->stack[i]));
 	}
 	return 1;
 }
@@ -1370,9 +1557,9 @@ static int esil_break(RAnalEsil *esil) {
 }
 
 static int esil_clear(RAnalEsil *esil) {
-	char *r;
-	while ((r = r_anal_esil_pop (esil))) {
-		free (r);
+	RAnalEsilValue v;
+	while (esil_val_pop (esil, &v)) {
+		esil_val_fini (&v);
 	}
 	return 1;
 }
@@ -1384,42 +1571,47 @@ static int esil_todo(RAnalEsil *esil) {
 
 static int esil_goto(RAnalEsil *esil) {
 	ut64 num = 0;
-	char *src = r_anal_esil_pop (esil);
-	if (src && *src && r_anal_esil_get_parm (esil, src, &num)) {
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &num)) {
 		esil->parse_goto = num;
 	}
-	free (src);
+	esil_val_fini (&src);
 	return 1;
 }
 
 static int esil_repeat(RAnalEsil *esil) {
-	char *dst = r_anal_esil_pop (esil); // destaintion of the goto
-	char *src = r_anal_esil_pop (esil); // value of the counter
+	RAnalEsilValue dst;
+	esil_val_pop (esil, &dst); // destaintion of the goto
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src); // value of the counter
 	ut64 n, num = 0;
-	if (r_anal_esil_get_parm (esil, src, &n) && r_anal_esil_get_parm (esil, dst, &num)) {
+	if (esil_val_parm (esil, &src, &n) && esil_val_parm (esil, &dst, &num)) {
 		if (n > 1) {
 			esil->parse_goto = num;
 			r_anal_esil_pushnum (esil, n - 1);
 		}
 	}
-	free (dst);
-	free (src);
+	esil_val_fini (&dst);
+	esil_val_fini (&src);
 	return 1;
 }
 
 static int esil_pop(RAnalEsil *esil) {
-	char *dst = r_anal_esil_pop (esil);
-	free (dst);
+	RAnalEsilValue dst;
+	esil_val_pop (esil, &dst);
+	esil_val_fini (&dst);
 	return 1;
 }
 
 static int esil_mod(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &d)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
+		if (dst.type && esil_val_parm (esil, &dst, &d)) {
 			if (s == 0) {
 				if (esil->verbose > 0) {
 					eprintf ("0x%08"PFMT64x" esil_mod: Division by zero!\n", esil->address);
@@ -1434,23 +1626,24 @@ static int esil_mod(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_mod: invalid parameters");
 	}
-	free (dst);
-	free (src);
+	esil_val_fini (&dst);
+	esil_val_fini (&src);
 	return ret;
 }
 
 static int esil_modeq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
+		if (dst.type && esil_val_reg_read (esil, &dst, &d, NULL)) {
 			if (s) {
 				esil->old = d;
 				esil->cur = d % s;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-				r_anal_esil_reg_write (esil, dst, d % s);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+				esil_val_reg_write (esil, &dst, d % s);
 			} else {
 				ERR ("esil_modeq: Division by zero!");
 				esil->trap = R_ANAL_TRAP_DIVBYZERO;
@@ -1463,18 +1656,19 @@ static int esil_modeq(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_modeq: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_div(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &d)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
+		if (dst.type && esil_val_parm (esil, &dst, &d)) {
 			if (s == 0) {
 				ERR ("esil_div: Division by zero!");
 				esil->trap = R_ANAL_TRAP_DIVBYZERO;
@@ -1487,23 +1681,24 @@ static int esil_div(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_div: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_diveq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
+		if (dst.type && esil_val_reg_read (esil, &dst, &d, NULL)) {
 			if (s) {
 				esil->old = d;
 				esil->cur = d / s;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-				r_anal_esil_reg_write (esil, dst, d / s);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+				esil_val_reg_write (esil, &dst, d / s);
 			} else {
 				// eprintf ("0x%08"PFMT64x" esil_diveq: Division by zero!\n", esil->address);
 				esil->trap = R_ANAL_TRAP_DIVBYZERO;
@@ -1516,18 +1711,19 @@ static int esil_diveq(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_diveq: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_mul(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &d)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
+		if (dst.type && esil_val_parm (esil, &dst, &d)) {
 			r_anal_esil_pushnum (esil, d * s);
 			ret = 1;
 		} else {
@@ -1536,165 +1732,174 @@ static int esil_mul(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_mul: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_muleq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
+		if (dst.type && esil_val_reg_read (esil, &dst, &d, NULL)) {
 			esil->old = d;
 			esil->cur = d * s;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			ret = r_anal_esil_reg_write (esil, dst, s * d);
+			esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			ret = esil_val_reg_write (esil, &dst, s * d);
 		} else {
 			ERR ("esil_muleq: empty stack");
 		}
 	} else {
 		ERR ("esil_muleq: invalid parameters");
 	}
-	free (dst);
-	free (src);
+	esil_val_fini (&dst);
+	esil_val_fini (&src);
 	return ret;
 }
 
 static int esil_add(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if ((src && r_anal_esil_get_parm (esil, src, &s)) && (dst && r_anal_esil_get_parm (esil, dst, &d))) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if ((src.type && esil_val_parm (esil, &src, &s)) && (dst.type && esil_val_parm (esil, &dst, &d))) {
 		r_anal_esil_pushnum (esil, s + d);
 		ret = true;
 	} else {
 		ERR ("esil_add: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_addeq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
+		if (dst.type && esil_val_reg_read (esil, &dst, &d, NULL)) {
 			esil->old = d;
 			esil->cur = d + s;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			ret = r_anal_esil_reg_write (esil, dst, s + d);
+			esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			ret = esil_val_reg_write (esil, &dst, s + d);
 		}
 	} else {
 		ERR ("esil_addeq: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_inc(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s;
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
 		s++;
 		ret = r_anal_esil_pushnum (esil, s);
 	} else {
 		ERR ("esil_inc: invalid parameters");
 	}
-	free (src);
+	esil_val_fini (&src);
 	return ret;
 }
 
 static int esil_inceq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 sd;
-	char *src_dst = r_anal_esil_pop (esil);
-	if (src_dst && (r_anal_esil_get_parm_type (esil, src_dst) == R_ANAL_ESIL_PARM_REG) && r_anal_esil_get_parm (esil, src_dst, &sd)) {
+	RAnalEsilValue src_dst;
+	esil_val_pop (esil, &src_dst);
+	if (src_dst.type && (esil_val_parm_type (esil, &src_dst) == R_ANAL_ESIL_PARM_REG) && esil_val_parm (esil, &src_dst, &sd)) {
 		// inc rax
 		esil->old = sd++;
 		esil->cur = sd;
-		r_anal_esil_reg_write (esil, src_dst, sd);
-		esil->lastsz = esil_internal_sizeof_reg (esil, src_dst);
+		esil_val_reg_write (esil, &src_dst, sd);
+		esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&src_dst));
 		ret = true;
 	} else {
 		ERR ("esil_inceq: invalid parameters");
 	}
-	free (src_dst);
+	esil_val_fini (&src_dst);
 	return ret;
 }
 
 static int esil_sub(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if ((src && r_anal_esil_get_parm (esil, src, &s)) && (dst && r_anal_esil_get_parm (esil, dst, &d))) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if ((src.type && esil_val_parm (esil, &src, &s)) && (dst.type && esil_val_parm (esil, &dst, &d))) {
 		ret = r_anal_esil_pushnum (esil, d - s);
 	} else {
 		ERR ("esil_sub: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_subeq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
+		if (dst.type && esil_val_reg_read (esil, &dst, &d, NULL)) {
 			esil->old = d;
 			esil->cur = d - s;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			ret = r_anal_esil_reg_write (esil, dst, d - s);
+			esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			ret = esil_val_reg_write (esil, &dst, d - s);
 		}
 	} else {
 		ERR ("esil_subeq: invalid parameters");
 	}
-	free (src);
-	free (dst);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
 static int esil_dec(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s;
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
 		s--;
 		ret = r_anal_esil_pushnum (esil, s);
 	} else {
 		ERR ("esil_dec: invalid parameters");
 	}
-	free (src);
+	esil_val_fini (&src);
 	return ret;
 }
 
 static int esil_deceq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 sd;
-	char *src_dst = r_anal_esil_pop (esil);
-	if (src_dst && (r_anal_esil_get_parm_type (esil, src_dst) == R_ANAL_ESIL_PARM_REG) && r_anal_esil_get_parm (esil, src_dst, &sd)) {
+	RAnalEsilValue src_dst;
+	esil_val_pop (esil, &src_dst);
+	if (src_dst.type && (esil_val_parm_type (esil, &src_dst) == R_ANAL_ESIL_PARM_REG) && esil_val_parm (esil, &src_dst, &sd)) {
 		esil->old = sd;
 		sd--;
 		esil->cur = sd;
-		r_anal_esil_reg_write (esil, src_dst, sd);
-		esil->lastsz = esil_internal_sizeof_reg (esil, src_dst);
+		esil_val_reg_write (esil, &src_dst, sd);
+		esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&src_dst));
 		ret = true;
 	} else {
 		ERR ("esil_deceq: invalid parameters");
 	}
-	free (src_dst);
+	esil_val_fini (&src_dst);
 	return ret;
 }
 
@@ -1704,21 +1909,22 @@ static int esil_poke_n(RAnalEsil *esil, int bits) {
 	ut64 num, num2, addr;
 	ut8 b[8] = {0};
 	ut64 n;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
 	int bytes = R_MIN (sizeof (b), bits / 8), ret = 0;
 	if (bits % 8) {
-		free (src);
-		free (dst);
+		esil_val_fini (&src);
+		esil_val_fini (&dst);
 		return 0;
 	}
 	//eprintf ("GONA POKE %d src:%s dst:%s\n", bits, src, dst);
-	char *src2 = NULL;
-	if (src && r_anal_esil_get_parm (esil, src, &num)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &addr)) {
+	RAnalEsilValue src2 = {0};
+	if (src.type && esil_val_parm (esil, &src, &num)) {
+		if (dst.type && esil_val_parm (esil, &dst, &addr)) {
 			if (bits == 128) {
-				src2 = r_anal_esil_pop (esil);
-				if (src2 && r_anal_esil_get_parm (esil, src2, &num2)) {
+				esil_val_pop (esil, &src2);
+				if (src2.type && esil_val_parm (esil, &src2, &num2)) {
 					r_write_ble (b, num, esil->anal->big_endian, 64);
 					ret = r_anal_esil_mem_write (esil, addr, b, bytes);
 					if (ret == 0) {
@@ -1746,9 +1952,9 @@ static int esil_poke_n(RAnalEsil *esil, int bits) {
 		}
 	}
 out:
-	free (src2);
-	free (src);
-	free (dst);
+	esil_val_fini (&src2);
+	esil_val_fini (&src);
+	esil_val_fini (&dst);
 	return ret;
 }
 
@@ -1784,26 +1990,28 @@ static int esil_poke_some(RAnalEsil *esil) {
 	int i, ret = 0;
 	int regsize;
 	ut64 ptr, regs = 0, tmp;
-	char *count, *dst = r_anal_esil_pop (esil);
+	RAnalEsilValue count, dst;
+	esil_val_pop (esil, &dst);
 #define BYTES_SIZE 64
-	if (dst && r_anal_esil_get_parm_size (esil, dst, &tmp, &regsize)) {
+	if (dst.type && esil_val_parm_size (esil, &dst, &tmp, &regsize)) {
 		// reg
-		isregornum (esil, dst, &ptr);
-		count = r_anal_esil_pop (esil);
-		if (count) {
-			isregornum (esil, count, &regs);
+		esil_val_regornum (esil, &dst, &ptr);
+		esil_val_pop (esil, &count);
+		if (count.type) {
+			esil_val_regornum (esil, &count, &regs);
 			if (regs > 0) {
 				ut8 b[BYTES_SIZE];
 				ut64 num64;
 				for (i = 0; i < regs; i++) {
-					char *foo = r_anal_esil_pop (esil);
-					if (!foo) {
+					RAnalEsilValue foo;
+					esil_val_pop (esil, &foo);
+					if (!foo.type) {
 						// avoid looping out of stack
-						free (dst);
-						free (count);
+						esil_val_fini (&dst);
+						esil_val_fini (&count);
 						return 1;
 					}
-					isregornum (esil, foo, &num64);
+					esil_val_regornum (esil, &foo, &num64);
 					/* TODO: implement peek here */
 					// read from $dst
 					r_write_ble (b, num64, esil->anal->big_endian, regsize);
@@ -1813,14 +2021,14 @@ static int esil_poke_some(RAnalEsil *esil) {
 						esil->trap = 1;
 					}
 					ptr += BYTES_SIZE;
-					free (foo);
+					esil_val_fini (&foo);
 				}
 			}
-			free (dst);
-			free (count);
+			esil_val_fini (&dst);
+			esil_val_fini (&count);
 			return 1;
 		}
-		free (dst);
+		esil_val_fini (&dst);
 	}
 	return 0;
 }
@@ -1831,26 +2039,24 @@ static int esil_peek_n(RAnalEsil *esil, int bits) {
 	if (bits & 7) {
 		return 0;
 	}
-	char res[32];
 	ut64 addr;
 	int ret = 0, bytes = bits / 8;
-	char *dst = r_anal_esil_pop (esil);
-	if (!dst) {
+	RAnalEsilValue dst;
+	esil_val_pop (esil, &dst);
+	if (!dst.type) {
 		eprintf ("ESIL-ERROR at 0x%08"PFMT64x": Cannot peek memory without specifying an address\n", esil->address);
 		return 0;
 	}
 	//eprintf ("GONA PEEK %d dst:%s\n", bits, dst);
-	if (dst && isregornum (esil, dst, &addr)) {
+	if (dst.type && esil_val_regornum (esil, &dst, &addr)) {
 		if (bits == 128) {
 			ut8 a[sizeof(ut64) * 2] = {0};
 			ret = r_anal_esil_mem_read (esil, addr, a, bytes);
 			ut64 b = r_read_ble64 (&a, 0); //esil->anal->big_endian);
 			ut64 c = r_read_ble64 (&a[8], 0); //esil->anal->big_endian);
-			snprintf (res, sizeof (res), "0x%" PFMT64x, b);
-			r_anal_esil_push (esil, res);
-			snprintf (res, sizeof (res), "0x%" PFMT64x, c);
-			r_anal_esil_push (esil, res);
-			free (dst);
+			r_anal_esil_pushnum (esil, b);
+			r_anal_esil_pushnum (esil, c);
+			esil_val_fini (&dst);
 			return ret;
 		}
 		ut64 bitmask = genmask (bits - 1);
@@ -1860,11 +2066,10 @@ static int esil_peek_n(RAnalEsil *esil, int bits) {
 		if (esil->anal->big_endian) {
 			r_mem_swapendian ((ut8*)&b, (const ut8*)&b, bytes);
 		}
-		snprintf (res, sizeof (res), "0x%" PFMT64x, b & bitmask);
-		r_anal_esil_push (esil, res);
+		r_anal_esil_pushnum (esil, b & bitmask);
 		esil->lastsz = bits;
 	}
-	free (dst);
+	esil_val_fini (&dst);
 	return ret;
 }
 
@@ -1901,40 +2106,42 @@ static int esil_peek_some(RAnalEsil *esil) {
 	int i, ret = 0;
 	ut64 ptr, regs;
 	// pop ptr
-	char *count, *dst = r_anal_esil_pop (esil);
-	if (dst) {
+	RAnalEsilValue count, dst;
+	esil_val_pop (esil, &dst);
+	if (dst.type) {
 		// reg
-		isregornum (esil, dst, &ptr);
-		count = r_anal_esil_pop (esil);
-		if (count) {
-			isregornum (esil, count, &regs);
+		esil_val_regornum (esil, &dst, &ptr);
+		esil_val_pop (esil, &count);
+		if (count.type) {
+			esil_val_regornum (esil, &count, &regs);
 			if (regs > 0) {
 				ut32 num32;
 				ut8 a[sizeof (ut32)];
 				for (i = 0; i < regs; i++) {
-					char *foo = r_anal_esil_pop (esil);
-					if (!foo) {
+					RAnalEsilValue foo;
+					esil_val_pop (esil, &foo);
+					if (!foo.type) {
 						ERR ("Cannot pop in peek");
 						return 0;
 					}
 					ret = r_anal_esil_mem_read (esil, ptr, a, 4);
 					if (ret == sizeof (ut32)) {
 						num32 = r_read_ble32 (a, esil->anal->big_endian);
-						r_anal_esil_reg_write (esil, foo, num32);
+						esil_val_reg_write (esil, &foo, num32);
 					} else {
 						if (esil->verbose) {
 							eprintf ("Cannot peek from 0x%08" PFMT64x "\n", ptr);
 						}
 					}
 					ptr += sizeof (ut32);
-					free (foo);
+					esil_val_fini (&foo);
 				}
 			}
-			free (dst);
-			free (count);
+			esil_val_fini (&dst);
+			esil_val_fini (&count);
 			return 1;
 		}
-		free (dst);
+		esil_val_fini (&dst);
 	}
 	return 0;
 }
@@ -1944,17 +2151,19 @@ static int esil_peek_some(RAnalEsil *esil) {
 static int esil_mem_oreq_n(RAnalEsil *esil, int bits) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);  //save the dst-addr
-	char *src0 = r_anal_esil_pop (esil); //get the src
-	char *src1 = NULL;
-	if (src0 && r_anal_esil_get_parm (esil, src0, &s)) { 	//get the src
-		r_anal_esil_push (esil, dst);			//push the dst-addr
+	RAnalEsilValue dst;
+	esil_val_pop (esil, &dst);  //save the dst-addr
+	RAnalEsilValue src0;
+	esil_val_pop (esil, &src0); //get the src
+	RAnalEsilValue src1 = {0};
+	if (src0.type && esil_val_parm (esil, &src0, &s)) { 	//get the src
+		r_anal_esil_push_value (esil, &dst);			//push the dst-addr
 		ret = (!!esil_peek_n (esil, bits));		//read
-		src1 = r_anal_esil_pop (esil);			//get the old dst-value
-		if (src1 && r_anal_esil_get_parm (esil, src1, &d)) { //get the old dst-value
+		esil_val_pop (esil, &src1);			//get the old dst-value
+		if (src1.type && esil_val_parm (esil, &src1, &d)) { //get the old dst-value
 			d |= s;					//calculate the new dst-value
 			r_anal_esil_pushnum (esil, d);		//push the new dst-value
-			r_anal_esil_push (esil, dst);		//push the dst-addr
+			r_anal_esil_push_value (esil, &dst);		//push the dst-addr
 			ret &= (!!esil_poke_n (esil, bits));	//write
 		} else {
 			ret = 0;
@@ -1963,9 +2172,9 @@ static int esil_mem_oreq_n(RAnalEsil *esil, int bits) {
 	if (!ret) {
 		ERR ("esil_mem_oreq_n: invalid parameters");
 	}
-	free (dst);
-	free (src0);
-	free (src1);
+	esil_val_fini (&dst);
+	esil_val_fini (&src0);
+	esil_val_fini (&src1);
 	return ret;
 }
 
@@ -1990,17 +2199,18 @@ static int esil_mem_oreq(RAnalEsil *esil) {
 static int esil_mem_xoreq_n(RAnalEsil *esil, int bits) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src0 = r_anal_esil_pop (esil);
-	char *src1 = NULL;
-	if (src0 && r_anal_esil_get_parm (esil, src0, &s)) {
-		r_anal_esil_push (esil, dst);
+	RAnalEsilValue dst, src0;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src0);
+	RAnalEsilValue src1 = {0};
+	if (src0.type && esil_val_parm (esil, &src0, &s)) {
+		r_anal_esil_push_value (esil, &dst);
 		ret = (!!esil_peek_n (esil, bits));
-		src1 = r_anal_esil_pop (esil);
-		if (src1 && r_anal_esil_get_parm (esil, src1, &d)) {
+		esil_val_pop (esil, &src1);
+		if (src1.type && esil_val_parm (esil, &src1, &d)) {
 			d ^= s;
 			r_anal_esil_pushnum (esil, d);
-			r_anal_esil_push (esil, dst);
+			r_anal_esil_push_value (esil, &dst);
 			ret &= (!!esil_poke_n (esil, bits));
 		} else {
 			ret = 0;
@@ -2009,9 +2219,9 @@ static int esil_mem_xoreq_n(RAnalEsil *esil, int bits) {
 	if (!ret) {
 		ERR ("esil_mem_xoreq_n: invalid parameters");
 	}
-	free (dst);
-	free (src0);
-	free (src1);
+	esil_val_fini (&dst);
+	esil_val_fini (&src0);
+	esil_val_fini (&src1);
 	return ret;
 }
 
@@ -2036,17 +2246,18 @@ static int esil_mem_xoreq(RAnalEsil *esil) {
 static int esil_mem_andeq_n(RAnalEsil *esil, int bits) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src0 = r_anal_esil_pop (esil);
-	char *src1 = NULL;
-	if (src0 && r_anal_esil_get_parm (esil, src0, &s)) {
-		r_anal_esil_push (esil, dst);
+	RAnalEsilValue dst, src0;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src0);
+	RAnalEsilValue src1 = {0};
+	if (src0.type && esil_val_parm (esil, &src0, &s)) {
+		r_anal_esil_push_value (esil, &dst);
 		ret = (!!esil_peek_n (esil, bits));
-		src1 = r_anal_esil_pop (esil);
-		if (src1 && r_anal_esil_get_parm (esil, src1, &d)) {
+		esil_val_pop (esil, &src1);
+		if (src1.type && esil_val_parm (esil, &src1, &d)) {
 			d &= s;
 			r_anal_esil_pushnum (esil, d);
-			r_anal_esil_push (esil, dst);
+			r_anal_esil_push_value (esil, &dst);
 			ret &= (!!esil_poke_n (esil, bits));
 		} else {
 			ret = 0;
@@ -2055,9 +2266,9 @@ static int esil_mem_andeq_n(RAnalEsil *esil, int bits) {
 	if (!ret) {
 		ERR ("esil_mem_andeq_n: invalid parameters");
 	}
-	free (dst);
-	free (src0);
-	free (src1);
+	esil_val_fini (&dst);
+	esil_val_fini (&src0);
+	esil_val_fini (&src1);
 	return ret;
 }
 
@@ -2082,17 +2293,18 @@ static int esil_mem_andeq(RAnalEsil *esil) {
 static int esil_mem_addeq_n(RAnalEsil *esil, int bits) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src0 = r_anal_esil_pop (esil);
-	char *src1 = NULL;
-	if (src0 && r_anal_esil_get_parm (esil, src0, &s)) {
-		r_anal_esil_push (esil, dst);
+	RAnalEsilValue dst, src0;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src0);
+	RAnalEsilValue src1 = {0};
+	if (src0.type && esil_val_parm (esil, &src0, &s)) {
+		r_anal_esil_push_value (esil, &dst);
 		ret = (!!esil_peek_n (esil, bits));
-		src1 = r_anal_esil_pop (esil);
-		if (src1 && r_anal_esil_get_parm (esil, src1, &d)) {
+		esil_val_pop (esil, &src1);
+		if (src1.type && esil_val_parm (esil, &src1, &d)) {
 			d += s;
 			r_anal_esil_pushnum (esil, d);
-			r_anal_esil_push (esil, dst);
+			r_anal_esil_push_value (esil, &dst);
 			ret &= (!!esil_poke_n (esil, bits));
 		} else {
 			ret = 0;
@@ -2101,9 +2313,9 @@ static int esil_mem_addeq_n(RAnalEsil *esil, int bits) {
 	if (!ret) {
 		ERR ("esil_mem_addeq_n: invalid parameters");
 	}
-	free (dst);
-	free (src0);
-	free (src1);
+	esil_val_fini (&dst);
+	esil_val_fini (&src0);
+	esil_val_fini (&src1);
 	return ret;
 }
 
@@ -2128,17 +2340,18 @@ static int esil_mem_addeq(RAnalEsil *esil) {
 static int esil_mem_subeq_n(RAnalEsil *esil, int bits) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src0 = r_anal_esil_pop (esil);
-	char *src1 = NULL;
-	if (src0 && r_anal_esil_get_parm (esil, src0, &s)) {
-		r_anal_esil_push (esil, dst);
+	RAnalEsilValue dst, src0;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src0);
+	RAnalEsilValue src1 = {0};
+	if (src0.type && esil_val_parm (esil, &src0, &s)) {
+		r_anal_esil_push_value (esil, &dst);
 		ret = (!!esil_peek_n (esil, bits));
-		src1 = r_anal_esil_pop (esil);
-		if (src1 && r_anal_esil_get_parm (esil, src1, &d)) {
+		esil_val_pop (esil, &src1);
+		if (src1.type && esil_val_parm (esil, &src1, &d)) {
 			d -= s;
 			r_anal_esil_pushnum (esil, d);
-			r_anal_esil_push (esil, dst);
+			r_anal_esil_push_value (esil, &dst);
 			ret &= (!!esil_poke_n (esil, bits));
 		} else {
 			ret = 0;
@@ -2147,9 +2360,9 @@ static int esil_mem_subeq_n(RAnalEsil *esil, int bits) {
 	if (!ret) {
 		ERR ("esil_mem_subeq_n: invalid parameters");
 	}
-	free (dst);
-	free (src0);
-	free (src1);
+	esil_val_fini (&dst);
+	esil_val_fini (&src0);
+	esil_val_fini (&src1);
 	return ret;
 }
 
@@ -2174,23 +2387,24 @@ static int esil_mem_subeq(RAnalEsil *esil) {
 static int esil_mem_modeq_n(RAnalEsil *esil, int bits) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src0 = r_anal_esil_pop (esil);
-	char *src1 = NULL;
-	if (src0 && r_anal_esil_get_parm (esil, src0, &s)) {
+	RAnalEsilValue dst, src0;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src0);
+	RAnalEsilValue src1 = {0};
+	if (src0.type && esil_val_parm (esil, &src0, &s)) {
 		if (s == 0) {
 			ERR ("esil_mem_modeq4: Division by zero!");
 			esil->trap = R_ANAL_TRAP_DIVBYZERO;
 			esil->trap_code = 0;
 		} else {
-			r_anal_esil_push (esil, dst);
+			r_anal_esil_push_value (esil, &dst);
 			ret = (!!esil_peek_n (esil, bits));
-			src1 = r_anal_esil_pop (esil);
-			if (src1 && r_anal_esil_get_parm (esil, src1, &d) && s >= 1) {
+			esil_val_pop (esil, &src1);
+			if (src1.type && esil_val_parm (esil, &src1, &d) && s >= 1) {
 				r_anal_esil_pushnum (esil, d % s);
 				d = d % s;
 				r_anal_esil_pushnum (esil, d);
-				r_anal_esil_push (esil, dst);
+				r_anal_esil_push_value (esil, &dst);
 				ret &= (!!esil_poke_n (esil, bits));
 			} else {
 				ret = 0;
@@ -2200,9 +2414,9 @@ static int esil_mem_modeq_n(RAnalEsil *esil, int bits) {
 	if (!ret) {
 		ERR ("esil_mem_modeq_n: invalid parameters");
 	}
-	free (dst);
-	free (src0);
-	free (src1);
+	esil_val_fini (&dst);
+	esil_val_fini (&src0);
+	esil_val_fini (&src1);
 	return ret;
 }
 
@@ -2227,22 +2441,23 @@ static int esil_mem_modeq(RAnalEsil *esil) {
 static int esil_mem_diveq_n(RAnalEsil *esil, int bits) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src0 = r_anal_esil_pop (esil);
-	char *src1 = NULL;
-	if (src0 && r_anal_esil_get_parm (esil, src0, &s)) {
+	RAnalEsilValue dst, src0;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src0);
+	RAnalEsilValue src1 = {0};
+	if (src0.type && esil_val_parm (esil, &src0, &s)) {
 		if (s == 0) {
 			ERR ("esil_mem_diveq8: Division by zero!");
 			esil->trap = R_ANAL_TRAP_DIVBYZERO;
 			esil->trap_code = 0;
 		} else {
-			r_anal_esil_push (esil, dst);
+			r_anal_esil_push_value (esil, &dst);
 			ret = (!!esil_peek_n (esil, bits));
-			src1 = r_anal_esil_pop (esil);
-			if (src1 && r_anal_esil_get_parm (esil, src1, &d)) {
+			esil_val_pop (esil, &src1);
+			if (src1.type && esil_val_parm (esil, &src1, &d)) {
 				d = d / s;
 				r_anal_esil_pushnum (esil, d);
-				r_anal_esil_push (esil, dst);
+				r_anal_esil_push_value (esil, &dst);
 				ret &= (!!esil_poke_n (esil, bits));
 			} else {
 				ret = 0;
@@ -2252,9 +2467,9 @@ static int esil_mem_diveq_n(RAnalEsil *esil, int bits) {
 	if (!ret) {
 		ERR ("esil_mem_diveq_n: invalid parameters");
 	}
-	free (dst);
-	free (src0);
-	free (src1);
+	esil_val_fini (&dst);
+	esil_val_fini (&src0);
+	esil_val_fini (&src1);
 	return ret;
 }
 
@@ -2279,17 +2494,18 @@ static int esil_mem_diveq(RAnalEsil *esil) {
 static int esil_mem_muleq_n(RAnalEsil *esil, int bits, ut64 bitmask) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src0 = r_anal_esil_pop (esil);
-	char *src1 = NULL;
-	if (src0 && r_anal_esil_get_parm (esil, src0, &s)) {
-		r_anal_esil_push (esil, dst);
+	RAnalEsilValue dst, src0;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src0);
+	RAnalEsilValue src1 = {0};
+	if (src0.type && esil_val_parm (esil, &src0, &s)) {
+		r_anal_esil_push_value (esil, &dst);
 		ret = (!!esil_peek_n (esil, bits));
-		src1 = r_anal_esil_pop (esil);
-		if (src1 && r_anal_esil_get_parm (esil, src1, &d)) {
+		esil_val_pop (esil, &src1);
+		if (src1.type && esil_val_parm (esil, &src1, &d)) {
 			d *= s;
 			r_anal_esil_pushnum (esil, d);
-			r_anal_esil_push (esil, dst);
+			r_anal_esil_push_value (esil, &dst);
 			ret &= (!!esil_poke_n (esil, bits));
 		} else {
 			ret = 0;
@@ -2298,9 +2514,9 @@ static int esil_mem_muleq_n(RAnalEsil *esil, int bits, ut64 bitmask) {
 	if (!ret) {
 		ERR ("esil_mem_muleq_n: invalid parameters");
 	}
-	free (dst);
-	free (src0);
-	free (src1);
+	esil_val_fini (&dst);
+	esil_val_fini (&src0);
+	esil_val_fini (&src1);
 	return ret;
 }
 
@@ -2332,19 +2548,20 @@ static int esil_mem_muleq(RAnalEsil *esil) {
 static int esil_mem_inceq_n(RAnalEsil *esil, int bits) {
 	int ret = 0;
 	ut64 s;
-	char *off = r_anal_esil_pop (esil);
-	char *src = NULL;
-	if (off) {
-		r_anal_esil_push (esil, off);
+	RAnalEsilValue off;
+	esil_val_pop (esil, &off);
+	RAnalEsilValue src = {0};
+	if (off.type) {
+		r_anal_esil_push_value (esil, &off);
 		ret = (!!esil_peek_n (esil, bits));
-		src = r_anal_esil_pop (esil);
-		if (src && r_anal_esil_get_parm (esil, src, &s)) {
+		esil_val_pop (esil, &src);
+		if (src.type && esil_val_parm (esil, &src, &s)) {
 			esil->old = s;
 			s++;
 			esil->cur = s;
 			esil->lastsz = bits;
 			r_anal_esil_pushnum (esil, s);
-			r_anal_esil_push (esil, off);
+			r_anal_esil_push_value (esil, &off);
 			ret &= (!!esil_poke_n (esil, bits));
 		} else {
 			ret = 0;
@@ -2353,8 +2570,8 @@ static int esil_mem_inceq_n(RAnalEsil *esil, int bits) {
 	if (!ret) {
 		ERR ("esil_mem_inceq_n: invalid parameters");
 	}
-	free (src);
-	free (off);
+	esil_val_fini (&src);
+	esil_val_fini (&off);
 	return ret;
 }
 
@@ -2379,16 +2596,17 @@ static int esil_mem_inceq(RAnalEsil *esil) {
 static int esil_mem_deceq_n(RAnalEsil *esil, int bits) {
 	int ret = 0;
 	ut64 s;
-	char *off = r_anal_esil_pop (esil);
-	char *src = NULL;
-	if (off) {
-		r_anal_esil_push (esil, off);
+	RAnalEsilValue off;
+	esil_val_pop (esil, &off);
+	RAnalEsilValue src = {0};
+	if (off.type) {
+		r_anal_esil_push_value (esil, &off);
 		ret = (!!esil_peek_n (esil, bits));
-		src = r_anal_esil_pop (esil);
-		if (src && r_anal_esil_get_parm (esil, src, &s)) {
+		esil_val_pop (esil, &src);
+		if (src.type && esil_val_parm (esil, &src, &s)) {
 			s--;
 			r_anal_esil_pushnum (esil, s);
-			r_anal_esil_push (esil, off);
+			r_anal_esil_push_value (esil, &off);
 			ret &= (!!esil_poke_n (esil, bits));
 		} else {
 			ret = 0;
@@ -2397,8 +2615,8 @@ static int esil_mem_deceq_n(RAnalEsil *esil, int bits) {
 	if (!ret) {
 		ERR ("esil_mem_deceq_n: invalid parameters");
 	}
-	free (src);
-	free (off);
+	esil_val_fini (&src);
+	esil_val_fini (&off);
 	return ret;
 }
 
@@ -2423,24 +2641,25 @@ static int esil_mem_deceq(RAnalEsil *esil) {
 static int esil_mem_lsleq_n(RAnalEsil *esil, int bits) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src0 = r_anal_esil_pop (esil);
-	char *src1 = NULL;
-	if (src0 && r_anal_esil_get_parm (esil, src0, &s)) {
+	RAnalEsilValue dst, src0;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src0);
+	RAnalEsilValue src1 = {0};
+	if (src0.type && esil_val_parm (esil, &src0, &s)) {
 		if (s > sizeof (ut64) * 8) {
 			ERR ("esil_mem_lsleq_n: shift is too big");
 		} else {
-			r_anal_esil_push (esil, dst);
+			r_anal_esil_push_value (esil, &dst);
 			ret = (!!esil_peek_n (esil, bits));
-			src1 = r_anal_esil_pop (esil);
-			if (src1 && r_anal_esil_get_parm (esil, src1, &d)) {
+			esil_val_pop (esil, &src1);
+			if (src1.type && esil_val_parm (esil, &src1, &d)) {
 				if (s > 63) {
 					d = 0;
 				} else {
 					d <<= s;
 				}
 				r_anal_esil_pushnum (esil, d);
-				r_anal_esil_push (esil, dst);
+				r_anal_esil_push_value (esil, &dst);
 				ret &= (!!esil_poke_n (esil, bits));
 			} else {
 				ret = 0;
@@ -2450,9 +2669,9 @@ static int esil_mem_lsleq_n(RAnalEsil *esil, int bits) {
 	if (!ret) {
 		ERR ("esil_mem_lsleq_n: invalid parameters");
 	}
-	free (dst);
-	free (src0);
-	free (src1);
+	esil_val_fini (&dst);
+	esil_val_fini (&src0);
+	esil_val_fini (&src1);
 	return ret;
 }
 
@@ -2477,17 +2696,18 @@ static int esil_mem_lsleq(RAnalEsil *esil) {
 static int esil_mem_lsreq_n(RAnalEsil *esil, int bits) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src0 = r_anal_esil_pop (esil);
-	char *src1 = NULL;
-	if (src0 && r_anal_esil_get_parm (esil, src0, &s)) {
-		r_anal_esil_push (esil, dst);
+	RAnalEsilValue dst, src0;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src0);
+	RAnalEsilValue src1 = {0};
+	if (src0.type && esil_val_parm (esil, &src0, &s)) {
+		r_anal_esil_push_value (esil, &dst);
 		ret = (!!esil_peek_n (esil, bits));
-		src1 = r_anal_esil_pop (esil);
-		if (src1 && r_anal_esil_get_parm (esil, src1, &d)) {
+		esil_val_pop (esil, &src1);
+		if (src1.type && esil_val_parm (esil, &src1, &d)) {
 			d >>= s;
 			r_anal_esil_pushnum (esil, d);
-			r_anal_esil_push (esil, dst);
+			r_anal_esil_push_value (esil, &dst);
 			ret &= (!!esil_poke_n (esil, bits));
 		} else {
 			ret = 0;
@@ -2496,9 +2716,9 @@ static int esil_mem_lsreq_n(RAnalEsil *esil, int bits) {
 	if (!ret) {
 		ERR ("esil_mem_lsreq_n: invalid parameters");
 	}
-	free (dst);
-	free (src0);
-	free (src1);
+	esil_val_fini (&dst);
+	esil_val_fini (&src0);
+	esil_val_fini (&src1);
 	return ret;
 }
 
@@ -2520,19 +2740,19 @@ static int esil_mem_lsreq(RAnalEsil *esil) {
 
 /* get value of register or memory reference and push the value */
 static int esil_num(RAnalEsil *esil) {
-	char *dup_me;
+	RAnalEsilValue dup_me;
 	ut64 dup;
 	if (!esil) {
 		return false;
 	}
-	if (!(dup_me = r_anal_esil_pop (esil))) {
+	if (!esil_val_pop (esil, &dup_me)) {
 		return false;
 	}
-	if (!r_anal_esil_get_parm (esil, dup_me, &dup)) {
-		free (dup_me);
+	if (!esil_val_parm (esil, &dup_me, &dup)) {
+		esil_val_fini (&dup_me);
 		return false;
 	}
-	free (dup_me);
+	esil_val_fini (&dup_me);
 	return r_anal_esil_pushnum (esil, dup);
 }
 
@@ -2541,15 +2761,15 @@ static int esil_dup(RAnalEsil *esil) {
 	if (!esil || !esil->stack || esil->stackptr < 1 || esil->stackptr > (esil->stacksize - 1)) {
 		return false;
 	}
-	return r_anal_esil_push (esil, esil->stack[esil->stackptr-1]);
+	return r_anal_esil_push_value (esil, &esil->stack[esil->stackptr-1]);
 }
 
 static int esil_swap(RAnalEsil *esil) {
-	char *tmp;
+	RAnalEsilValue tmp;
 	if (!esil || !esil->stack || esil->stackptr < 2) {
 		return false;
 	}
-	if (!esil->stack[esil->stackptr-1] || !esil->stack[esil->stackptr-2]) {
+	if (!esil->stack[esil->stackptr-1].type || !esil->stack[esil->stackptr-2].type) {
 		return false;
 	}
 	tmp = esil->stack[esil->stackptr-1];
@@ -2586,17 +2806,18 @@ static int signed_compare_gt(ut64 a, ut64 b, ut64 size) {
 static int esil_smaller(RAnalEsil *esil) { // 'dst < src' => 'src,dst,<'
 	ut64 num, num2;
 	int ret = 0;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm (esil, &dst, &num)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = 1;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_val_parm_type (esil, &dst) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			} else if (esil_val_parm_type (esil, &src) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&src));
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2605,25 +2826,26 @@ static int esil_smaller(RAnalEsil *esil) { // 'dst < src' => 'src,dst,<'
 			                           !signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
+	esil_val_fini (&dst);
+	esil_val_fini (&src);
 	return ret;
 }
 
 static int esil_bigger(RAnalEsil *esil) { // 'dst > src' => 'src,dst,>'
 	ut64 num, num2;
 	int ret = 0;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm (esil, &dst, &num)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = 1;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_val_parm_type (esil, &dst) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			} else if (esil_val_parm_type (esil, &src) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&src));
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2631,25 +2853,26 @@ static int esil_bigger(RAnalEsil *esil) { // 'dst > src' => 'src,dst,>'
 			r_anal_esil_pushnum (esil, signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
+	esil_val_fini (&dst);
+	esil_val_fini (&src);
 	return ret;
 }
 
 static int esil_smaller_equal(RAnalEsil *esil) { // 'dst <= src' => 'src,dst,<='
 	ut64 num, num2;
 	int ret = 0;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm (esil, &dst, &num)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = 1;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_val_parm_type (esil, &dst) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			} else if (esil_val_parm_type (esil, &src) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&src));
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2657,25 +2880,26 @@ static int esil_smaller_equal(RAnalEsil *esil) { // 'dst <= src' => 'src,dst,<='
 			r_anal_esil_pushnum (esil, !signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
+	esil_val_fini (&dst);
+	esil_val_fini (&src);
 	return ret;
 }
 
 static int esil_bigger_equal(RAnalEsil *esil) { // 'dst >= src' => 'src,dst,>='
 	ut64 num, num2;
 	int ret = 0;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue dst, src;
+	esil_val_pop (esil, &dst);
+	esil_val_pop (esil, &src);
+	if (dst.type && esil_val_parm (esil, &dst, &num)) {
+		if (src.type && esil_val_parm (esil, &src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = 1;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_val_parm_type (esil, &dst) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&dst));
+			} else if (esil_val_parm_type (esil, &src) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_val_str (&src));
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2684,54 +2908,54 @@ static int esil_bigger_equal(RAnalEsil *esil) { // 'dst >= src' => 'src,dst,>='
 			                           signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
+	esil_val_fini (&dst);
+	esil_val_fini (&src);
 	return ret;
 }
 
 static int esil_set_jump_target(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s;
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
 		esil->jump_target = s;
 		esil->jump_target_set = 1;
 		ret = true;
 	} else {
-		R_FREE (src);
 		ERR ("esil_set_jump_target: empty stack");
 	}
-	free (src);
+	esil_val_fini (&src);
 	return ret;
 }
 
 static int esil_set_jump_target_set(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s;
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
 		esil->jump_target_set = s;
 		ret = true;
 	} else {
-		R_FREE (src);
 		ERR ("esil_set_jump_target_set: empty stack");
 	}
-	free (src);
+	esil_val_fini (&src);
 	return ret;
 }
 
 static int esil_set_delay_slot(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s;
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
+	RAnalEsilValue src;
+	esil_val_pop (esil, &src);
+	if (src.type && esil_val_parm (esil, &src, &s)) {
 		esil->delay = s;
 		ret = true;
 	} else {
-		R_FREE (src);
 		ERR ("esil_set_delay_slot: empty stack");
 	}
-	free (src);
+	esil_val_fini (&src);
 	return ret;
 }
 
@@ -2885,7 +3109,7 @@ static int evalWord(RAnalEsil *esil, const char *ostr, const char **str) {
 	return 3;
 }
 
-R_API int r_anal_esil_parse(RAnalEsil *esil, const char *str) {
+static int esil_parse(RAnalEsil *esil, const char *str) {
 	int wordi = 0;
 	int dorunword;
 	char word[64];
@@ -2905,6 +3129,12 @@ R_API int r_anal_esil_parse(RAnalEsil *esil, const char *str) {
 			esil->cmd (esil, esil->cmd_todo, esil->address, 0);
 		}
 	}
+	if (!hashbang && !esil->Reil && esil->anal && esil->anal->esil_compile) {
+		RAnalEsilCode *code = r_anal_esil_code_get (esil, esil->address, str);
+		if (code) {
+			return r_anal_esil_code_run (esil, code);
+		}
+	}
 loop:
 	esil->repeat = 0;
 	esil->skip = 0;
@@ -2975,6 +3205,13 @@ repeat:
 	return 1;
 }
 
+R_API int r_anal_esil_parse(RAnalEsil *esil, const char *str) {
+	R_PROF_BEGIN (R_PROF_ESIL_STEP);
+	int ret = esil_parse (esil, str);
+	R_PROF_END (R_PROF_ESIL_STEP);
+	return ret;
+}
+
 R_API int r_anal_esil_runword(RAnalEsil *esil, const char *word) {
 	const char *str = NULL;
 	runword (esil, word);
@@ -2995,14 +3232,14 @@ R_API void r_anal_esil_stack_free(RAnalEsil *esil) {
 	int i;
 	if (esil) {
 		for (i = 0; i < esil->stackptr; i++) {
-			R_FREE (esil->stack[i]);
+			esil_val_fini (&esil->stack[i]);
 		}
 		esil->stackptr = 0;
 	}
 }
 
 R_API int r_anal_esil_condition(RAnalEsil *esil, const char *str) {
-	char *popped;
+	RAnalEsilValue popped;
 	int ret;
 	if (!esil) {
 		return false;
@@ -3011,15 +3248,14 @@ R_API int r_anal_esil_condition(RAnalEsil *esil, const char *str) {
 		str++; // use proper string chop?
 	}
 	(void) r_anal_esil_parse (esil, str);
-	popped = r_anal_esil_pop (esil);
-	if (popped) {
+	if (esil_val_pop (esil, &popped)) {
 		ut64 num;
-		if (isregornum (esil, popped, &num)) {
+		if (esil_val_regornum (esil, &popped, &num)) {
 			ret = !!num;
 		} else {
 			ret = 0;
 		}
-		free (popped);
+		esil_val_fini (&popped);
 	} else {
 		ERR ("ESIL stack is empty");
 		return -1;
@@ -0,0 +1,306 @@
+/* radare - LGPL - Copyright 2019 - pancake, condret */
+
+#include <r_anal.h>
+
+/* Compiled ESIL
+ *
+ * An esil expression is tokenized once, every word is resolved to an
+ * operator, a register item or an immediate, and the result is cached
+ * per instruction address. Evaluation then walks the word array instead
+ * of re-parsing the string, keeping the same control flow semantics as
+ * r_anal_esil_parse (skip, goto, break, todo and repeat).
+ */
+
+// drop the whole cache when it grows beyond this amount of expressions
+#define CODE_CACHE_MAX 0x10000
+// words longer than this make the string parser bail out
+#define CODE_WORD_MAX 62
+
+static void code_cache_kv_free(HtUPKv *kv) {
+	r_anal_esil_code_free (kv->value);
+}
+
+static RAnalEsilOp code_getop(RAnalEsil *esil, const char *word) {
+	char t[128];
+	char *h = sdb_itoa (sdb_hash (word), t, 16);
+	if (sdb_num_exists (esil->ops, h)) {
+		return (RAnalEsilOp)(size_t)sdb_num_get (esil->ops, h, 0);
+	}
+	return NULL;
+}
+
+// prebuild the stack value of operands, long words are pushed as strings
+static void code_setval(RAnalEsilCodeWord *w) {
+	RAnalEsilValue *v = &w->val;
+	size_t len = strlen (w->str);
+	if (len >= sizeof (v->text)) {
+		return;
+	}
+	switch (w->type) {
+	case R_ANAL_ESIL_CODE_NUM:
+		v->type = R_ANAL_ESIL_VAL_NUM;
+		v->num = r_num_get (NULL, w->str);
+		break;
+	case R_ANAL_ESIL_CODE_REG:
+		v->type = R_ANAL_ESIL_VAL_REG;
+		break;
+	default:
+		v->type = R_ANAL_ESIL_VAL_STR;
+		break;
+	}
+	memcpy (v->text, w->str, len + 1);
+}
+
+static void code_resolve(RAnalEsil *esil, RAnalEsilCodeWord *w) {
+	if (!strcmp (w->str, "}")) {
+		w->type = R_ANAL_ESIL_CODE_ENDIF;
+		return;
+	}
+	if (!strcmp (w->str, "}{")) {
+		w->type = R_ANAL_ESIL_CODE_ELSE;
+		return;
+	}
+	w->op = code_getop (esil, w->str);
+	if (!strcmp (w->str, "?{")) {
+		w->type = R_ANAL_ESIL_CODE_IF;
+		return;
+	}
+	if (w->op) {
+		w->type = R_ANAL_ESIL_CODE_OP;
+		return;
+	}
+	switch (r_anal_esil_get_parm_type (esil, w->str)) {
+	case R_ANAL_ESIL_PARM_NUM:
+		// same rule as r_anal_esil_push, "-1" stays a plain word
+		w->type = IS_DIGIT (*w->str)? R_ANAL_ESIL_CODE_NUM: R_ANAL_ESIL_CODE_STR;
+		break;
+	case R_ANAL_ESIL_PARM_REG:
+		w->type = R_ANAL_ESIL_CODE_REG;
+		break;
+	default:
+		w->type = R_ANAL_ESIL_CODE_STR;
+		break;
+	}
+	code_setval (w);
+}
+
+/* Returns NULL for expressions the compiler does not handle (hashbangs,
+ * multiple statements, empty or oversized words), those must be evaluated
+ * by the string parser. */
+R_API RAnalEsilCode *r_anal_esil_compile(RAnalEsil *esil, const char *expr) {
+	r_return_val_if_fail (esil && expr, NULL);
+	if (!esil->anal || !esil->anal->reg || !esil->ops) {
+		return NULL;
+	}
+	if (!*expr || *expr == ',' || strchr (expr, ';') || strstr (expr, "#!") || strstr (expr, ",,")) {
+		return NULL;
+	}
+	RAnalEsilCode *code = R_NEW0 (RAnalEsilCode);
+	if (!code) {
+		return NULL;
+	}
+	code->expr = strdup (expr);
+	code->buf = strdup (expr);
+	if (!code->expr || !code->buf) {
+		goto fail;
+	}
+	int i, n = 1;
+	char *p;
+	for (p = code->buf; *p; p++) {
+		if (*p == ',') {
+			n++;
+		}
+	}
+	code->words = R_NEWS0 (RAnalEsilCodeWord, n);
+	if (!code->words) {
+		goto fail;
+	}
+	p = code->buf;
+	for (i = 0; i < n; i++) {
+		char *word = p;
+		char *comma = strchr (p, ',');
+		if (comma) {
+			*comma = 0;
+			p = comma + 1;
+		}
+		if (!*word) {
+			// trailing comma, the string parser ignores it too
+			break;
+		}
+		if (strlen (word) > CODE_WORD_MAX) {
+			goto fail;
+		}
+		code->words[i].str = word;
+		code_resolve (esil, &code->words[i]);
+	}
+	code->len = i;
+	code->reg = esil->anal->reg;
+	code->reg_gen = esil->anal->reg->profile_gen;
+	code->refs = 1;
+	return code;
+fail:
+	code->refs = 1;
+	r_anal_esil_code_free (code);
+	return NULL;
+}
+
+R_API void r_anal_esil_code_free(RAnalEsilCode *code) {
+	if (!code || --code->refs > 0) {
+		return;
+	}
+	free (code->words);
+	free (code->buf);
+	free (code->expr);
+	free (code);
+}
+
+static int code_runword(RAnalEsil *esil, RAnalEsilCodeWord *w) {
+	esil->parse_goto_count--;
+	if (esil->parse_goto_count < 1) {
+		if (esil->verbose) {
+			eprintf ("0x%08" PFMT64x " ESIL infinite loop detected\n", esil->address);
+		}
+		esil->trap = 1;
+		esil->parse_stop = 1;
+		return 0;
+	}
+	switch (w->type) {
+	case R_ANAL_ESIL_CODE_ELSE:
+		if (esil->skip == 1) {
+			esil->skip = 0;
+		} else if (esil->skip == 0) {
+			esil->skip = 1;
+		}
+		return 1;
+	case R_ANAL_ESIL_CODE_ENDIF:
+		if (esil->skip) {
+			esil->skip--;
+		}
+		return 1;
+	case R_ANAL_ESIL_CODE_IF:
+		break;
+	default:
+		if (esil->skip) {
+			return 1;
+		}
+		break;
+	}
+	if (w->op) {
+		if (esil->cb.hook_command && esil->cb.hook_command (esil, w->str)) {
+			return 1;
+		}
+		int ret = w->op (esil);
+		if (!ret && esil->verbose) {
+			eprintf ("%s returned 0\n", w->str);
+		}
+		return ret;
+	}
+	bool pushed = w->val.type
+		? r_anal_esil_push_value (esil, &w->val)
+		: r_anal_esil_push (esil, w->str);
+	if (!pushed) {
+		if (esil->verbose) {
+			eprintf ("0x%08" PFMT64x " ESIL stack is full\n", esil->address);
+		}
+		esil->trap = 1;
+		esil->trap_code = 1;
+	}
+	return 1;
+}
+
+static int code_exec(RAnalEsil *esil, RAnalEsilCode *code) {
+	int i;
+loop:
+	esil->repeat = 0;
+	esil->skip = 0;
+	esil->parse_goto = -1;
+	esil->parse_stop = 0;
+	esil->parse_goto_count = esil->anal? esil->anal->esil_goto_limit: R_ANAL_ESIL_GOTO_LIMIT;
+	i = 0;
+	while (i < code->len) {
+		if (!code_runword (esil, &code->words[i])) {
+			return 0;
+		}
+		if (esil->repeat) {
+			goto loop;
+		}
+		if (esil->parse_goto != -1) {
+			if (esil->parse_goto >= 0 && esil->parse_goto < code->len) {
+				i = esil->parse_goto;
+				esil->parse_goto = -1;
+				continue;
+			}
+			if (esil->verbose) {
+				eprintf ("Cannot find word %d\n", esil->parse_goto);
+			}
+			return 0;
+		}
+		if (esil->parse_stop) {
+			if (esil->parse_stop == 2) {
+				const char *rest = (i + 1 < code->len)
+					? code->expr + (code->words[i + 1].str - code->buf): "";
+				eprintf ("[esil at 0x%08"PFMT64x"] TODO: %s\n", esil->address, rest);
+			}
+			return 0;
+		}
+		i++;
+	}
+	return 1;
+}
+
+R_API int r_anal_esil_code_run(RAnalEsil *esil, RAnalEsilCode *code) {
+	r_return_val_if_fail (esil && code, 0);
+	// hold a reference, ops may re-enter the parser and recycle the cache
+	code->refs++;
+	int ret = code_exec (esil, code);
+	r_anal_esil_code_free (code);
+	return ret;
+}
+
+static bool code_isvalid(RAnalEsil *esil, RAnalEsilCode *code, const char *expr) {
+	RReg *reg = esil->anal->reg;
+	return code->reg == reg && code->reg_gen == reg->profile_gen && !strcmp (code->expr, expr);
+}
+
+/* Returns the compiled form of expr for the instruction at addr, compiling
+ * and caching it on the first use. NULL means the string parser must be
+ * used instead. */
+R_API RAnalEsilCode *r_anal_esil_code_get(RAnalEsil *esil, ut64 addr, const char *expr) {
+	r_return_val_if_fail (esil && expr, NULL);
+	if (!esil->anal || !esil->anal->reg) {
+		return NULL;
+	}
+	if (esil->code_cache) {
+		RAnalEsilCode *code = ht_up_find (esil->code_cache, addr, NULL);
+		if (code && code_isvalid (esil, code, expr)) {
+			return code;
+		}
+	} else {
+		esil->code_cache = ht_up_new (NULL, code_cache_kv_free, NULL);
+		if (!esil->code_cache) {
+			return NULL;
+		}
+	}
+	RAnalEsilCode *code = r_anal_esil_compile (esil, expr);
+	if (!code) {
+		return NULL;
+	}
+	if (esil->code_cache->count >= CODE_CACHE_MAX) {
+		r_anal_esil_code_flush (esil);
+		esil->code_cache = ht_up_new (NULL, code_cache_kv_free, NULL);
+		if (!esil->code_cache) {
+			r_anal_esil_code_free (code);
+			return NULL;
+		}
+	}
+	code->addr = addr;
+	ht_up_update (esil->code_cache, addr, code);
+	return code;
+}
+
+R_API void r_anal_esil_code_flush(RAnalEsil *esil) {
+	if (esil) {
+		ht_up_free (esil->code_cache);
+		esil->code_cache = NULL;
+	}
+}
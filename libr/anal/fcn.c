@@ -64,32 +64,86 @@ R_API const char *r_anal_fcn_type_tostring(int type) {
 }
 
 #if READ_AHEAD
-static ut64 cache_addr = UT64_MAX;
+#define READ_AHEAD_PAGE 0x1000
+#define READ_AHEAD_SETS 16
+#define READ_AHEAD_WAYS 4
+
+typedef struct {
+	ut64 addr; // UT64_MAX when unused
+	ut32 used; // tick of the last use, the oldest way of a set is replaced
+	ut8 buf[READ_AHEAD_PAGE];
+} ReadAheadPage;
+
+/* Set associative cache of code pages. It belongs to the RAnal instance and
+ * it is dropped when the io generation or the io mode changes. */
+struct r_anal_read_ahead_t {
+	ut32 gen;
+	int va;
+	int cached;
+	ut32 tick;
+	ReadAheadPage pages[READ_AHEAD_SETS][READ_AHEAD_WAYS];
+};
+
+static void read_ahead_reset(struct r_anal_read_ahead_t *ra, RIO *io) {
+	int i, j;
+	for (i = 0; i < READ_AHEAD_SETS; i++) {
+		for (j = 0; j < READ_AHEAD_WAYS; j++) {
+			ra->pages[i][j].addr = UT64_MAX;
+		}
+	}
+	ra->gen = io->gen;
+	ra->va = io->va;
+	ra->cached = io->cached;
+}
+
+static const ut8 *read_ahead_page(RAnal *anal, ut64 page) {
+	struct r_anal_read_ahead_t *ra = anal->read_ahead;
+	ReadAheadPage *set = ra->pages[(page / READ_AHEAD_PAGE) % READ_AHEAD_SETS];
+	ReadAheadPage *victim = set;
+	int i;
+	ra->tick++;
+	for (i = 0; i < READ_AHEAD_WAYS; i++) {
+		if (set[i].addr == page) {
+			set[i].used = ra->tick;
+			return set[i].buf;
+		}
+		if (set[i].used < victim->used) {
+			victim = &set[i];
+		}
+	}
+	anal->iob.read_at (anal->iob.io, page, victim->buf, READ_AHEAD_PAGE);
+	victim->addr = page;
+	victim->used = ra->tick;
+	return victim->buf;
+}
 
-// TODO: move into io :?
 static int read_ahead(RAnal *anal, ut64 addr, ut8 *buf, int len) {
-	static ut8 cache[1024];
-	const int cache_len = sizeof (cache);
-
+	RIO *io = anal->iob.io;
 	if (len < 1) {
 		return 0;
 	}
-	if (len > cache_len) {
-		int a = anal->iob.read_at (anal->iob.io, addr, buf, len); // double read
-		memcpy (cache, buf, cache_len);
-		cache_addr = addr;
-		return a;
-	}
-
-	ut64 addr_end = UT64_ADD_OVFCHK (addr, len)? UT64_MAX: addr + len;
-	ut64 cache_addr_end = UT64_ADD_OVFCHK (cache_addr, cache_len)? UT64_MAX: cache_addr + cache_len;
-	bool isCached = ((addr != UT64_MAX) && (addr >= cache_addr) && (addr_end < cache_addr_end));
-	if (isCached) {
-		memcpy (buf, cache + (addr - cache_addr), len);
-	} else {
-		anal->iob.read_at (anal->iob.io, addr, cache, sizeof (cache));
-		memcpy (buf, cache, len);
-		cache_addr = addr;
+	// debuggee memory changes behind the io back
+	if (!io || io->debug || io->addrbytes != 1 || len > READ_AHEAD_PAGE || UT64_ADD_OVFCHK (addr, len)) {
+		return anal->iob.read_at (io, addr, buf, len);
+	}
+	struct r_anal_read_ahead_t *ra = anal->read_ahead;
+	if (!ra) {
+		ra = anal->read_ahead = R_NEW0 (struct r_anal_read_ahead_t);
+		if (!ra) {
+			return anal->iob.read_at (io, addr, buf, len);
+		}
+		read_ahead_reset (ra, io);
+	} else if (ra->gen != io->gen || ra->va != io->va || ra->cached != io->cached) {
+		read_ahead_reset (ra, io);
+	}
+	int done = 0;
+	while (done < len) {
+		ut64 at = addr + done;
+		ut64 page = at - (at % READ_AHEAD_PAGE);
+		int delta = (int)(at - page);
+		int n = R_MIN (len - done, READ_AHEAD_PAGE - delta);
+		memcpy (buf + done, read_ahead_page (anal, page) + delta, n);
+		done += n;
 	}
 	return len;
 }
@@ -99,9 +153,12 @@ static int read_ahead(RAnal *anal, ut64 addr, ut8 *buf, int len) {
 }
 #endif
 
-R_API void r_anal_fcn_invalidate_read_ahead_cache() {
+// only needed when the analyzed memory changes without going through RIO
+R_API void r_anal_fcn_invalidate_read_ahead_cache(RAnal *anal) {
 #if READ_AHEAD
-	cache_addr = UT64_MAX;
+	if (anal && anal->read_ahead && anal->iob.io) {
+		read_ahead_reset (anal->read_ahead, anal->iob.io);
+	}
 #endif
 }
 
@@ -120,6 +177,16 @@ R_API void r_anal_fcn_update_tinyrange_bbs(RAnalFunction *fcn) {
 	}
 }
 
+/* Adds the blocks of fcn to anal->bb_tree, or refreshes the range of the
+ * ones already there after the analysis changed them. */
+R_API void r_anal_fcn_update_bb_tree(RAnal *anal, RAnalFunction *fcn) {
+	RAnalBlock *bb;
+	RListIter *iter;
+	r_list_foreach (fcn->bbs, iter, bb) {
+		r_anal_bb_tree_insert (anal, bb);
+	}
+}
+
 static void set_meta_min_if_needed(RAnalFunction *x) {
 	if (x->meta.min == UT64_MAX) {
 		ut64 min = UT64_MAX;
@@ -355,6 +422,7 @@ R_API int r_anal_fcn_resize(RAnal *anal, RAnalFunction *fcn, int newsize) {
 		}
 		if (bb->addr + bb->size >= eof) {
 			bb->size = eof - bb->addr;
+			r_anal_bb_tree_update (bb);
 		}
 		if (bb->jump != UT64_MAX && bb->jump >= eof) {
 			bb->jump = UT64_MAX;
@@ -442,6 +510,7 @@ static RAnalBlock *appendBasicBlock(RAnal *anal, RAnalFunction *fcn, ut64 addr)
 	bb->fail = UT64_MAX;
 	bb->type = 0; // TODO
 	r_anal_fcn_bbadd (fcn, bb);
+	r_anal_bb_tree_insert (anal, bb);
 	if (anal->cb.on_fcn_bb_new) {
 		anal->cb.on_fcn_bb_new (anal, anal->user, fcn, bb);
 	}
@@ -1865,6 +1934,7 @@ R_API int r_anal_fcn(RAnal *anal, RAnalFunction *fcn, ut64 addr, ut64 len, int r
 #endif
 		r_anal_trim_jmprefs (anal, fcn);
 	}
+	r_anal_fcn_update_bb_tree (anal, fcn);
 	return ret;
 }
 
@@ -2067,6 +2137,7 @@ R_API bool r_anal_fcn_add_bb(RAnal *anal, RAnalFunction *fcn, ut64 addr, ut64 si
 		if (bbi) {
 			/* shrink overlapped basic block */
 			bbi->size = addr - (bbi->addr);
+			r_anal_bb_tree_update (bbi);
 			r_anal_fcn_update_tinyrange_bbs (fcn);
 		}
 	}
@@ -2074,9 +2145,9 @@ R_API bool r_anal_fcn_add_bb(RAnal *anal, RAnalFunction *fcn, ut64 addr, ut64 si
 		if (bb) {
 			r_list_delete_data (fcn->bbs, bb);
 		}
-		r_anal_fcn_invalidate_read_ahead_cache ();
 		fcn_recurse (anal, fcn, addr, size, 1);
 		r_anal_fcn_update_tinyrange_bbs (fcn);
+		r_anal_fcn_update_bb_tree (anal, fcn);
 		r_anal_fcn_set_size (anal, fcn, r_anal_fcn_size (fcn));
 		bb = r_anal_fcn_bbget_at (fcn, addr);
 		if (!bb) {
@@ -2103,6 +2174,7 @@ R_API bool r_anal_fcn_add_bb(RAnal *anal, RAnalFunction *fcn, ut64 addr, ut64 si
 	bb->jump = jump;
 	bb->fail = fail;
 	bb->type = type;
+	r_anal_bb_tree_insert (anal, bb);
 	if (diff) {
 		if (!bb->diff) {
 			bb->diff = r_anal_diff_new ();
@@ -2143,6 +2215,8 @@ R_API int r_anal_fcn_split_bb(RAnal *anal, RAnalFunction *fcn, RAnalBlock *bbi,
 	bb->conditional = bbi->conditional;
 	FITFCNSZ ();
 	bbi->size = addr - bbi->addr;
+	r_anal_bb_tree_update (bb);
+	r_anal_bb_tree_update (bbi);
 	bbi->jump = addr;
 	bbi->fail = -1;
 	bbi->conditional = false;
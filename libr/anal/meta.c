@@ -1,136 +1,203 @@
-/* radare - LGPL - Copyright 2008-2018 - nibble, pancake */
+/* radare - LGPL - Copyright 2008-2019 - nibble, pancake */
 
-// TODO: rename to r_anal_meta_get() ??
-#if 0
-    TODO
-    ====
-    - handle sync to synchronize all the data on disk.
-    - actually listing only works in memory
-    - array_add doesnt needs index, right?
-    - remove unused arguments from r_meta_find (where ?)
-    - implement r_meta_find
-#endif
 #if 0
   SDB SPECS
 
 DatabaseName:
   'anal.meta'
 Keys:
-  'meta.<type>.count=<int>'     number of added metas where 'type' is a single char
-  'meta.<type>.<last>=<array>'  splitted array, each block contains K elements
-  'meta.<type>.<addr>=<string>' string representing extra information of the meta type at given address
-  'range.<baddr>=<array>'       store valid addresses in a base range array
+  'meta.<type>.<addr>=<string>' size,space,[subtype,]base64 of the meta type at given address
+  'meta.<addr>=<array>'         types added at the given address with r_meta_add
 #endif
 
+/* The metadata lives in anal->meta_tree, an interval tree of MetaNode per
+ * type keyed on the address, so lookups don't format, hash or decode any
+ * string. Every change is written through to the sdb above to keep it
+ * available for 'k' and the projects, r_meta_rebuild() loads it back. */
+
 #include <r_anal.h>
 #include <r_core.h>
 #include <r_util.h>
 
-#define META_RANGE_BASE(x) ((x)>>5)
 #undef DB
 #define DB a->sdb_meta
+#define META_NODE(x) container_of ((RBNode*)(x), MetaNode, rb)
+#define META_TREE(a, type) (&(a)->meta_tree[(ut8)(type)])
 
-static char *meta_inrange_get (RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
-		return NULL;
+typedef struct {
+	RAnalMetaItem item; // owns the decoded string
+	bool listed; // the type is in the meta.<addr> array
+	ut64 seq; // order in which the types were listed at an address
+	ut64 rb_max_addr; // maximum of item.to - 1 in the subtree
+	RBNode rb;
+} MetaNode;
+
+static ut64 meta_seq = 0;
+
+static int meta_node_cmp(const void *incoming, const RBNode *in_tree) {
+	const ut64 addr = *(const ut64 *)incoming;
+	const MetaNode *mn = META_NODE (in_tree);
+	if (addr != mn->item.from) {
+		return addr < mn->item.from? -1: 1;
 	}
-	ut64 base = META_RANGE_BASE (addr);
-	ut64 base2 = META_RANGE_BASE (addr + size - 1);
-	char *res = NULL;
-	// return string array of all the offsets where there are stuff
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		char *r = sdb_get (DB, key, 0);
-		if (r) {
-			if (res) {
-				res = r_str_append (res, ",");
+	return 0;
+}
+
+static void meta_node_calc_max_addr(RBNode *node) {
+	int i;
+	MetaNode *mn = META_NODE (node);
+	mn->rb_max_addr = mn->item.from + (mn->item.size > 0? mn->item.size - 1: 0);
+	for (i = 0; i < 2; i++) {
+		if (node->child[i]) {
+			MetaNode *mn1 = META_NODE (node->child[i]);
+			if (mn1->rb_max_addr > mn->rb_max_addr) {
+				mn->rb_max_addr = mn1->rb_max_addr;
 			}
-			res = r_str_append (res, r);
-			free (r);
 		}
 	}
-	return res;
 }
 
-static bool meta_inrange_add (RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
-		return false;
+static void meta_node_free(RBNode *node) {
+	MetaNode *mn = META_NODE (node);
+	free (mn->item.str);
+	free (mn);
+}
+
+static MetaNode *meta_node_get(RAnal *a, int type, ut64 addr) {
+	RBNode *node = r_rbtree_find (*META_TREE (a, type), &addr, meta_node_cmp);
+	return node? META_NODE (node): NULL;
+}
+
+static MetaNode *meta_node_new(RAnal *a, int type, ut64 addr, int size) {
+	MetaNode *mn = R_NEW0 (MetaNode);
+	if (!mn) {
+		return NULL;
 	}
-	bool set = false;
-	ut64 base, base2;
-	base = META_RANGE_BASE (addr);
-	base2 = META_RANGE_BASE (addr + size - 1);
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		if (sdb_array_add_num (DB, key, addr, 0)) {
-			set = true;
-		}
+	mn->item.type = type;
+	mn->item.from = addr;
+	mn->item.size = size;
+	mn->item.to = addr + size;
+	r_rbtree_aug_insert (META_TREE (a, type), &mn->item.from, &mn->rb,
+		meta_node_cmp, meta_node_calc_max_addr);
+	return mn;
+}
+
+static void meta_node_resize(RAnal *a, MetaNode *mn, int size) {
+	if (mn->item.size != size) {
+		mn->item.size = size;
+		mn->item.to = mn->item.from + size;
+		r_rbtree_aug_update_sum (*META_TREE (a, mn->item.type), &mn->item.from,
+			&mn->rb, meta_node_cmp, meta_node_calc_max_addr);
 	}
-	return set;
 }
 
-static bool meta_inrange_del (RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
-		return false;
+static void meta_node_list(RAnal *a, MetaNode *mn) {
+	if (!mn->listed) {
+		char type[2] = { mn->item.type, 0 };
+		mn->listed = true;
+		mn->seq = meta_seq++;
+		sdb_array_add (DB, sdb_fmt ("meta.0x%"PFMT64x, mn->item.from), type, 0);
 	}
-	bool set = false;
-	ut64 base = META_RANGE_BASE (addr);
-	ut64 base2 = META_RANGE_BASE (addr + size - 1);
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		if (sdb_array_remove_num (DB, key, addr, 0)) {
-			set = true;
-		}
+}
+
+// serialize the node in its sdb key
+static void meta_node_sync(RAnal *a, MetaNode *mn) {
+	const RAnalMetaItem *it = &mn->item;
+	const char *space = it->space? it->space->name: "*";
+	char *e_str = sdb_encode ((const ut8 *)(it->str? it->str: ""), -1);
+	char *val = it->subtype
+		? r_str_newf ("%d,%s,%c,%s", (int)it->size, space, it->subtype, e_str)
+		: r_str_newf ("%d,%s,%s", (int)it->size, space, e_str);
+	sdb_set_owned (DB, sdb_fmt ("meta.%c.0x%"PFMT64x, it->type, it->from), val, 0);
+	free (e_str);
+}
+
+static void meta_node_del(RAnal *a, MetaNode *mn) {
+	sdb_unset (DB, sdb_fmt ("meta.%c.0x%"PFMT64x, mn->item.type, mn->item.from), 0);
+	if (mn->listed) {
+		char type[2] = { mn->item.type, 0 };
+		sdb_array_remove (DB, sdb_fmt ("meta.0x%"PFMT64x, mn->item.from), type, 0);
 	}
-	return set;
+	r_rbtree_aug_delete (META_TREE (a, mn->item.type), &mn->item.from,
+		meta_node_cmp, meta_node_free, meta_node_calc_max_addr);
 }
 
-// 512 = 1.5s
-// 256 = 1.3s
-// 128 = 1.2s
-// 64 = 1.14
-// 32 = 1.12
-// not storing any = 1
-#define K 256
+R_API void r_meta_fini(RAnal *a) {
+	int i;
+	for (i = 0; i < R_ARRAY_SIZE (a->meta_tree); i++) {
+		r_rbtree_free (a->meta_tree[i], meta_node_free);
+		a->meta_tree[i] = NULL;
+	}
+}
 
-static int meta_type_add(RAnal *a, char type, ut64 addr) {
-	char key[32];
-	ut32 count, last;
-	snprintf (key, sizeof (key)-1, "meta.%c.count", type);
-	count = (ut32)sdb_num_inc (DB, key, 1, 0);
-	last = count/K;
+static int meta_rebuild_item_cb(void *user, const char *k, const char *v) {
+	RAnal *a = user;
+	// only meta.<type>.0x<addr>, the var comments have another .0x<idx>
+	if (strncmp (k, "meta.", 5) || !k[5] || k[6] != '.'
+			|| strncmp (k + 7, "0x", 2) || strchr (k + 9, '.')) {
+		return 1;
+	}
+	RAnalMetaItem it = {0};
+	if (!r_meta_deserialize_val (a, &it, k[5], sdb_atoi (k + 7), v)) {
+		free (it.str);
+		return 1;
+	}
+	MetaNode *mn = meta_node_new (a, it.type, it.from, it.size);
+	if (mn) {
+		mn->item.subtype = it.subtype;
+		mn->item.space = it.space;
+		mn->item.str = it.str;
+	} else {
+		free (it.str);
+	}
+	return 1;
+}
 
-	snprintf (key, sizeof (key)-1, "meta.%c.%d", type, last);
-	sdb_array_add_num (DB, key, addr, 0);
-	return count;
+static int meta_rebuild_list_cb(void *user, const char *k, const char *v) {
+	RAnal *a = user;
+	if (strncmp (k, "meta.0x", 7)) {
+		return 1;
+	}
+	ut64 addr = sdb_atoi (k + 5);
+	for (; *v; v++) {
+		MetaNode *mn = *v != SDB_RS? meta_node_get (a, *v, addr): NULL;
+		if (mn && !mn->listed) {
+			mn->listed = true;
+			mn->seq = meta_seq++;
+		}
+	}
+	return 1;
+}
+
+/* Reload the metadata store from the sdb, after this was written directly */
+R_API void r_meta_rebuild(RAnal *a) {
+	r_return_if_fail (a);
+	r_meta_fini (a);
+	sdb_foreach (DB, meta_rebuild_item_cb, a);
+	sdb_foreach (DB, meta_rebuild_list_cb, a);
 }
 
 // TODO: Add APIs to resize meta? nope, just del and add
 R_API int r_meta_set_string(RAnal *a, int type, ut64 addr, const char *s) {
-	char key[100], val[2048], *e_str;
-	int ret;
-	ut64 size;
-	const char *space = r_spaces_current_name (&a->meta_spaces);
-	meta_type_add (a, type, addr);
-
-	snprintf (key, sizeof (key)-1, "meta.%c.0x%"PFMT64x, type, addr);
-	size = sdb_array_get_num (DB, key, 0, 0);
-	if (!size) {
-		size = strlen (s);
-		meta_inrange_add (a, addr, size);
+	int ret = false;
+	MetaNode *mn = meta_node_get (a, type, addr);
+	if (!mn) {
+		mn = meta_node_new (a, type, addr, strlen (s));
+		if (!mn) {
+			return false;
+		}
 		ret = true;
-	} else {
-		ret = false;
 	}
 	if (a->log) {
 		char *msg = r_str_newf (":C%c %s @ 0x%"PFMT64x, type, s, addr);
 		a->log (a, msg);
 		free (msg);
 	}
-	e_str = sdb_encode ((const void*)s, -1);
-	snprintf (val, sizeof (val)-1, "%d,%s,%s", (int)size, space, e_str);
-	sdb_set (DB, key, val, 0);
-	free ((void*)e_str);
+	free (mn->item.str);
+	mn->item.str = strdup (s);
+	mn->item.subtype = 0;
+	mn->item.space = r_spaces_current (&a->meta_spaces);
+	meta_node_sync (a, mn);
 
 	/* send event */
 	REventMeta rems = {
@@ -148,13 +215,11 @@ R_API int r_meta_set_var_comment(RAnal *a, int type, ut64 idx, ut64 addr, const
 	int ret;
 	ut64 size;
 	const char *space = r_spaces_current_name (&a->meta_spaces);
-	meta_type_add (a, type, addr);
 
 	snprintf (key, sizeof (key)-1, "meta.%c.0x%"PFMT64x".0x%"PFMT64x, type, addr, idx);
 	size = sdb_array_get_num (DB, key, 0, 0);
 	if (!size) {
 		size = strlen (s);
-		meta_inrange_add (a, addr, size);
 		ret = true;
 	} else {
 		ret = false;
@@ -167,30 +232,8 @@ R_API int r_meta_set_var_comment(RAnal *a, int type, ut64 idx, ut64 addr, const
 }
 
 R_API char *r_meta_get_string(RAnal *a, int type, ut64 addr) {
-	char key[100];
-	const char *k, *p, *p2, *p3;
-	snprintf (key, sizeof (key)-1, "meta.%c.0x%"PFMT64x, type, addr);
-	k = sdb_const_get (DB, key, NULL);
-	if (!k) {
-		return NULL;
-	}
-	p = strchr (k, SDB_RS);
-	if (!p) {
-		return NULL;
-	}
-	k = p + 1;
-	p2 = strchr (k, SDB_RS);
-	if (!p2) {
-		return (char *)sdb_decode (k, NULL);
-	}
-	k = p2 + 1;
-	if (type == R_META_TYPE_STRING) {
-		p3 = strchr (k, SDB_RS);
-		if (p3) {
-			return (char *)sdb_decode (p3 + 1, NULL);
-		}
-	}
-	return (char *)sdb_decode (k, NULL);
+	MetaNode *mn = meta_node_get (a, type, addr);
+	return mn && mn->item.str? strdup (mn->item.str): NULL;
 }
 
 R_API char *r_meta_get_var_comment (RAnal *a, int type, ut64 idx, ut64 addr) {
@@ -213,22 +256,8 @@ R_API char *r_meta_get_var_comment (RAnal *a, int type, ut64 idx, ut64 addr) {
 	return (char *)sdb_decode (p2+1, NULL);
 }
 
-static bool mustDeleteMetaEntry(RAnal *a, ut64 addr) {
-	const char *tt = sdb_const_get (DB, sdb_fmt ("meta.t.0x%"PFMT64x, addr), NULL);
-	const char *ss = sdb_const_get (DB, sdb_fmt ("meta.s.0x%"PFMT64x, addr), NULL);
-	const char *dd = sdb_const_get (DB, sdb_fmt ("meta.d.0x%"PFMT64x, addr), NULL);
-	const char *cc = sdb_const_get (DB, sdb_fmt ("meta.C.0x%"PFMT64x, addr), NULL);
-	int count = 0;
-	if (tt) count++;
-	if (ss) count++;
-	if (dd) count++;
-	if (cc) count++;
-	return (count == 0);
-}
-
 R_API int r_meta_del(RAnal *a, int type, ut64 addr, ut64 size) {
-	char key[100], *dtr, *s, *p, *next;
-	const char *val;
+	MetaNode *mn;
 	int i;
 	/* send event */
 	REventMeta rems = {
@@ -239,75 +268,36 @@ R_API int r_meta_del(RAnal *a, int type, ut64 addr, ut64 size) {
 	r_event_send (a->ev, R_EVENT_META_DEL, &rems);
 	if (size == UT64_MAX) {
 		// FULL CLEANUP
-		// XXX: this thing ignores the type
 		if (type == R_META_TYPE_ANY) {
 			sdb_reset (DB);
+			r_meta_fini (a);
 		} else {
-			snprintf (key, sizeof (key)-1, "meta.%c.count", type);
-			int last = (ut64)sdb_num_get (DB, key, NULL)/K;
-			for (i = 0; i < last; i++) {
-				snprintf (key, sizeof (key)-1, "meta.%c.%d", type, i);
-				dtr = sdb_get (DB, key, 0);
-				for (p = dtr; p; p = next) {
-					s = sdb_anext (p, &next);
-					snprintf (key, sizeof (key)-1,
-						"meta.%c.0x%"PFMT64x,
-						type, sdb_atoi (s));
-					sdb_unset (DB, key, 0);
-					if (!next) {
-						break;
-					}
+			RBIter it;
+			r_rbtree_foreach (*META_TREE (a, type), it, mn, MetaNode, rb) {
+				sdb_unset (DB, sdb_fmt ("meta.%c.0x%"PFMT64x, type, mn->item.from), 0);
+				if (mn->listed) {
+					char t[2] = { type, 0 };
+					sdb_array_remove (DB, sdb_fmt ("meta.0x%"PFMT64x, mn->item.from), t, 0);
 				}
-				free (dtr);
 			}
+			r_rbtree_free (*META_TREE (a, type), meta_node_free);
+			*META_TREE (a, type) = NULL;
 		}
 		return false;
 	}
 	if (type == R_META_TYPE_ANY) {
-		/* special case */
-		r_meta_del (a, R_META_TYPE_COMMENT, addr, size);
-		r_meta_del (a, R_META_TYPE_VARTYPE, addr, size);
-	}
-	if (type == R_META_TYPE_COMMENT || type == R_META_TYPE_VARTYPE) {
-		snprintf (key, sizeof (key)-1, "meta.%c.0x%"PFMT64x, type, addr);
-	} else {
-		snprintf (key, sizeof (key)-1, "meta.0x%"PFMT64x, addr);
-	}
-	val = sdb_const_get (DB, key, 0);
-	if (val) {
-		if (type == R_META_TYPE_ANY) {
-			char item_key[100];
-			const char *ptr = val;
-			while (*ptr) {
-				snprintf (item_key, sizeof (item_key), "meta.%c.0x%" PFMT64x, *ptr, addr);
-				sdb_unset (DB, item_key, 0);
-				ptr++;
-				if (*ptr) {
-					ptr++;
-				}
+		/* the comments and vartypes and everything listed at addr */
+		for (i = 0; i < R_ARRAY_SIZE (a->meta_tree); i++) {
+			mn = a->meta_tree[i]? meta_node_get (a, i, addr): NULL;
+			if (mn && (mn->listed || i == R_META_TYPE_COMMENT || i == R_META_TYPE_VARTYPE)) {
+				meta_node_del (a, mn);
 			}
-			sdb_unset (DB, key, 0);
-			return false;
 		}
-		if (strchr (val, ',')) {
-			char type_fld[] = "##";
-			if (val[0] == type) {
-				type_fld[0] = type;
-				type_fld[1] = ',';
-			} else {
-				type_fld[0] = ',';
-				type_fld[1] = type;
-			}
-			sdb_uncat (DB, key, type_fld, 0);
-		} else {
-			sdb_unset (DB, key, 0);
-		}
-		snprintf (key, sizeof (key), "meta.%c.0x%" PFMT64x, type, addr);
-		sdb_unset (DB, key, 0);
+		return false;
 	}
-	sdb_unset (DB, key, 0);
-	if (mustDeleteMetaEntry (a, addr)) {
-		meta_inrange_del (a, addr, size);
+	mn = meta_node_get (a, type, addr);
+	if (mn) {
+		meta_node_del (a, mn);
 	}
 	return false;
 }
@@ -341,16 +331,6 @@ R_API RAnalMetaItem *r_meta_item_new(int type) {
 	return mi;
 }
 
-static void meta_serialize(RAnalMetaItem *it, char *k, size_t k_size, char *v, size_t v_size) {
-	snprintf (k, k_size, "meta.%c.0x%" PFMT64x, it->type, it->from);
-	const char *name = it->space? it->space->name: "*";
-	if (it->subtype) {
-		snprintf (v, v_size, "%d,%s,%c,%s", (int)it->size, name, it->subtype, it->str);
-	} else {
-		snprintf (v, v_size, "%d,%s,%s", (int)it->size, name, it->str);
-	}
-}
-
 static bool meta_deserialize(RAnal *a, RAnalMetaItem *it, const char *k, const char *v) {
 	if (strlen (k) < 8) {
 		return false;
@@ -395,8 +375,6 @@ R_API bool r_meta_deserialize_val(RAnal *a, RAnalMetaItem *it, int type, ut64 fr
 }
 
 static int meta_add(RAnal *a, int type, int subtype, ut64 from, ut64 to, const char *str) {
-	const RSpace *space = r_spaces_current (&a->meta_spaces);
-	char key[100], val[2048];
 	if (from > to) {
 		return false;
 	}
@@ -406,34 +384,21 @@ static int meta_add(RAnal *a, int type, int subtype, ut64 from, ut64 to, const c
 	if (type == 100 && (to - from) < 1) {
 		return false;
 	}
-	/* set entry */
-	char *e_str = sdb_encode ((const void*)str, -1);
-	RAnalMetaItem mi = {from, to, (int)(to - from), type, subtype, e_str, space};
-	meta_serialize (&mi, key, sizeof (key), val, sizeof (val));
-	bool exists = sdb_exists (DB, key);
-
-	sdb_set (DB, key, val, 0);
-	free (e_str);
-
-	// XXX: This is totally inefficient, using array_add withuot
-	// checking return value is wrong practice, also it may lead
-	// to inconsistent DB, and pretty bad performance. We should
-	// store this list in a different storage that doesnt have
-	// those limits and it's O(1) instead of O(n)
-	snprintf (key, sizeof (key) - 1, "meta.0x%"PFMT64x, from);
-	if (exists) {
-		const char *value = sdb_const_get (DB, key, 0);
-		if (value) {
-			int idx = sdb_array_indexof (DB, key, value, 0);
-			if (idx >= 0) {
-				sdb_array_delete (DB, key, idx, 0);
-			}
+	MetaNode *mn = meta_node_get (a, type, from);
+	if (mn) {
+		meta_node_resize (a, mn, (int)(to - from));
+	} else {
+		mn = meta_node_new (a, type, from, (int)(to - from));
+		if (!mn) {
+			return false;
 		}
 	}
-	val[0] = type;
-	val[1] = '\0';
-	sdb_array_add (DB, key, val, 0);
-	meta_inrange_add (a, from, to - from);
+	free (mn->item.str);
+	mn->item.str = str? strdup (str): NULL;
+	mn->item.subtype = subtype;
+	mn->item.space = r_spaces_current (&a->meta_spaces);
+	meta_node_sync (a, mn);
+	meta_node_list (a, mn);
 	return true;
 }
 
@@ -445,114 +410,111 @@ R_API int r_meta_add_with_subtype(RAnal *a, int type, int subtype, ut64 from, ut
 	return meta_add (a, type, subtype, from, to, str);
 }
 
-static RAnalMetaItem *r_meta_find_(RAnal *a, ut64 at, int type, int where, int excl_type) {
-	const char *infos, *metas;
-	char key[100];
-	Sdb *s = a->sdb_meta;
-	static RAnalMetaItem mi = {0};
-	// XXX: return allocated item? wtf
+// the item listed first at the address, of any type but excl_type
+static RAnalMetaItem *meta_find_any(RAnal *a, ut64 at, int excl_type) {
+	MetaNode *mn, *first = NULL;
+	int i;
+	for (i = 0; i < R_ARRAY_SIZE (a->meta_tree); i++) {
+		if (!a->meta_tree[i] || i == excl_type) {
+			continue;
+		}
+		mn = meta_node_get (a, i, at);
+		if (mn && mn->listed && (!first || mn->seq < first->seq)) {
+			first = mn;
+		}
+	}
+	return first? &first->item: NULL;
+}
+
+// TODO should be named get imho
+R_API RAnalMetaItem *r_meta_find(RAnal *a, ut64 at, int type, int where) {
 	if (where != R_META_WHERE_HERE) {
 		eprintf ("THIS WAS NOT SUPOSED TO HAPPEN\n");
 		return NULL;
 	}
+	if (type == R_META_TYPE_ANY) {
+		return meta_find_any (a, at, R_META_TYPE_NONE);
+	}
+	MetaNode *mn = meta_node_get (a, type, at);
+	return mn && mn->listed? &mn->item: NULL;
+}
 
-	snprintf (key, sizeof (key), "meta.0x%" PFMT64x, at);
-	infos = sdb_const_get (s, key, 0);
-	if (!infos) {
+R_API RAnalMetaItem *r_meta_find_any_except(RAnal *a, ut64 at, int type, int where) {
+	if (where != R_META_WHERE_HERE) {
+		eprintf ("THIS WAS NOT SUPOSED TO HAPPEN\n");
 		return NULL;
 	}
-	for (; *infos; infos++) {
-		if (*infos == ',') {
-			continue;
-		}
-		if (type != R_META_TYPE_ANY && type != *infos) {
-			continue;
+	return meta_find_any (a, at, type);
+}
+
+// append the listed nodes containing at, in address order
+static void meta_tree_find_in(RBNode *node, ut64 at, RList *out) {
+	while (node) {
+		MetaNode *mn = META_NODE (node);
+		if (mn->rb_max_addr < at) {
+			return;
 		}
-		if (excl_type && excl_type == *infos) {
-			continue;
+		meta_tree_find_in (node->child[0], at, out);
+		if (mn->item.from > at) {
+			return;
 		}
-		snprintf (key, sizeof (key), "meta.%c.0x%" PFMT64x, *infos, at);
-		metas = sdb_const_get (s, key, 0);
-		if (metas) {
-			if (!r_meta_deserialize_val (a, &mi, *infos, at, metas)) {
-				continue;
-			}
-			return &mi;
+		if (mn->listed && at < mn->item.to) {
+			r_list_append (out, mn);
 		}
+		node = node->child[1];
 	}
-	return NULL;
-}
-
-// TODO should be named get imho
-R_API RAnalMetaItem *r_meta_find(RAnal *a, ut64 at, int type, int where) {
-	return r_meta_find_ (a, at, type, where, R_META_TYPE_NONE);
 }
 
-R_API RAnalMetaItem *r_meta_find_any_except(RAnal *a, ut64 at, int type, int where) {
-	return r_meta_find_ (a, at, R_META_TYPE_ANY, where, type);
+static int meta_node_order(const void *_a, const void *_b) {
+	const MetaNode *a = _a, *b = _b;
+	if (a->item.from != b->item.from) {
+		return a->item.from < b->item.from? -1: 1;
+	}
+	return a->seq < b->seq? -1: a->seq > b->seq;
 }
 
-R_API RAnalMetaItem *r_meta_find_in(RAnal *a, ut64 at, int type, int where) {
-	char *res = meta_inrange_get (a, at, 1);
-	if (!res) {
+// the listed nodes containing at, in address and listing order
+static RList *meta_find_in(RAnal *a, ut64 at, int type) {
+	RList *list = r_list_new ();
+	int i;
+	if (!list) {
 		return NULL;
 	}
-	RList *list = r_str_split_list (res, ",");
-	RListIter *iter;
-	const char *meta;
-	r_list_foreach (list, iter, meta) {
-		ut64 mia = r_num_math (NULL, meta);
-		RAnalMetaItem *mi = r_meta_find (a, mia, type, where);
-		if (mi && (at >= mi->from && at < mi->to)) {
-			free (res);
-			return mi;
-		}
+	if (type != R_META_TYPE_ANY) {
+		meta_tree_find_in (*META_TREE (a, type), at, list);
+		return list;
+	}
+	for (i = 0; i < R_ARRAY_SIZE (a->meta_tree); i++) {
+		meta_tree_find_in (a->meta_tree[i], at, list);
+	}
+	if (r_list_length (list) > 1) {
+		r_list_sort (list, meta_node_order);
 	}
+	return list;
+}
+
+R_API RAnalMetaItem *r_meta_find_in(RAnal *a, ut64 at, int type, int where) {
+	RList *list = meta_find_in (a, at, type);
+	MetaNode *mn = list? r_list_first (list): NULL;
 	r_list_free (list);
-	free (res);
-	return NULL;
+	return mn? &mn->item: NULL;
 }
 
+/* The items are owned by the store, free the list with r_list_free */
 R_API RList *r_meta_find_list_in(RAnal *a, ut64 at, int type, int where) {
-	char *res = meta_inrange_get (a, at, 1);
-	if (!res) {
-		return NULL;
-	}
-	RList *list = r_str_split_list (res, ",");
-	RList *out = r_list_new ();
-	if (!out) {
+	RList *list = meta_find_in (a, at, R_META_TYPE_ANY);
+	if (list && r_list_empty (list)) {
+		r_list_free (list);
 		return NULL;
 	}
-	RListIter *iter;
-	const char *meta;
-	r_list_foreach (list, iter, meta) {
-		Sdb *s = a->sdb_meta;
-		ut64 mia = r_num_math (NULL, meta);
-		const char *key = sdb_fmt ("meta.0x%" PFMT64x, mia);
-		const char *infos = sdb_const_get (s, key, 0);
-		if (!infos) {
-			continue;
-		}
-		for (; *infos; infos++) {
-			if (*infos == ',') {
-				continue;
-			}
-			const char *key = sdb_fmt ("meta.%c.0x%" PFMT64x, *infos, mia);
-			const char *metas = sdb_const_get (s, key, 0);
-			if (metas) {
-				RAnalMetaItem *mi = R_NEW0 (RAnalMetaItem);
-				if (!r_meta_deserialize_val (a, mi, *infos, mia, metas)) {
-					continue;
-				}
-				if (mi && (at >= mi->from && at < mi->to)) {
-					r_list_append (out, mi);
-				}
-			}
+	if (list) {
+		RListIter *iter;
+		MetaNode *mn;
+		r_list_foreach (list, iter, mn) {
+			iter->data = &mn->item;
 		}
 	}
-	r_list_free (list);
-	free (res);
-	return out;
+	return list;
 }
 
 R_API const char *r_meta_type_to_string(int type) {
@@ -815,19 +777,18 @@ R_API void r_meta_list_offset(RAnal *a, ut64 addr, char input) {
 		R_META_TYPE_DATA,
 	};
 
-	char key[100];
 	int i;
 
-	for (i = 0; i < sizeof (types) / sizeof (types[0]); i ++) {
-		snprintf (key, sizeof (key)-1, "meta.%c.0x%"PFMT64x, types[i], addr);
-		const char *k = sdb_const_get (DB, key, 0);
-		if (!k) {
+	for (i = 0; i < R_ARRAY_SIZE (types); i++) {
+		MetaNode *mn = meta_node_get (a, types[i], addr);
+		if (!mn) {
 			continue;
 		}
-
-		RAnalMetaUserItem ui = { a };
-
-		meta_print_item ((void *)&ui, key, k);
+		RAnalMetaItem it = mn->item;
+		if (!it.str) {
+			it.str = "";
+		}
+		r_meta_print (a, &it, 0, true);
 	}
 }
 
@@ -901,51 +862,30 @@ R_API RList *r_meta_enumerate(RAnal *a, int type) {
 	return list;
 }
 
-static int meta_unset_cb(void *user, const char *k, const char *v) {
-	char nk[128], nv[4096];
-	RAnalMetaUserItem *ui = user;
-	RAnal *a = ui->anal;
-	RAnalMetaItem it = {0};
-	if (!strstr (k, ".0x")) {
-		return 1;
-	}
-	meta_deserialize (ui->anal, &it, k, v);
-	if (it.space && it.space == ui->user) {
-		it.space = NULL;
-		meta_serialize (&it, nk, sizeof (nk), nv, sizeof (nv));
-		sdb_set (DB, nk, nv, 0);
-	}
-	return 1;
-}
-
 R_API void r_meta_space_unset_for(RAnal *a, const RSpace *space) {
-	RAnalMetaUserItem ui = { .anal = a, .user = (void *)space };
-	r_meta_list_cb (a, R_META_TYPE_ANY, 0, meta_unset_cb, &ui, UT64_MAX);
-}
-
-typedef struct {
-	int count;
-	int index;
-	const RSpace *ctx;
-} myMetaUser;
-
-static int meta_count_cb(void *user, const char *k, const char *v) {
-	RAnalMetaUserItem *ui = user;
-	myMetaUser *mu = ui->user;
-	RAnalMetaItem it = {0};
-	if (!strstr (k, ".0x")) {
-		return 1;
-	}
-	meta_deserialize (ui->anal, &it, k, v);
-	if (mu && it.space == mu->ctx) {
-		mu->count++;
+	RBIter it;
+	MetaNode *mn;
+	int i;
+	for (i = 0; i < R_ARRAY_SIZE (a->meta_tree); i++) {
+		r_rbtree_foreach (a->meta_tree[i], it, mn, MetaNode, rb) {
+			if (mn->item.space == space) {
+				mn->item.space = NULL;
+				meta_node_sync (a, mn);
+			}
+		}
 	}
-	r_meta_item_fini (&it);
-	return 1;
 }
 
 R_API int r_meta_space_count_for(RAnal *a, const RSpace *space) {
-	myMetaUser mu = { .ctx = space };
-	r_meta_list_cb (a, R_META_TYPE_ANY, 0, meta_count_cb, &mu, UT64_MAX);
-	return mu.count;
+	RBIter it;
+	MetaNode *mn;
+	int i, count = 0;
+	for (i = 0; i < R_ARRAY_SIZE (a->meta_tree); i++) {
+		r_rbtree_foreach (a->meta_tree[i], it, mn, MetaNode, rb) {
+			if (mn->item.space == space) {
+				count++;
+			}
+		}
+	}
+	return count;
 }
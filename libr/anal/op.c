@@ -145,6 +145,7 @@ R_API int r_anal_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int le
 	}
 	int ret = R_MIN (2, len);
 	if (len > 0 && anal->cur && anal->cur->op) {
+		R_PROF_BEGIN (R_PROF_ANAL_OP);
 		//use core binding to set asm.bits correctly based on the addr
 		//this is because of the hassle of arm/thumb
 		if (anal && anal->coreb.archbits) {
@@ -167,6 +168,7 @@ R_API int r_anal_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int le
 				op->var = tmp;
 			}
 		}
+		R_PROF_END (R_PROF_ANAL_OP);
 	} else if (!memcmp (data, "\xff\xff\xff\xff", R_MIN (4, len))) {
 		op->type = R_ANAL_OP_TYPE_ILL;
 	} else {
@@ -476,6 +476,7 @@ RAnalPlugin r_anal_plugin_arm_gnu = {
 	.desc = "ARM code analysis plugin",
 	.archinfo = archinfo,
 	.op = &arm_op,
+	.threadsafe = true,
 	.set_reg_profile = set_reg_profile,
 };
 
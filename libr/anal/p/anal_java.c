@@ -501,6 +501,7 @@ static int analyze_from_code_buffer(RAnal *anal, RAnalFunction *fcn, ut64 addr,
 	r_list_foreach (fcn->bbs, bb_iter, bb) {
 		actual_size += bb->size;
 	}
+	r_anal_fcn_update_bb_tree (anal, fcn);
 	r_anal_fcn_set_size (NULL, fcn, state->bytes_consumed);
 	r_list_free (nodes->cfg_node_addrs);
 	free (nodes);
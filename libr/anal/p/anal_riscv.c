@@ -727,6 +727,7 @@ RAnalPlugin r_anal_plugin_riscv = {
 	.arch = "riscv",
 	.bits = 32|64,
 	.op = &riscv_op,
+	.threadsafe = true,
 	.get_reg_profile = &get_reg_profile,
 };
 
@@ -9,18 +9,46 @@
 #define mid_refline(a, r) (mid_down_refline (a, r) || mid_up_refline (a, r))
 #define in_refline(a, r) (mid_refline (a, r) || (a) == (r)->from || (a) == (r)->to)
 
+#define REFLINE_OPS_MAX 65536
+
 typedef struct refline_end {
 	int val;
+	int seq;
 	bool is_from;
 	RAnalRefline *r;
 } ReflineEnd;
 
+/* what the sweep needs from the op at an address, kept in anal->refline_ops
+ * and reused while all the bytes of the op and the arch setup match. hints
+ * are applied on top of it */
+typedef struct refline_op {
+	int nbytes;
+	int bits;
+	int big_endian;
+	ut32 cpu;
+	RAnalPlugin *cur;
+	int ret;
+	int size;
+	ut32 type;
+	ut64 jump;
+	ut8 bytes[];
+} ReflineOp;
+
+// same order r_list_add_sorted gave, the last added end goes first on ties
 static int cmp_asc(const struct refline_end *a, const struct refline_end *b) {
-	return a->val > b->val;
+	if (a->val != b->val) {
+		return (a->val > b->val)? 1: -1;
+	}
+	return b->seq - a->seq;
 }
 
-static int cmp_by_ref_lvl(const RAnalRefline *a, const RAnalRefline *b) {
-	return a->level < b->level;
+// outer levels first, the last added refline goes first on ties
+static int cmp_by_ref_lvl(const void *_a, const void *_b) {
+	const RAnalRefline *a = _a, *b = _b;
+	if (a->level != b->level) {
+		return b->level - a->level;
+	}
+	return b->index - a->index;
 }
 
 static ReflineEnd *refline_end_new(ut64 val, bool is_from, RAnalRefline *ref) {
@@ -34,6 +62,69 @@ static ReflineEnd *refline_end_new(ut64 val, bool is_from, RAnalRefline *ref) {
 	return re;
 }
 
+static void refline_op_kv_free(HtUPKv *kv) {
+	free (kv->value);
+}
+
+static int refline_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *buf, int len, ut32 cpu) {
+	ReflineOp *ro = NULL;
+	int ret;
+	if (anal->pcalign) {
+		return r_anal_op (anal, op, addr, buf, len, R_ANAL_OP_MASK_BASIC | R_ANAL_OP_MASK_HINT);
+	}
+	if (!anal->refline_ops) {
+		anal->refline_ops = ht_up_new (NULL, refline_op_kv_free, NULL);
+		if (!anal->refline_ops) {
+			return r_anal_op (anal, op, addr, buf, len, R_ANAL_OP_MASK_BASIC | R_ANAL_OP_MASK_HINT);
+		}
+	}
+	if (anal->coreb.archbits) {
+		anal->coreb.archbits (anal->coreb.core, addr);
+	}
+	ro = ht_up_find (anal->refline_ops, addr, NULL);
+	if (ro && ro->nbytes <= len && ro->bits == anal->bits && ro->cur == anal->cur
+			&& ro->big_endian == anal->big_endian && ro->cpu == cpu
+			&& !memcmp (ro->bytes, buf, ro->nbytes)) {
+		r_anal_op_init (op);
+		op->addr = addr;
+		op->size = ro->size;
+		op->type = ro->type;
+		op->jump = ro->jump;
+		ret = ro->ret;
+	} else {
+		ret = r_anal_op (anal, op, addr, buf, len, R_ANAL_OP_MASK_BASIC);
+		// undecoded ops are not cached, their size does not tell which bytes were read
+		if (!op->switch_op && ret > 0 && op->size > 0 && op->size <= len) {
+			if (!ro && anal->refline_ops->count >= REFLINE_OPS_MAX) {
+				ht_up_free (anal->refline_ops);
+				anal->refline_ops = ht_up_new (NULL, refline_op_kv_free, NULL);
+			}
+			ro = malloc (sizeof (ReflineOp) + op->size);
+			if (ro && !ht_up_update (anal->refline_ops, addr, ro)) {
+				R_FREE (ro);
+			}
+			if (ro) {
+				memcpy (ro->bytes, buf, op->size);
+				ro->nbytes = op->size;
+				ro->bits = anal->bits;
+				ro->big_endian = anal->big_endian;
+				ro->cpu = cpu;
+				ro->cur = anal->cur;
+				ro->ret = ret;
+				ro->size = op->size;
+				ro->type = op->type;
+				ro->jump = op->jump;
+			}
+		}
+	}
+	RAnalHint *hint = r_anal_hint_get (anal, addr);
+	if (hint) {
+		r_anal_op_hint (op, hint);
+		r_anal_hint_free (hint);
+	}
+	return ret;
+}
+
 static bool add_refline(RList *list, RList *sten, ut64 addr, ut64 to, int *idx) {
 	ReflineEnd *re1, *re2;
 	RAnalRefline *item = R_NEW0 (RAnalRefline);
@@ -53,7 +144,8 @@ static bool add_refline(RList *list, RList *sten, ut64 addr, ut64 to, int *idx)
 		free (item);
 		return false;
 	}
-	r_list_add_sorted (sten, re1, (RListComparator)cmp_asc);
+	re1->seq = r_list_length (sten);
+	r_list_append (sten, re1);
 
 	re2 = refline_end_new (item->to, false, item);
 	if (!re2) {
@@ -61,7 +153,8 @@ static bool add_refline(RList *list, RList *sten, ut64 addr, ut64 to, int *idx)
 		free (item);
 		return false;
 	}
-	r_list_add_sorted (sten, re2, (RListComparator)cmp_asc);
+	re2->seq = r_list_length (sten);
+	r_list_append (sten, re2);
 	return true;
 }
 
@@ -87,6 +180,7 @@ R_API RList *r_anal_reflines_get(RAnal *anal, ut64 addr, const ut8 *buf, ut64 le
 	ut8 *free_levels;
 	int res, sz = 0, count = 0;
 	ut64 opc = addr;
+	const ut32 cpu = r_str_hash (r_str_get (anal->cpu));
 
 	memset (&op, 0, sizeof (op));
 	/*
@@ -122,7 +216,6 @@ R_API RList *r_anal_reflines_get(RAnal *anal, ut64 addr, const ut8 *buf, ut64 le
 			if (mi) {
 				ptr += mi->size;
 				addr += mi->size;
-				free (mi->str);
 				continue;
 			}
 		}
@@ -133,7 +226,7 @@ R_API RList *r_anal_reflines_get(RAnal *anal, ut64 addr, const ut8 *buf, ut64 le
 		addr += sz;
 		// This can segfault if opcode length and buffer check fails
 		r_anal_op_fini (&op);
-		sz = r_anal_op (anal, &op, addr, ptr, (int)(end - ptr), R_ANAL_OP_MASK_BASIC | R_ANAL_OP_MASK_HINT);
+		sz = refline_op (anal, &op, addr, ptr, (int)(end - ptr), cpu);
 		if (sz <= 0) {
 			sz = 1;
 			goto __next;
@@ -181,6 +274,7 @@ R_API RList *r_anal_reflines_get(RAnal *anal, ut64 addr, const ut8 *buf, ut64 le
 	}
 	r_anal_op_fini (&op);
 	r_cons_break_pop ();
+	r_list_sort (sten, (RListComparator)cmp_asc);
 
 	free_levels = R_NEWS0 (ut8, r_list_length (list) + 1);
 	if (!free_levels) {
@@ -218,6 +312,8 @@ R_API RList *r_anal_reflines_get(RAnal *anal, ut64 addr, const ut8 *buf, ut64 le
 	 * increasing. */
 	free (free_levels);
 	r_list_free (sten);
+	// r_anal_reflines_str() draws them in this order
+	r_list_sort (list, cmp_by_ref_lvl);
 	return list;
 
 sten_err:
@@ -352,7 +448,21 @@ static const char* get_corner_char(RAnalRefline *ref, ut64 addr, bool is_middle_
 	return "";
 }
 
-static void add_spaces(RBuffer *b, int level, int pos, bool wide) {
+// like r_buf_write_at(), strings written past the end are appended
+static void write_at(RStrBuf *b, int pos, const char *s, int len) {
+	int blen = r_strbuf_length (b);
+	if (pos < blen) {
+		int n = R_MIN (len, blen - pos);
+		memcpy (r_strbuf_get (b) + pos, s, n);
+		s += n;
+		len -= n;
+	} else if (pos > blen) {
+		r_strbuf_append (b, r_str_pad (' ', pos - blen));
+	}
+	r_strbuf_append_n (b, s, len);
+}
+
+static void add_spaces(RStrBuf *b, int level, int pos, bool wide) {
 	if (pos != -1) {
 		if (wide) {
 			pos *= 2;
@@ -360,23 +470,23 @@ static void add_spaces(RBuffer *b, int level, int pos, bool wide) {
 		}
 		if (pos > level + 1) {
 			const char *pd = r_str_pad (' ', pos - level - 1);
-			r_buf_append_string (b, pd);
+			r_strbuf_append (b, pd);
 		}
 	}
 }
 
-static void fill_level(RBuffer *b, int pos, char ch, RAnalRefline *r, bool wide) {
+static void fill_level(RStrBuf *b, int pos, char ch, RAnalRefline *r, bool wide) {
 	int sz = r->level;
 	if (wide) {
 		sz *= 2;
 	}
 	const char *pd = r_str_pad (ch, sz - 1);
 	if (pos == -1) {
-		r_buf_append_string (b, pd);
+		r_strbuf_append (b, pd);
 	} else {
 		int pdlen = strlen (pd);
 		if (pdlen > 0) {
-			r_buf_write_at (b, pos, (const ut8 *)pd, pdlen);
+			write_at (b, pos, pd, pdlen);
 		}
 	}
 }
@@ -402,8 +512,7 @@ R_API RAnalRefStr *r_anal_reflines_str(void *_core, ut64 addr, int opts) {
 	RCore *core = _core;
 	RCons *cons = core->cons;
 	RAnal *anal = core->anal;
-	RBuffer *b;
-	RBuffer *c;
+	RStrBuf b, c;
 	RListIter *iter;
 	RAnalRefline *ref;
 	int l;
@@ -416,28 +525,39 @@ R_API RAnalRefStr *r_anal_reflines_str(void *_core, ut64 addr, int opts) {
 
 	r_return_val_if_fail (cons && anal && anal->reflines, NULL);
 
-	RList *lvls = r_list_new ();
+	RPVector *lvls = r_pvector_new (NULL);
 	if (!lvls) {
 		return NULL;
 	}
+	if (core->cons && core->cons->context->breaked) {
+		r_pvector_free (lvls);
+		return NULL;
+	}
+	bool sorted = true;
+	RAnalRefline *prev = NULL;
 	r_list_foreach (anal->reflines, iter, ref) {
-		if (core->cons && core->cons->context->breaked) {
-			r_list_free (lvls);
-			return NULL;
-		}
 		if (in_refline (addr, ref) && refline_kept (ref, middle_after, addr)) {
-			r_list_add_sorted (lvls, (void *)ref, (RListComparator)cmp_by_ref_lvl);
+			if (prev && cmp_by_ref_lvl (prev, ref) > 0) {
+				sorted = false;
+			}
+			r_pvector_push (lvls, ref);
+			prev = ref;
 		}
 	}
-	b = r_buf_new ();
-	c = r_buf_new ();
-	r_buf_append_string (c, " ");
-	r_buf_append_string (b, " ");
-	r_list_foreach (lvls, iter, ref) {
+	if (!sorted) {
+		r_pvector_sort (lvls, cmp_by_ref_lvl);
+	}
+	r_strbuf_init (&b);
+	r_strbuf_init (&c);
+	r_strbuf_append (&c, " ");
+	r_strbuf_append (&b, " ");
+	void **it;
+	r_pvector_foreach (lvls, it) {
+		ref = *it;
 		if (core->cons && core->cons->context->breaked) {
-			r_list_free (lvls);
-			r_buf_free (b);
-			r_buf_free (c);
+			r_pvector_free (lvls);
+			r_strbuf_fini (&b);
+			r_strbuf_fini (&c);
 			return NULL;
 		}
 		if ((ref->from == addr || ref->to == addr) && !middle_after) {
@@ -450,18 +570,18 @@ R_API RAnalRefStr *r_anal_reflines_str(void *_core, ut64 addr, int opts) {
 				if (wide) {
 					ch_pos = ch_pos * 2 - 1;
 				}
-				r_buf_write_at (b, ch_pos, (ut8 *)corner, 1);
-				r_buf_write_at (c, ch_pos, (ut8 *)col, 1);
-				fill_level (b, ch_pos + 1, ch, ref, wide);
-				fill_level (c, ch_pos + 1, ch_col, ref, wide);
+				write_at (&b, ch_pos, corner, 1);
+				write_at (&c, ch_pos, col, 1);
+				fill_level (&b, ch_pos + 1, ch, ref, wide);
+				fill_level (&c, ch_pos + 1, ch_col, ref, wide);
 			} else {
-				add_spaces (b, ref->level, pos, wide);
-				add_spaces (c, ref->level, pos, wide);
-				r_buf_append_string (b, corner);
-				r_buf_append_string (c, col);
+				add_spaces (&b, ref->level, pos, wide);
+				add_spaces (&c, ref->level, pos, wide);
+				r_strbuf_append (&b, corner);
+				r_strbuf_append (&c, col);
 				if (!middle_before) {
-					fill_level (b, -1, ch, ref, wide);
-					fill_level (c, -1, ch_col, ref, wide);
+					fill_level (&b, -1, ch, ref, wide);
+					fill_level (&c, -1, ch_col, ref, wide);
 				}
 			}
 			if (!middle_before) {
@@ -472,14 +592,14 @@ R_API RAnalRefStr *r_anal_reflines_str(void *_core, ut64 addr, int opts) {
 			if (!pos) {
 				continue;
 			}
-			add_spaces (b, ref->level, pos, wide);
-			add_spaces (c, ref->level, pos, wide);
+			add_spaces (&b, ref->level, pos, wide);
+			add_spaces (&c, ref->level, pos, wide);
 			if (ref->from >= ref->to) {
-				r_buf_append_string (b, ":");
-				r_buf_append_string (c, "t");
+				r_strbuf_append (&b, ":");
+				r_strbuf_append (&c, "t");
 			} else {
-				r_buf_append_string (b, "|");
-				r_buf_append_string (c, "d");
+				r_strbuf_append (&b, "|");
+				r_strbuf_append (&c, "d");
 			}
 			pos = ref->level;
 		}
@@ -487,21 +607,16 @@ R_API RAnalRefStr *r_anal_reflines_str(void *_core, ut64 addr, int opts) {
 			max_level = ref->level;
 		}
 	}
-	add_spaces (c, 0, pos, wide);
-	add_spaces (b, 0, pos, wide);
-	str = r_buf_to_string (b);
-	col_str = r_buf_to_string (c);
-	r_buf_free (b);
-	r_buf_free (c);
-	b = NULL;
-	c = NULL;
+	add_spaces (&c, 0, pos, wide);
+	add_spaces (&b, 0, pos, wide);
+	str = strdup (r_strbuf_get (&b));
+	col_str = strdup (r_strbuf_get (&c));
+	r_strbuf_fini (&b);
+	r_strbuf_fini (&c);
 	if (!str || !col_str) {
-		r_list_free (lvls);
-		//r_buf_free_to_string already free b and if that is the case
-		//b will be NULL and r_buf_free will return but if there was
-		//an error we free b here so in other words is safe
-		r_buf_free (b);
-		r_buf_free (c);
+		r_pvector_free (lvls);
+		free (str);
+		free (col_str);
 		return NULL;
 	}
 	if (core->anal->lineswidth > 0) {
@@ -530,7 +645,7 @@ R_API RAnalRefStr *r_anal_reflines_str(void *_core, ut64 addr, int opts) {
 		: (dir == 2) ? "=< " : "   ");
 	col_str = r_str_append (col_str, arr_col);
 
-	r_list_free (lvls);
+	r_pvector_free (lvls);
 	RAnalRefStr *out = R_NEW0 (RAnalRefStr);
 	out->cols = col_str;
 	out->str = str;
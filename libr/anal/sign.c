@@ -1677,6 +1677,600 @@ R_API bool r_sign_foreach(RAnal *a, RSignForeachCallback cb, void *user) {
 	return sdb_foreach (a->sdb_zigns, foreachCB, &ctx);
 }
 
+/* Compiled byte zignatures
+ *
+ * The byte patterns are merged in a trie over their first SIGN_TRIE_DEPTH
+ * bytes. Every edge holds a (mask, value) pair, so the masked bytes become
+ * wildcard edges and the fixed ones are looked up by value. Each offset of
+ * the scanned buffer walks the trie once for the whole set, the signatures
+ * reached are checked against the rest of their pattern. The compiled trie
+ * can be cached next to the loaded zignatures file (see zign.cache).
+ */
+
+#define SIGN_TRIE_DEPTH 32
+#define SIGN_TRIE_MAGIC 0x435a3252 // R2ZC
+#define SIGN_TRIE_VERSION 2
+
+typedef struct {
+	ut8 mask;
+	ut8 val;
+	int child;
+} SignTrieEdge;
+
+typedef struct {
+	int edge; // first edge, the masked ones come before the exact ones
+	int nmasked;
+	int nexact;
+	int item; // first item ending here, in the order array
+	int nitems;
+	int depth;
+} SignTrieNode;
+
+typedef struct {
+	int kw; // index in the keyword list
+	ut64 addr;
+} SignTrieHit;
+
+struct r_sign_trie_t {
+	int count;
+	RSignItem **items;
+	RSearchKeyword **kws;
+	int *order; // items sorted by pattern
+	SignTrieNode *nodes;
+	int nnodes;
+	SignTrieEdge *edges;
+	int nedges;
+	int root[256]; // exact children of the root or -1
+	int longest;
+	// tail of the previous block, for the patterns crossing blocks
+	ut8 *left;
+	int left_len;
+	ut64 left_end;
+	ut8 *win;
+	int win_size;
+	int *stack;
+	int stack_size;
+	RVector hits;
+};
+
+typedef struct {
+	int idx;
+	const RSignBytes *b;
+} SignTrieKey;
+
+static inline ut8 trieMask(const RSignBytes *b, int i) {
+	return b->mask? b->mask[i]: 0xff;
+}
+
+static inline int trieSym(const RSignBytes *b, int i) {
+	ut8 m = trieMask (b, i);
+	return (m << 8) | (b->bytes[i] & m);
+}
+
+static int trieKeyCmp(const void *_a, const void *_b) {
+	const SignTrieKey *a = _a, *b = _b;
+	int la = R_MIN (a->b->size, SIGN_TRIE_DEPTH);
+	int lb = R_MIN (b->b->size, SIGN_TRIE_DEPTH);
+	int i;
+	for (i = 0; i < la && i < lb; i++) {
+		int d = trieSym (a->b, i) - trieSym (b->b, i);
+		if (d) {
+			return d;
+		}
+	}
+	if (la != lb) {
+		return la - lb;
+	}
+	return a->idx - b->idx;
+}
+
+static int trieBuild(RSignTrie *t, SignTrieKey *keys, int lo, int hi, int d) {
+	int n = t->nnodes++;
+	int i = lo, j, e;
+	while (i < hi && R_MIN (keys[i].b->size, SIGN_TRIE_DEPTH) == d) {
+		i++;
+	}
+	t->nodes[n].item = lo;
+	t->nodes[n].nitems = i - lo;
+	t->nodes[n].depth = d;
+	// the edges of a node are contiguous, reserve them before the children
+	int ngroups = 0;
+	for (j = i; j < hi; j++) {
+		if (j == i || trieSym (keys[j].b, d) != trieSym (keys[j - 1].b, d)) {
+			ngroups++;
+		}
+	}
+	e = t->nedges;
+	t->nedges += ngroups;
+	t->nodes[n].edge = e;
+	t->nodes[n].nmasked = 0;
+	t->nodes[n].nexact = 0;
+	for (j = i; j < hi; e++) {
+		int sym = trieSym (keys[j].b, d);
+		int k = j + 1;
+		while (k < hi && trieSym (keys[k].b, d) == sym) {
+			k++;
+		}
+		t->edges[e].mask = sym >> 8;
+		t->edges[e].val = sym & 0xff;
+		if (t->edges[e].mask == 0xff) {
+			t->nodes[n].nexact++;
+		} else {
+			t->nodes[n].nmasked++;
+		}
+		int child = trieBuild (t, keys, j, k, d + 1);
+		t->edges[e].child = child;
+		j = k;
+	}
+	return n;
+}
+
+static void trieRoot(RSignTrie *t) {
+	const SignTrieNode *root = &t->nodes[0];
+	int i;
+	for (i = 0; i < 256; i++) {
+		t->root[i] = -1;
+	}
+	for (i = 0; i < root->nexact; i++) {
+		const SignTrieEdge *e = &t->edges[root->edge + root->nmasked + i];
+		t->root[e->val] = e->child;
+	}
+}
+
+static void trieFree(RSignTrie *t) {
+	if (t) {
+		free (t->items);
+		free (t->kws);
+		free (t->order);
+		free (t->nodes);
+		free (t->edges);
+		free (t->left);
+		free (t->win);
+		free (t->stack);
+		r_vector_clear (&t->hits);
+		free (t);
+	}
+}
+
+static RSignTrie *trieNew(RSignSearch *ss) {
+	RSignTrie *t = R_NEW0 (RSignTrie);
+	RSearchKeyword *kw;
+	RListIter *iter;
+	int i = 0, total = 1;
+	if (!t) {
+		return NULL;
+	}
+	r_vector_init (&t->hits, sizeof (SignTrieHit), NULL, NULL);
+	t->count = r_list_length (ss->search->kws);
+	t->items = calloc (R_MAX (t->count, 1), sizeof (RSignItem *));
+	t->kws = calloc (R_MAX (t->count, 1), sizeof (RSearchKeyword *));
+	t->order = calloc (R_MAX (t->count, 1), sizeof (int));
+	SignTrieKey *keys = calloc (R_MAX (t->count, 1), sizeof (SignTrieKey));
+	if (!t->count || !t->items || !t->kws || !t->order || !keys) {
+		free (keys);
+		trieFree (t);
+		return NULL;
+	}
+	r_list_foreach (ss->search->kws, iter, kw) {
+		t->kws[i] = kw;
+		t->items[i] = kw->data;
+		keys[i].idx = i;
+		keys[i].b = t->items[i]->bytes;
+		total += R_MIN (keys[i].b->size, SIGN_TRIE_DEPTH);
+		t->longest = R_MAX (t->longest, keys[i].b->size);
+		i++;
+	}
+	qsort (keys, t->count, sizeof (SignTrieKey), trieKeyCmp);
+	t->nodes = calloc (total, sizeof (SignTrieNode));
+	t->edges = calloc (total, sizeof (SignTrieEdge));
+	if (!t->nodes || !t->edges) {
+		free (keys);
+		trieFree (t);
+		return NULL;
+	}
+	trieBuild (t, keys, 0, t->count, 0);
+	for (i = 0; i < t->count; i++) {
+		t->order[i] = keys[i].idx;
+	}
+	free (keys);
+	trieRoot (t);
+	return t;
+}
+
+static bool trieGrow(void **p, int *size, int need, int elem) {
+	if (need <= *size) {
+		return true;
+	}
+	int n = R_MAX (need, *size * 2);
+	void *q = realloc (*p, (size_t)n * elem);
+	if (!q) {
+		return false;
+	}
+	*p = q;
+	*size = n;
+	return true;
+}
+
+static inline bool trieTailMatch(const RSignBytes *b, const ut8 *buf, int from) {
+	int j;
+	for (j = from; j < b->size; j++) {
+		ut8 m = trieMask (b, j);
+		if ((buf[j] & m) != (b->bytes[j] & m)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// walks the trie from every offset of buf, offsets below skip only report
+// the patterns reaching past it
+static bool trieScan(RSignTrie *t, const ut8 *buf, int len, int skip, ut64 addr, int align) {
+	const bool root_masked = t->nodes[0].nmasked > 0;
+	int i, k, sp;
+	for (i = 0; i < len; i++) {
+		if (align && (addr + i) % align) {
+			continue;
+		}
+		sp = 0;
+		if (root_masked) {
+			t->stack[sp++] = 0;
+		} else if (t->root[buf[i]] >= 0) {
+			t->stack[sp++] = t->root[buf[i]];
+		} else {
+			continue;
+		}
+		while (sp > 0) {
+			const SignTrieNode *n = &t->nodes[t->stack[--sp]];
+			const int d = n->depth;
+			for (k = 0; k < n->nitems; k++) {
+				int idx = t->order[n->item + k];
+				const RSignBytes *b = t->items[idx]->bytes;
+				if (i + b->size > len || i + b->size <= skip || !trieTailMatch (b, buf + i, d)) {
+					continue;
+				}
+				SignTrieHit hit = { idx, addr + i };
+				if (!r_vector_push (&t->hits, &hit)) {
+					return false;
+				}
+			}
+			if (d >= SIGN_TRIE_DEPTH || i + d >= len) {
+				continue;
+			}
+			if (!trieGrow ((void **)&t->stack, &t->stack_size, sp + n->nmasked + 1, sizeof (int))) {
+				return false;
+			}
+			const SignTrieEdge *e = &t->edges[n->edge];
+			const ut8 c = buf[i + d];
+			for (k = 0; k < n->nmasked; k++) {
+				if ((c & e[k].mask) == e[k].val) {
+					t->stack[sp++] = e[k].child;
+				}
+			}
+			int lo = n->nmasked, hi = n->nmasked + n->nexact;
+			while (lo < hi) {
+				int mid = lo + (hi - lo) / 2;
+				if (e[mid].val < c) {
+					lo = mid + 1;
+				} else {
+					hi = mid;
+				}
+			}
+			if (lo < n->nmasked + n->nexact && e[lo].val == c) {
+				t->stack[sp++] = e[lo].child;
+			}
+		}
+	}
+	return true;
+}
+
+static int trieHitCmp(const void *_a, const void *_b) {
+	const SignTrieHit *a = _a, *b = _b;
+	if (a->kw != b->kw) {
+		return a->kw - b->kw;
+	}
+	return a->addr < b->addr? -1: a->addr > b->addr;
+}
+
+static bool trieReady(RSignTrie *t) {
+	int keep = R_MAX (t->longest - 1, 1);
+	t->left = malloc (keep);
+	return t->left && trieGrow ((void **)&t->stack, &t->stack_size, 64, sizeof (int));
+}
+
+static int trieUpdate(RSignSearch *ss, ut64 at, const ut8 *buf, int len) {
+	RSignTrie *t = ss->trie;
+	RSearch *s = ss->search;
+	const ut64 old_nhits = s->nhits;
+	if (t->left_end != at) {
+		t->left_len = 0;
+	}
+	int total = t->left_len + len;
+	if (!trieGrow ((void **)&t->win, &t->win_size, total, 1)) {
+		return -1;
+	}
+	memcpy (t->win, t->left, t->left_len);
+	memcpy (t->win + t->left_len, buf, len);
+	t->hits.len = 0;
+	if (!trieScan (t, t->win, total, t->left_len, at - t->left_len, s->align)) {
+		return -1;
+	}
+	int keep = R_MIN (total, t->longest - 1);
+	memcpy (t->left, t->win + total - keep, keep);
+	t->left_len = keep;
+	t->left_end = at + len;
+	// reported in the order of the keyword search, by keyword and address
+	qsort (t->hits.a, t->hits.len, sizeof (SignTrieHit), trieHitCmp);
+	SignTrieHit *hit;
+	r_vector_foreach (&t->hits, hit) {
+		RSearchKeyword *kw = t->kws[hit->kw];
+		if (!s->overlap && kw->count && hit->addr < kw->last) {
+			continue;
+		}
+		int r = r_search_hit_new (s, kw, hit->addr);
+		if (!r) {
+			return -1;
+		}
+		if (r > 1) {
+			break;
+		}
+	}
+	return s->nhits - old_nhits;
+}
+
+/* The cache holds the items and the trie, it is used when the checksum of
+ * the zignatures database, the current space and minsz did not change */
+
+static ut64 checksumStr(ut64 h, const char *s) {
+	// fnv1a, including the nul so "ab"+"c" and "a"+"bc" differ
+	do {
+		h = (h ^ (ut8)*s) * 0x100000001b3ULL;
+	} while (*s++);
+	return h;
+}
+
+static int checksumCB(void *user, const char *k, const char *v) {
+	ut64 *sum = (ut64 *)user;
+	// each key is hashed with its value, and the pairs are added
+	// because sdb_foreach does not keep the insertion order
+	ut64 h = checksumStr (checksumStr (0xcbf29ce484222325ULL, k), v);
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	*sum += h;
+	return 1;
+}
+
+static ut64 trieChecksum(RAnal *a, int minsz) {
+	const RSpace *cur = r_spaces_current (&a->zign_spaces);
+	ut64 sum = SIGN_TRIE_VERSION + (ut64)minsz * 0x9e3779b97f4a7c15ULL;
+	sdb_foreach (a->sdb_zigns, checksumCB, &sum);
+	return sum ^ r_str_hash64 (cur? cur->name: "*");
+}
+
+static void bufAppendInt(RBuffer *b, ut64 v, int size) {
+	ut8 tmp[8];
+	r_write_ble (tmp, v, false, size * 8);
+	r_buf_append_bytes (b, tmp, size);
+}
+
+static void bufAppendStr(RBuffer *b, const char *s) {
+	int len = s? strlen (s): 0;
+	bufAppendInt (b, len, 4);
+	r_buf_append_bytes (b, (const ut8 *)(s? s: ""), len);
+}
+
+static bool trieSave(RSignTrie *t, const char *file, ut64 sum) {
+	RBuffer *b = r_buf_new ();
+	ut64 size;
+	int i;
+	if (!b) {
+		return false;
+	}
+	bufAppendInt (b, SIGN_TRIE_MAGIC, 4);
+	bufAppendInt (b, SIGN_TRIE_VERSION, 4);
+	bufAppendInt (b, sum, 8);
+	bufAppendInt (b, t->count, 4);
+	bufAppendInt (b, t->nnodes, 4);
+	bufAppendInt (b, t->nedges, 4);
+	for (i = 0; i < t->count; i++) {
+		const RSignItem *it = t->items[i];
+		bufAppendStr (b, it->name);
+		bufAppendStr (b, it->realname);
+		bufAppendInt (b, it->bytes->size, 4);
+		r_buf_append_bytes (b, it->bytes->bytes, it->bytes->size);
+		bufAppendInt (b, it->bytes->mask? 1: 0, 1);
+		if (it->bytes->mask) {
+			r_buf_append_bytes (b, it->bytes->mask, it->bytes->size);
+		}
+		bufAppendInt (b, t->order[i], 4);
+	}
+	for (i = 0; i < t->nnodes; i++) {
+		const SignTrieNode *n = &t->nodes[i];
+		bufAppendInt (b, n->edge, 4);
+		bufAppendInt (b, n->nmasked, 4);
+		bufAppendInt (b, n->nexact, 4);
+		bufAppendInt (b, n->item, 4);
+		bufAppendInt (b, n->nitems, 4);
+		bufAppendInt (b, n->depth, 4);
+	}
+	for (i = 0; i < t->nedges; i++) {
+		bufAppendInt (b, t->edges[i].mask, 1);
+		bufAppendInt (b, t->edges[i].val, 1);
+		bufAppendInt (b, t->edges[i].child, 4);
+	}
+	const ut8 *data = r_buf_data (b, &size);
+	bool ret = size < ST32_MAX && r_file_dump (file, data, (int)size, false);
+	r_buf_free (b);
+	return ret;
+}
+
+typedef struct {
+	const ut8 *p;
+	const ut8 *end;
+	bool ok;
+} SignTrieReader;
+
+static ut64 readInt(SignTrieReader *r, int size) {
+	if (!r->ok || r->end - r->p < size) {
+		r->ok = false;
+		return 0;
+	}
+	ut64 v = r_read_ble (r->p, false, size * 8);
+	r->p += size;
+	return v;
+}
+
+static const ut8 *readBytes(SignTrieReader *r, ut64 len) {
+	if (!r->ok || r->end - r->p < len) {
+		r->ok = false;
+		return NULL;
+	}
+	const ut8 *p = r->p;
+	r->p += len;
+	return p;
+}
+
+static char *readStr(SignTrieReader *r, bool empty_null) {
+	ut64 len = readInt (r, 4);
+	const ut8 *s = readBytes (r, len);
+	if (!s || (!len && empty_null)) {
+		return NULL;
+	}
+	return r_str_ndup ((const char *)s, len);
+}
+
+static bool trieLoadItems(RAnal *a, RSignSearch *ss, SignTrieReader *r, int count, int *order) {
+	const RSpace *cur = r_spaces_current (&a->zign_spaces);
+	int i;
+	for (i = 0; i < count && r->ok; i++) {
+		RSignItem *it = r_sign_item_new ();
+		if (!it || !(it->bytes = R_NEW0 (RSignBytes))) {
+			r_sign_item_free (it);
+			return false;
+		}
+		r_list_append (ss->items, it);
+		it->space = cur;
+		it->name = readStr (r, false);
+		it->realname = readStr (r, true);
+		int size = readInt (r, 4);
+		const ut8 *bytes = readBytes (r, size);
+		const ut8 *mask = readInt (r, 1)? readBytes (r, size): NULL;
+		if (!r->ok || !it->name || size < 1) {
+			return false;
+		}
+		it->bytes->size = size;
+		it->bytes->bytes = r_mem_dup (bytes, size);
+		it->bytes->mask = mask? r_mem_dup (mask, size): NULL;
+		order[i] = readInt (r, 4);
+		if (order[i] < 0 || order[i] >= count) {
+			return false;
+		}
+		RSearchKeyword *kw = r_search_keyword_new (bytes, size, mask, mask? size: 0, (const char *)it);
+		if (!kw) {
+			return false;
+		}
+		r_search_kw_add (ss->search, kw);
+	}
+	return r->ok;
+}
+
+static RSignTrie *trieLoad(RAnal *a, RSignSearch *ss, const char *file, ut64 sum) {
+	int size = 0, i;
+	ut8 *data = (ut8 *)r_file_slurp (file, &size);
+	if (!data) {
+		return NULL;
+	}
+	SignTrieReader r = { data, data + size, true };
+	RSignTrie *t = NULL;
+	if (readInt (&r, 4) != SIGN_TRIE_MAGIC || readInt (&r, 4) != SIGN_TRIE_VERSION || readInt (&r, 8) != sum) {
+		goto fail;
+	}
+	int count = readInt (&r, 4);
+	int nnodes = readInt (&r, 4);
+	int nedges = readInt (&r, 4);
+	if (!r.ok || count < 1 || nnodes < 1 || nedges < 0 || count > size || nnodes > size || nedges > size) {
+		goto fail;
+	}
+	if (!(t = R_NEW0 (RSignTrie))) {
+		goto fail;
+	}
+	r_vector_init (&t->hits, sizeof (SignTrieHit), NULL, NULL);
+	t->count = count;
+	t->items = calloc (count, sizeof (RSignItem *));
+	t->kws = calloc (count, sizeof (RSearchKeyword *));
+	t->order = calloc (count, sizeof (int));
+	t->nodes = calloc (nnodes, sizeof (SignTrieNode));
+	t->edges = calloc (R_MAX (nedges, 1), sizeof (SignTrieEdge));
+	if (!t->items || !t->kws || !t->order || !t->nodes || !t->edges
+			|| !trieLoadItems (a, ss, &r, count, t->order)) {
+		goto fail;
+	}
+	RSearchKeyword *kw;
+	RListIter *iter;
+	i = 0;
+	r_list_foreach (ss->search->kws, iter, kw) {
+		t->kws[i] = kw;
+		t->items[i] = kw->data;
+		t->longest = R_MAX (t->longest, t->items[i]->bytes->size);
+		i++;
+	}
+	for (i = 0; i < nnodes; i++) {
+		SignTrieNode *n = &t->nodes[i];
+		n->edge = readInt (&r, 4);
+		n->nmasked = readInt (&r, 4);
+		n->nexact = readInt (&r, 4);
+		n->item = readInt (&r, 4);
+		n->nitems = readInt (&r, 4);
+		n->depth = readInt (&r, 4);
+		if (n->edge < 0 || n->nmasked < 0 || n->nexact < 0 || n->edge + n->nmasked + n->nexact > nedges
+				|| n->item < 0 || n->nitems < 0 || n->item + n->nitems > count
+				|| n->depth < 0 || n->depth > SIGN_TRIE_DEPTH) {
+			r.ok = false;
+			break;
+		}
+	}
+	for (i = 0; i < nedges && r.ok; i++) {
+		t->edges[i].mask = readInt (&r, 1);
+		t->edges[i].val = readInt (&r, 1);
+		t->edges[i].child = readInt (&r, 4);
+		if (t->edges[i].child <= 0 || t->edges[i].child >= nnodes) {
+			r.ok = false;
+		}
+	}
+	// children are one level deeper and the items ending in a node long
+	// enough for it, so a broken cache cannot loop or read out of bounds
+	for (i = 0; i < nnodes && r.ok; i++) {
+		const SignTrieNode *n = &t->nodes[i];
+		int k;
+		for (k = 0; k < n->nmasked + n->nexact; k++) {
+			if (t->nodes[t->edges[n->edge + k].child].depth != n->depth + 1) {
+				r.ok = false;
+				break;
+			}
+		}
+		for (k = 0; k < n->nitems && r.ok; k++) {
+			if (t->items[t->order[n->item + k]]->bytes->size < n->depth) {
+				r.ok = false;
+				break;
+			}
+		}
+	}
+	if (!r.ok) {
+		goto fail;
+	}
+	t->nnodes = nnodes;
+	t->nedges = nedges;
+	trieRoot (t);
+	free (data);
+	return t;
+fail:
+	free (data);
+	trieFree (t);
+	r_list_purge (ss->items);
+	r_search_kw_reset (ss->search);
+	return NULL;
+}
+
 R_API RSignSearch *r_sign_search_new() {
 	RSignSearch *ret = R_NEW0 (RSignSearch);
 	if (ret) {
@@ -1690,6 +2284,7 @@ R_API void r_sign_search_free(RSignSearch *ss) {
 	if (!ss) {
 		return;
 	}
+	trieFree (ss->trie);
 	r_search_free (ss->search);
 	r_list_free (ss->items);
 	free (ss);
@@ -1715,6 +2310,9 @@ static int addSearchKwCB(RSignItem *it, void *user) {
 		eprintf ("Cannot find bytes for this signature: %s\n", it->name);
 		return 1;
 	}
+	if (!bytes->bytes) {
+		return 1;
+	}
 
 	if (ctx->minsz && bytes->size < ctx->minsz) {
 		return 1;
@@ -1734,15 +2332,38 @@ R_API void r_sign_search_init(RAnal *a, RSignSearch *ss, int minsz, RSignSearchC
 	r_return_if_fail (a && ss && cb);
 	ss->cb = cb;
 	ss->user = user;
+	trieFree (ss->trie);
+	ss->trie = NULL;
 	r_list_purge (ss->items);
+	r_search_kw_reset (ss->search);
 	r_search_reset (ss->search, R_SEARCH_KEYWORD);
-	r_sign_foreach (a, addSearchKwCB, &ctx);
+	char *cache = a->zign_cache && a->zign_file? r_str_newf ("%s.zc", a->zign_file): NULL;
+	ut64 sum = cache? trieChecksum (a, minsz): 0;
+	if (cache) {
+		ss->trie = trieLoad (a, ss, cache, sum);
+	}
+	if (!ss->trie) {
+		r_sign_foreach (a, addSearchKwCB, &ctx);
+		ss->trie = trieNew (ss);
+		if (ss->trie && cache && !trieSave (ss->trie, cache, sum)) {
+			eprintf ("Cannot write the zignatures cache %s\n", cache);
+		}
+	}
+	// without the trie the keywords go through r_search
+	if (ss->trie && !trieReady (ss->trie)) {
+		trieFree (ss->trie);
+		ss->trie = NULL;
+	}
+	free (cache);
 	r_search_begin (ss->search);
 	r_search_set_callback (ss->search, searchHitCB, ss);
 }
 
 R_API int r_sign_search_update(RAnal *a, RSignSearch *ss, ut64 *at, const ut8 *buf, int len) {
 	r_return_val_if_fail (a && ss && buf && len > 0, 0);
+	if (ss->trie) {
+		return trieUpdate (ss, *at, buf, len);
+	}
 	return r_search_update (ss->search, *at, buf, len);
 }
 
@@ -1753,36 +2374,70 @@ static int matchCount(int a, int b) {
 	return R_ABS (c) < m;
 }
 
-static bool fcnMetricsCmp(RSignItem *it, RAnalFunction *fcn) {
-	RSignGraph *graph = it->graph;
-	int ebbs = -1;
+typedef struct {
+	int cc;
+	int nbbs;
+	int edges;
+	int ebbs;
+	int size;
+} SignFcnMetrics;
 
-	if (graph->cc != -1 && graph->cc != r_anal_fcn_cc (NULL, fcn)) {
+static void fcnMetrics(RAnalFunction *fcn, SignFcnMetrics *m) {
+	m->cc = r_anal_fcn_cc (NULL, fcn);
+	m->nbbs = r_list_length (fcn->bbs);
+	m->edges = r_anal_fcn_count_edges (fcn, &m->ebbs);
+	m->size = r_anal_fcn_size (fcn);
+}
+
+static bool fcnMetricsCmp(RSignGraph *graph, const SignFcnMetrics *m) {
+	if (graph->cc != -1 && graph->cc != m->cc) {
 		return false;
 	}
-	if (graph->nbbs != -1 && graph->nbbs != r_list_length (fcn->bbs)) {
+	if (graph->nbbs != -1 && graph->nbbs != m->nbbs) {
 		return false;
 	}
-	if (graph->edges != -1 && graph->edges != r_anal_fcn_count_edges (fcn, &ebbs)) {
+	if (graph->edges != -1 && graph->edges != m->edges) {
 		return false;
 	}
-	if (graph->ebbs != -1 && graph->ebbs != ebbs) {
+	if (graph->ebbs != -1 && graph->ebbs != m->ebbs) {
 		return false;
 	}
-	if (graph->bbsum > 0 && matchCount (graph->bbsum, r_anal_fcn_size (fcn))) {
+	if (graph->bbsum > 0 && matchCount (graph->bbsum, m->size)) {
 		return false;
 	}
 	return true;
 }
 
+static bool strListEq(RList *a, RList *b) {
+	RListIter *ia = a? a->head: NULL;
+	RListIter *ib = b? b->head: NULL;
+	for (; ia && ib; ia = ia->n, ib = ib->n) {
+		if (strcmp (ia->data, ib->data)) {
+			return false;
+		}
+	}
+	return !ia && !ib;
+}
+
+// the function features are computed once, on the first signature that needs them
 struct ctxFcnMatchCB {
 	RAnal *anal;
 	RAnalFunction *fcn;
 	RSignGraphMatchCallback cb;
 	void *user;
 	int mincc;
+	bool has_metrics;
+	SignFcnMetrics metrics;
+	bool has_feature;
+	char *bbhash;
+	RList *list;
 };
 
+static void fcnMatchFini(struct ctxFcnMatchCB *ctx) {
+	free (ctx->bbhash);
+	r_list_free (ctx->list);
+}
+
 static int graphMatchCB(RSignItem *it, void *user) {
 	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
 	RSignGraph *graph = it->graph;
@@ -1795,7 +2450,11 @@ static int graphMatchCB(RSignItem *it, void *user) {
 		return 1;
 	}
 
-	if (!fcnMetricsCmp (it, ctx->fcn)) {
+	if (!ctx->has_metrics) {
+		fcnMetrics (ctx->fcn, &ctx->metrics);
+		ctx->has_metrics = true;
+	}
+	if (!fcnMetricsCmp (graph, &ctx->metrics)) {
 		return 1;
 	}
 
@@ -1844,127 +2503,361 @@ static int hashMatchCB(RSignItem *it, void *user) {
 		return 1;
 	}
 
-	char *digest_hex = r_sign_calc_bbhash (ctx->anal, ctx->fcn);
-	bool retval = false;
-	if (digest_hex && strcmp (hash->bbhash, digest_hex)) {
-		goto beach;
+	if (!ctx->has_feature) {
+		ctx->bbhash = r_sign_calc_bbhash (ctx->anal, ctx->fcn);
+		ctx->has_feature = true;
+	}
+	if (!ctx->bbhash || strcmp (hash->bbhash, ctx->bbhash)) {
+		return 1;
 	}
 
 	if (ctx->cb) {
-		retval = ctx->cb (it, ctx->fcn, ctx->user);
+		return ctx->cb (it, ctx->fcn, ctx->user);
 	}
-beach:
-	free (digest_hex);
-	return retval;
+	return 1;
 }
 
 R_API bool r_sign_match_hash(RAnal *a, RAnalFunction *fcn, RSignHashMatchCallback cb, void *user) {
 	r_return_val_if_fail (a && fcn && cb, false);
 	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-	return r_sign_foreach (a, hashMatchCB, &ctx);
+	bool retval = r_sign_foreach (a, hashMatchCB, &ctx);
+	fcnMatchFini (&ctx);
+	return retval;
 }
 
-
 static int refsMatchCB(RSignItem *it, void *user) {
 	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
-	RList *refs = NULL;
-	char *ref_a = NULL, *ref_b = NULL;
-	int i = 0, retval = 1;
 
 	if (!it->refs) {
 		return 1;
 	}
 
-	// TODO(nibble): slow operation, add cache
-	refs = r_sign_fcn_refs (ctx->anal, ctx->fcn);
-	if (!refs) {
-		return 1;
+	if (!ctx->has_feature) {
+		ctx->list = r_sign_fcn_refs (ctx->anal, ctx->fcn);
+		ctx->has_feature = true;
 	}
-
-	for (i = 0; ; i++) {
-		ref_a = (char *) r_list_get_n (it->refs, i);
-		ref_b = (char *) r_list_get_n (refs, i);
-
-		if (!ref_a || !ref_b) {
-			if (ref_a != ref_b) {
-				retval = 1;
-				goto out;
-			}
-			break;
-		}
-		if (strcmp (ref_a, ref_b)) {
-			retval = 1;
-			goto out;
-		}
+	if (!ctx->list || !strListEq (it->refs, ctx->list)) {
+		return 1;
 	}
 
 	if (ctx->cb) {
-		retval = ctx->cb (it, ctx->fcn, ctx->user);
-		goto out;
+		return ctx->cb (it, ctx->fcn, ctx->user);
 	}
-
-out:
-	r_list_free (refs);
-
-	return retval;
+	return 1;
 }
 
 R_API bool r_sign_match_refs(RAnal *a, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user) {
 	r_return_val_if_fail (a && fcn && cb, false);
 	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-	return r_sign_foreach (a, refsMatchCB, &ctx);
+	bool retval = r_sign_foreach (a, refsMatchCB, &ctx);
+	fcnMatchFini (&ctx);
+	return retval;
 }
 
 static int varsMatchCB(RSignItem *it, void *user) {
 	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
-	RList *vars = NULL;
-	char *var_a = NULL, *var_b = NULL;
-	int i = 0, retval = 1;
 
 	if (!it->vars) {
 		return 1;
 	}
 
-	// TODO(nibble): slow operation, add cache
-	vars = r_sign_fcn_vars (ctx->anal, ctx->fcn);
-	if (!vars) {
+	if (!ctx->has_feature) {
+		ctx->list = r_sign_fcn_vars (ctx->anal, ctx->fcn);
+		ctx->has_feature = true;
+	}
+	if (!ctx->list || !strListEq (it->vars, ctx->list)) {
 		return 1;
 	}
 
-	for (i = 0; ; i++) {
-		var_a = (char *) r_list_get_n (it->vars, i);
-		var_b = (char *) r_list_get_n (vars, i);
+	if (ctx->cb) {
+		return ctx->cb (it, ctx->fcn, ctx->user);
+	}
+	return 1;
+}
+
+R_API bool r_sign_match_vars(RAnal *a, RAnalFunction *fcn, RSignVarsMatchCallback cb, void *user) {
+	r_return_val_if_fail (a && fcn && cb, false);
+	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
+	bool retval = r_sign_foreach (a, varsMatchCB, &ctx);
+	fcnMatchFini (&ctx);
+	return retval;
+}
+
+typedef struct {
+	int cc;
+	int nbbs;
+	int edges;
+	int idx;
+} SignGraphKey;
 
-		if (!var_a || !var_b) {
-			if (var_a != var_b) {
-				retval = 1;
-				goto out;
+// signatures of the current space, deserialized once and indexed by
+// the features the function matchers look up
+struct r_sign_index_t {
+	RAnal *anal;
+	RSignItem **items;
+	int count;
+	// chains of items sharing a key, in load order
+	int *hash_next;
+	int *refs_next;
+	int *addr_next;
+	HtPP *hashes; // bbhash -> first item + 1
+	HtPP *refs; // joined refs -> first item + 1
+	HtUP *addrs; // addr -> first item + 1
+	SignGraphKey *graphs; // sorted by metrics
+	int ngraphs;
+	int *graph_any; // items with wildcard metrics
+	int ngraph_any;
+};
+
+static char *joinList(RList *list) {
+	RStrBuf *sb = r_strbuf_new ("");
+	RListIter *iter;
+	const char *s;
+	r_list_foreach (list, iter, s) {
+		if (iter != list->head) {
+			r_strbuf_append (sb, ",");
+		}
+		r_strbuf_append (sb, s);
+	}
+	return r_strbuf_drain (sb);
+}
+
+static int graphKeyCmp(const void *_a, const void *_b) {
+	const SignGraphKey *a = _a, *b = _b;
+	if (a->cc != b->cc) {
+		return a->cc < b->cc? -1: 1;
+	}
+	if (a->nbbs != b->nbbs) {
+		return a->nbbs < b->nbbs? -1: 1;
+	}
+	if (a->edges != b->edges) {
+		return a->edges < b->edges? -1: 1;
+	}
+	return a->idx - b->idx;
+}
+
+struct ctxIndexCB {
+	RSignIndex *idx;
+	int size;
+};
+
+static int indexLoadCB(void *user, const char *k, const char *v) {
+	struct ctxIndexCB *ctx = (struct ctxIndexCB *) user;
+	RSignIndex *idx = ctx->idx;
+	RSignItem *it = r_sign_item_new ();
+	if (!it) {
+		return 0;
+	}
+	if (!r_sign_deserialize (idx->anal, it, k, v)) {
+		eprintf ("error: cannot deserialize zign\n");
+		r_sign_item_free (it);
+		return 1;
+	}
+	if (it->space != r_spaces_current (&idx->anal->zign_spaces)) {
+		r_sign_item_free (it);
+		return 1;
+	}
+	if (idx->count == ctx->size) {
+		int size = ctx->size? ctx->size * 2: 1024;
+		RSignItem **items = realloc (idx->items, size * sizeof (RSignItem *));
+		if (!items) {
+			r_sign_item_free (it);
+			return 0;
+		}
+		idx->items = items;
+		ctx->size = size;
+	}
+	idx->items[idx->count++] = it;
+	return 1;
+}
+
+static void indexChain(HtPP *ht, const char *key, int *next, int i) {
+	bool found = false;
+	int head = (int)(size_t)ht_pp_find (ht, key, &found);
+	next[i] = found? head - 1: -1;
+	ht_pp_update (ht, key, (void *)(size_t)(i + 1));
+}
+
+R_API RSignIndex *r_sign_index_new(RAnal *a) {
+	r_return_val_if_fail (a, NULL);
+	struct ctxIndexCB ctx = { NULL, 0 };
+	RSignIndex *idx = R_NEW0 (RSignIndex);
+	int i;
+	if (!idx) {
+		return NULL;
+	}
+	idx->anal = a;
+	ctx.idx = idx;
+	sdb_foreach (a->sdb_zigns, indexLoadCB, &ctx);
+	idx->hashes = ht_pp_new0 ();
+	idx->refs = ht_pp_new0 ();
+	idx->addrs = ht_up_new0 ();
+	int n = R_MAX (idx->count, 1);
+	idx->hash_next = calloc (n, sizeof (int));
+	idx->refs_next = calloc (n, sizeof (int));
+	idx->addr_next = calloc (n, sizeof (int));
+	idx->graphs = calloc (n, sizeof (SignGraphKey));
+	idx->graph_any = calloc (n, sizeof (int));
+	if (!idx->hashes || !idx->refs || !idx->addrs || !idx->hash_next || !idx->refs_next
+			|| !idx->addr_next || !idx->graphs || !idx->graph_any) {
+		r_sign_index_free (idx);
+		return NULL;
+	}
+	// walk backwards so every chain lists its items in load order
+	for (i = idx->count - 1; i >= 0; i--) {
+		RSignItem *it = idx->items[i];
+		if (it->hash && it->hash->bbhash && *it->hash->bbhash) {
+			indexChain (idx->hashes, it->hash->bbhash, idx->hash_next, i);
+		}
+		if (it->refs) {
+			char *key = joinList (it->refs);
+			if (key) {
+				indexChain (idx->refs, key, idx->refs_next, i);
+				free (key);
 			}
-			break;
 		}
-		if (strcmp (var_a, var_b)) {
-			retval = 1;
-			goto out;
+		if (it->addr != UT64_MAX) {
+			bool found = false;
+			int head = (int)(size_t)ht_up_find (idx->addrs, it->addr, &found);
+			idx->addr_next[i] = found? head - 1: -1;
+			ht_up_update (idx->addrs, it->addr, (void *)(size_t)(i + 1));
 		}
 	}
+	for (i = 0; i < idx->count; i++) {
+		RSignGraph *g = idx->items[i]->graph;
+		if (!g) {
+			continue;
+		}
+		if (g->cc == -1 || g->nbbs == -1 || g->edges == -1) {
+			idx->graph_any[idx->ngraph_any++] = i;
+		} else {
+			SignGraphKey *k = &idx->graphs[idx->ngraphs++];
+			k->cc = g->cc;
+			k->nbbs = g->nbbs;
+			k->edges = g->edges;
+			k->idx = i;
+		}
+	}
+	qsort (idx->graphs, idx->ngraphs, sizeof (SignGraphKey), graphKeyCmp);
+	return idx;
+}
 
-	if (ctx->cb) {
-		retval = ctx->cb (it, ctx->fcn, ctx->user);
-		goto out;
+R_API void r_sign_index_free(RSignIndex *idx) {
+	int i;
+	if (!idx) {
+		return;
 	}
+	for (i = 0; i < idx->count; i++) {
+		r_sign_item_free (idx->items[i]);
+	}
+	free (idx->items);
+	free (idx->hash_next);
+	free (idx->refs_next);
+	free (idx->addr_next);
+	ht_pp_free (idx->hashes);
+	ht_pp_free (idx->refs);
+	ht_up_free (idx->addrs);
+	free (idx->graphs);
+	free (idx->graph_any);
+	free (idx);
+}
 
-out:
-	r_list_free (vars);
+// number of indexed signatures having the given type, or all of them for 0
+R_API int r_sign_index_count(RSignIndex *idx, int type) {
+	if (!idx) {
+		return 0;
+	}
+	switch (type) {
+	case R_SIGN_BBHASH:
+		return idx->hashes->count;
+	case R_SIGN_REFS:
+		return idx->refs->count;
+	case R_SIGN_OFFSET:
+		return idx->addrs->count;
+	case R_SIGN_GRAPH:
+		return idx->ngraphs + idx->ngraph_any;
+	}
+	return idx->count;
+}
+
+// the index matchers only read the index and the function, so they can run
+// in parallel as long as the callbacks do too. The hits are reported in the
+// same order as the r_sign_match_* ones, and like them the return value of
+// the callback is ignored
+R_API bool r_sign_index_match_graph(RSignIndex *idx, RAnalFunction *fcn, int mincc, RSignGraphMatchCallback cb, void *user) {
+	r_return_val_if_fail (idx && fcn && cb, false);
+	SignFcnMetrics m;
+	int lo = 0, hi = idx->ngraphs, a = 0;
+	fcnMetrics (fcn, &m);
+	SignGraphKey key = { m.cc, m.nbbs, m.edges, -1 };
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (graphKeyCmp (&idx->graphs[mid], &key) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	int end = lo;
+	while (end < idx->ngraphs && idx->graphs[end].cc == m.cc
+			&& idx->graphs[end].nbbs == m.nbbs && idx->graphs[end].edges == m.edges) {
+		end++;
+	}
+	// merge the exact bucket with the wildcard items
+	while (lo < end || a < idx->ngraph_any) {
+		int i = (lo < end && (a >= idx->ngraph_any || idx->graphs[lo].idx < idx->graph_any[a]))
+			? idx->graphs[lo++].idx: idx->graph_any[a++];
+		RSignItem *it = idx->items[i];
+		if (it->graph->cc < mincc || !fcnMetricsCmp (it->graph, &m)) {
+			continue;
+		}
+		cb (it, fcn, user);
+	}
+	return true;
+}
 
-	return retval;
+R_API bool r_sign_index_match_addr(RSignIndex *idx, RAnalFunction *fcn, RSignOffsetMatchCallback cb, void *user) {
+	r_return_val_if_fail (idx && fcn && cb, false);
+	int i = (int)(size_t)ht_up_find (idx->addrs, fcn->addr, NULL) - 1;
+	for (; i >= 0; i = idx->addr_next[i]) {
+		cb (idx->items[i], fcn, user);
+	}
+	return true;
 }
 
-R_API bool r_sign_match_vars(RAnal *a, RAnalFunction *fcn, RSignVarsMatchCallback cb, void *user) {
-	r_return_val_if_fail (a && fcn && cb, false);
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-	return r_sign_foreach (a, varsMatchCB, &ctx);
+// bbhash is the one of r_sign_calc_bbhash, computed by the caller as it reads io
+R_API bool r_sign_index_match_hash(RSignIndex *idx, RAnalFunction *fcn, const char *bbhash, RSignHashMatchCallback cb, void *user) {
+	r_return_val_if_fail (idx && fcn && cb, false);
+	if (!bbhash) {
+		return true;
+	}
+	int i = (int)(size_t)ht_pp_find (idx->hashes, bbhash, NULL) - 1;
+	for (; i >= 0; i = idx->hash_next[i]) {
+		cb (idx->items[i], fcn, user);
+	}
+	return true;
 }
 
+// refs is the list of r_sign_fcn_refs, computed by the caller as it reads the flags
+R_API bool r_sign_index_match_refs(RSignIndex *idx, RAnalFunction *fcn, RList *refs, RSignRefsMatchCallback cb, void *user) {
+	r_return_val_if_fail (idx && fcn && cb, false);
+	if (!refs) {
+		return true;
+	}
+	char *key = joinList (refs);
+	if (!key) {
+		return false;
+	}
+	int i = (int)(size_t)ht_pp_find (idx->refs, key, NULL) - 1;
+	free (key);
+	for (; i >= 0; i = idx->refs_next[i]) {
+		RSignItem *it = idx->items[i];
+		if (strListEq (it->refs, refs)) {
+			cb (it, fcn, user);
+		}
+	}
+	return true;
+}
 
 R_API RSignItem *r_sign_item_new() {
 	RSignItem *ret = R_NEW0 (RSignItem);
@@ -2126,7 +3019,8 @@ R_API bool r_sign_load(RAnal *a, const char *file) {
 	sdb_foreach (db, loadCB, a);
 	sdb_close (db);
 	sdb_free (db);
-	free (path);
+	free (a->zign_file);
+	a->zign_file = path;
 	return true;
 }
 
@@ -20,6 +20,94 @@ struct VarType {
 #define SETKEY(x, ...) snprintf (key, sizeof (key) - 1, x, ## __VA_ARGS__);
 #define SETKEY2(x, ...) snprintf (key2, sizeof (key) - 1, x, ## __VA_ARGS__);
 #define SETVAL(x, ...) snprintf (val, sizeof (val) - 1, x, ## __VA_ARGS__);
+
+/* The vars of each function are kept parsed in anal->fcn_vars, loaded from
+ * the sdb keys on first use and dropped whenever they're written again */
+static void var_store_kv_free(HtUPKv *kv) {
+	r_list_free (kv->value);
+}
+
+static RAnalVar *var_dup(RAnalVar *var) {
+	RAnalVar *av = R_NEW0 (RAnalVar);
+	if (av) {
+		*av = *var;
+		av->name = strdup (var->name? var->name: "unkown_var");
+		av->type = strdup (var->type? var->type: "unkown_type");
+	}
+	return av;
+}
+
+static RList *var_store_load(RAnal *a, ut64 addr) {
+	const char *kind;
+	RList *vars = r_list_newf ((RListFree)r_anal_var_free);
+	if (!vars) {
+		return NULL;
+	}
+	for (kind = "absr"; *kind; kind++) {
+		char *varlist = sdb_get (DB, sdb_fmt ("fcn.0x%"PFMT64x ".%c", addr, *kind), 0);
+		char *next, *ptr = varlist;
+		while (ptr && *ptr) {
+			char *word = sdb_anext (ptr, &next);
+			const char *vardef = sdb_const_get (DB, sdb_fmt (
+				"var.0x%"PFMT64x ".%c.%s", addr, *kind, word), 0);
+			const char *d = strchr (word, '.');
+			if (vardef && d) {
+				struct VarType vt = { 0 };
+				RAnalVar *av = R_NEW0 (RAnalVar);
+				if (!av) {
+					break;
+				}
+				sdb_fmt_init (&vt, SDB_VARTYPE_FMT);
+				sdb_fmt_tobin (vardef, SDB_VARTYPE_FMT, &vt);
+				av->addr = addr;
+				av->scope = atoi (word);
+				av->delta = d[1] == '_'? -atoi (d + 2): atoi (d + 1);
+				av->kind = *kind;
+				av->isarg = vt.isarg;
+				av->size = vt.size;
+				av->name = vt.name? strdup (vt.name): NULL;
+				av->type = vt.type? strdup (vt.type): NULL;
+				sdb_fmt_free (&vt, SDB_VARTYPE_FMT);
+				r_list_append (vars, av);
+			} else {
+				eprintf ("Cannot find var definition for '%s'\n", word);
+			}
+			ptr = next;
+		}
+		free (varlist);
+	}
+	return vars;
+}
+
+static RList *var_store_get(RAnal *a, ut64 addr) {
+	bool found = false;
+	if (!a->fcn_vars) {
+		a->fcn_vars = ht_up_new (NULL, var_store_kv_free, NULL);
+		if (!a->fcn_vars) {
+			return NULL;
+		}
+	}
+	RList *vars = ht_up_find (a->fcn_vars, addr, &found);
+	if (!found) {
+		vars = var_store_load (a, addr);
+		ht_up_insert (a->fcn_vars, addr, vars);
+	}
+	return vars;
+}
+
+static void var_store_dirty(RAnal *a, ut64 addr) {
+	if (a->fcn_vars) {
+		ht_up_delete (a->fcn_vars, addr);
+	}
+}
+
+/* Drop the parsed vars, after the sdb was written directly */
+R_API void r_anal_var_rebuild(RAnal *a) {
+	r_return_if_fail (a);
+	ht_up_free (a->fcn_vars);
+	a->fcn_vars = NULL;
+}
+
 R_API bool r_anal_var_display(RAnal *anal, int delta, char kind, const char *type) {
 	char *fmt = r_type_format (anal->sdb_types, type);
 	RRegItem *i;
@@ -86,6 +174,7 @@ R_API bool r_anal_var_add(RAnal *a, ut64 addr, int scope, int delta, char kind,
 		return false;
 	}
 	const char *var_def = sdb_fmt ("%d,%s,%d,%s", isarg, type, size, name);
+	var_store_dirty (a, addr);
 	if (scope > 0) {
 		const char *sign = "";
 		if (delta < 0) {
@@ -152,6 +241,7 @@ R_API int r_anal_var_retype(RAnal *a, ut64 addr, int scope, int delta, char kind
 		return false;
 	}
 	const char *var_def = sdb_fmt ("%d,%s,%d,%s", isarg, type, size, name);
+	var_store_dirty (a, fcn->addr);
 	if (scope > 0) {
 		char *sign = delta >= 0 ? "": "_";
 		/* local variable */
@@ -212,6 +302,7 @@ R_API int r_anal_var_delete(RAnal *a, ut64 addr, const char kind, int scope, int
 	if (!av) {
 		return false;
 	}
+	var_store_dirty (a, addr);
 	if (scope > 0) {
 		char *sign = "";
 		if (delta < 0) {
@@ -288,68 +379,31 @@ R_API RAnalVar *r_anal_var_get_byname(RAnal *a, ut64 addr, const char *name) {
 		// eprintf ("No something\n");
 		return NULL;
 	}
-	char *name_key = sdb_fmt ("var.0x%"PFMT64x ".%d.%s", addr, 1, name);
-	char *name_value = sdb_get (DB, name_key, 0);
-	if (!name_value) {
-		// eprintf ("Cant find key for %s\n", name_key);
-		return NULL;
-	}
-	const char *comma = strchr (name_value, ',');
-	if (comma && *comma) {
-		int delta = r_num_math (NULL, comma + 1);
-		RAnalVar *res = r_anal_var_get (a, addr, *name_value, 1, delta);
-		free (name_value);
-		return res;
+	RList *vars = var_store_get (a, addr);
+	RListIter *iter;
+	RAnalVar *var;
+	r_list_foreach (vars, iter, var) {
+		if (var->scope == 1 && var->name && !strcmp (var->name, name)) {
+			return r_anal_var_get (a, addr, var->kind, 1, var->delta);
+		}
 	}
-	free (name_value);
 	return NULL;
 }
 
 R_API RAnalVar *r_anal_var_get(RAnal *a, ut64 addr, char kind, int scope, int delta) {
-	struct VarType vt = {
-		0
-	};
-	char *sign = "";
 	RAnalFunction *fcn = r_anal_get_fcn_in (a, addr, 0);
 	if (!fcn) {
 		return NULL;
 	}
-	if (delta < 0) {
-		delta = -delta;
-		sign = "_";
-	}
-	const char *varkey = sdb_fmt ("var.0x%"PFMT64x ".%c.%d.%s%d",
-			fcn->addr, kind, scope, sign, delta);
-	char *vardef = sdb_get (DB, varkey, 0);
-	if (!vardef) {
-		return NULL;
-	}
-	if (*sign) {
-		delta = -delta;
-	}
-	sdb_fmt_init (&vt, SDB_VARTYPE_FMT);
-	sdb_fmt_tobin (vardef, SDB_VARTYPE_FMT, &vt);
-	free (vardef);
-
-	RAnalVar *av = R_NEW0 (RAnalVar);
-	if (!av) {
-		sdb_fmt_free (&vt, SDB_VARTYPE_FMT);
-		return NULL;
+	RList *vars = var_store_get (a, fcn->addr);
+	RListIter *iter;
+	RAnalVar *var;
+	r_list_foreach (vars, iter, var) {
+		if (var->kind == kind && var->scope == scope && var->delta == delta) {
+			return var_dup (var);
+		}
 	}
-	av->addr = fcn->addr;
-	av->scope = scope;
-	av->delta = delta;
-	av->isarg = vt.isarg;
-	av->name = vt.name? strdup (vt.name): strdup ("unkown_var");
-	av->size = vt.size;
-	av->type = vt.type? strdup (vt.type): strdup ("unkown_type");
-	av->kind = kind;
-	sdb_fmt_free (&vt, SDB_VARTYPE_FMT);
-	// TODO:
-	// get name from sdb
-	// get size from sdb
-	// get type from sdb
-	return av;
+	return NULL;
 }
 
 R_API void r_anal_var_free(RAnalVar *av) {
@@ -406,6 +460,7 @@ R_API int r_anal_var_rename(RAnal *a, ut64 addr, int scope, char kind, const cha
 	}
 	// XXX: This is hardcoded because ->kind seems to be 0
 	scope = 1;
+	var_store_dirty (a, addr);
 	// XXX. this is pretty weak, because oldname may not exist  too and error returned.
 	if (scope > 0) { // local
 		const char *sign = "";
@@ -491,6 +546,7 @@ R_API void r_anal_var_access_clear(RAnal *a, ut64 var_addr, int scope, int delta
 R_API int r_anal_fcn_var_del_bydelta(RAnal *a, ut64 fna, const char kind, int scope, ut32 delta) {
 	int idx;
 	char key[128], val[128], *v;
+	var_store_dirty (a, fna);
 	SETKEY ("fcn.0x%08"PFMT64x ".%c", fna, kind);
 	v = sdb_itoa (delta, val, 10);
 	idx = sdb_array_indexof (DB, key, v, 0);
@@ -805,57 +861,30 @@ static RList *var_generate_list(RAnal *a, RAnalFunction *fcn, int kind, bool dyn
 	if (kind < 1) {
 		kind = R_ANAL_VAR_KIND_BPV; // by default show vars
 	}
-	char *varlist = sdb_get (DB, sdb_fmt ("fcn.0x%"PFMT64x ".%c", fcn->addr, kind), 0);
-	if (varlist && *varlist) {
-		char *next, *ptr = varlist;
-		do {
-			char *word = sdb_anext (ptr, &next);
-			if (r_str_nlen (word, 3) < 3) {
-				return NULL;
-			}
-			const char *vardef = sdb_const_get (DB, sdb_fmt (
-				"var.0x%"PFMT64x ".%c.%s",
-				fcn->addr, kind, word), 0);
-			if (word[2] == '_') {
-				word[2] = '-';
-			}
-			int delta = atoi (word + 2);
-			if (vardef) {
-				struct VarType vt = { 0 };
-				sdb_fmt_init (&vt, SDB_VARTYPE_FMT);
-				sdb_fmt_tobin (vardef, SDB_VARTYPE_FMT, &vt);
-				RAnalVar *av = R_NEW0 (RAnalVar);
-				if (!av) {
-					free (varlist);
-					r_list_free (list);
-					return NULL;
-				}
-				if (!vt.name || !vt.type) {
-					// This should be properly fixed
-					eprintf ("Warning null var in fcn.0x%"PFMT64x ".%c.%s\n",
-						fcn->addr, kind, word);
-					free (av);
-					continue;
-				}
-				av->addr = fcn->addr;
-				av->delta = delta;
-				av->kind = kind;
-				av->name = strdup (vt.name);
-				av->isarg = vt.isarg;
-				av->size = vt.size;
-				av->type = strdup (vt.type);
-				r_list_append (list, av);
-				if (dynamicVars) { // make dynamic variables like structure fields
-					var_add_structure_fields_to_list (a, av, vt.name, delta, list);
-				}
-				sdb_fmt_free (&vt, SDB_VARTYPE_FMT);
-			} else {
-				eprintf ("Cannot find var definition for '%s'\n", word);
-			}
-			ptr = next;
-		} while (next);
+	RList *vars = var_store_get (a, fcn->addr);
+	RListIter *iter;
+	RAnalVar *var;
+	r_list_foreach (vars, iter, var) {
+		if (var->kind != kind) {
+			continue;
+		}
+		if (!var->name || !var->type) {
+			// This should be properly fixed
+			eprintf ("Warning null var in fcn.0x%"PFMT64x ".%c.%d.%d\n",
+				fcn->addr, kind, var->scope, var->delta);
+			continue;
+		}
+		RAnalVar *av = var_dup (var);
+		if (!av) {
+			r_list_free (list);
+			return NULL;
+		}
+		av->scope = 0;
+		r_list_append (list, av);
+		if (dynamicVars) { // make dynamic variables like structure fields
+			var_add_structure_fields_to_list (a, av, var->name, var->delta, list);
+		}
 	}
-	free (varlist);
 	return list;
 }
 
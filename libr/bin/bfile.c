@@ -3,6 +3,9 @@
 #include <r_bin.h>
 #include <r_hash.h>
 #include "i/private.h"
+#if __SSE2__
+#include <emmintrin.h>
+#endif
 
 // maybe too big sometimes? 2KB of stack eaten here..
 #define R_STRING_SCAN_BUFFER_SIZE 2048
@@ -105,204 +108,482 @@ static void print_string(RBinFile *bf, RBinString *string, int raw) {
 	}
 }
 
-static int string_scan_range(RList *list, RBinFile *bf, int min,
-			      const ut64 from, const ut64 to, int type, int raw, RBinSection *section) {
+/* String scanning
+ *
+ * Ranges are read in windows of STR_CHUNK_SIZE bytes, so memory does not grow
+ * with the size of the file. With bin.str.jobs > 1 the windows of a round are
+ * scanned by several threads, each one starting at the beginning of its own
+ * window. The serial scan only depends on the position it is at, so the hits
+ * of a window are kept from the first position both scans step on, what the
+ * previous window scanned until then is used instead. The output is the same
+ * as scanning the whole range at once, in the same order.
+ */
+
+// ranges are scanned in windows of this size
+#define STR_CHUNK_SIZE 0x100000
+// scanning one string never reads further than this from where it started
+#define STR_CHUNK_MARGIN 0x4000
+// control characters printed as escape sequences: \a \b \t \n \v \f \r \e
+#define STR_ESC_MASK ((1U << 7) | (1U << 8) | (1U << 9) | (1U << 10) \
+		| (1U << 11) | (1U << 12) | (1U << 13) | (1U << 0x1b))
+
+typedef struct {
+	ut8 *buf;
+	ut64 base; // address of buf[0]
+	ut64 end; // address after the last byte of buf
+	ut64 stop; // strings are scanned from positions before this one
+	ut64 skip_at; // block of positions classified in skip
+	ut32 skip;
+	ut64 from; // start of the scanned range
+	int min;
+	int type;
+} StrWindow;
+
+typedef struct {
+	ut64 at; // position the scan of the string started from
+	RBinString *bs;
+} StrHit;
+
+typedef struct {
+	StrWindow w;
+	ut64 start;
+	ut64 stop;
+	ut64 needle; // where the scan of the window ended
+	RVector hits;
+	bool fail;
+} StrJob;
+
+typedef struct {
+	RBinFile *bf;
+	RList *list;
+	int raw;
+	RBinSection *section;
+	RBinSection *s;
+	st64 vdelta;
+	st64 pdelta;
+	ut64 from;
+	ut64 to;
+	int count;
+} StrOut;
+
+/* Classifies the 16 positions starting at p, a bit is set for the ones the
+ * scan steps over one byte at a time without finding a string: invalid utf8
+ * leads, and control characters that are neither printed nor followed by a
+ * wide string. 32 bytes must be readable at p. */
+static ut32 str_skip_mask(const ut8 *p) {
+	ut32 inv, dead, zero;
+#if __SSE2__
+	const __m128i c0 = _mm_set1_epi8 ((char)0xc0);
+	const __m128i c80 = _mm_set1_epi8 ((char)0x80);
+	const __m128i cf8 = _mm_set1_epi8 ((char)0xf8);
+	const __m128i c1f = _mm_set1_epi8 (0x1f);
+	const __m128i c7 = _mm_set1_epi8 (7);
+	const __m128i c6 = _mm_set1_epi8 (6);
+	const __m128i c1b = _mm_set1_epi8 (0x1b);
+	const __m128i c7f = _mm_set1_epi8 (0x7f);
+	int i;
+	inv = dead = zero = 0;
+	for (i = 0; i < 2; i++) {
+		__m128i v = _mm_loadu_si128 ((const __m128i *)(p + i * 16));
+		__m128i e = _mm_sub_epi8 (v, c7);
+		__m128i m_inv = _mm_or_si128 (
+			_mm_cmpeq_epi8 (_mm_and_si128 (v, c0), c80),
+			_mm_cmpeq_epi8 (_mm_max_epu8 (v, cf8), v));
+		__m128i m_esc = _mm_or_si128 (
+			_mm_cmpeq_epi8 (_mm_min_epu8 (e, c6), e),
+			_mm_cmpeq_epi8 (v, c1b));
+		__m128i m_dead = _mm_or_si128 (
+			_mm_andnot_si128 (m_esc, _mm_cmpeq_epi8 (_mm_min_epu8 (v, c1f), v)),
+			_mm_cmpeq_epi8 (v, c7f));
+		inv |= (ut32)_mm_movemask_epi8 (m_inv) << (i * 16);
+		dead |= (ut32)_mm_movemask_epi8 (m_dead) << (i * 16);
+		zero |= (ut32)_mm_movemask_epi8 (_mm_cmpeq_epi8 (v, _mm_setzero_si128 ())) << (i * 16);
+	}
+#else
+	int i;
+	inv = dead = zero = 0;
+	for (i = 0; i < 32; i++) {
+		const ut8 b = p[i];
+		inv |= (ut32)((b & 0xc0) == 0x80 || b >= 0xf8) << i;
+		dead |= (ut32)(b == 0x7f || (b < 0x20 && !((STR_ESC_MASK >> b) & 1))) << i;
+		zero |= (ut32)!b << i;
+	}
+#endif
+	// a wide string is only detected when the next byte is zero and some of the 3 after it are not
+	ut32 z1 = zero >> 1;
+	ut32 narrow = ~z1 | (z1 & (zero >> 2) & (zero >> 3) & (zero >> 4));
+	return (inv | (dead & narrow)) & 0xffff;
+}
+
+/* Scans one string at *pneedle the way the whole range would be scanned and
+ * moves the needle past it. Returns NULL when there is no string there. */
+static RBinString *scan_string(StrWindow *w, ut64 *pneedle, bool *fail) {
 	ut8 tmp[R_STRING_SCAN_BUFFER_SIZE];
-	ut64 str_start, needle = from;
-	int count = 0, i, rc, runes;
+	const ut8 *buf = w->buf;
+	const ut64 base = w->base;
+	const ut64 to = w->end;
+	ut64 str_start, needle = *pneedle;
+	int i, rc, runes;
+	int type = w->type;
 	int str_type = R_STRING_TYPE_DETECT;
 
-	// if list is null it means its gonna dump
-	r_return_val_if_fail (bf, -1);
-
-	if (type == -1) {
-		type = R_STRING_TYPE_DETECT;
-	}
-	if (from >= to) {
-		eprintf ("Invalid range to find strings 0x%"PFMT64x" .. 0x%"PFMT64x"\n", from, to);
-		return -1;
+	while (needle < w->stop) {
+		// the masks are computed once per block of 16 positions
+		ut64 at = needle - ((needle - base) & 15);
+		if (at + 32 > to) {
+			break;
+		}
+		if (at != w->skip_at) {
+			w->skip = str_skip_mask (buf + at - base);
+			w->skip_at = at;
+		}
+		ut32 m = w->skip >> (needle - at);
+		if (!(m & 1)) {
+			break;
+		}
+		while (m & 1) {
+			m >>= 1;
+			needle++;
+		}
 	}
-	int len = to - from;
-	ut8 *buf = calloc (len, 1);
-	if (!buf || !min) {
-		free (buf);
-		return -1;
+	if (needle >= w->stop) {
+		*pneedle = needle;
+		return NULL;
 	}
-	st64 vdelta = 0, pdelta = 0;
-	RBinSection *s = NULL;
-	r_buf_read_at (bf->buf, from, buf, len);
 	// may oobread
-	while (needle < to) {
-		rc = r_utf8_decode (buf + needle - from, to - needle, NULL);
-		if (!rc) {
-			needle++;
-			continue;
-		}
-		if (type == R_STRING_TYPE_DETECT) {
-			char *w = (char *)buf + needle + rc - from;
-			if ((to - needle) > 5 + rc) {
-				bool is_wide32 = (needle + rc + 2 < to) && (!w[0] && !w[1] && !w[2] && w[3] && !w[4]);
-				if (is_wide32) {
-					str_type = R_STRING_TYPE_WIDE32;
-				} else {
-					bool is_wide = needle + rc + 2 < to && !w[0] && w[1] && !w[2];
-					str_type = is_wide? R_STRING_TYPE_WIDE: R_STRING_TYPE_ASCII;
-				}
+	rc = r_utf8_decode (buf + needle - base, to - needle, NULL);
+	if (!rc) {
+		*pneedle = needle + 1;
+		return NULL;
+	}
+	if (type == R_STRING_TYPE_DETECT) {
+		char *w = (char *)buf + needle + rc - base;
+		if ((to - needle) > 5 + rc) {
+			bool is_wide32 = (needle + rc + 2 < to) && (!w[0] && !w[1] && !w[2] && w[3] && !w[4]);
+			if (is_wide32) {
+				str_type = R_STRING_TYPE_WIDE32;
 			} else {
-				str_type = R_STRING_TYPE_ASCII;
+				bool is_wide = needle + rc + 2 < to && !w[0] && w[1] && !w[2];
+				str_type = is_wide? R_STRING_TYPE_WIDE: R_STRING_TYPE_ASCII;
 			}
 		} else {
-			str_type = type;
+			str_type = R_STRING_TYPE_ASCII;
 		}
-		runes = 0;
-		str_start = needle;
+	} else {
+		str_type = type;
+	}
+	runes = 0;
+	str_start = needle;
 
-		/* Eat a whole C string */
-		for (i = 0; i < sizeof (tmp) - 3 && needle < to; i += rc) {
-			RRune r = {0};
+	/* Eat a whole C string */
+	for (i = 0; i < sizeof (tmp) - 3 && needle < to; i += rc) {
+		RRune r = {0};
 
-			if (str_type == R_STRING_TYPE_WIDE32) {
-				rc = r_utf32le_decode (buf + needle - from, to - needle, &r);
-				if (rc) {
-					rc = 4;
-				}
-			} else if (str_type == R_STRING_TYPE_WIDE) {
-				rc = r_utf16le_decode (buf + needle - from, to - needle, &r);
-				if (rc == 1) {
-					rc = 2;
-				}
-			} else {
-				rc = r_utf8_decode (buf + needle - from, to - needle, &r);
-				if (rc > 1) {
-					str_type = R_STRING_TYPE_UTF8;
-				}
+		if (str_type == R_STRING_TYPE_WIDE32) {
+			rc = r_utf32le_decode (buf + needle - base, to - needle, &r);
+			if (rc) {
+				rc = 4;
 			}
-
-			/* Invalid sequence detected */
-			if (!rc) {
-				needle++;
-				break;
+		} else if (str_type == R_STRING_TYPE_WIDE) {
+			rc = r_utf16le_decode (buf + needle - base, to - needle, &r);
+			if (rc == 1) {
+				rc = 2;
 			}
+		} else {
+			rc = r_utf8_decode (buf + needle - base, to - needle, &r);
+			if (rc > 1) {
+				str_type = R_STRING_TYPE_UTF8;
+			}
+		}
+
+		/* Invalid sequence detected */
+		if (!rc) {
+			needle++;
+			break;
+		}
 
-			needle += rc;
+		needle += rc;
 
-			if (r_isprint (r) && r != '\\') {
-				if (str_type == R_STRING_TYPE_WIDE32) {
-					if (r == 0xff) {
-						r = 0;
-					}
-				}
-				rc = r_utf8_encode (&tmp[i], r);
-				runes++;
-				/* Print the escape code */
-			} else if (r && r < 0x100 && strchr ("\b\v\f\n\r\t\a\033\\", (char)r)) {
-				if ((i + 32) < sizeof (tmp) && r < 93) {
-					tmp[i + 0] = '\\';
-					tmp[i + 1] = "       abtnvfr             e  "
-					             "                              "
-					             "                              "
-					             "  \\"[r];
-				} else {
-					// string too long
-					break;
+		if (r_isprint (r) && r != '\\') {
+			if (str_type == R_STRING_TYPE_WIDE32) {
+				if (r == 0xff) {
+					r = 0;
 				}
-				rc = 2;
-				runes++;
+			}
+			rc = r_utf8_encode (&tmp[i], r);
+			runes++;
+			/* Print the escape code */
+		} else if (r && r < 0x100 && strchr ("\b\v\f\n\r\t\a\033\\", (char)r)) {
+			if ((i + 32) < sizeof (tmp) && r < 93) {
+				tmp[i + 0] = '\\';
+				tmp[i + 1] = "       abtnvfr             e  "
+				             "                              "
+				             "                              "
+				             "  \\"[r];
 			} else {
-				/* \0 marks the end of C-strings */
+				// string too long
 				break;
 			}
+			rc = 2;
+			runes++;
+		} else {
+			/* \0 marks the end of C-strings */
+			break;
 		}
+	}
+	*pneedle = needle;
 
-		tmp[i++] = '\0';
+	tmp[i++] = '\0';
 
-		if (runes >= min) {
-			// reduce false positives
-			int j, num_blocks, *block_list;
-			if (str_type == R_STRING_TYPE_ASCII) {
-				for (j = 0; j < i; j++) {
-					char ch = tmp[j];
-					if (ch != '\n' && ch != '\r' && ch != '\t') {
-						if (!IS_PRINTABLE (tmp[j])) {
-							continue;
-						}
-					}
-				}
-			}
-			switch (str_type) {
-			case R_STRING_TYPE_UTF8:
-			case R_STRING_TYPE_WIDE:
-			case R_STRING_TYPE_WIDE32:
-				num_blocks = 0;
-				block_list = r_utf_block_list ((const ut8*)tmp, i - 1);
-				if (block_list) {
-					for (j = 0; block_list[j] != -1; j++) {
-						num_blocks++;
-					}
-				}
-				free (block_list);
-				if (num_blocks > R_STRING_MAX_UNI_BLOCKS) {
+	if (runes < w->min) {
+		return NULL;
+	}
+	// reduce false positives
+	int j, num_blocks, *block_list;
+	if (str_type == R_STRING_TYPE_ASCII) {
+		for (j = 0; j < i; j++) {
+			char ch = tmp[j];
+			if (ch != '\n' && ch != '\r' && ch != '\t') {
+				if (!IS_PRINTABLE (tmp[j])) {
 					continue;
 				}
 			}
-			RBinString *bs = R_NEW0 (RBinString);
-			if (!bs) {
-				break;
+		}
+	}
+	switch (str_type) {
+	case R_STRING_TYPE_UTF8:
+	case R_STRING_TYPE_WIDE:
+	case R_STRING_TYPE_WIDE32:
+		num_blocks = 0;
+		block_list = r_utf_block_list ((const ut8*)tmp, i - 1);
+		if (block_list) {
+			for (j = 0; block_list[j] != -1; j++) {
+				num_blocks++;
 			}
-			bs->type = str_type;
-			bs->length = runes;
-			bs->size = needle - str_start;
-			bs->ordinal = count++;
-			// TODO: move into adjust_offset
-			switch (str_type) {
-			case R_STRING_TYPE_WIDE:
-				if (str_start - from > 1) {
-					const ut8 *p = buf + str_start - 2 - from;
-					if (p[0] == 0xff && p[1] == 0xfe) {
-						str_start -= 2; // \xff\xfe
-					}
+		}
+		free (block_list);
+		if (num_blocks > R_STRING_MAX_UNI_BLOCKS) {
+			return NULL;
+		}
+	}
+	RBinString *bs = R_NEW0 (RBinString);
+	if (!bs) {
+		*fail = true;
+		return NULL;
+	}
+	bs->type = str_type;
+	bs->length = runes;
+	bs->size = needle - str_start;
+	// TODO: move into adjust_offset
+	switch (str_type) {
+	case R_STRING_TYPE_WIDE:
+		if (str_start - w->from > 1) {
+			const ut8 *p = buf + str_start - 2 - base;
+			if (p[0] == 0xff && p[1] == 0xfe) {
+				str_start -= 2; // \xff\xfe
+			}
+		}
+		break;
+	case R_STRING_TYPE_WIDE32:
+		if (str_start - w->from > 3) {
+			const ut8 *p = buf + str_start - 4 - base;
+			if (p[0] == 0xff && p[1] == 0xfe) {
+				str_start -= 4; // \xff\xfe\x00\x00
+			}
+		}
+		break;
+	}
+	bs->paddr = str_start;
+	bs->string = r_str_ndup ((const char *)tmp, i);
+	return bs;
+}
+
+static void string_output(StrOut *out, RBinString *bs) {
+	RBinFile *bf = out->bf;
+	bs->ordinal = out->count++;
+	if (!out->s) {
+		if (out->section) {
+			out->s = out->section;
+		} else if (bf->o) {
+			out->s = r_bin_get_section_at (bf->o, bs->paddr, false);
+		}
+		if (out->s) {
+			out->vdelta = out->s->vaddr;
+			out->pdelta = out->s->paddr;
+		}
+	}
+	bs->vaddr = bs->paddr - out->pdelta + out->vdelta;
+	if (out->list) {
+		r_list_append (out->list, bs);
+		if (bf->o) {
+			ht_up_insert (bf->o->strings_db, bs->vaddr, bs);
+		}
+	} else {
+		print_string (bf, bs, out->raw);
+		r_bin_string_free (bs);
+	}
+	if (out->from == 0 && out->to == bf->size) {
+		/* force lookup section at the next one */
+		out->s = NULL;
+	}
+}
+
+// reads the bytes needed to scan [start, stop) of the range
+static bool string_window(RBinFile *bf, StrWindow *w, ut64 start, ut64 stop, ut64 to) {
+	w->base = R_MAX (w->from + 4, start) - 4; // room for the byte order marks
+	w->end = R_MIN (to, stop + STR_CHUNK_MARGIN);
+	w->stop = stop;
+	w->skip_at = UT64_MAX;
+	ut8 *buf = calloc (w->end - w->base, 1);
+	if (!buf) {
+		return false;
+	}
+	r_buf_read_at (bf->buf, w->base, buf, w->end - w->base);
+	free (w->buf);
+	w->buf = buf;
+	return true;
+}
+
+static bool string_scan_job(void *user, int idx) {
+	StrJob *job = (StrJob *)user + idx;
+	ut64 needle = job->start;
+	r_vector_clear (&job->hits);
+	while (needle < job->stop && !job->fail) {
+		StrHit h = { needle, NULL };
+		h.bs = scan_string (&job->w, &needle, &job->fail);
+		if (h.bs && !r_vector_push (&job->hits, &h)) {
+			r_bin_string_free (h.bs);
+			job->fail = true;
+		}
+	}
+	job->needle = needle;
+	return true;
+}
+
+static void string_hit_fini(void *e, void *user) {
+	StrHit *h = e;
+	if (h->bs) {
+		r_bin_string_free (h->bs);
+	}
+}
+
+/* Stitches the jobs of a round to the serial scan, which is at *pneedle. */
+static bool string_jobs_merge(StrOut *out, StrJob *jobs, int njobs, ut64 *pneedle) {
+	ut64 a = *pneedle;
+	bool fail = false;
+	int i;
+	size_t k;
+	for (i = 0; i < njobs; i++) {
+		StrJob *job = &jobs[i];
+		ut64 b = job->start;
+		// step both scans until they meet, the serial one keeps what it finds
+		while (a != b && b < job->stop && !fail) {
+			if (b < a) {
+				RBinString *bs = scan_string (&job->w, &b, &fail);
+				if (bs) {
+					r_bin_string_free (bs);
 				}
-				break;
-			case R_STRING_TYPE_WIDE32:
-				if (str_start - from > 3) {
-					const ut8 *p = buf + str_start - 4 - from;
-					if (p[0] == 0xff && p[1] == 0xfe) {
-						str_start -= 4; // \xff\xfe\x00\x00
-					}
+			} else {
+				RBinString *bs = scan_string (&job->w, &a, &fail);
+				if (bs) {
+					string_output (out, bs);
 				}
-				break;
 			}
-			if (!s) {
-				if (section) {
-					s = section;
-				} else if (bf->o) {
-					s = r_bin_get_section_at (bf->o, str_start, false);
-				}
-				if (s) {
-					vdelta = s->vaddr;
-					pdelta = s->paddr;
+		}
+		if (a == b && !job->fail) {
+			StrHit *h = job->hits.a;
+			for (k = 0; k < job->hits.len; k++) {
+				if (h[k].at >= a) {
+					string_output (out, h[k].bs);
+					h[k].bs = NULL;
 				}
 			}
-			bs->paddr = str_start;
-			bs->vaddr = str_start - pdelta + vdelta;
-			bs->string = r_str_ndup ((const char *)tmp, i);
-			if (list) {
-				r_list_append (list, bs);
-				if (bf->o) {
-					ht_up_insert (bf->o->strings_db, bs->vaddr, bs);
+			a = job->needle;
+		} else {
+			// never met, scan the whole window again
+			while (a < job->stop && !fail) {
+				RBinString *bs = scan_string (&job->w, &a, &fail);
+				if (bs) {
+					string_output (out, bs);
 				}
-			} else {
-				print_string (bf, bs, raw);
-				r_bin_string_free (bs);
 			}
-			if (from == 0 && to == bf->size) {
-				/* force lookup section at the next one */
-				s = NULL;
+		}
+		if (fail || job->fail) {
+			return false;
+		}
+	}
+	*pneedle = a;
+	return true;
+}
+
+static int string_scan_range(RList *list, RBinFile *bf, int min,
+			      const ut64 from, const ut64 to, int type, int raw, RBinSection *section) {
+	// if list is null it means its gonna dump
+	r_return_val_if_fail (bf, -1);
+
+	if (type == -1) {
+		type = R_STRING_TYPE_DETECT;
+	}
+	if (from >= to) {
+		eprintf ("Invalid range to find strings 0x%"PFMT64x" .. 0x%"PFMT64x"\n", from, to);
+		return -1;
+	}
+	if (!min) {
+		return -1;
+	}
+	StrOut out = { bf, list, raw, section, NULL, 0, 0, from, to, 0 };
+	StrWindow w = { NULL, 0, 0, 0, UT64_MAX, 0, from, min, type };
+	ut64 needle = from;
+	int i, njobs = bf->rbin->strjobs;
+	if (njobs > 1 && to - from > STR_CHUNK_SIZE) {
+		StrJob *jobs = R_NEWS0 (StrJob, njobs);
+		RThreadPool *pool = jobs? r_th_pool_new (njobs): NULL;
+		bool ok = pool != NULL;
+		for (i = 0; i < njobs && jobs; i++) {
+			jobs[i].w = w;
+			r_vector_init (&jobs[i].hits, sizeof (StrHit), string_hit_fini, NULL);
+		}
+		while (ok && needle < to) {
+			// windows of the round start at fixed offsets, the first one where the scan is
+			ut64 at = needle;
+			int n = 0;
+			for (n = 0; n < njobs && at < to && ok; n++) {
+				StrJob *job = &jobs[n];
+				job->start = at;
+				job->stop = R_MIN (to, at + STR_CHUNK_SIZE);
+				job->fail = false;
+				ok = string_window (bf, &job->w, job->start, job->stop, to);
+				at = job->stop;
+			}
+			if (ok) {
+				r_th_pool_run (pool, n, string_scan_job, jobs);
+				ok = string_jobs_merge (&out, jobs, n, &needle);
+			}
+		}
+		for (i = 0; i < njobs && jobs; i++) {
+			r_vector_clear (&jobs[i].hits);
+			free (jobs[i].w.buf);
+		}
+		r_th_pool_free (pool);
+		free (jobs);
+		return ok? out.count: -1;
+	}
+	bool fail = false;
+	while (needle < to && !fail) {
+		ut64 stop = R_MIN (to, needle + STR_CHUNK_SIZE);
+		if (!string_window (bf, &w, needle, stop, to)) {
+			fail = true;
+			break;
+		}
+		while (needle < stop && !fail) {
+			RBinString *bs = scan_string (&w, &needle, &fail);
+			if (bs) {
+				string_output (&out, bs);
 			}
 		}
 	}
-	free (buf);
-	return count;
+	free (w.buf);
+	return fail? -1: out.count;
 }
 
 static bool __isDataSection(RBinFile *a, RBinSection *s) {
@@ -906,6 +1187,7 @@ R_IPI void r_bin_class_free(RBinClass *k) {
 
 R_API RBinClass *r_bin_file_add_class(RBinFile *bf, const char *name, const char *super, int view) {
 	r_return_val_if_fail (name && bf && bf->o, NULL);
+	r_bin_object_load_items (bf, bf->o, R_BIN_REQ_CLASSES);
 	RBinClass *c = __getClass (bf, name);
 	if (c) {
 		if (super) {
@@ -739,6 +739,16 @@ R_API RBinAddr *r_bin_get_sym(RBin *bin, int sym) {
 	return o? o->binsym[sym]: NULL;
 }
 
+// current object with the given items loaded, see bin.lazy
+static RBinObject *cur_object_items(RBin *bin, ut64 req) {
+	RBinFile *bf = r_bin_cur (bin);
+	RBinObject *o = bf? bf->o: NULL;
+	if (o && (o->pending & req)) {
+		r_bin_object_load_items (bf, o, req);
+	}
+	return o;
+}
+
 // XXX: those accessors are redundant
 R_API RList *r_bin_get_entries(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
@@ -748,13 +758,13 @@ R_API RList *r_bin_get_entries(RBin *bin) {
 
 R_API RList *r_bin_get_fields(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_items (bin, R_BIN_REQ_FIELDS);
 	return o ? o->fields : NULL;
 }
 
 R_API RList *r_bin_get_imports(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_items (bin, R_BIN_REQ_IMPORTS);
 	return o ? o->imports : NULL;
 }
 
@@ -766,7 +776,7 @@ R_API RBinInfo *r_bin_get_info(RBin *bin) {
 
 R_API RList *r_bin_get_libs(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_items (bin, R_BIN_REQ_LIBS);
 	return o ? o->libs : NULL;
 }
 
@@ -783,7 +793,7 @@ static RList *relocs_rbtree2list(RBNode *root) {
 
 R_API RBNode *r_bin_patch_relocs(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_items (bin, R_BIN_REQ_RELOCS);
 	return o? r_bin_object_patch_relocs (bin, o): NULL;
 }
 
@@ -796,7 +806,7 @@ R_API RList *r_bin_patch_relocs_list(RBin *bin) {
 
 R_API RBNode *r_bin_get_relocs(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_items (bin, R_BIN_REQ_RELOCS);
 	return o ? o->relocs : NULL;
 }
 
@@ -841,6 +851,7 @@ R_API RList *r_bin_reset_strings(RBin *bin) {
 	if (!a || !o) {
 		return NULL;
 	}
+	o->pending &= ~R_BIN_REQ_STRINGS;
 	if (o->strings) {
 		r_list_free (o->strings);
 		o->strings = NULL;
@@ -864,7 +875,7 @@ R_API RList *r_bin_reset_strings(RBin *bin) {
 
 R_API RList *r_bin_get_strings(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_items (bin, R_BIN_REQ_STRINGS);
 	return o ? o->strings : NULL;
 }
 
@@ -888,7 +899,7 @@ R_API int r_bin_is_string(RBin *bin, ut64 va) {
 
 R_API RList *r_bin_get_symbols(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_items (bin, R_BIN_REQ_SYMBOLS);
 	return o? o->symbols: NULL;
 }
 
@@ -906,7 +917,7 @@ R_API int r_bin_is_big_endian(RBin *bin) {
 
 R_API int r_bin_is_static(RBin *bin) {
 	r_return_val_if_fail (bin, false);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_items (bin, R_BIN_REQ_LIBS);
 	if (o && o->libs && r_list_length (o->libs) > 0) {
 		return R_BIN_DBG_STATIC & o->info->dbg_info;
 	}
@@ -1297,7 +1308,7 @@ R_API RBuffer *r_bin_package(RBin *bin, const char *type, const char *file, RLis
 
 R_API RList * /*<RBinClass>*/ r_bin_get_classes(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_items (bin, R_BIN_REQ_CLASSES);
 	return o ? o->classes : NULL;
 }
 
@@ -200,6 +200,7 @@ R_IPI int r_bin_lang_type(RBinFile *binfile, const char *def, const char *sym) {
 		type = plugin->demangle_type (def);
 	} else {
 		if (binfile && binfile->o && binfile->o->info) {
+			r_bin_object_load_items (binfile, binfile->o, R_BIN_REQ_INFO);
 			type = r_bin_demangle_type (binfile->o->info->lang);
 		}
 	}
@@ -246,14 +246,161 @@ static RBNode *list2rbtree(RList *relocs) {
 	return res;
 }
 
+/* Items materialized on first use when RBin.lazy is set. R_BIN_REQ_INFO
+ * stands for the language detection, which needs most of the others. */
+#define LAZY_ITEMS (R_BIN_REQ_FIELDS | R_BIN_REQ_IMPORTS | R_BIN_REQ_SYMBOLS | R_BIN_REQ_LIBS \
+		| R_BIN_REQ_RELOCS | R_BIN_REQ_STRINGS | R_BIN_REQ_CLASSES | R_BIN_REQ_SRCLINE | R_BIN_REQ_INFO)
+
+// items that must be loaded before each kind, as the plugins expect the eager order
+static ut64 lazy_deps(ut64 req) {
+	ut64 deps = req;
+	if (deps & R_BIN_REQ_INFO) {
+		deps |= R_BIN_REQ_IMPORTS | R_BIN_REQ_SYMBOLS | R_BIN_REQ_LIBS | R_BIN_REQ_CLASSES;
+	}
+	if (deps & R_BIN_REQ_CLASSES) {
+		deps |= R_BIN_REQ_SYMBOLS | R_BIN_REQ_LIBS | R_BIN_REQ_STRINGS;
+	}
+	if (deps & R_BIN_REQ_RELOCS) {
+		deps |= R_BIN_REQ_IMPORTS | R_BIN_REQ_SYMBOLS;
+	}
+	if (deps & R_BIN_REQ_SYMBOLS) {
+		deps |= R_BIN_REQ_IMPORTS;
+	}
+	return deps;
+}
+
+static void load_classes(RBinFile *bf, RBinObject *o) {
+	RBinPlugin *p = o->plugin;
+	if (p->classes) {
+		RList *classes = p->classes (bf);
+		if (classes) {
+			// XXX we should probably merge them instead
+			r_list_free (o->classes);
+			o->classes = classes;
+		}
+		o->swift = r_bin_lang_swift (bf);
+		if (o->swift) {
+			o->classes = classes_from_symbols (bf);
+		}
+	} else {
+		RList *classes = classes_from_symbols (bf);
+		if (classes) {
+			o->classes = classes;
+		}
+	}
+	if (bf->rbin->filter) {
+		filter_classes (bf, o->classes);
+	}
+	// cache addr=class+method
+	if (o->classes) {
+		RList *klasses = o->classes;
+		RListIter *iter, *iter2;
+		RBinClass *klass;
+		RBinSymbol *method;
+		if (!o->addr2klassmethod) {
+			// this is slow. must be optimized, but at least its cached
+			o->addr2klassmethod = sdb_new0 ();
+			r_list_foreach (klasses, iter, klass) {
+				r_list_foreach (klass->methods, iter2, method) {
+					char *km = sdb_fmt ("method.%s.%s", klass->name, method->name);
+					char *at = sdb_fmt ("0x%08"PFMT64x, method->vaddr);
+					sdb_set (o->addr2klassmethod, at, km, 0);
+				}
+			}
+		}
+	}
+}
+
+/* Materializes the requested items (R_BIN_REQ_* bits) that were left
+ * pending by r_bin_object_set_items in lazy mode, together with the items
+ * they depend on. Items already loaded are not touched. */
+R_API void r_bin_object_load_items(RBinFile *bf, RBinObject *o, ut64 req) {
+	r_return_if_fail (bf && o);
+	// only set by r_bin_object_set_items, so there is a plugin
+	ut64 todo = o->pending & lazy_deps (req);
+	if (!todo) {
+		return;
+	}
+	RBin *bin = bf->rbin;
+	RBinPlugin *p = o->plugin;
+	RBinObject *bo = bf->o;
+	// plugins reach the object through bf, accessors may ask again while loading
+	bf->o = o;
+	o->pending &= ~todo;
+	// the eager load filters symbols and classes before the language is known
+	int lang = o->lang;
+	if (bin->lazy) {
+		o->lang = 0;
+	}
+	if ((todo & R_BIN_REQ_FIELDS) && p->fields) {
+		o->fields = p->fields (bf);
+		if (o->fields) {
+			o->fields->free = r_bin_field_free;
+			REBASE_PADDR (o, o->fields, RBinField);
+		}
+	}
+	if ((todo & R_BIN_REQ_IMPORTS) && p->imports) {
+		r_list_free (o->imports);
+		o->imports = p->imports (bf);
+		if (o->imports) {
+			o->imports->free = r_bin_import_free;
+		}
+	}
+	if ((todo & R_BIN_REQ_SYMBOLS) && p->symbols) {
+		o->symbols = p->symbols (bf); // 5s
+		if (o->symbols) {
+			o->symbols->free = r_bin_symbol_free;
+			REBASE_PADDR (o, o->symbols, RBinSymbol);
+			if (bin->filter) {
+				r_bin_filter_symbols (bf, o->symbols); // 5s
+			}
+		}
+	}
+	if ((todo & R_BIN_REQ_LIBS) && p->libs) {
+		o->libs = p->libs (bf);
+	}
+	if ((todo & R_BIN_REQ_RELOCS) && p->relocs) {
+		RList *l = p->relocs (bf);
+		if (l) {
+			REBASE_PADDR (o, l, RBinReloc);
+			o->relocs = list2rbtree (l);
+			l->free = NULL;
+			r_list_free (l);
+		}
+	}
+	if (todo & R_BIN_REQ_STRINGS) {
+		int minlen = (bin->minstrlen > 0) ? bin->minstrlen : p->minstrlen;
+		o->strings = p->strings
+			? p->strings (bf)
+			: r_bin_file_get_strings (bf, minlen, 0, bf->rawstr);
+		if (bin->debase64) {
+			r_bin_object_filter_strings (o);
+		}
+		REBASE_PADDR (o, o->strings, RBinString);
+	}
+	if (todo & R_BIN_REQ_CLASSES) {
+		load_classes (bf, o);
+	}
+	if ((todo & R_BIN_REQ_SRCLINE) && p->lines) {
+		o->lines = p->lines (bf);
+	}
+	if (todo & R_BIN_REQ_INFO) {
+		lang = o->swift? R_BIN_NM_SWIFT: r_bin_load_languages (bf);
+		if (bin->lazy && o->info && !o->info->lang) {
+			// r_bin_file_set_obj did this before the language was known
+			o->info->lang = r_bin_lang_tostring (lang);
+		}
+	}
+	o->lang = lang;
+	bf->o = bo;
+}
+
 R_API int r_bin_object_set_items(RBinFile *bf, RBinObject *o) {
 	r_return_val_if_fail (bf && o && o->plugin, false);
 
 	int i;
-	bool isSwift = false;
 	RBin *bin = bf->rbin;
 	RBinPlugin *p = o->plugin;
-	int minlen = (bf->rbin->minstrlen > 0) ? bf->rbin->minstrlen : p->minstrlen;
 	bf->o = o;
 
 	if (p->file_type) {
@@ -290,33 +437,26 @@ R_API int r_bin_object_set_items(RBinFile *bf, RBinObject *o) {
 		o->entries = p->entries (bf);
 		REBASE_PADDR (o, o->entries, RBinAddr);
 	}
-	if (p->fields) {
-		o->fields = p->fields (bf);
-		if (o->fields) {
-			o->fields->free = r_bin_field_free;
-			REBASE_PADDR (o, o->fields, RBinField);
-		}
+	o->pending = LAZY_ITEMS;
+	if (!(bin->filter_rules & (R_BIN_REQ_RELOCS | R_BIN_REQ_IMPORTS))) {
+		o->pending &= ~R_BIN_REQ_RELOCS;
 	}
-	if (p->imports) {
-		r_list_free (o->imports);
-		o->imports = p->imports (bf);
-		if (o->imports) {
-			o->imports->free = r_bin_import_free;
-		}
+	if (!(bin->filter_rules & R_BIN_REQ_STRINGS)) {
+		o->pending &= ~R_BIN_REQ_STRINGS;
 	}
-	if (p->symbols) {
-		o->symbols = p->symbols (bf); // 5s
-		if (o->symbols) {
-			o->symbols->free = r_bin_symbol_free;
-			REBASE_PADDR (o, o->symbols, RBinSymbol);
-			if (bin->filter) {
-				r_bin_filter_symbols (bf, o->symbols); // 5s
-			}
-		}
+	if (!(bin->filter_rules & R_BIN_REQ_CLASSES)) {
+		o->pending &= ~R_BIN_REQ_CLASSES;
+	}
+	if (!(bin->filter_rules & (R_BIN_REQ_INFO | R_BIN_REQ_SYMBOLS | R_BIN_REQ_IMPORTS))) {
+		o->pending &= ~R_BIN_REQ_INFO;
+	}
+	o->swift = false;
+	if (!bin->lazy) {
+		r_bin_object_load_items (bf, o, R_BIN_REQ_FIELDS | R_BIN_REQ_IMPORTS | R_BIN_REQ_SYMBOLS);
 	}
 	o->info = p->info? p->info (bf): NULL;
-	if (p->libs) {
-		o->libs = p->libs (bf);
+	if (!bin->lazy) {
+		r_bin_object_load_items (bf, o, R_BIN_REQ_LIBS);
 	}
 	if (p->sections) {
 		// XXX sections are populated by call to size
@@ -328,68 +468,9 @@ R_API int r_bin_object_set_items(RBinFile *bf, RBinObject *o) {
 			r_bin_filter_sections (bf, o->sections);
 		}
 	}
-	if (bin->filter_rules & (R_BIN_REQ_RELOCS | R_BIN_REQ_IMPORTS)) {
-		if (p->relocs) {
-			RList *l = p->relocs (bf);
-			if (l) {
-				REBASE_PADDR (o, l, RBinReloc);
-				o->relocs = list2rbtree (l);
-				l->free = NULL;
-				r_list_free (l);
-			}
-		}
-	}
-	if (bin->filter_rules & R_BIN_REQ_STRINGS) {
-		o->strings = p->strings
-			? p->strings (bf)
-			: r_bin_file_get_strings (bf, minlen, 0, bf->rawstr);
-		if (bin->debase64) {
-			r_bin_object_filter_strings (o);
-		}
-		REBASE_PADDR (o, o->strings, RBinString);
-	}
-	if (bin->filter_rules & R_BIN_REQ_CLASSES) {
-		if (p->classes) {
-			RList *classes = p->classes (bf);
-			if (classes) {
-				// XXX we should probably merge them instead
-				r_list_free (o->classes);
-				o->classes = classes;
-			}
-			isSwift = r_bin_lang_swift (bf);
-			if (isSwift) {
-				o->classes = classes_from_symbols (bf);
-			}
-		} else {
-			RList *classes = classes_from_symbols (bf);
-			if (classes) {
-				o->classes = classes;
-			}
-		}
-		if (bin->filter) {
-			filter_classes (bf, o->classes);
-		}
-		// cache addr=class+method
-		if (o->classes) {
-			RList *klasses = o->classes;
-			RListIter *iter, *iter2;
-			RBinClass *klass;
-			RBinSymbol *method;
-			if (!o->addr2klassmethod) {
-				// this is slow. must be optimized, but at least its cached
-				o->addr2klassmethod = sdb_new0 ();
-				r_list_foreach (klasses, iter, klass) {
-					r_list_foreach (klass->methods, iter2, method) {
-						char *km = sdb_fmt ("method.%s.%s", klass->name, method->name);
-						char *at = sdb_fmt ("0x%08"PFMT64x, method->vaddr);
-						sdb_set (o->addr2klassmethod, at, km, 0);
-					}
-				}
-			}
-		}
-	}
-	if (p->lines) {
-		o->lines = p->lines (bf);
+	if (!bin->lazy) {
+		r_bin_object_load_items (bf, o, R_BIN_REQ_RELOCS | R_BIN_REQ_STRINGS
+			| R_BIN_REQ_CLASSES | R_BIN_REQ_SRCLINE);
 	}
 	if (p->get_sdb) {
 		Sdb* new_kv = p->get_sdb (bf);
@@ -401,8 +482,8 @@ R_API int r_bin_object_set_items(RBinFile *bf, RBinObject *o) {
 	if (p->mem)  {
 		o->mem = p->mem (bf);
 	}
-	if (bin->filter_rules & (R_BIN_REQ_INFO | R_BIN_REQ_SYMBOLS | R_BIN_REQ_IMPORTS)) {
-		o->lang = isSwift? R_BIN_NM_SWIFT: r_bin_load_languages (bf);
+	if (!bin->lazy) {
+		r_bin_object_load_items (bf, o, R_BIN_REQ_INFO);
 	}
 	return true;
 }
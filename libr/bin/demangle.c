@@ -82,6 +82,7 @@ R_API char *r_bin_demangle(RBinFile *binfile, const char *def, const char *str,
 		str += 4;
 	}
 	if (o) {
+		r_bin_object_load_items (binfile, o, R_BIN_REQ_LIBS);
 		r_list_foreach (o->libs, iter, lib) {
 			size_t len = strlen (lib);
 			if (!r_str_ncasecmp (str, lib, len)) {
@@ -8,6 +8,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include "grep_private.h"
 #if __UNIX__
 #include <signal.h>
 #endif
@@ -129,6 +130,7 @@ static void __break_signal(int sig) {
 }
 
 static inline void __cons_write_ll(const char *buf, int len) {
+	R_PROF_ADD (R_PROF_CONS_BYTES, len);
 #if __WINDOWS__
 	if (I.ansicon) {
 		(void) write (I.fdout, buf, len);
@@ -831,6 +833,91 @@ static bool lastMatters() {
 		!I.context->grep.json && !I.is_html);
 }
 
+static void cons_tee(const char *tee) {
+	if (tee && *tee) {
+		FILE *d = r_sandbox_fopen (tee, "a+");
+		if (d) {
+			if (I.context->buffer_len != fwrite (I.context->buffer, 1, I.context->buffer_len, d)) {
+				eprintf ("r_cons_flush: fwrite: error (%s)\n", tee);
+			}
+			fclose (d);
+		} else {
+			eprintf ("Cannot write on '%s'\n", tee);
+		}
+	}
+}
+
+/* streaming is only safe when every filter in the way works line by line */
+static bool cons_stream_ready(void) {
+	if (I.noflush || I.null || I.filter || I.linesleep > 0 || I.stream_hold) {
+		return false;
+	}
+	if (I.context->buffer[I.context->buffer_len - 1] != '\n') {
+		return false;
+	}
+	if (!r_cons_context_is_main () || !r_stack_is_empty (I.context->cons_stack)) {
+		return false;
+	}
+	if (I.context->grep_depth > 1) {
+		return false;
+	}
+	if (r_cons_is_interactive () && I.pager && *I.pager) {
+		return false;
+	}
+	return I.stream != 2 || !r_cons_isatty ();
+}
+
+static bool cons_grep_streamable(RConsGrep *grep) {
+	if (grep->nstrings > 0 || grep->tokens_used || grep->less || grep->json) {
+		return !grep->counter && !grep->less && !grep->json && grep->sort == -1 && grep->range_line == 2;
+	}
+	return true;
+}
+
+/* write out the complete lines accumulated so far and keep the grep state */
+static void cons_stream_flush(void) {
+	RConsGrep grep;
+	if (!cons_stream_ready ()) {
+		return;
+	}
+	bool pending = grep_pending_load (&grep);
+	if (!cons_grep_streamable (&I.context->grep)) {
+		if (pending) {
+			grep_pending_unload (&grep);
+		}
+		return;
+	}
+	I.noflush++;
+	r_cons_filter ();
+	if (I.is_html && I.context->buffer_len > 0 && I.context->buffer[I.context->buffer_len - 1] == '\n') {
+		// the output continues, so the filter must not end it
+		I.context->buffer_len--;
+		if (palloc (8)) {
+			memcpy (I.context->buffer + I.context->buffer_len, "<br />", 7);
+			I.context->buffer_len += 6;
+		}
+	}
+	cons_tee (I.teefile);
+	r_cons_highlight (I.highlight);
+	__cons_write (I.context->buffer, I.context->buffer_len);
+	if (I.context->buffer) {
+		I.context->buffer[0] = '\0';
+	}
+	I.context->buffer_len = 0;
+	I.lastline = I.context->buffer;
+	I.streamed = true;
+	I.noflush--;
+	if (pending) {
+		grep_pending_unload (&grep);
+	}
+}
+
+static inline void cons_stream(void) {
+	if (I.stream && I.context->buffer_len >= CONS_STREAM_CHUNK) {
+		cons_stream_flush ();
+	}
+}
+
 R_API void r_cons_flush(void) {
 	const char *tee = I.teefile;
 	if (I.noflush) {
@@ -840,7 +927,13 @@ R_API void r_cons_flush(void) {
 		r_cons_reset ();
 		return;
 	}
-	if (lastMatters () && !CTX (lastMode)) {
+	if (I.streamed) {
+		// the snapshot would only hold the tail of the output
+		I.streamed = false;
+		R_FREE (CTX (lastOutput));
+		CTX (lastLength) = 0;
+		CTX (lastMode) = false;
+	} else if (lastMatters () && !CTX (lastMode)) {
 		// snapshot of the output
 		if (CTX (buffer_len) > CTX (lastLength)) {
 			free (CTX (lastOutput));
@@ -891,17 +984,7 @@ R_API void r_cons_flush(void) {
 			r_cons_set_raw (true);
 		}
 	}
-	if (tee && *tee) {
-		FILE *d = r_sandbox_fopen (tee, "a+");
-		if (d) {
-			if (I.context->buffer_len != fwrite (I.context->buffer, 1, I.context->buffer_len, d)) {
-				eprintf ("r_cons_flush: fwrite: error (%s)\n", tee);
-			}
-			fclose (d);
-		} else {
-			eprintf ("Cannot write on '%s'\n", tee);
-		}
-	}
+	cons_tee (tee);
 	r_cons_highlight (I.highlight);
 
 	// is_html must be a filter, not a write endpoint
@@ -1094,6 +1177,7 @@ club:
 			}
 			I.context->buffer_len += written;
 			I.context->buffer[I.context->buffer_len] = 0;
+			cons_stream ();
 		}
 	} else {
 		r_cons_strcat (format);
@@ -1144,6 +1228,8 @@ R_API int r_cons_memcat(const char *str, int len) {
 	}
 	if (I.flush) {
 		r_cons_flush ();
+	} else {
+		cons_stream ();
 	}
 	if (I.break_word && str && len > 0) {
 		if (r_mem_mem ((const ut8*)str, len, (const ut8*)I.break_word, I.break_word_len)) {
@@ -1160,6 +1246,7 @@ R_API void r_cons_memset(char ch, int len) {
 			I.context->buffer_len += len;
 			I.context->buffer[I.context->buffer_len] = 0;
 		}
+		cons_stream ();
 	}
 }
 
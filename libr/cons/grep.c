@@ -4,6 +4,7 @@
 #include <r_util.h>
 #include <r_util/r_print.h>
 #include <sdb.h>
+#include "grep_private.h"
 
 #define I(x) r_cons_singleton ()->x
 
@@ -395,16 +396,47 @@ R_API char *r_cons_grep_strip(char *cmd, const char *quotestr) {
 		ptr = preprocess_filter_expr (cmd, quotestr);
 		r_str_trim (cmd);
 	}
+	if (ptr) {
+		RConsContext *ctx = r_cons_singleton ()->context;
+		if (!ctx->grep_depth++) {
+			ctx->grep_pending = ptr;
+		}
+	}
 	return ptr;
 }
 
 R_API void r_cons_grep_process(char * grep) {
 	if (grep) {
+		RConsContext *ctx = r_cons_singleton ()->context;
+		if (ctx->grep_depth > 0 && !--ctx->grep_depth) {
+			ctx->grep_pending = NULL;
+		}
 		parse_grep_expression (grep);
 		free (grep);
 	}
 }
 
+/* parse the grep of the running command ahead of time, so the chunks
+ * streamed before it finishes get filtered the same way */
+R_IPI bool grep_pending_load(RConsGrep *saved) {
+	RConsContext *ctx = r_cons_singleton ()->context;
+	if (!ctx->grep_pending) {
+		return false;
+	}
+	*saved = ctx->grep;
+	ctx->grep.str = NULL;
+	ctx->grep.json_path = NULL;
+	parse_grep_expression (ctx->grep_pending);
+	return true;
+}
+
+R_IPI void grep_pending_unload(RConsGrep *saved) {
+	RConsContext *ctx = r_cons_singleton ()->context;
+	free (ctx->grep.str);
+	free (ctx->grep.json_path);
+	ctx->grep = *saved;
+}
+
 static int cmp(const void *a, const void *b) {
 	char *da = NULL;
 	char *db = NULL;
@@ -0,0 +1,7 @@
+#ifndef GREP_PRIVATE_H
+#define GREP_PRIVATE_H
+
+R_IPI bool grep_pending_load(RConsGrep *saved);
+R_IPI void grep_pending_unload(RConsGrep *saved);
+
+#endif
@@ -38,6 +38,7 @@ static void loganal(ut64 from, ut64 to, int depth) {
 static char *getFunctionName(RCore *core, ut64 addr) {
 	RBinFile *bf = r_bin_cur (core->bin);
 	if (bf && bf->o) {
+		r_bin_object_load_items (bf, bf->o, R_BIN_REQ_CLASSES);
 		Sdb *kv = bf->o->addr2klassmethod;
 		char *at = sdb_fmt ("0x%08"PFMT64x, addr);
 		char *res = sdb_get (kv, at, 0);
@@ -715,7 +716,6 @@ static int core_anal_fcn(RCore *core, ut64 at, ut64 from, int reftype, int depth
 	if (!fcn->name) {
 		fcn->name = r_str_newf ("%s.%08"PFMT64x, fcnpfx, at);
 	}
-	r_anal_fcn_invalidate_read_ahead_cache ();
 	do {
 		RFlagItem *f;
 		int delta = r_anal_fcn_size (fcn);
@@ -1598,6 +1598,8 @@ R_API int r_core_anal_bb(RCore *core, RAnalFunction *fcn, ut64 addr, int head) {
 			}
 			if (bblen == R_ANAL_RET_END) { /* bb analysis complete */
 				ret = r_anal_fcn_bb_overlaps (fcn, bb);
+				// the block belongs to fcn in both cases
+				r_anal_bb_tree_insert (core->anal, bb);
 				if (ret == R_ANAL_RET_NEW) {
 					r_anal_fcn_bbadd (fcn, bb);
 					fail = bb->fail;
@@ -2040,7 +2042,7 @@ R_API void r_core_anal_importxrefs(RCore *core) {
 	if (!obj) {
 		return;
 	}
-	r_list_foreach (obj->imports, iter, imp) {
+	r_list_foreach (r_bin_get_imports (core->bin), iter, imp) {
 		ut64 addr = lit ? r_core_bin_impaddr (core->bin, va, imp->name): 0;
 		if (addr) {
 			r_core_anal_codexrefs (core, addr);
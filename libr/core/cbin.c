@@ -591,6 +591,8 @@ static int bin_info(RCore *r, int mode, ut64 laddr) {
 		}
 		return false;
 	}
+	// the language is detected on first use in lazy mode
+	r_bin_object_load_items (bf, obj, R_BIN_REQ_INFO);
 	havecode = is_executable (obj) | (obj->entries != NULL);
 	compiled = get_compile_time (bf->sdb);
 
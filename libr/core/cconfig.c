@@ -95,6 +95,20 @@ fail:
 	return false;
 }
 
+static bool cb_zigncache(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	core->anal->zign_cache = node->i_value;
+	return true;
+}
+
+static bool cb_diff_jobs(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	core->anal->diff_jobs = node->i_value;
+	return true;
+}
+
 static const char *has_esil(RCore *core, const char *name) {
 	RListIter *iter;
 	RAnalPlugin *h;
@@ -834,6 +848,13 @@ static bool cb_binfilter(void *user, void *data) {
 	return true;
 }
 
+static bool cb_binlazy(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	core->bin->lazy = node->i_value;
+	return true;
+}
+
 /* BinDemangleCmd */
 static bool cb_bdc(void *user, void *data) {
 	RCore *core = (RCore*) user;
@@ -908,6 +929,13 @@ static bool cb_midflags (void *user, void *data) {
 	return true;
 }
 
+static bool cb_strjobs(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	core->bin->strjobs = node->i_value;
+	return true;
+}
+
 static bool cb_strfilter(void *user, void *data) {
 	RCore *core = (RCore*) user;
 	RConfigNode *node = (RConfigNode*) data;
@@ -1377,6 +1405,16 @@ static bool cb_gotolimit(void *user, void *data) {
 	return true;
 }
 
+static bool cb_esilcompile(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode*) data;
+	core->anal->esil_compile = node->i_value;
+	if (core->anal->esil) {
+		r_anal_esil_code_flush (core->anal->esil);
+	}
+	return true;
+}
+
 static bool cb_esilverbose (void *user, void *data) {
 	RCore *core = (RCore *) user;
 	RConfigNode *node = (RConfigNode*) data;
@@ -1940,6 +1978,16 @@ static bool cb_scrhtml(void *user, void *data) {
 	return true;
 }
 
+static bool cb_scrstream(void *user, void *data) {
+	RConfigNode *node = (RConfigNode *) data;
+	if (!strcmp (node->value, "auto")) {
+		r_cons_singleton ()->stream = 2;
+	} else {
+		r_cons_singleton ()->stream = r_str_is_true (node->value);
+	}
+	return true;
+}
+
 static bool cb_scrhighlight(void *user, void *data) {
 	RConfigNode *node = (RConfigNode *) data;
 	r_cons_highlight (node->value);
@@ -2750,6 +2798,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETCB ("anal.jmp.eob", "false", &cb_analeobjmp, "jmp is end of block mode (option)");
 	SETCB ("anal.jmp.after", "true", &cb_analafterjmp, "Continue analysis after jmp/ujmp");
 	SETCB ("anal.endsize", "true", &cb_anal_endsize, "Adjust function size at the end of the analysis (known to be buggy)");
+	SETI ("anal.jobs", 1, "Threads decoding the aac call sweep ahead, functions are still analyzed serially (1 = serial)");
 	SETICB ("anal.depth", 64, &cb_analdepth, "Max depth at code analysis"); // XXX: warn if depth is > 50 .. can be problematic
 	SETICB ("anal.graph_depth", 256, &cb_analgraphdepth, "Max depth for path search");
 	SETICB ("anal.sleep", 0, &cb_analsleep, "Sleep N usecs every so often during analysis. Avoid 100% CPU usage");
@@ -2819,6 +2868,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("esil.fillstack", "", "Initialize ESIL stack with (random, debrujn, sequence, zeros, ...)");
 	SETICB ("esil.verbose", 0, &cb_esilverbose, "Show ESIL verbose level (0, 1, 2)");
 	SETICB ("esil.gotolimit", core->anal->esil_goto_limit, &cb_gotolimit, "Maximum number of gotos per ESIL expression");
+	SETCB ("esil.compile", "true", &cb_esilcompile, "Compile ESIL expressions once and cache them per instruction address");
 	SETICB ("esil.stack.depth", 32, &cb_esilstackdepth, "Number of elements that can be pushed on the esilstack");
 	SETI ("esil.stack.size", 0xf0000, "Set stack size in ESIL VM");
 	SETI ("esil.stack.addr", 0x100000, "Set stack address in ESIL VM");
@@ -2867,6 +2917,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("asm.dwarf.file", "true", "Show filename of asm.dwarf in pd");
 	SETPREF ("asm.esil", "false", "Show ESIL instead of mnemonic");
 	SETPREF ("asm.nodup", "false", "Do not show dupped instructions (collapse disasm)");
+	SETPREF ("asm.cache", "false", "Reuse the decoded instructions across disasm calls (faster visual scroll)");
 	SETPREF ("asm.emu", "false", "Run ESIL emulation analysis on disasm");
 	SETPREF ("emu.pre", "false", "Run ESIL emulation starting at the closest flag in pd");
 	SETPREF ("asm.refptr", "true", "Show refpointer information in disasm");
@@ -2990,6 +3041,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("bin.hashlimit", "10M", "Only compute hash when opening a file if smaller than this size");
 	SETCB ("bin.usextr", "true", &cb_usextr, "Use extract plugins when loading files");
 	SETCB ("bin.useldr", "true", &cb_useldr, "Use loader plugins when loading files");
+	SETICB ("bin.str.jobs", 1, &cb_strjobs, "Threads used to scan big ranges for strings (1 = serial)");
 	SETCB ("bin.str.purge", "", &cb_strpurge, "Purge strings (e bin.str.purge=? provides more detail)");
 	SETPREF ("bin.b64str", "false", "Try to debase64 the strings");
 	SETCB ("bin.at", "false", &cb_binat, "RBin.cur depends on RCore.offset");
@@ -2998,6 +3050,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETDESC (n, "Filter strings");
 	SETOPTIONS (n, "a", "8", "p", "e", "u", "i", "U", "f", NULL);
 	SETCB ("bin.filter", "true", &cb_binfilter, "Filter symbol names to fix dupped names");
+	SETCB ("bin.lazy", "false", &cb_binlazy, "Load symbols, imports, strings and classes when first used");
 	SETCB ("bin.force", "", &cb_binforce, "Force that rbin plugin");
 	SETPREF ("bin.lang", "", "Language for bin.demangle");
 	SETPREF ("bin.demangle", "true", "Import demangled symbols from RBin");
@@ -3026,6 +3079,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("prj.zip", "false", "Use ZIP format for project files");
 	SETPREF ("prj.gpg", "false", "TODO: Encrypt project with GnuPGv2");
 	SETPREF ("prj.simple", "false", "Use simple project saving style (functions, comments, options)");
+	SETPREF ("prj.snapshot", "true", "Save the analysis in a binary snapshot next to the project script");
 
 	/* cfg */
 	SETPREF ("cfg.r2wars", "false", "Enable some tweaks for the r2wars game");
@@ -3086,6 +3140,8 @@ R_API int r_core_config_init(RCore *core) {
 	SETI ("zign.maxsz", 500, "Maximum zignature length");
 	SETI ("zign.minsz", 16, "Minimum zignature length for matching");
 	SETI ("zign.mincc", 10, "Minimum cyclomatic complexity for matching");
+	SETI ("zign.jobs", 1, "Threads used to match the functions in z/ (1 = serial)");
+	SETCB ("zign.cache", "false", &cb_zigncache, "Save the compiled byte zignatures next to the file loaded with zo, and reuse them");
 	SETPREF ("zign.graph", "true", "Use graph metrics for matching");
 	SETPREF ("zign.bytes", "true", "Use bytes patterns for matching");
 	SETPREF ("zign.offset", "true", "Use original offset for matching");
@@ -3100,6 +3156,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETI ("diff.from", 0, "Set source diffing address for px (uses cc command)");
 	SETI ("diff.to", 0, "Set destination diffing address for px (uses cc command)");
 	SETPREF ("diff.bare", "false", "Never show function names in diff output");
+	SETICB ("diff.jobs", 1, &cb_diff_jobs, "Threads used to score the function pairs in radiff2 -C (1 = serial)");
 	SETPREF ("diff.levenstein", "false", "Use faster (and buggy) levenstein algorithm for buffer distance diffing");
 
 	/* dir */
@@ -3282,6 +3339,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("http.sandbox", "true", "Sandbox the HTTP server");
 	SETI ("http.timeout", 3, "Disconnect clients after N seconds of inactivity");
 	SETI ("http.dietime", 0, "Kill server after N seconds with no client");
+	SETI ("http.workers", 0, "Serve from N forked processes running read-only commands concurrently (0: single loop)");
 	SETPREF ("http.verbose", "false", "Output server logs to stdout");
 	SETPREF ("http.upget", "false", "/up/ answers GET requests, in addition to POST");
 	SETPREF ("http.upload", "false", "Enable file uploads to /up/<filename>");
@@ -3394,6 +3452,9 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("scr.tts", "false", "Use tts if available by a command (see ic)");
 	SETCB ("scr.prompt", "true", &cb_scrprompt, "Show user prompt (used by r2 -q)");
 	SETCB ("scr.tee", "", &cb_teefile, "Pipe output to file of this name");
+	n = NODECB ("scr.stream", "auto", &cb_scrstream);
+	SETDESC (n, "Flush big outputs in chunks as they are printed (auto: when stdout is not a tty and there is no ~ grep)");
+	SETOPTIONS (n, "false", "true", "auto", NULL);
 	SETPREF ("scr.seek", "", "Seek to the specified address on startup");
 	SETICB ("scr.color", (core->print->flags&R_PRINT_FLAGS_COLOR)?COLOR_MODE_16:COLOR_MODE_DISABLED, &cb_color, "Enable colors (0: none, 1: ansi, 2: 256 colors, 3: truecolor)");
 	r_config_set_getter (cfg, "scr.color", (RConfigCallback)cb_color_getter);
@@ -3424,6 +3485,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("search.flags", "true", "All search results are flagged, otherwise only printed");
 	SETPREF ("search.overlap", "false", "Look for overlapped search hits");
 	SETI ("search.maxhits", 0, "Maximum number of hits (0: no limit)");
+	SETI ("search.jobs", 1, "Threads used to search keywords and crypto keys (1 = serial)");
 	SETI ("search.from", -1, "Search start address");
 	n = NODECB ("search.in", "io.maps", &cb_searchin);
 	SETDESC (n, "Specify search boundaries");
@@ -3446,6 +3508,8 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("rop.subchains", "false", "Display every length gadget from rop.len=X to 2 in /Rl");
 	SETPREF ("rop.conditional", "false", "Include conditional jump, calls and returns in ropsearch");
 	SETPREF ("rop.comments", "false", "Display comments in rop search output");
+	SETI ("rop.jobs", 1, "Threads used to find the end gadgets and decode the gadgets (1 = serial)");
+	SETPREF ("rop.cache", "false", "Keep the gadgets index of the searched ranges in ~/.cache/radare2/rop");
 
 	/* io */
 	SETCB ("io.cache", "false", &cb_io_cache, "Change both of io.cache.{read,write}");
@@ -191,6 +191,7 @@ static const char *help_msg_equalh[] = {
 	"=h--", "", "stop foreground webserver",
 	"=h*", "", "restart current webserver",
 	"=h&", " port", "start http server in background",
+	"=hs", "[j-]", "show requests/s and latency of the http server (json, reset)",
 	"=H", " port", "launch browser and listen for http",
 	"=H&", " port", "launch browser and listen for http in background",
 	NULL
@@ -601,6 +602,8 @@ static int cmd_rap(void *data, const char *input) {
 	case 'h': // "=h"
 		if (input[1] == '?') {
 			r_core_cmd_help (core, help_msg_equalh);
+		} else if (input[1] == 's') { // "=hs"
+			r_core_rtr_http_stats (core, input[2]);
 		} else {
 			r_core_rtr_http (core, getArg (input[1], 'h'), 'h', input + 1);
 		}
@@ -4106,6 +4109,12 @@ R_API int r_core_cmd(RCore *core, const char *cstr, int log) {
 		goto beach;
 	}
 	core->cmd_depth--;
+	// a trailing ~ filters the output of the whole line, which is only
+	// known after the first commands have printed, so do not stream it.
+	// auto mode does not stream any grepped line
+	RCons *cons = r_cons_singleton ();
+	bool stream_hold = strchr (cstr, '~') && (cons->stream == 2 || strpbrk (cstr, ";\n"));
+	cons->stream_hold += stream_hold;
 	for (rcmd = cmd;;) {
 		ptr = strchr (rcmd, '\n');
 		if (ptr) {
@@ -4121,6 +4130,7 @@ R_API int r_core_cmd(RCore *core, const char *cstr, int log) {
 		}
 		rcmd = ptr + 1;
 	}
+	cons->stream_hold -= stream_hold;
 	/* run pending analysis commands */
 	run_pending_anal (core);
 	core->cmd_depth++;
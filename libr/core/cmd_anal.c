@@ -5723,6 +5723,177 @@ ctrl_c:
 	r_cons_break_pop ();
 }
 
+#define ANAL_CALLS_CHUNK 0x10000
+// bytes prefetched past the end of the range for the last instructions
+#define ANAL_CALLS_PAD 64
+#define ANAL_CALLS_MAX 0x10000000
+#define ANAL_CALLS_ISCALL 0x80
+
+typedef struct {
+	ut64 addr;
+	ut64 jump;
+} AnalCallSite;
+
+/* Instructions in the range are decoded ahead of time by anal.jobs threads,
+ * ops[] holds the size of the instruction starting at each offset (0 when
+ * none was decoded there) and calls[] the call sites found in each chunk.
+ * The serial sweep in _anal_calls keeps driving the analysis, it just takes
+ * the decoded instructions from here, so the results do not depend on the
+ * amount of threads. Only this linear decode is parallel, the functions found
+ * from the call sites are still analyzed one at a time on the main thread. */
+typedef struct {
+	RAnal *anal;
+	ut64 addr;
+	ut64 size;
+	int minop;
+	ut8 *buf;
+	ut8 *ops;
+	int chunks;
+	RVector *calls;
+} AnalCallsSweep;
+
+static bool anal_calls_job(void *user, int job) {
+	AnalCallsSweep *s = user;
+	RVector *calls = &s->calls[job];
+	ut64 off = (ut64)job * ANAL_CALLS_CHUNK;
+	ut64 end = R_MIN (off + ANAL_CALLS_CHUNK, s->size);
+	RAnalOp op;
+	while (off < end) {
+		int len = (int)R_MIN (s->size + ANAL_CALLS_PAD - off, 4096);
+		int size = s->minop;
+		bool call = false;
+		if (r_anal_op (s->anal, &op, s->addr + off, s->buf + off, len, 0) > 0) {
+			if (op.size > 0) {
+				size = op.size;
+			}
+			call = op.type == R_ANAL_OP_TYPE_CALL;
+		}
+		if (size < ANAL_CALLS_ISCALL) {
+			s->ops[off] = size | (call? ANAL_CALLS_ISCALL: 0);
+			if (call) {
+				AnalCallSite cs = { s->addr + off, op.jump };
+				r_vector_push (calls, &cs);
+			}
+		}
+		r_anal_op_fini (&op);
+		off += size;
+	}
+	return true;
+}
+
+static void anal_calls_sweep_free(AnalCallsSweep *s) {
+	if (s) {
+		int i;
+		for (i = 0; i < s->chunks; i++) {
+			r_vector_clear (&s->calls[i]);
+		}
+		free (s->calls);
+		free (s->ops);
+		free (s->buf);
+		free (s);
+	}
+}
+
+// r_anal_op can be called from several threads for the whole io space
+static bool anal_op_threadsafe(RCore *core) {
+	RAnal *anal = core->anal;
+	if (!anal->cur || !anal->cur->threadsafe || anal->rb_hints_ranges) {
+		// bit hints make the decoding switch modes
+		return false;
+	}
+	if (core->io->addrbytes != 1) {
+		return false;
+	}
+	if (!core->fixedbits || !core->fixedarch) {
+		RListIter *iter;
+		RBinSection *s;
+		RList *sections = r_bin_get_sections (core->bin);
+		r_list_foreach (sections, iter, s) {
+			if (s->bits || s->arch) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static AnalCallsSweep *anal_calls_sweep(RCore *core, ut64 from, ut64 to, int minop) {
+	int jobs = r_config_get_i (core->config, "anal.jobs");
+	if (jobs < 2 || from >= to || to - from > ANAL_CALLS_MAX || !anal_op_threadsafe (core)) {
+		return NULL;
+	}
+	AnalCallsSweep *s = R_NEW0 (AnalCallsSweep);
+	if (!s) {
+		return NULL;
+	}
+	s->anal = core->anal;
+	s->addr = from;
+	s->size = to - from;
+	s->minop = minop;
+	s->chunks = (int)((s->size + ANAL_CALLS_CHUNK - 1) / ANAL_CALLS_CHUNK);
+	s->buf = malloc (s->size + ANAL_CALLS_PAD);
+	s->ops = calloc (1, s->size);
+	s->calls = R_NEWS0 (RVector, s->chunks);
+	RThreadPool *pool = r_th_pool_new (jobs);
+	if (!s->buf || !s->ops || !s->calls || !pool) {
+		r_th_pool_free (pool);
+		free (s->buf);
+		free (s->ops);
+		free (s->calls);
+		free (s);
+		return NULL;
+	}
+	int bits = r_config_get_i (core->config, "asm.bits");
+	if (bits != core->assembler->bits) {
+		r_config_set_i (core->config, "asm.bits", bits);
+	}
+	int i;
+	for (i = 0; i < s->chunks; i++) {
+		r_vector_init (&s->calls[i], sizeof (AnalCallSite), NULL, NULL);
+	}
+	(void)r_io_read_at (core->io, from, s->buf, s->size + ANAL_CALLS_PAD);
+	// plugins may initialize their tables on the first use
+	RAnalOp op;
+	r_anal_op (core->anal, &op, from, s->buf, ANAL_CALLS_PAD, 0);
+	r_anal_op_fini (&op);
+	// archbits writes the config, and it is a nop without section bits or hints
+	RCoreSeekArchBits archbits = core->anal->coreb.archbits;
+	core->anal->coreb.archbits = NULL;
+	r_th_pool_run (pool, s->chunks, anal_calls_job, s);
+	core->anal->coreb.archbits = archbits;
+	r_th_pool_free (pool);
+	return s;
+}
+
+// fills op from the sweep, returns 0 when the instruction must be decoded
+static int anal_calls_sweep_op(AnalCallsSweep *s, RAnalOp *op, ut64 addr) {
+	ut64 off = addr - s->addr;
+	ut8 o = s->ops[off];
+	if (!o) {
+		return 0;
+	}
+	r_anal_op_init (op);
+	op->addr = addr;
+	op->size = o & ~ANAL_CALLS_ISCALL;
+	if (o & ANAL_CALLS_ISCALL) {
+		RVector *calls = &s->calls[off / ANAL_CALLS_CHUNK];
+		size_t lo = 0, hi = calls->len;
+		while (lo < hi) {
+			size_t mid = lo + (hi - lo) / 2;
+			AnalCallSite *cs = r_vector_index_ptr (calls, mid);
+			if (cs->addr < addr) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		AnalCallSite *cs = r_vector_index_ptr (calls, lo);
+		op->type = R_ANAL_OP_TYPE_CALL;
+		op->jump = cs->jump;
+	}
+	return op->size;
+}
+
 static void _anal_calls(RCore *core, ut64 addr, ut64 addr_end, bool printCommands, bool importsOnly) {
 	RAnalOp op;
 	int depth = r_config_get_i (core->config, "anal.depth");
@@ -5749,6 +5920,7 @@ static void _anal_calls(RCore *core, ut64 addr, ut64 addr_end, bool printCommand
 		minop = 1;
 	}
 	int setBits = r_config_get_i (core->config, "asm.bits");
+	AnalCallsSweep *sweep = anal_calls_sweep (core, addr, addr_end, minop);
 	r_cons_break_push (NULL, NULL);
 	while (addr < addr_end && !r_cons_is_breaked ()) {
 		// TODO: too many ioreads here
@@ -5763,14 +5935,18 @@ static void _anal_calls(RCore *core, ut64 addr, ut64 addr_end, bool printCommand
 			addr += bsz;
 			continue;
 		}
-		RAnalHint *hint = r_anal_hint_get (core->anal, addr);
+		RAnalHint *hint = sweep? NULL: r_anal_hint_get (core->anal, addr);
 		if (hint && hint->bits) {
 			setBits = hint->bits;
 		}
 		if (setBits != core->assembler->bits) {
 			r_config_set_i (core->config, "asm.bits", setBits);
 		}
-		if (r_anal_op (core->anal, &op, addr, buf + bufi, bsz - bufi, 0) > 0) {
+		int ret = sweep? anal_calls_sweep_op (sweep, &op, addr): 0;
+		if (!ret) {
+			ret = r_anal_op (core->anal, &op, addr, buf + bufi, bsz - bufi, 0);
+		}
+		if (ret > 0) {
 			if (op.size < 1) {
 				op.size = minop;
 			}
@@ -5803,6 +5979,11 @@ static void _anal_calls(RCore *core, ut64 addr, ut64 addr_end, bool printCommand
 						if (r_io_is_valid_offset (core->io, op.jump, 1)) {
 							r_core_anal_fcn (core, op.jump, addr, R_ANAL_REF_TYPE_CALL, depth);
 						}
+						if (sweep && core->anal->rb_hints_ranges) {
+							// the analysis added bit hints, decode the rest here
+							anal_calls_sweep_free (sweep);
+							sweep = NULL;
+						}
 					}
 #endif
 				}
@@ -5818,6 +5999,7 @@ static void _anal_calls(RCore *core, ut64 addr, ut64 addr_end, bool printCommand
 		r_anal_op_fini (&op);
 	}
 	r_cons_break_pop ();
+	anal_calls_sweep_free (sweep);
 	free (buf);
 	free (block0);
 	free (block1);
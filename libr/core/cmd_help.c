@@ -153,6 +153,8 @@ static const char *help_msg_question[] = {
 	"?s", " from to step", "sequence of numbers from to by steps",
 	"?t", " cmd", "returns the time to run a command",
 	"?T", "", "show loading times",
+	"?Tc", "[j] [cmd]", "show the hot path counters (PROF=1 builds), or what cmd added to them",
+	"?Tc-", "", "reset the hot path counters",
 	"?u", " num", "get value in human units (KB, MB, GB, TB)",
 	"?v", " eip-0x804800", "show hex value of math expr",
 	"?vi", " rsp-rbp", "show decimal value of math expr",
@@ -381,6 +383,102 @@ R_API void r_core_clippy(const char *msg) {
 	free (s);
 }
 
+static void prof_print(RProfCounters *c, PJ *pj) {
+	int i;
+	for (i = 0; i < R_PROF_LAST; i++) {
+		const char *name = r_prof_name (i);
+		bool timed = r_prof_timed (i);
+		double ms = r_prof_ticks_to_ms (c->ticks[i]);
+		if (pj) {
+			pj_k (pj, name);
+			pj_o (pj);
+			pj_kn (pj, "count", c->count[i]);
+			if (timed) {
+				pj_kd (pj, "ms", ms);
+			}
+			pj_end (pj);
+		} else if (timed) {
+			r_cons_printf ("%-12s %12"PFMT64u" %12.3f ms\n", name, c->count[i], ms);
+		} else {
+			r_cons_printf ("%-12s %12"PFMT64u"\n", name, c->count[i]);
+		}
+	}
+}
+
+/* ?Tc: the R_PROF counters, summed over all threads, then per thread */
+static void cmd_help_prof(RCore *core, const char *input) {
+	RProfCounters before, after;
+	PJ *pj = NULL;
+	int i, j, used = 0;
+	if (!r_prof_enabled ()) {
+		eprintf ("The hot path counters are compiled out, rebuild with PROF=1\n");
+		return;
+	}
+	if (*input == '-') {
+		r_prof_reset ();
+		return;
+	}
+	if (*input == 'j') {
+		pj = pj_new ();
+		input++;
+	}
+	input = r_str_trim_ro (input);
+	if (*input) {
+		r_prof_total (&before);
+		r_core_cmd (core, input, 0);
+		r_cons_flush ();
+		r_prof_total (&after);
+		for (j = 0; j < R_PROF_LAST; j++) {
+			after.count[j] -= before.count[j];
+			after.ticks[j] -= before.ticks[j];
+		}
+	} else {
+		r_prof_total (&after);
+	}
+	if (pj) {
+		pj_o (pj);
+		pj_ks (pj, "clock", r_prof_clock ());
+		pj_k (pj, "total");
+		pj_o (pj);
+		prof_print (&after, pj);
+		pj_end (pj);
+	} else {
+		prof_print (&after, NULL);
+	}
+	for (i = 0; i < R_PROF_SLOTS; i++) {
+		used += r_prof_slot (i)? 1: 0;
+	}
+	if (!*input && used > 1) {
+		if (pj) {
+			pj_k (pj, "threads");
+			pj_a (pj);
+		}
+		for (i = 0; i < R_PROF_SLOTS; i++) {
+			RProfCounters *c = r_prof_slot (i);
+			if (!c) {
+				continue;
+			}
+			if (pj) {
+				pj_o (pj);
+				pj_ki (pj, "slot", i);
+				prof_print (c, pj);
+				pj_end (pj);
+			} else {
+				r_cons_printf ("# slot %d\n", i);
+				prof_print (c, NULL);
+			}
+		}
+		if (pj) {
+			pj_end (pj);
+		}
+	}
+	if (pj) {
+		pj_end (pj);
+		r_cons_println (pj_string (pj));
+		pj_free (pj);
+	}
+}
+
 static int cmd_help(void *data, const char *input) {
 	RCore *core = (RCore *)data;
 	RIOMap *map;
@@ -500,6 +598,10 @@ static int cmd_help(void *data, const char *input) {
 		r_cons_printf ("0%"PFMT64o"\n", n);
 		break;
 	case 'T': // "?T"
+		if (input[1] == 'c') {
+			cmd_help_prof (core, input + 2);
+			break;
+		}
 		r_cons_printf("plug.init = %"PFMT64d"\n"
 			"plug.load = %"PFMT64d"\n"
 			"file.load = %"PFMT64d"\n",
@@ -658,8 +658,8 @@ static int cmd_info(void *data, const char *input) {
 			RBININFO ("fields", R_CORE_BIN_ACC_FIELDS, NULL, 0);
 			break;
 		case 'l': { // "il"
-			RBinObject *obj = r_bin_cur_object (core->bin);
-			RBININFO ("libs", R_CORE_BIN_ACC_LIBS, NULL, (obj && obj->libs)? r_list_length (obj->libs): 0);
+			RList *libs = r_bin_get_libs (core->bin);
+			RBININFO ("libs", R_CORE_BIN_ACC_LIBS, NULL, libs? r_list_length (libs): 0);
 			break;
 		}
 		case 'L': { // "iL"
@@ -679,16 +679,16 @@ static int cmd_info(void *data, const char *input) {
 			goto done;
 		}
 		case 's': { // "is"
-			RBinObject *obj = r_bin_cur_object (core->bin);
+			RList *symbols = r_bin_get_symbols (core->bin);
 			// Case for isj.
 			if (input[1] == 'j' && input[2] == '.') {
 				mode = R_MODE_JSON;
-				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 2, (obj && obj->symbols)? r_list_length (obj->symbols): 0);
+				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 2, symbols? r_list_length (symbols): 0);
 			} else if (input[1] == 'q' && input[2] == 'q') {
 				mode = R_MODE_SIMPLEST;
-				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 1, (obj && obj->symbols)? r_list_length (obj->symbols): 0);
+				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 1, symbols? r_list_length (symbols): 0);
 			} else {
-				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 1, (obj && obj->symbols)? r_list_length (obj->symbols): 0);
+				RBININFO ("symbols", R_CORE_BIN_ACC_SYMBOLS, input + 1, symbols? r_list_length (symbols): 0);
 			}
 			while (*(++input)) ;
 			input--;
@@ -810,9 +810,9 @@ static int cmd_info(void *data, const char *input) {
 			}
 			break;
 		case 'i': { // "ii"
-			RBinObject *obj = r_bin_cur_object (core->bin);
+			RList *imports = r_bin_get_imports (core->bin);
 			RBININFO ("imports", R_CORE_BIN_ACC_IMPORTS, NULL,
-				(obj && obj->imports)? r_list_length (obj->imports): 0);
+				imports? r_list_length (imports): 0);
 			break;
 		}
 		case 'I': // "iI"
@@ -895,6 +895,7 @@ static int cmd_info(void *data, const char *input) {
 				RBININFO ("strings", R_CORE_BIN_ACC_RAW_STRINGS, NULL, 0);
 			} else {
 				RBinObject *obj = r_bin_cur_object (core->bin);
+				RList *strings = r_bin_get_strings (core->bin);
 				if (input[1] == 'q') {
 					mode = (input[2] == 'q')
 					? R_MODE_SIMPLEST
@@ -903,7 +904,7 @@ static int cmd_info(void *data, const char *input) {
 				}
 				if (obj) {
 					RBININFO ("strings", R_CORE_BIN_ACC_STRINGS, NULL,
-						(obj && obj->strings)? r_list_length (obj->strings): 0);
+						strings? r_list_length (strings): 0);
 				}
 			}
 			break;
@@ -916,6 +917,7 @@ static int cmd_info(void *data, const char *input) {
 				RBinSymbol *sym;
 				RListIter *iter, *iter2;
 				RBinObject *obj = r_bin_cur_object (core->bin);
+				RList *classes = r_bin_get_classes (core->bin);
 				if (obj) {
 					if (input[2]) {
 						bool radare2 = strstr (input, "**") != NULL;
@@ -937,7 +939,7 @@ static int cmd_info(void *data, const char *input) {
 							input++;
 						}
 						int count = 0;
-						r_list_foreach (obj->classes, iter, cls) {
+						r_list_foreach (classes, iter, cls) {
 							if (radare2) {
 								r_cons_printf ("ac %s\n", cls->name);
 								r_list_foreach (cls->methods, iter2, sym) {
@@ -997,10 +999,10 @@ static int cmd_info(void *data, const char *input) {
 							goto done;
 						}
 						goto done;
-					} else if (obj->classes) {
-						playMsg (core, "classes", r_list_length (obj->classes));
+					} else if (classes) {
+						playMsg (core, "classes", r_list_length (classes));
 						if (input[1] == 'l' && obj) { // "icl"
-							r_list_foreach (obj->classes, iter, cls) {
+							r_list_foreach (classes, iter, cls) {
 								r_list_foreach (cls->methods, iter2, sym) {
 									const char *comma = iter2->p? " ": "";
 									r_cons_printf ("%s0x%"PFMT64d, comma, sym->vaddr);
@@ -1011,17 +1013,17 @@ static int cmd_info(void *data, const char *input) {
 							}
 						} else if (input[1] == 'c' && obj) { // "icc"
 							mode = R_MODE_CLASSDUMP;
-							RBININFO ("classes", R_CORE_BIN_ACC_CLASSES, NULL, r_list_length (obj->classes));
+							RBININFO ("classes", R_CORE_BIN_ACC_CLASSES, NULL, r_list_length (classes));
 							input = " ";
 						} else {
-							RBININFO ("classes", R_CORE_BIN_ACC_CLASSES, NULL, r_list_length (obj->classes));
+							RBININFO ("classes", R_CORE_BIN_ACC_CLASSES, NULL, r_list_length (classes));
 						}
 					}
         			}
 			} else {
-				RBinObject *obj = r_bin_cur_object (core->bin);
-				if (obj && obj->classes) {
-					int len = r_list_length (obj->classes);
+				RList *classes = r_bin_get_classes (core->bin);
+				if (classes) {
+					int len = r_list_length (classes);
 					RBININFO ("classes", R_CORE_BIN_ACC_CLASSES, NULL, len);
 				}
 			}
@@ -684,32 +684,23 @@ static int cmd_meta_others(RCore *core, const char *input) {
 			}
 			break;
 		}
-		char key[100];
-		const char *val;
-		RAnalMetaItem mi;
-		Sdb *s = core->anal->sdb_meta;
 		bool esc_bslash = core->print->esc_bslash;
-		snprintf (key, sizeof (key), "meta.%c.0x%" PFMT64x, type, addr);
-		val = sdb_const_get (s, key, 0);
-		if (!val) {
-			break;
-		}
-		if (!r_meta_deserialize_val (core->anal, &mi, type, addr, val)) {
-			break;
-		}
-		if (!mi.str) {
+		char *str = r_meta_get_string (core->anal, type, addr);
+		if (!str) {
 			break;
 		}
+		RAnalMetaItem *mi = r_meta_find (core->anal, addr, type, R_META_WHERE_HERE);
+		subtype = mi? mi->subtype: 0;
 		if (type == 's') {
 			char *esc_str;
-			switch (mi.subtype) {
+			switch (subtype) {
 			case R_STRING_ENC_UTF8:
-				esc_str = r_str_escape_utf8 (mi.str, false, esc_bslash);
+				esc_str = r_str_escape_utf8 (str, false, esc_bslash);
 				break;
 			case 0:  /* temporary legacy workaround */
 				esc_bslash = false;
 			default:
-				esc_str = r_str_escape_latin1 (mi.str, false, esc_bslash, false);
+				esc_str = r_str_escape_latin1 (str, false, esc_bslash, false);
 			}
 			if (esc_str) {
 				r_cons_printf ("\"%s\"\n", esc_str);
@@ -718,11 +709,11 @@ static int cmd_meta_others(RCore *core, const char *input) {
 				r_cons_println ("<oom>");
 			}
 		} else if (type == 'd') {
-			r_cons_printf ("%"PFMT64u"\n", mi.size);
+			r_cons_printf ("%"PFMT64u"\n", mi? mi->size: (ut64)strlen (str));
 		} else {
-			r_cons_println (mi.str);
+			r_cons_println (str);
 		}
-		free (mi.str);
+		free (str);
 		break;
 	case ' ':
 	case '\0':
@@ -165,11 +165,6 @@ struct search_parameters {
 	bool rsa_search;
 };
 
-struct endlist_pair {
-	int instr_offset;
-	int delay_size;
-};
-
 static void cmd_search_init(RCore *core) {
 	DEFINE_CMD_DESCRIPTOR_SPECIAL (core, /, slash);
 	DEFINE_CMD_DESCRIPTOR_SPECIAL (core, /c, slash_c);
@@ -984,58 +979,17 @@ R_API RList *r_core_get_boundaries_prot(RCore *core, int perm, const char *mode,
 	return list;
 }
 
-static bool is_end_gadget(const RAnalOp *aop, const ut8 crop) {
-	switch (aop->type) {
-	case R_ANAL_OP_TYPE_TRAP:
-	case R_ANAL_OP_TYPE_RET:
-	case R_ANAL_OP_TYPE_UCALL:
-	case R_ANAL_OP_TYPE_RCALL:
-	case R_ANAL_OP_TYPE_ICALL:
-	case R_ANAL_OP_TYPE_IRCALL:
-	case R_ANAL_OP_TYPE_UJMP:
-	case R_ANAL_OP_TYPE_RJMP:
-	case R_ANAL_OP_TYPE_IJMP:
-	case R_ANAL_OP_TYPE_IRJMP:
-	case R_ANAL_OP_TYPE_JMP:
-	case R_ANAL_OP_TYPE_CALL:
-		return true;
-	}
-	if (crop) { // if conditional jumps, calls and returns should be used for the gadget-search too
-		switch (aop->type) {
-		case R_ANAL_OP_TYPE_CJMP:
-		case R_ANAL_OP_TYPE_UCJMP:
-		case R_ANAL_OP_TYPE_CCALL:
-		case R_ANAL_OP_TYPE_UCCALL:
-		case R_ANAL_OP_TYPE_CRET:   // i'm a condret
-			return true;
-		}
-	}
-	return false;
-}
-
-static bool insert_into(void *user, const ut64 k, const ut64 v) {
-	HtUU *ht = (HtUU *)user;
-	ht_uu_insert (ht, k, v);
-	return true;
-}
-
 // TODO: follow unconditional jumps
-static RList *construct_rop_gadget(RCore *core, ut64 addr, ut8 *buf, int idx, const char *grep, int regex, RList *rx_list, struct endlist_pair *end_gadget, HtUU *badstart) {
+static int construct_rop_gadget(RopIndex *ri, int idx, int max_instr, const char *grep, int regex, RList *rx_list, struct endlist_pair *end_gadget, HtUU *badstart, RopInsn **insns) {
 	int endaddr = end_gadget->instr_offset;
 	int branch_delay = end_gadget->delay_size;
-	RAsmOp asmop;
 	const char *start = NULL, *end = NULL;
 	char *grep_str = NULL;
-	RCoreAsmHit *hit = NULL;
-	RList *hitlist = r_core_asm_hit_list_new ();
-	ut8 nb_instr = 0;
-	const ut8 max_instr = r_config_get_i (core->config, "rop.len");
+	int nb_instr = 0, n = 0;
 	bool valid = false;
 	int grep_find;
 	int search_hit;
 	char *rx = NULL;
-	HtUUOptions opt = { 0 };
-	HtUU *localbadstart = ht_uu_new_opt (&opt);
 	int count = 0;
 
 	if (grep) {
@@ -1060,33 +1014,19 @@ static RList *construct_rop_gadget(RCore *core, ut64 addr, ut8 *buf, int idx, co
 		valid = false;
 		goto ret;
 	}
-	int opsz = 0;
-	char *opst = NULL;
 
 	while (nb_instr < max_instr) {
-		ht_uu_insert (localbadstart, idx, 1);
-		r_asm_set_pc (core->assembler, addr);
-		if (!r_asm_disassemble (core->assembler, &asmop, buf + idx, 15)) {
-			goto ret;
-		} else {
-			opsz = asmop.size;
-			// opsz = r_strbuf_length (asmop.buf);
-			opst = r_asm_op_get_asm (&asmop);
-		}
-		if (!r_str_ncasecmp (opst, "invalid", strlen ("invalid")) ||
-		    !r_str_ncasecmp (opst, ".byte", strlen (".byte"))) {
+		RopInsn *in = rop_index_insn (ri, idx);
+		if (!in || (in->flags & (ROP_INSN_ZERO | ROP_INSN_INVALID))) {
 			valid = false;
 			goto ret;
 		}
-
-		hit = r_core_asm_hit_new ();
-		hit->addr = addr;
-		hit->len = opsz;
-		r_list_append (hitlist, hit);
+		const char *opst = rop_index_str (ri, in->text);
+		int opsz = in->size;
+		insns[n++] = in;
 
 		// Move on to the next instruction
 		idx += opsz;
-		addr += opsz;
 		if (rx) {
 			grep_find = !r_regex_match (rx, "e", opst);
 			search_hit = (end && grep && (grep_find < 1));
@@ -1120,40 +1060,57 @@ static RList *construct_rop_gadget(RCore *core, ut64 addr, ut8 *buf, int idx, co
 ret:
 	free (grep_str);
 	if (regex && rx) {
-		r_list_free (hitlist);
-		ht_uu_free (localbadstart);
-		return NULL;
+		return 0;
 	}
 	if (!valid || (grep && end)) {
-		r_list_free (hitlist);
-		ht_uu_free (localbadstart);
-		return NULL;
+		return 0;
+	}
+	int i;
+	for (i = 0; i < n; i++) {
+		ht_uu_insert (badstart, insns[i]->off, 1);
 	}
-	ht_uu_foreach (localbadstart, insert_into, badstart);
-	ht_uu_free (localbadstart);
 	// If our arch has bds then we better be including them
-	if (branch_delay && r_list_length (hitlist) < (1 + branch_delay)) {
-		r_list_free (hitlist);
-		return NULL;
+	if (branch_delay && n < (1 + branch_delay)) {
+		return 0;
 	}
-	return hitlist;
+	return n;
 }
 
-static void print_rop(RCore *core, RList *hitlist, char mode, bool *json_first) {
+typedef struct {
+	ut64 addr;
+	int size;
+	ut32 type;
+	bool nohex;
+	const char *opstr;
+	const char *esil;
+} RopGadgetOp;
+
+static char *rop_op_hex(RCore *core, const RopGadgetOp *op) {
+	char *hex = calloc (2, op->size + 1);
+	ut8 *buf = malloc (op->size + 1);
+	if (hex && buf && !op->nohex) {
+		r_io_read_at (core->io, op->addr, buf, op->size);
+		r_hex_bin2str (buf, op->size, hex);
+	}
+	free (buf);
+	return hex;
+}
+
+static void print_rop_ops(RCore *core, RopIndex *ri, const RopGadgetOp *ops, int n, char mode, bool *json_first) {
 	const char *otype;
-	RCoreAsmHit *hit = NULL;
-	RListIter *iter;
 	RList *ropList = NULL;
 	char *buf_asm = NULL;
 	unsigned int size = 0;
-	RAnalOp analop = R_EMPTY;
-	RAsmOp asmop;
 	Sdb *db = NULL;
+	int i;
 	const bool colorize = r_config_get_i (core->config, "scr.color");
 	const bool rop_comments = r_config_get_i (core->config, "rop.comments");
 	const bool esil = r_config_get_i (core->config, "asm.esil");
 	const bool rop_db = r_config_get_i (core->config, "rop.db");
 
+	if (n < 1) {
+		return;
+	}
 	if (rop_db) {
 		db = sdb_ns (core->sdb, "rop", true);
 		ropList = r_list_newf (free);
@@ -1173,147 +1130,166 @@ static void print_rop(RCore *core, RList *hitlist, char mode, bool *json_first)
 			r_cons_strcat (",");
 		}
 		r_cons_printf ("{\"opcodes\":[");
-		r_list_foreach (hitlist, iter, hit) {
-			ut8 *buf = malloc (hit->len);
-			r_io_read_at (core->io, hit->addr, buf, hit->len);
-			r_asm_set_pc (core->assembler, hit->addr);
-			r_asm_disassemble (core->assembler, &asmop, buf, hit->len);
-			r_anal_op (core->anal, &analop, hit->addr, buf, hit->len, R_ANAL_OP_MASK_ESIL);
-			size += hit->len;
-			if (analop.type != R_ANAL_OP_TYPE_RET) {
-				char *opstr_n = r_str_newf (" %s", R_STRBUF_SAFEGET (&analop.esil));
-				r_list_append (ropList, (void *) opstr_n);
+		for (i = 0; i < n; i++) {
+			const RopGadgetOp *op = &ops[i];
+			size += op->size;
+			if (ropList && op->type != R_ANAL_OP_TYPE_RET) {
+				r_list_append (ropList, r_str_newf (" %s", op->esil));
 			}
 			r_cons_printf ("{\"offset\":%"PFMT64d ",\"size\":%d,"
 				"\"opcode\":\"%s\",\"type\":\"%s\"}%s",
-				hit->addr, hit->len, r_asm_op_get_asm (&asmop),
-				r_anal_optype_to_string (analop.type),
-				iter->n? ",": "");
-			free (buf);
-		}
-		if (db && hit) {
-			const ut64 addr = ((RCoreAsmHit *) hitlist->head->data)->addr;
-			// r_cons_printf ("Gadget size: %d\n", (int)size);
-			const char *key = sdb_fmt ("0x%08"PFMT64x, addr);
-			rop_classify (core, db, ropList, key, size);
-			r_cons_printf ("],\"retaddr\":%"PFMT64d ",\"size\":%d}", hit->addr, size);
-		} else if (hit) {
-			r_cons_printf ("],\"retaddr\":%"PFMT64d ",\"size\":%d}", hit->addr, size);
+				op->addr, op->size, op->opstr,
+				r_anal_optype_to_string (op->type),
+				i + 1 < n? ",": "");
 		}
+		r_cons_printf ("],\"retaddr\":%"PFMT64d ",\"size\":%d}", ops[n - 1].addr, size);
 		break;
 	case 'q':
 		// Print gadgets in a 'linear manner', each sequence
 		// on one line.
-		r_cons_printf ("0x%08"PFMT64x ":",
-			((RCoreAsmHit *) hitlist->head->data)->addr);
-		r_list_foreach (hitlist, iter, hit) {
-			ut8 *buf = malloc (hit->len);
-			r_io_read_at (core->io, hit->addr, buf, hit->len);
-			r_asm_set_pc (core->assembler, hit->addr);
-			r_asm_disassemble (core->assembler, &asmop, buf, hit->len);
-			r_anal_op (core->anal, &analop, hit->addr, buf, hit->len, R_ANAL_OP_MASK_BASIC);
-			size += hit->len;
-			const char *opstr = R_STRBUF_SAFEGET (&analop.esil);
-			if (analop.type != R_ANAL_OP_TYPE_RET) {
-				r_list_append (ropList, r_str_newf (" %s", opstr));
+		r_cons_printf ("0x%08"PFMT64x ":", ops[0].addr);
+		for (i = 0; i < n; i++) {
+			const RopGadgetOp *op = &ops[i];
+			size += op->size;
+			if (ropList && op->type != R_ANAL_OP_TYPE_RET) {
+				r_list_append (ropList, r_str_newf (" %s", op->esil));
 			}
 			if (esil) {
-				r_cons_printf ("%s\n", opstr);
+				r_cons_printf ("%s\n", op->esil);
 			} else if (colorize) {
-				buf_asm = r_print_colorize_opcode (core->print, r_asm_op_get_asm (&asmop),
+				buf_asm = r_print_colorize_opcode (core->print, (char *)op->opstr,
 					core->cons->context->pal.reg, core->cons->context->pal.num, false, 0);
 				r_cons_printf (" %s%s;", buf_asm, Color_RESET);
 				free (buf_asm);
 			} else {
-				r_cons_printf (" %s;", r_asm_op_get_asm (&asmop));
+				r_cons_printf (" %s;", op->opstr);
 			}
-			free (buf);
-		}
-		if (db && hit) {
-			const ut64 addr = ((RCoreAsmHit *) hitlist->head->data)->addr;
-			// r_cons_printf ("Gadget size: %d\n", (int)size);
-			const char *key = sdb_fmt ("0x%08"PFMT64x, addr);
-			rop_classify (core, db, ropList, key, size);
 		}
 		break;
 	default:
 		// Print gadgets with new instruction on a new line.
-		r_list_foreach (hitlist, iter, hit) {
+		for (i = 0; i < n; i++) {
+			const RopGadgetOp *op = &ops[i];
 			char *comment = rop_comments? r_meta_get_string (core->anal,
-				R_META_TYPE_COMMENT, hit->addr): NULL;
-			if (hit->len < 0) {
-				eprintf ("Invalid hit length here\n");
-				continue;
-			}
-			ut8 *buf = malloc (1 + hit->len);
-			if (!buf) {
+				R_META_TYPE_COMMENT, op->addr): NULL;
+			char *hex = rop_op_hex (core, op);
+			if (!hex) {
+				free (comment);
 				break;
 			}
-			buf[hit->len] = 0;
-			r_io_read_at (core->io, hit->addr, buf, hit->len);
-			r_asm_set_pc (core->assembler, hit->addr);
-			r_asm_disassemble (core->assembler, &asmop, buf, hit->len);
-			r_anal_op (core->anal, &analop, hit->addr, buf, hit->len, R_ANAL_OP_MASK_ESIL);
-			size += hit->len;
-			if (analop.type != R_ANAL_OP_TYPE_RET) {
-				char *opstr_n = r_str_newf (" %s", R_STRBUF_SAFEGET (&analop.esil));
-				r_list_append (ropList, (void *) opstr_n);
+			size += op->size;
+			if (ropList && op->type != R_ANAL_OP_TYPE_RET) {
+				r_list_append (ropList, r_str_newf (" %s", op->esil));
 			}
 			if (colorize) {
-				char *buf_asm = r_print_colorize_opcode (core->print, r_asm_op_get_asm (&asmop),
+				char *buf_asm = r_print_colorize_opcode (core->print, (char *)op->opstr,
 					core->cons->context->pal.reg, core->cons->context->pal.num, false, 0);
-				otype = r_print_color_op_type (core->print, analop.type);
+				otype = r_print_color_op_type (core->print, op->type);
 				if (comment) {
 					r_cons_printf ("  0x%08"PFMT64x " %18s%s  %s%s ; %s\n",
-						hit->addr, r_asm_op_get_hex (&asmop), otype, buf_asm, Color_RESET, comment);
+						op->addr, hex, otype, buf_asm, Color_RESET, comment);
 				} else {
 					r_cons_printf ("  0x%08"PFMT64x " %18s%s  %s%s\n",
-						hit->addr, r_asm_op_get_hex (&asmop), otype, buf_asm, Color_RESET);
+						op->addr, hex, otype, buf_asm, Color_RESET);
 				}
 				free (buf_asm);
 			} else {
 				if (comment) {
 					r_cons_printf ("  0x%08"PFMT64x " %18s  %s ; %s\n",
-						hit->addr, r_asm_op_get_hex (&asmop), r_asm_op_get_asm (&asmop), comment);
+						op->addr, hex, op->opstr, comment);
 				} else {
 					r_cons_printf ("  0x%08"PFMT64x " %18s  %s\n",
-						hit->addr, r_asm_op_get_hex (&asmop), r_asm_op_get_asm (&asmop));
+						op->addr, hex, op->opstr);
 				}
 			}
-			free (buf);
-		}
-		if (db && hit) {
-			const ut64 addr = ((RCoreAsmHit *) hitlist->head->data)->addr;
-			// r_cons_printf ("Gadget size: %d\n", (int)size);
-			const char *key = sdb_fmt ("0x%08"PFMT64x, addr);
-			rop_classify (core, db, ropList, key, size);
+			free (hex);
+			free (comment);
 		}
 	}
+	if (db) {
+		const char *key = sdb_fmt ("0x%08"PFMT64x, ops[0].addr);
+		rop_index_classify (core, ri, db, ropList, key, size, ops[0].addr, ops[n - 1].addr);
+	}
 	if (mode != 'j') {
 		r_cons_newline ();
 	}
 	r_list_free (ropList);
 }
 
+// shows the gadgets stored with rop.sdb, decoding them again
+static void print_rop(RCore *core, RList *hitlist, char mode, bool *json_first) {
+	RopGadgetOp *ops = R_NEWS0 (RopGadgetOp, r_list_length (hitlist) + 1);
+	RCoreAsmHit *hit;
+	RListIter *iter;
+	int i, n = 0;
+	if (!ops) {
+		return;
+	}
+	r_list_foreach (hitlist, iter, hit) {
+		RopGadgetOp *op = &ops[n++];
+		RAnalOp analop = R_EMPTY;
+		RAsmOp asmop;
+		ut8 *buf = calloc (1, hit->len + 1);
+		if (!buf) {
+			n--;
+			break;
+		}
+		r_io_read_at (core->io, hit->addr, buf, hit->len);
+		r_asm_set_pc (core->assembler, hit->addr);
+		op->nohex = r_asm_disassemble (core->assembler, &asmop, buf, hit->len) < 0;
+		r_anal_op (core->anal, &analop, hit->addr, buf, hit->len, R_ANAL_OP_MASK_ESIL);
+		op->addr = hit->addr;
+		op->size = hit->len;
+		op->type = analop.type;
+		op->opstr = strdup (r_str_get (r_asm_op_get_asm (&asmop)));
+		op->esil = strdup (R_STRBUF_SAFEGET (&analop.esil));
+		r_anal_op_fini (&analop);
+		r_asm_op_fini (&asmop);
+		free (buf);
+	}
+	print_rop_ops (core, NULL, ops, n, mode, json_first);
+	for (i = 0; i < n; i++) {
+		free ((char *)ops[i].opstr);
+		free ((char *)ops[i].esil);
+	}
+	free (ops);
+}
+
+// shows the gadget starting at insns[first]
+static void print_rop_index(RCore *core, RopIndex *ri, RopInsn **insns, int first, int n, char mode, bool *json_first) {
+	RopGadgetOp *ops = R_NEWS0 (RopGadgetOp, n - first + 1);
+	int i, k = 0;
+	if (!ops) {
+		return;
+	}
+	for (i = first; i < n; i++, k++) {
+		RopInsn *in = insns[i];
+		ops[k].addr = ri->addr + in->off;
+		ops[k].size = in->size;
+		ops[k].type = in->type;
+		ops[k].nohex = in->flags & ROP_INSN_NOHEX;
+		ops[k].opstr = rop_index_str (ri, in->text);
+		ops[k].esil = rop_index_str (ri, in->esil);
+	}
+	print_rop_ops (core, ri, ops, k, mode, json_first);
+	free (ops);
+}
+
 static int r_core_search_rop(RCore *core, RInterval search_itv, int opt, const char *grep, int regexp, struct search_parameters *param) {
-	const ut8 crop = r_config_get_i (core->config, "rop.conditional");      // decide if cjmp, cret, and ccall should be used too for the gadget-search
 	const ut8 subchain = r_config_get_i (core->config, "rop.subchains");
-	const ut8 max_instr = r_config_get_i (core->config, "rop.len");
-	const char *arch = r_config_get (core->config, "asm.arch");
 	int max_count = r_config_get_i (core->config, "search.maxhits");
-	int i = 0, end = 0, mode = 0, increment = 1, ret, result = true;
-	RList /*<endlist_pair>*/ *end_list = r_list_newf (free);
+	int i = 0, mode = 0, result = true;
 	RList /*<RRegex>*/ *rx_list = NULL;
 	int align = core->search->align;
 	RListIter *itermap = NULL;
 	char *tok, *gregexp = NULL;
 	char *grep_arg = NULL;
 	bool json_first = true;
+	RopInsn **insns = NULL;
+	RopIndexOptions ro;
 	char *rx = NULL;
 	int delta = 0;
-	ut8 *buf;
 	RIOMap *map;
-	RAsmOp asmop;
 
 	Sdb *gadgetSdb = NULL;
 	if (r_config_get_i (core->config, "rop.sdb")) {
@@ -1324,22 +1300,18 @@ static int r_core_search_rop(RCore *core, RInterval search_itv, int opt, const c
 	if (max_count == 0) {
 		max_count = -1;
 	}
-	if (max_instr <= 1) {
-		r_list_free (end_list);
+	if (!rop_index_options (core, &ro)) {
 		eprintf ("ROP length (rop.len) must be greater than 1.\n");
-		if (max_instr == 1) {
+		if (ro.max_instr == 1) {
 			eprintf ("For rop.len = 1, use /c to search for single "
 				"instructions. See /c? for help.\n");
 		}
 		return false;
 	}
-
-	if (!strcmp (arch, "mips")) { // MIPS has no jump-in-the-middle
-		increment = 4;
-	} else if (!strcmp (arch, "arm")) { // ARM has no jump-in-the-middle
-		increment = r_config_get_i (core->config, "asm.bits") == 16? 2: 4;
-	} else if (!strcmp (arch, "avr")) { // AVR is halfword aligned.
-		increment = 2;
+	const int increment = ro.increment;
+	const int ropdepth = ro.ropdepth;
+	if (!(insns = R_NEWS0 (RopInsn *, ro.max_instr))) {
+		return false;
 	}
 
 	// Options, like JSON, linear, ...
@@ -1383,10 +1355,9 @@ static int r_core_search_rop(RCore *core, RInterval search_itv, int opt, const c
 		r_cons_printf ("[");
 	}
 	r_cons_break_push (NULL, NULL);
+	rop_index_begin (core);
 
 	r_list_foreach (param->boundaries, itermap, map) {
-		HtUUOptions opt = { 0 };
-		HtUU *badstart = ht_uu_new_opt (&opt);
 		if (!r_itv_overlap (search_itv, map->itv)) {
 			continue;
 		}
@@ -1396,66 +1367,19 @@ static int r_core_search_rop(RCore *core, RInterval search_itv, int opt, const c
 			break;
 		}
 		delta = to - from;
-		buf = calloc (1, delta);
-		if (!buf) {
-			result = false;
-			goto bad;
-		}
-		(void) r_io_read_at (core->io, from, buf, delta);
-
-		// Find the end gadgets.
-		for (i = 0; i + 32 < delta; i += increment) {
-			RAnalOp end_gadget = R_EMPTY;
-			// Disassemble one.
-			if (r_anal_op (core->anal, &end_gadget, from + i, buf + i,
-				    delta - i, R_ANAL_OP_MASK_BASIC) <= 0) {
-				r_anal_op_fini (&end_gadget);
-				continue;
-			}
-			if (is_end_gadget (&end_gadget, crop)) {
-				struct endlist_pair *epair;
-#if 0
-				if (search->maxhits && r_list_length (end_list) >= search->maxhits) {
-					// limit number of high level rop gadget results
-					r_anal_op_fini (&end_gadget);
-					break;
-				}
-#endif
-				epair = R_NEW0 (struct endlist_pair);
-				if (epair) {
-					// If this arch has branch delay slots, add the next instr as well
-					if (end_gadget.delay) {
-						epair->instr_offset = i + increment;
-						epair->delay_size = end_gadget.delay;
-					} else {
-						epair->instr_offset = (intptr_t) i;
-						epair->delay_size = end_gadget.delay;
-					}
-					r_list_append (end_list, (void *) (intptr_t) epair);
-				}
-			}
-			r_anal_op_fini (&end_gadget);
-			if (r_cons_is_breaked ()) {
-				break;
-			}
-			// Right now we have a list of all of the end/stop gadgets.
-			// We can just construct gadgets from a little bit before them.
+		// The end gadgets and the instructions before them are found once,
+		// the queries only walk the index
+		RopIndex *ri = rop_index_get (core, &ro, from, delta, true);
+		if (!ri) {
+			continue;
 		}
-		r_list_reverse (end_list);
+		const int nends = ri->ends.len;
 		// If we have no end gadgets, just skip all of this search nonsense.
-		if (r_list_length (end_list) > 0) {
-			int prev, next, ropdepth;
-			const int max_inst_size_x86 = 15;
-			// Get the depth of rop search, should just be max_instr
-			// instructions, x86 and friends are weird length instructions, so
-			// we'll just assume 15 byte instructions.
-			ropdepth = increment == 1?
-			           max_instr * max_inst_size_x86 /* wow, x86 is long */:
-			           max_instr * increment;
-			if (r_cons_is_breaked ()) {
-				break;
-			}
-			struct endlist_pair *end_gadget = (struct endlist_pair *) r_list_pop (end_list);
+		if (nends > 0) {
+			HtUU *badstart = ht_uu_new0 ();
+			int prev, next, ei = 0;
+			const int max_inst_size_x86 = ROP_INSN_MAXSZ;
+			struct endlist_pair *end_gadget = r_vector_index_ptr (&ri->ends, ei);
 			next = end_gadget->instr_offset;
 			prev = 0;
 			// Start at just before the first end gadget.
@@ -1479,10 +1403,9 @@ static int r_core_search_rop(RCore *core, RInterval search_itv, int opt, const c
 				if (i >= next) {
 					// We've exhausted the first end-gadget section,
 					// move to the next one.
-					free (end_gadget);
-					if (r_list_get_n (end_list, 0)) {
+					if (ei + 1 < nends) {
 						prev = i;
-						end_gadget = (struct endlist_pair *) r_list_pop (end_list);
+						end_gadget = r_vector_index_ptr (&ri->ends, ++ei);
 						next = end_gadget->instr_offset;
 						i = next - ropdepth;
 						if (i < 0) {
@@ -1492,39 +1415,32 @@ static int r_core_search_rop(RCore *core, RInterval search_itv, int opt, const c
 						break;
 					}
 				}
-				if (i >= end) { // read by chunk of 4k
-					r_io_read_at (core->io, from + i, buf + i,
-						R_MIN ((delta - i), 4096));
-					end = i + 2048;
-				}
-				ret = r_asm_disassemble (core->assembler, &asmop, buf + i, delta - i);
-				if (ret) {
-					RList *hitlist;
-					r_asm_set_pc (core->assembler, from + i);
-					hitlist = construct_rop_gadget (core,
-						from + i, buf, i, grep, regexp,
-						rx_list, end_gadget, badstart);
-					if (!hitlist) {
+				RopInsn *in = rop_index_insn (ri, i);
+				if (in && !(in->flags & ROP_INSN_ZERO)) {
+					int n = construct_rop_gadget (ri, i, ro.max_instr, grep, regexp,
+						rx_list, end_gadget, badstart, insns);
+					if (!n) {
 						continue;
 					}
 					if (align && (0 != ((from + i) % align))) {
 						continue;
 					}
 					if (gadgetSdb) {
-						RListIter *iter;
-
-						RCoreAsmHit *hit = (RCoreAsmHit *) hitlist->head->data;
-						char *headAddr = r_str_newf ("%"PFMT64x, hit->addr);
+						char *headAddr = r_str_newf ("%"PFMT64x, from + insns[0]->off);
+						int k;
 						if (!headAddr) {
 							result = false;
+							ht_uu_free (badstart);
 							goto bad;
 						}
 
-						r_list_foreach (hitlist, iter, hit) {
-							char *addr = r_str_newf ("%"PFMT64x"(%"PFMT32d")", hit->addr, hit->len);
+						for (k = 0; k < n; k++) {
+							char *addr = r_str_newf ("%"PFMT64x"(%"PFMT32d")",
+								from + insns[k]->off, insns[k]->size);
 							if (!addr) {
 								free (headAddr);
 								result = false;
+								ht_uu_free (badstart);
 								goto bad;
 							}
 							sdb_concat (gadgetSdb, headAddr, addr, 0);
@@ -1537,14 +1453,13 @@ static int r_core_search_rop(RCore *core, RInterval search_itv, int opt, const c
 						mode = 'j';
 					}
 					if ((mode == 'q') && subchain) {
+						int k = 0;
 						do {
-							print_rop (core, hitlist, mode, &json_first);
-							hitlist->head = hitlist->head->n;
-						} while (hitlist->head->n);
+							print_rop_index (core, ri, insns, k, n, mode, &json_first);
+						} while (++k < n - 1);
 					} else {
-						print_rop (core, hitlist, mode, &json_first);
+						print_rop_index (core, ri, insns, 0, n, mode, &json_first);
 					}
-					r_list_free (hitlist);
 					if (max_count > 0) {
 						max_count--;
 						if (max_count < 1) {
@@ -1556,8 +1471,8 @@ static int r_core_search_rop(RCore *core, RInterval search_itv, int opt, const c
 					i = next;
 				}
 			}
+			ht_uu_free (badstart);
 		}
-		free (buf);
 	}
 	if (r_cons_is_breaked ()) {
 		eprintf ("\n");
@@ -1568,13 +1483,30 @@ static int r_core_search_rop(RCore *core, RInterval search_itv, int opt, const c
 		r_cons_printf ("]\n");
 	}
 bad:
+	rop_index_end (core, &ro);
 	r_list_free (rx_list);
-	r_list_free (end_list);
+	free (insns);
 	free (grep_arg);
 	free (gregexp);
 	return result;
 }
 
+// loads the cached gadget indexes, so /Rk shows their classes
+static void rop_index_kuery(RCore *core, RInterval search_itv, struct search_parameters *param) {
+	RListIter *iter;
+	RopIndexOptions ro;
+	RIOMap *map;
+	if (!rop_index_options (core, &ro) || !ro.cache) {
+		return;
+	}
+	r_list_foreach (param->boundaries, iter, map) {
+		if (r_itv_overlap (search_itv, map->itv)) {
+			RInterval itv = r_itv_intersect (search_itv, map->itv);
+			rop_index_get (core, &ro, itv.addr, itv.size, false);
+		}
+	}
+}
+
 static int esil_addrinfo(RAnalEsil *esil) {
 	RCore *core = (RCore *) esil->cb.user;
 	ut64 num = 0;
@@ -2304,6 +2236,323 @@ static void do_asm_search(RCore *core, struct search_parameters *param, const ch
 	r_cons_break_pop ();
 }
 
+/* Parallel search
+ *
+ * With search.jobs > 1 the range is read in windows of jobs * SEARCH_JOB_SIZE
+ * bytes and every job searches its part of the window. Keyword jobs use
+ * their own RSearch with a copy of the keywords, made once per search so
+ * the automaton is not rebuilt for every window. They look past their end
+ * by the longest keyword - 1, so matches crossing jobs are found once. The hits
+ * are then reported from this thread in address order through
+ * r_search_hit_new, so search.maxhits, search.align, search.overlap and
+ * search.contiguous work as in the serial search. Crypto finders keep the
+ * serial block boundaries, their results do not change at all.
+ */
+#define SEARCH_JOB_SIZE 0x100000
+
+typedef struct {
+	ut64 addr;
+	int kw;
+} SearchJobHit;
+
+typedef struct {
+	RVector hits;
+	ut64 limit; // hits starting here belong to the next job
+} SearchJob;
+
+typedef struct {
+	RSearch *search;
+	struct search_parameters *param;
+	RThreadPool *pool;
+	ut8 *buf;
+	const ut8 *data; // window contents, buf or borrowed from io
+	ut64 addr; // address of data[0]
+	ut64 size; // bytes searched in this window
+	ut64 avail; // bytes in buf, past size only for keywords crossing the end
+	ut64 chunk; // bytes per job, a multiple of the blocksize
+	ut64 window;
+	int bsize;
+	int longest;
+	int njobs;
+	SearchJob *jobs;
+	RSearch **searches; // keyword search of each job
+	RSearchKeyword **kws;
+	int nkws;
+	ut64 base; // start of the range, the serial search reads its blocks from here
+	ut64 *skips; // per keyword, hits before it are skipped in the current segment
+	ut64 *segs; // per keyword, the segment the skip belongs to
+	int *deltas; // crypto hit of each block, -1 if none
+} SearchJobs;
+
+static int search_job_cb(RSearchKeyword *kw, void *user, ut64 addr) {
+	SearchJob *job = user;
+	if (addr < job->limit) {
+		SearchJobHit h = { addr, kw->kwidx };
+		if (!r_vector_push (&job->hits, &h)) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+// a copy of the keywords for one job, its automaton is built on the first
+// update and kept for the following windows
+static RSearch *search_job_clone(SearchJobs *sj) {
+	RSearch *s = r_search_new (R_SEARCH_KEYWORD);
+	if (!s) {
+		return NULL;
+	}
+	int i;
+	for (i = 0; i < sj->nkws; i++) {
+		RSearchKeyword *kw = sj->kws[i];
+		RSearchKeyword *k = r_search_keyword_new (kw->bin_keyword, kw->keyword_length,
+			kw->bin_binmask, kw->binmask_length, NULL);
+		if (!k) {
+			r_search_free (s);
+			return NULL;
+		}
+		k->icase = kw->icase;
+		k->type = kw->type;
+		r_search_kw_add (s, k);
+	}
+	// every match is collected, the overlap rules are applied when merging
+	s->overlap = true;
+	s->contiguous = true;
+	s->distance = sj->search->distance;
+	r_search_begin (s);
+	return s;
+}
+
+static bool search_keyword_job(void *user, int idx) {
+	SearchJobs *sj = user;
+	SearchJob *job = &sj->jobs[idx];
+	RSearch *s = sj->searches[idx];
+	ut64 off = idx * sj->chunk;
+	ut64 end = R_MIN (off + sj->chunk, sj->size);
+	ut64 tail = R_MIN (end + sj->longest - 1, sj->avail);
+	job->limit = sj->addr + end;
+	// the bytes left from the previous window are not contiguous with these
+	R_FREE (s->data);
+	r_search_set_callback (s, search_job_cb, job);
+	r_search_update (s, sj->addr + off, sj->data + off, tail - off);
+	return true;
+}
+
+static bool search_crypto_job(void *user, int idx) {
+	SearchJobs *sj = user;
+	ut64 off = idx * sj->chunk;
+	ut64 end = R_MIN (off + sj->chunk, sj->size);
+	for (; off < end; off += sj->bsize) {
+		int len = (int)R_MIN (sj->bsize, sj->size - off);
+		sj->deltas[off / sj->bsize] = sj->param->aes_search
+			? r_search_aes_update (sj->search, sj->addr + off, sj->data + off, len)
+			: r_search_rsa_update (sj->search, sj->addr + off, sj->data + off, len);
+	}
+	return true;
+}
+
+static int search_job_hit_cmp(const void *a, const void *b) {
+	const SearchJobHit *ha = a, *hb = b;
+	if (ha->addr != hb->addr) {
+		return ha->addr < hb->addr? -1: 1;
+	}
+	return ha->kw - hb->kw;
+}
+
+static void search_jobs_free(SearchJobs *sj) {
+	if (sj) {
+		int i;
+		for (i = 0; sj->jobs && i < sj->njobs; i++) {
+			r_vector_clear (&sj->jobs[i].hits);
+		}
+		for (i = 0; sj->searches && i < sj->njobs; i++) {
+			r_search_free (sj->searches[i]);
+		}
+		free (sj->searches);
+		r_th_pool_free (sj->pool);
+		free (sj->jobs);
+		free (sj->kws);
+		free (sj->skips);
+		free (sj->segs);
+		free (sj->deltas);
+		free (sj->buf);
+		free (sj);
+	}
+}
+
+static SearchJobs *search_jobs_new(RCore *core, struct search_parameters *param) {
+	RSearch *search = core->search;
+	int i, njobs = r_config_get_i (core->config, "search.jobs");
+	bool keywords = search->mode == R_SEARCH_KEYWORD && !search->inverse && !search->bckwrds;
+	if (njobs < 2 || (!param->crypto_search && !keywords) || core->blocksize < 1) {
+		return NULL;
+	}
+	SearchJobs *sj = R_NEW0 (SearchJobs);
+	if (!sj) {
+		return NULL;
+	}
+	sj->search = search;
+	sj->param = param;
+	sj->njobs = njobs;
+	sj->bsize = core->blocksize;
+	sj->chunk = R_MAX (1, SEARCH_JOB_SIZE / sj->bsize) * sj->bsize;
+	sj->window = sj->chunk * njobs;
+	if (!param->crypto_search) {
+		RListIter *iter;
+		RSearchKeyword *kw;
+		sj->nkws = r_list_length (search->kws);
+		sj->kws = R_NEWS0 (RSearchKeyword *, sj->nkws);
+		sj->skips = R_NEWS0 (ut64, sj->nkws);
+		sj->segs = R_NEWS0 (ut64, sj->nkws);
+		if (!sj->kws || !sj->skips || !sj->segs) {
+			search_jobs_free (sj);
+			return NULL;
+		}
+		i = 0;
+		r_list_foreach (search->kws, iter, kw) {
+			sj->longest = R_MAX (sj->longest, kw->keyword_length);
+			sj->kws[i++] = kw;
+		}
+	} else {
+		sj->deltas = R_NEWS (int, sj->window / sj->bsize);
+	}
+	sj->buf = malloc (sj->window + sj->longest);
+	sj->jobs = R_NEWS0 (SearchJob, njobs);
+	sj->pool = r_th_pool_new (njobs);
+	if (!sj->buf || !sj->jobs || !sj->pool || (param->crypto_search && !sj->deltas)) {
+		search_jobs_free (sj);
+		return NULL;
+	}
+	for (i = 0; i < njobs; i++) {
+		r_vector_init (&sj->jobs[i].hits, sizeof (SearchJobHit), NULL, NULL);
+	}
+	if (!param->crypto_search) {
+		sj->searches = R_NEWS0 (RSearch *, njobs);
+		for (i = 0; sj->searches && i < njobs; i++) {
+			if (!(sj->searches[i] = search_job_clone (sj))) {
+				break;
+			}
+		}
+		if (i < njobs) {
+			search_jobs_free (sj);
+			return NULL;
+		}
+	}
+	return sj;
+}
+
+// returns 1 to stop searching the current range, 2 when maxhits is reached
+static int search_jobs_report(SearchJobs *sj, RSearchKeyword *aeskw) {
+	RSearch *search = sj->search;
+	int i, t;
+	if (sj->param->crypto_search) {
+		for (i = 0; i * sj->bsize < sj->size; i++) {
+			if (sj->deltas[i] != -1) {
+				t = r_search_hit_new (search, aeskw, sj->addr + (ut64)i * sj->bsize + sj->deltas[i]);
+				if (!t || t > 1) {
+					return 1;
+				}
+			}
+		}
+		return 0;
+	}
+	RVector all;
+	r_vector_init (&all, sizeof (SearchJobHit), NULL, NULL);
+	for (i = 0; i < sj->njobs; i++) {
+		RVector *hits = &sj->jobs[i].hits;
+		bool fail = hits->len && !r_vector_insert_range (&all, all.len, hits->a, hits->len);
+		// the last window may run less jobs, leave nothing behind for it
+		r_vector_clear (hits);
+		if (fail) {
+			r_vector_clear (&all);
+			return 1;
+		}
+	}
+	if (all.len > 1) {
+		qsort (all.a, all.len, sizeof (SearchJobHit), search_job_hit_cmp);
+	}
+	int ret = 0;
+	SearchJobHit *h = all.a;
+	for (i = 0; i < all.len; i++, h++) {
+		RSearchKeyword *kw = sj->kws[h->kw];
+		if (!search->overlap) {
+			/* same rules as the serial search. it starts each block, and each
+			 * run over the bytes left from the previous one, at kw->last and
+			 * then skips the length of every hit found, including the
+			 * unaligned ones that do not move kw->last */
+			ut64 block = (h->addr + kw->keyword_length - 1 - sj->base) / sj->bsize;
+			ut64 seg = block * 2 + (h->addr >= sj->base + block * sj->bsize) + 1;
+			if (sj->segs[h->kw] != seg) {
+				sj->segs[h->kw] = seg;
+				sj->skips[h->kw] = 0;
+			}
+			if (h->addr < sj->skips[h->kw] || (kw->count && h->addr < kw->last)) {
+				continue;
+			}
+			sj->skips[h->kw] = h->addr + kw->keyword_length;
+		}
+		t = r_search_hit_new (search, kw, h->addr);
+		if (!t) {
+			ret = 1;
+			break;
+		}
+		if (t > 1) {
+			ret = 2;
+			break;
+		}
+	}
+	r_vector_clear (&all);
+	return ret;
+}
+
+// searches itv like the serial loop, returns 2 when maxhits is reached
+static int search_jobs_run(RCore *core, SearchJobs *sj, RInterval itv, RSearchKeyword *aeskw, ut64 *at) {
+	const ut64 to = r_itv_end (itv);
+	sj->base = itv.addr;
+	if (sj->segs) {
+		memset (sj->segs, 0, sizeof (ut64) * sj->nkws);
+	}
+	for (*at = itv.addr; *at < to; *at += sj->size) {
+		print_search_progress (*at, to, sj->search->nhits);
+		if (r_cons_is_breaked ()) {
+			eprintf ("\n\n");
+			return 0;
+		}
+		// same blocks the serial search would read, stopping at invalid ones
+		ut64 want = R_MIN (sj->window, to - *at);
+		bool valid = true;
+		for (sj->size = 0; sj->size < want; sj->size += sj->bsize) {
+			if (!r_io_is_valid_offset (core->io, *at + sj->size, 0)) {
+				valid = false;
+				break;
+			}
+		}
+		sj->size = R_MIN (sj->size, want);
+		if (!sj->size) {
+			break;
+		}
+		sj->avail = sj->size;
+		if (valid && sj->longest > 1 && *at + sj->size < to
+				&& r_io_is_valid_offset (core->io, *at + sj->size, 0)) {
+			sj->avail += R_MIN (sj->longest - 1, to - *at - sj->size);
+		}
+		sj->addr = *at;
+		sj->data = r_io_read_at_ptr (core->io, *at, sj->buf, sj->avail);
+		int njobs = (int)((sj->size + sj->chunk - 1) / sj->chunk);
+		r_th_pool_run (sj->pool, njobs, sj->param->crypto_search? search_crypto_job: search_keyword_job, sj);
+		int ret = search_jobs_report (sj, aeskw);
+		if (ret) {
+			*at += sj->size;
+			return ret;
+		}
+		if (!valid) {
+			*at += sj->size;
+			break;
+		}
+	}
+	return 0;
+}
+
 static void do_string_search(RCore *core, RInterval search_itv, struct search_parameters *param) {
 	ut64 at;
 	ut8 *buf;
@@ -2341,6 +2590,7 @@ static void do_string_search(RCore *core, RInterval search_itv, struct search_pa
 		if (search->bckwrds) {
 			r_search_string_prepare_backward (search);
 		}
+		SearchJobs *sj = search_jobs_new (core, param);
 		r_cons_break_push (NULL, NULL);
 		// TODO search cross boundary
 		r_list_foreach (param->boundaries, iter, map) {
@@ -2368,44 +2618,52 @@ static void do_string_search(RCore *core, RInterval search_itv, struct search_pa
 					from1 = search->bckwrds ? to : from,
 					to1 = search->bckwrds ? from : to;
 			ut64 len;
-			for (at = from1; at != to1; at = search->bckwrds ? at - len : at + len) {
-				print_search_progress (at, to1, search->nhits);
-				if (r_cons_is_breaked ()) {
-					eprintf ("\n\n");
-					break;
+			if (sj) {
+				if (search_jobs_run (core, sj, itv, &aeskw, &at) > 1) {
+					goto done;
 				}
-				if (search->bckwrds) {
-					len = R_MIN (core->blocksize, at - from);
-					// TODO prefix_read_at
-					if (!r_io_is_valid_offset (core->io, at - len, 0)) {
-						break;
-					}
-					(void)r_io_read_at (core->io, at - len, buf, len);
-				} else {
-					len = R_MIN (core->blocksize, to - at);
-					if (!r_io_is_valid_offset (core->io, at, 0)) {
+			} else {
+				// backward searches reverse the block in place, never borrow it
+				const ut8 *data = buf;
+				for (at = from1; at != to1; at = search->bckwrds ? at - len : at + len) {
+					print_search_progress (at, to1, search->nhits);
+					if (r_cons_is_breaked ()) {
+						eprintf ("\n\n");
 						break;
 					}
-					(void)r_io_read_at (core->io, at, buf, len);
-				}
-				if (param->crypto_search) {
-					// TODO support backward search
-					int delta = 0;
-					if (param->aes_search) {
-						delta = r_search_aes_update (core->search, at, buf, len);
-					} else if (param->rsa_search) {
-						delta = r_search_rsa_update (core->search, at, buf, len);
-					}
-					if (delta != -1) {
-						int t = r_search_hit_new (core->search, &aeskw, at + delta);
-						if (!t || t > 1) {
+					if (search->bckwrds) {
+						len = R_MIN (core->blocksize, at - from);
+						// TODO prefix_read_at
+						if (!r_io_is_valid_offset (core->io, at - len, 0)) {
+							break;
+						}
+						(void)r_io_read_at (core->io, at - len, buf, len);
+					} else {
+						len = R_MIN (core->blocksize, to - at);
+						if (!r_io_is_valid_offset (core->io, at, 0)) {
 							break;
 						}
+						data = r_io_read_at_ptr (core->io, at, buf, len);
 					}
-				} else {
-					(void)r_search_update (core->search, at, buf, len);
-					if (core->search->maxhits > 0 && core->search->nhits >= core->search->maxhits) {
-						goto done;
+					if (param->crypto_search) {
+						// TODO support backward search
+						int delta = 0;
+						if (param->aes_search) {
+							delta = r_search_aes_update (core->search, at, data, len);
+						} else if (param->rsa_search) {
+							delta = r_search_rsa_update (core->search, at, data, len);
+						}
+						if (delta != -1) {
+							int t = r_search_hit_new (core->search, &aeskw, at + delta);
+							if (!t || t > 1) {
+								break;
+							}
+						}
+					} else {
+						(void)r_search_update (core->search, at, data, len);
+						if (core->search->maxhits > 0 && core->search->nhits >= core->search->maxhits) {
+							goto done;
+						}
 					}
 				}
 			}
@@ -2418,6 +2676,7 @@ static void do_string_search(RCore *core, RInterval search_itv, struct search_pa
 		}
 done:
 		r_cons_break_pop ();
+		search_jobs_free (sj);
 		free (buf);
 	} else {
 		eprintf ("No keywords defined\n");
@@ -3056,6 +3315,7 @@ reread:
 			if (input[2] == '?') {
 				r_core_cmd_help (core, help_msg_slash_Rk);
 			} else {
+				rop_index_kuery (core, search_itv, &param);
 				rop_kuery (core, input + 2);
 			}
 		} else {
@@ -683,9 +683,10 @@ static int rop_classify_nops(RCore *core, RList *ropList) {
 	return changes;
 }
 
-static void rop_classify (RCore *core, Sdb *db, RList *ropList, const char *key, unsigned int size) {
+// returns the "namespace value" lines set in db, so they can be replayed
+static char *rop_classify (RCore *core, Sdb *db, RList *ropList, const char *key, unsigned int size) {
 	int nop = 0;  rop_classify_nops (core, ropList);
-	char *mov, *ct, *arithm, *arithm_ct, *str;
+	char *mov, *ct, *arithm, *arithm_ct, *str, *kinds = NULL;
 	Sdb *db_nop = sdb_ns (db, "nop", true);
 	Sdb *db_mov = sdb_ns (db, "mov", true);
 	Sdb *db_ct = sdb_ns (db, "const", true);
@@ -694,7 +695,7 @@ static void rop_classify (RCore *core, Sdb *db, RList *ropList, const char *key,
 
 	if (!db_nop || !db_mov || !db_ct || !db_aritm || !db_aritm_ct) {
 		eprintf ("Error: Could not create SDB 'rop' sub-namespaces\n");
-		return;
+		return NULL;
 	}
 	nop = rop_classify_nops (core, ropList);
 	mov = rop_classify_mov (core, ropList);
@@ -706,33 +707,748 @@ static void rop_classify (RCore *core, Sdb *db, RList *ropList, const char *key,
 	if (nop == 1) {
 		char *str_nop = r_str_newf ("%s NOP", str);
 		sdb_set (db_nop, key, str_nop, 0);
+		kinds = r_str_appendf (kinds, "nop %s\n", str_nop);
 		free (str_nop);
 	} else {
 		if (mov) {
 			char *str_mov = r_str_newf ("%s MOV { %s }", str, mov);
 			sdb_set (db_mov, key, str_mov, 0);
+			kinds = r_str_appendf (kinds, "mov %s\n", str_mov);
 			free (str_mov);
 			free (mov);
 		}
 		if (ct) {
 			char *str_ct = r_str_newf ("%s LOAD_CONST { %s }", str, ct);
 			sdb_set (db_ct, key, str_ct, 0);
+			kinds = r_str_appendf (kinds, "const %s\n", str_ct);
 			free (str_ct);
 			free (ct);
 		}
 		if (arithm) {
 			char *str_arithm = r_str_newf ("%s ARITHMETIC { %s }", str, arithm);
 			sdb_set (db_aritm, key, str_arithm, 0);
+			kinds = r_str_appendf (kinds, "arithm %s\n", str_arithm);
 			free (str_arithm);
 			free (arithm);
 		}
 		if (arithm_ct) {
 			char *str_arithm_ct = r_str_newf ("%s ARITHMETIC_CONST { %s }", str, arithm_ct);
 			sdb_set (db_aritm_ct, key, str_arithm_ct, 0);
+			kinds = r_str_appendf (kinds, "arithm_ct %s\n", str_arithm_ct);
 			free (str_arithm_ct);
 			free (arithm_ct);
 		}
 	}
 
 	free (str);
+	return kinds;
+}
+
+struct endlist_pair {
+	int instr_offset;
+	int delay_size;
+};
+
+static bool is_end_gadget(const RAnalOp *aop, const ut8 crop) {
+	switch (aop->type) {
+	case R_ANAL_OP_TYPE_TRAP:
+	case R_ANAL_OP_TYPE_RET:
+	case R_ANAL_OP_TYPE_UCALL:
+	case R_ANAL_OP_TYPE_RCALL:
+	case R_ANAL_OP_TYPE_ICALL:
+	case R_ANAL_OP_TYPE_IRCALL:
+	case R_ANAL_OP_TYPE_UJMP:
+	case R_ANAL_OP_TYPE_RJMP:
+	case R_ANAL_OP_TYPE_IJMP:
+	case R_ANAL_OP_TYPE_IRJMP:
+	case R_ANAL_OP_TYPE_JMP:
+	case R_ANAL_OP_TYPE_CALL:
+		return true;
+	}
+	if (crop) { // if conditional jumps, calls and returns should be used for the gadget-search too
+		switch (aop->type) {
+		case R_ANAL_OP_TYPE_CJMP:
+		case R_ANAL_OP_TYPE_UCJMP:
+		case R_ANAL_OP_TYPE_CCALL:
+		case R_ANAL_OP_TYPE_UCCALL:
+		case R_ANAL_OP_TYPE_CRET:   // i'm a condret
+			return true;
+		}
+	}
+	return false;
+}
+
+/* The gadget index holds the end gadgets of a searched range and every
+ * instruction decoded before them, so /R queries walk it instead of
+ * decoding the range again. The classifications made while printing are
+ * kept in it too. It is keyed by the sha1 of the range bytes and of the
+ * settings changing the gadgets, and saved in the cache dir with rop.cache */
+
+#define ROP_INDEX_MAGIC 0x58444952 // RIDX
+#define ROP_INDEX_VERSION 1
+#define ROP_INDEX_CHUNK 0x10000
+#define ROP_INDEX_OPS 0x1000
+#define ROP_INDEX_PAD 32
+// longest instruction, what the search assumes for x86
+#define ROP_INSN_MAXSZ 15
+
+enum {
+	ROP_INSN_ZERO = 1, // r_asm_disassemble failed
+	ROP_INSN_INVALID = 2, // shown as invalid or .byte
+	ROP_INSN_NOHEX = 4, // unaligned, no bytes were decoded
+};
+
+typedef struct {
+	ut32 off;
+	ut32 size;
+	ut32 type;
+	ut32 flags;
+	ut32 text; // offsets in the strings pool
+	ut32 esil;
+} RopInsn;
+
+typedef struct {
+	ut64 end;
+	char *kinds; // "namespace value" lines, see rop_classify
+} RopClass;
+
+typedef struct {
+	ut8 key[R_HASH_SIZE_SHA1];
+	ut64 addr;
+	ut64 size;
+	RVector ends; // struct endlist_pair, by offset
+	RVector insns; // RopInsn, by offset
+	RStrpool *strs;
+	HtUP *classes; // RopClass by gadget address
+	bool used;
+	bool dirty;
+} RopIndex;
+
+typedef struct {
+	int increment;
+	int max_instr;
+	int ropdepth;
+	int jobs;
+	bool crop;
+	bool cache;
+} RopIndexOptions;
+
+typedef struct {
+	RAnal *anal;
+	RopIndex *ri;
+	const ut8 *buf;
+	const RopIndexOptions *ro;
+	RVector *ends; // found by each chunk
+	RStrpool **esil; // written by each ops job
+} RopIndexBuild;
+
+static bool rop_index_options(RCore *core, RopIndexOptions *ro) {
+	const char *arch = r_config_get (core->config, "asm.arch");
+	ro->max_instr = r_config_get_i (core->config, "rop.len");
+	ro->crop = r_config_get_i (core->config, "rop.conditional");
+	ro->jobs = r_config_get_i (core->config, "rop.jobs");
+	ro->cache = r_config_get_i (core->config, "rop.cache");
+	ro->increment = 1;
+	if (!strcmp (arch, "mips")) { // MIPS has no jump-in-the-middle
+		ro->increment = 4;
+	} else if (!strcmp (arch, "arm")) { // ARM has no jump-in-the-middle
+		ro->increment = r_config_get_i (core->config, "asm.bits") == 16? 2: 4;
+	} else if (!strcmp (arch, "avr")) { // AVR is halfword aligned.
+		ro->increment = 2;
+	}
+	// x86 and friends are weird length instructions, so we'll just
+	// assume 15 byte instructions.
+	ro->ropdepth = ro->increment == 1
+		? ro->max_instr * ROP_INSN_MAXSZ
+		: ro->max_instr * ro->increment;
+	return ro->max_instr > 1;
+}
+
+static void rop_class_kv_free(HtUPKv *kv) {
+	RopClass *c = kv->value;
+	free (c->kinds);
+	free (c);
+}
+
+static void rop_index_free(RopIndex *ri) {
+	if (ri) {
+		r_vector_clear (&ri->ends);
+		r_vector_clear (&ri->insns);
+		r_strpool_free (ri->strs);
+		ht_up_free (ri->classes);
+		free (ri);
+	}
+}
+
+static RopIndex *rop_index_new(const ut8 *key, ut64 addr, ut64 size, int strs) {
+	RopIndex *ri = R_NEW0 (RopIndex);
+	if (!ri) {
+		return NULL;
+	}
+	memcpy (ri->key, key, R_HASH_SIZE_SHA1);
+	ri->addr = addr;
+	ri->size = size;
+	r_vector_init (&ri->ends, sizeof (struct endlist_pair), NULL, NULL);
+	r_vector_init (&ri->insns, sizeof (RopInsn), NULL, NULL);
+	ri->strs = r_strpool_new (strs);
+	ri->classes = ht_up_new (NULL, rop_class_kv_free, NULL);
+	if (!ri->strs || !ri->classes) {
+		rop_index_free (ri);
+		return NULL;
+	}
+	return ri;
+}
+
+static const char *rop_index_str(RopIndex *ri, ut32 off) {
+	return ri->strs->str + off;
+}
+
+static RopInsn *rop_index_insn(RopIndex *ri, st64 off) {
+	size_t lo = 0, hi = ri->insns.len;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		RopInsn *in = r_vector_index_ptr (&ri->insns, mid);
+		if (in->off == off) {
+			return in;
+		}
+		if (in->off < off) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return NULL;
+}
+
+static void rop_index_key(RCore *core, const RopIndexOptions *ro, ut64 addr, const ut8 *buf, ut64 size, ut8 *key) {
+	RAsm *a = core->assembler;
+	RAnal *anal = core->anal;
+	char *s = r_str_newf ("%d %s %s %s %d %d %d %d %d %d %d %s %s %d %d %d %d %d 0x%"PFMT64x" 0x%"PFMT64x,
+		ROP_INDEX_VERSION, a->cur? a->cur->name: "", r_str_get (a->cpu), r_str_get (a->features),
+		a->bits, a->big_endian, a->syntax, a->invhex, a->pcalign, a->immdisp, a->ofilter? 1: 0,
+		anal->cur? anal->cur->name: "", r_str_get (anal->cpu), anal->bits, anal->big_endian,
+		ro->increment, ro->max_instr, ro->crop, addr, size);
+	RHash *h = r_hash_new (false, R_HASH_SHA1);
+	if (!s || !h) {
+		memset (key, 0, R_HASH_SIZE_SHA1);
+		free (s);
+		r_hash_free (h);
+		return;
+	}
+	r_hash_do_begin (h, R_HASH_SHA1);
+	r_hash_do_sha1 (h, (const ut8 *)s, strlen (s));
+	ut64 i;
+	for (i = 0; i < size; i += ROP_INDEX_CHUNK) {
+		r_hash_do_sha1 (h, buf + i, (int)R_MIN (size - i, ROP_INDEX_CHUNK));
+	}
+	r_hash_do_end (h, R_HASH_SHA1);
+	memcpy (key, h->digest, R_HASH_SIZE_SHA1);
+	r_hash_free (h);
+	free (s);
+}
+
+static void rop_index_find_ends(RopIndexBuild *b, ut64 i, ut64 end, RVector *ends) {
+	const ut64 size = b->ri->size;
+	for (; i < end && i + 32 < size; i += b->ro->increment) {
+		RAnalOp end_gadget = R_EMPTY;
+		// Disassemble one.
+		if (r_anal_op (b->anal, &end_gadget, b->ri->addr + i, b->buf + i,
+			    size - i, R_ANAL_OP_MASK_BASIC) <= 0) {
+			r_anal_op_fini (&end_gadget);
+			continue;
+		}
+		if (is_end_gadget (&end_gadget, b->ro->crop)) {
+			// If this arch has branch delay slots, add the next instr as well
+			struct endlist_pair epair = { i, end_gadget.delay };
+			if (end_gadget.delay) {
+				epair.instr_offset += b->ro->increment;
+			}
+			r_vector_push (ends, &epair);
+		}
+		r_anal_op_fini (&end_gadget);
+	}
+}
+
+static bool rop_index_ends_job(void *user, int job) {
+	RopIndexBuild *b = user;
+	ut64 from = (ut64)job * ROP_INDEX_CHUNK;
+	rop_index_find_ends (b, from, from + ROP_INDEX_CHUNK, &b->ends[job]);
+	return true;
+}
+
+static bool rop_index_ops_job(void *user, int job) {
+	RopIndexBuild *b = user;
+	RVector *insns = &b->ri->insns;
+	RStrpool *esil = b->esil[job];
+	size_t i = (size_t)job * ROP_INDEX_OPS;
+	size_t end = R_MIN (i + ROP_INDEX_OPS, insns->len);
+	for (; i < end; i++) {
+		RopInsn *in = r_vector_index_ptr (insns, i);
+		if (in->flags & (ROP_INSN_ZERO | ROP_INSN_INVALID)) {
+			continue;
+		}
+		RAnalOp op = R_EMPTY;
+		r_anal_op (b->anal, &op, b->ri->addr + in->off, b->buf + in->off,
+			in->size, R_ANAL_OP_MASK_ESIL);
+		in->type = op.type;
+		in->esil = r_strpool_append (esil, R_STRBUF_SAFEGET (&op.esil));
+		r_anal_op_fini (&op);
+	}
+	return true;
+}
+
+// decodes the instruction at off once, returns its position in insns
+static size_t rop_index_decode(RCore *core, RopIndexBuild *b, HtUU *seen, ut64 off) {
+	RopIndex *ri = b->ri;
+	bool found;
+	ut64 n = ht_uu_find (seen, off, &found);
+	if (found) {
+		return n;
+	}
+	RAsmOp asmop;
+	r_asm_set_pc (core->assembler, ri->addr + off);
+	int ret = r_asm_disassemble (core->assembler, &asmop, b->buf + off, ROP_INSN_MAXSZ);
+	const char *opst = r_str_get (r_asm_op_get_asm (&asmop));
+	RopInsn in = { .off = off, .size = R_MAX (asmop.size, 0) };
+	if (!ret) {
+		in.flags |= ROP_INSN_ZERO;
+	} else if (ret < 0) {
+		in.flags |= ROP_INSN_NOHEX;
+	}
+	if (!r_str_ncasecmp (opst, "invalid", strlen ("invalid")) ||
+	    !r_str_ncasecmp (opst, ".byte", strlen (".byte"))) {
+		in.flags |= ROP_INSN_INVALID;
+	}
+	in.text = r_strpool_append (ri->strs, opst);
+	r_asm_op_fini (&asmop);
+	n = ri->insns.len;
+	r_vector_push (&ri->insns, &in);
+	ht_uu_insert (seen, off, n);
+	return n;
+}
+
+// decodes every gadget the search can try to end at e
+static void rop_index_decode_end(RCore *core, RopIndexBuild *b, HtUU *seen, const struct endlist_pair *e) {
+	const RopIndexOptions *ro = b->ro;
+	const st64 next = e->instr_offset;
+	const st64 last = (st64)b->ri->size - ROP_INSN_MAXSZ;
+	st64 i = R_MAX (next - ro->ropdepth, 0);
+	for (; i <= next && i < last; i += ro->increment) {
+		st64 o = i;
+		int k;
+		for (k = 0; k < ro->max_instr && o <= next; k++) {
+			size_t n = rop_index_decode (core, b, seen, o);
+			RopInsn *in = r_vector_index_ptr (&b->ri->insns, n);
+			if (in->flags & (ROP_INSN_ZERO | ROP_INSN_INVALID) || o == next) {
+				break;
+			}
+			o += in->size;
+		}
+	}
+}
+
+static int rop_insn_cmp(const void *a, const void *b) {
+	const RopInsn *x = a, *y = b;
+	return x->off < y->off? -1: x->off > y->off;
+}
+
+static RopIndex *rop_index_build(RCore *core, const RopIndexOptions *ro, ut64 addr, const ut8 *buf, ut64 size, const ut8 *key) {
+	RopIndex *ri = rop_index_new (key, addr, size, (int)R_MIN (size * 4, ST32_MAX / 2));
+	if (!ri) {
+		return NULL;
+	}
+	RopIndexBuild b = { core->anal, ri, buf, ro };
+	RCoreSeekArchBits archbits = core->anal->coreb.archbits;
+	const int chunks = (int)((size + ROP_INDEX_CHUNK - 1) / ROP_INDEX_CHUNK);
+	const bool threads = ro->jobs > 1 && anal_op_threadsafe (core);
+	RThreadPool *pool = r_th_pool_new (threads? ro->jobs: 1);
+	HtUU *seen = ht_uu_new0 ();
+	struct endlist_pair *e;
+	int i, ops = 0;
+	b.ends = R_NEWS0 (RVector, R_MAX (chunks, 1));
+	if (!pool || !seen || !b.ends) {
+		goto fail;
+	}
+	for (i = 0; i < chunks; i++) {
+		r_vector_init (&b.ends[i], sizeof (struct endlist_pair), NULL, NULL);
+	}
+	if (threads) {
+		// plugins may initialize their tables on the first use
+		RAnalOp op;
+		r_anal_op (core->anal, &op, addr, buf, ROP_INDEX_PAD, 0);
+		r_anal_op_fini (&op);
+		// archbits writes the config, and it is a nop without section bits or hints
+		core->anal->coreb.archbits = NULL;
+	}
+	r_th_pool_run (pool, chunks, rop_index_ends_job, &b);
+	core->anal->coreb.archbits = archbits;
+	for (i = 0; i < chunks; i++) {
+		r_vector_foreach (&b.ends[i], e) {
+			r_vector_push (&ri->ends, e);
+		}
+	}
+	if (r_cons_is_breaked ()) {
+		goto fail;
+	}
+	// the asm plugins keep state, instructions are decoded here
+	r_vector_foreach (&ri->ends, e) {
+		rop_index_decode_end (core, &b, seen, e);
+	}
+	if (r_cons_is_breaked ()) {
+		goto fail;
+	}
+	ops = (int)((ri->insns.len + ROP_INDEX_OPS - 1) / ROP_INDEX_OPS);
+	b.esil = R_NEWS0 (RStrpool *, R_MAX (ops, 1));
+	if (!b.esil) {
+		goto fail;
+	}
+	for (i = 0; i < ops; i++) {
+		if (!(b.esil[i] = r_strpool_new (ROP_INDEX_OPS * 16))) {
+			goto fail;
+		}
+	}
+	if (threads) {
+		core->anal->coreb.archbits = NULL;
+	}
+	r_th_pool_run (pool, ops, rop_index_ops_job, &b);
+	core->anal->coreb.archbits = archbits;
+	for (i = 0; i < ops; i++) {
+		int base = r_strpool_memcat (ri->strs, b.esil[i]->str, b.esil[i]->len);
+		size_t j, end = R_MIN ((size_t)(i + 1) * ROP_INDEX_OPS, ri->insns.len);
+		for (j = (size_t)i * ROP_INDEX_OPS; j < end; j++) {
+			RopInsn *in = r_vector_index_ptr (&ri->insns, j);
+			if (!(in->flags & (ROP_INSN_ZERO | ROP_INSN_INVALID))) {
+				in->esil += base;
+			}
+		}
+	}
+	if (ri->insns.len > 0) {
+		qsort (ri->insns.a, ri->insns.len, sizeof (RopInsn), rop_insn_cmp);
+	}
+	if (r_cons_is_breaked ()) {
+		goto fail;
+	}
+	goto done;
+fail:
+	rop_index_free (ri);
+	ri = NULL;
+done:
+	if (b.ends) {
+		for (i = 0; i < chunks; i++) {
+			r_vector_clear (&b.ends[i]);
+		}
+		free (b.ends);
+	}
+	if (b.esil) {
+		for (i = 0; i < ops; i++) {
+			r_strpool_free (b.esil[i]);
+		}
+		free (b.esil);
+	}
+	ht_uu_free (seen);
+	r_th_pool_free (pool);
+	return ri;
+}
+
+static void rop_buf_append_int(RBuffer *b, ut64 v, int size) {
+	ut8 tmp[8];
+	r_write_ble (tmp, v, false, size * 8);
+	r_buf_append_bytes (b, tmp, size);
+}
+
+typedef struct {
+	const ut8 *p;
+	const ut8 *end;
+	bool ok;
+} RopIndexReader;
+
+static ut64 rop_read_int(RopIndexReader *r, int size) {
+	if (!r->ok || r->end - r->p < size) {
+		r->ok = false;
+		return 0;
+	}
+	ut64 v = r_read_ble (r->p, false, size * 8);
+	r->p += size;
+	return v;
+}
+
+static const ut8 *rop_read_bytes(RopIndexReader *r, ut64 len) {
+	if (!r->ok || r->end - r->p < len) {
+		r->ok = false;
+		return NULL;
+	}
+	const ut8 *p = r->p;
+	r->p += len;
+	return p;
+}
+
+static char *rop_index_path(const ut8 *key) {
+	char hex[R_HASH_SIZE_SHA1 * 2 + 1];
+	r_hex_bin2str (key, R_HASH_SIZE_SHA1, hex);
+	char *name = r_str_newf (R_JOIN_3_PATHS (R2_HOME_CACHEDIR, "rop", "%s"), hex);
+	char *path = name? r_str_home (name): NULL;
+	free (name);
+	return path;
+}
+
+static bool rop_class_save_cb(void *user, const ut64 k, const void *v) {
+	RBuffer *b = user;
+	const RopClass *c = v;
+	int len = strlen (c->kinds);
+	rop_buf_append_int (b, k, 8);
+	rop_buf_append_int (b, c->end, 8);
+	rop_buf_append_int (b, len, 4);
+	r_buf_append_bytes (b, (const ut8 *)c->kinds, len);
+	return true;
+}
+
+static bool rop_index_save(RopIndex *ri) {
+	char *dir = r_str_home (R_JOIN_2_PATHS (R2_HOME_CACHEDIR, "rop"));
+	char *file = rop_index_path (ri->key);
+	RBuffer *b = r_buf_new ();
+	bool ret = false;
+	if (!dir || !file || !b || !r_sys_mkdirp (dir)) {
+		goto beach;
+	}
+	rop_buf_append_int (b, ROP_INDEX_MAGIC, 4);
+	rop_buf_append_int (b, ROP_INDEX_VERSION, 4);
+	r_buf_append_bytes (b, ri->key, R_HASH_SIZE_SHA1);
+	rop_buf_append_int (b, ri->addr, 8);
+	rop_buf_append_int (b, ri->size, 8);
+	rop_buf_append_int (b, ri->ends.len, 4);
+	rop_buf_append_int (b, ri->insns.len, 4);
+	rop_buf_append_int (b, ri->strs->len, 4);
+	rop_buf_append_int (b, ri->classes->count, 4);
+	struct endlist_pair *e;
+	r_vector_foreach (&ri->ends, e) {
+		rop_buf_append_int (b, e->instr_offset, 4);
+		rop_buf_append_int (b, e->delay_size, 4);
+	}
+	RopInsn *in;
+	r_vector_foreach (&ri->insns, in) {
+		rop_buf_append_int (b, in->off, 4);
+		rop_buf_append_int (b, in->size, 4);
+		rop_buf_append_int (b, in->type, 4);
+		rop_buf_append_int (b, in->flags, 4);
+		rop_buf_append_int (b, in->text, 4);
+		rop_buf_append_int (b, in->esil, 4);
+	}
+	r_buf_append_bytes (b, (const ut8 *)ri->strs->str, ri->strs->len);
+	ht_up_foreach (ri->classes, rop_class_save_cb, b);
+	ut64 size;
+	const ut8 *data = r_buf_data (b, &size);
+	ret = size < ST32_MAX && r_file_dump (file, data, (int)size, false);
+beach:
+	r_buf_free (b);
+	free (file);
+	free (dir);
+	return ret;
+}
+
+static RopIndex *rop_index_load(const ut8 *key) {
+	char *file = rop_index_path (key);
+	int size = 0;
+	ut8 *data = file? (ut8 *)r_file_slurp (file, &size): NULL;
+	free (file);
+	if (!data) {
+		return NULL;
+	}
+	RopIndexReader r = { data, data + size, true };
+	RopIndex *ri = NULL;
+	if (rop_read_int (&r, 4) != ROP_INDEX_MAGIC || rop_read_int (&r, 4) != ROP_INDEX_VERSION) {
+		goto fail;
+	}
+	const ut8 *k = rop_read_bytes (&r, R_HASH_SIZE_SHA1);
+	if (!k || memcmp (k, key, R_HASH_SIZE_SHA1)) {
+		goto fail;
+	}
+	ut64 addr = rop_read_int (&r, 8);
+	ut64 rsize = rop_read_int (&r, 8);
+	ut64 nends = rop_read_int (&r, 4);
+	ut64 ninsns = rop_read_int (&r, 4);
+	ut64 nstrs = rop_read_int (&r, 4);
+	ut64 nclasses = rop_read_int (&r, 4);
+	if (!r.ok || nends * 8 + ninsns * 24 + nstrs > (ut64)(r.end - r.p)
+			|| (nstrs && data[r.p - data + nends * 8 + ninsns * 24 + nstrs - 1])) {
+		goto fail;
+	}
+	if (!(ri = rop_index_new (key, addr, rsize, (int)R_MAX (nstrs, 1)))) {
+		goto fail;
+	}
+	ut64 i;
+	st64 last = 0;
+	for (i = 0; i < nends; i++) {
+		struct endlist_pair e;
+		e.instr_offset = (int)rop_read_int (&r, 4);
+		e.delay_size = (int)rop_read_int (&r, 4);
+		// the search walks them in address order
+		if (e.instr_offset < last || e.instr_offset > rsize) {
+			goto fail;
+		}
+		last = e.instr_offset;
+		r_vector_push (&ri->ends, &e);
+	}
+	last = -1;
+	for (i = 0; i < ninsns; i++) {
+		RopInsn in;
+		in.off = rop_read_int (&r, 4);
+		in.size = rop_read_int (&r, 4);
+		in.type = rop_read_int (&r, 4);
+		in.flags = rop_read_int (&r, 4);
+		in.text = rop_read_int (&r, 4);
+		in.esil = rop_read_int (&r, 4);
+		if ((st64)in.off <= last || in.off > rsize || in.text >= nstrs || in.esil >= nstrs) {
+			goto fail;
+		}
+		last = in.off;
+		r_vector_push (&ri->insns, &in);
+	}
+	const ut8 *strs = rop_read_bytes (&r, nstrs);
+	if (!strs || r_strpool_memcat (ri->strs, (const char *)strs, (int)nstrs) < 0) {
+		goto fail;
+	}
+	for (i = 0; i < nclasses && r.ok; i++) {
+		ut64 gaddr = rop_read_int (&r, 8);
+		ut64 end = rop_read_int (&r, 8);
+		ut64 len = rop_read_int (&r, 4);
+		const ut8 *kinds = rop_read_bytes (&r, len);
+		RopClass *c = kinds? R_NEW0 (RopClass): NULL;
+		if (!c) {
+			goto fail;
+		}
+		c->end = end;
+		c->kinds = r_str_ndup ((const char *)kinds, len);
+		ht_up_insert (ri->classes, gaddr, c);
+	}
+	if (!r.ok) {
+		goto fail;
+	}
+	free (data);
+	return ri;
+fail:
+	rop_index_free (ri);
+	free (data);
+	return NULL;
+}
+
+// sets the "namespace value" lines from rop_classify in the rop/ namespaces
+static void rop_class_set(Sdb *db, const char *key, const char *kinds) {
+	char *dup = strdup (kinds);
+	char *line, *next;
+	for (line = dup; line && *line; line = next) {
+		next = strchr (line, '\n');
+		if (next) {
+			*next++ = 0;
+		}
+		char *value = strchr (line, ' ');
+		if (value) {
+			*value++ = 0;
+			sdb_set (sdb_ns (db, line, true), key, value, 0);
+		}
+	}
+	free (dup);
+}
+
+static bool rop_class_replay_cb(void *user, const ut64 k, const void *v) {
+	const RopClass *c = v;
+	rop_class_set ((Sdb *)user, sdb_fmt ("0x%08"PFMT64x, k), c->kinds);
+	return true;
+}
+
+/* classifies the gadget at addr ending at end, the results are kept in
+ * the index and reused the next time it is shown */
+static void rop_index_classify(RCore *core, RopIndex *ri, Sdb *db, RList *ropList, const char *key, unsigned int size, ut64 addr, ut64 end) {
+	RopClass *c = ri? ht_up_find (ri->classes, addr, NULL): NULL;
+	if (c && c->end == end) {
+		rop_class_set (db, key, c->kinds);
+		return;
+	}
+	char *kinds = rop_classify (core, db, ropList, key, size);
+	if (!ri || !kinds) {
+		// nothing is kept when the classifiers are disabled
+		free (kinds);
+		return;
+	}
+	if (c) {
+		free (c->kinds);
+	} else {
+		if (!(c = R_NEW0 (RopClass))) {
+			free (kinds);
+			return;
+		}
+		ht_up_insert (ri->classes, addr, c);
+	}
+	c->end = end;
+	c->kinds = kinds;
+	ri->dirty = true;
+}
+
+static RopIndex *rop_index_find(RCore *core, const ut8 *key) {
+	RListIter *iter;
+	RopIndex *ri;
+	r_list_foreach (core->rop_index, iter, ri) {
+		if (!memcmp (ri->key, key, R_HASH_SIZE_SHA1)) {
+			return ri;
+		}
+	}
+	return NULL;
+}
+
+/* returns the index of [addr, addr + size) from memory or from the cache
+ * dir, it is built when missing and build is set */
+static RopIndex *rop_index_get(RCore *core, const RopIndexOptions *ro, ut64 addr, ut64 size, bool build) {
+	ut8 key[R_HASH_SIZE_SHA1];
+	if (!size || size > ST32_MAX) {
+		return NULL;
+	}
+	ut8 *buf = calloc (1, size + ROP_INDEX_PAD);
+	if (!buf) {
+		return NULL;
+	}
+	(void)r_io_read_at (core->io, addr, buf, (int)size);
+	rop_index_key (core, ro, addr, buf, size, key);
+	if (!core->rop_index) {
+		core->rop_index = r_list_newf ((RListFree)rop_index_free);
+	}
+	RopIndex *ri = rop_index_find (core, key);
+	if (!ri && ro->cache && (ri = rop_index_load (key))) {
+		r_list_append (core->rop_index, ri);
+		// make the stored classes visible to /Rk
+		if (ri->classes->count > 0) {
+			ht_up_foreach (ri->classes, rop_class_replay_cb, sdb_ns (core->sdb, "rop", true));
+		}
+	}
+	if (!ri && build && (ri = rop_index_build (core, ro, addr, buf, size, key))) {
+		r_list_append (core->rop_index, ri);
+		if (ro->cache) {
+			rop_index_save (ri);
+		}
+	}
+	free (buf);
+	if (ri) {
+		ri->used = true;
+	}
+	return ri;
+}
+
+static void rop_index_begin(RCore *core) {
+	RListIter *iter;
+	RopIndex *ri;
+	r_list_foreach (core->rop_index, iter, ri) {
+		ri->used = false;
+	}
+}
+
+// drops the indexes of ranges not searched anymore and saves the new classes
+static void rop_index_end(RCore *core, const RopIndexOptions *ro) {
+	RListIter *iter, *iter2;
+	RopIndex *ri;
+	r_list_foreach_safe (core->rop_index, iter, iter2, ri) {
+		if (!ri->used) {
+			r_list_delete (core->rop_index, iter);
+		} else if (ri->dirty && ro->cache) {
+			rop_index_save (ri);
+			ri->dirty = false;
+		}
+	}
 }
@@ -6,6 +6,7 @@
 #include <r_list.h>
 #include <r_cons.h>
 #include <r_util.h>
+#include <r_th.h>
 
 static const char *help_msg_z[] = {
 	"Usage:", "z[*j-aof/cs] [args] ", "# Manage zignatures",
@@ -720,20 +721,15 @@ static int fcnMatchCB(RSignItem *it, RAnalFunction *fcn, void *user) {
 	return 1;
 }
 
-static bool searchRange(RCore *core, ut64 from, ut64 to, bool rad, struct ctxSearchCB *ctx) {
+static bool searchRange(RCore *core, RSignSearch *ss, ut64 from, ut64 to, bool rad, struct ctxSearchCB *ctx) {
 	ut8 *buf = malloc (core->blocksize);
 	ut64 at;
 	int rlen;
 	bool retval = true;
-	int minsz = r_config_get_i (core->config, "zign.minsz");
 
 	if (!buf) {
 		return false;
 	}
-	RSignSearch *ss = r_sign_search_new ();
-	ss->search->align = r_config_get_i (core->config, "search.align");
-	r_sign_search_init (core->anal, ss, minsz, searchHitCB, ctx);
-
 	r_cons_break_push (NULL, NULL);
 	for (at = from; at < to; at += core->blocksize) {
 		if (r_cons_is_breaked ()) {
@@ -754,42 +750,61 @@ static bool searchRange(RCore *core, ut64 from, ut64 to, bool rad, struct ctxSea
 	}
 	r_cons_break_pop ();
 	free (buf);
-	r_sign_search_free (ss);
 
 	return retval;
 }
 
-static bool searchRange2(RCore *core, RSignSearch *ss, ut64 from, ut64 to, bool rad, struct ctxSearchCB *ctx) {
-	ut8 *buf = malloc (core->blocksize);
-	ut64 at;
-	int rlen;
-	bool retval = true;
+enum {
+	ZIGN_MATCH_GRAPH,
+	ZIGN_MATCH_OFFSET,
+	ZIGN_MATCH_REFS,
+	ZIGN_MATCH_HASH,
+	ZIGN_MATCH_LAST
+};
 
-	if (!buf) {
-		return false;
-	}
-	r_cons_break_push (NULL, NULL);
-	for (at = from; at < to; at += core->blocksize) {
-		if (r_cons_is_breaked ()) {
-			retval = false;
-			break;
+#define ZIGN_CHUNK 64
+
+typedef struct {
+	RAnalFunction *fcn;
+	char *bbhash;
+	RList *refs;
+	RPVector hits[ZIGN_MATCH_LAST];
+} ZignFcnMatch;
+
+struct ctxMatchJob {
+	RSignIndex *idx;
+	ZignFcnMatch *fcns;
+	int count;
+	int mincc;
+	bool use[ZIGN_MATCH_LAST];
+};
+
+static int collectHitCB(RSignItem *it, RAnalFunction *fcn, void *user) {
+	r_pvector_push ((RPVector *)user, it);
+	return 1;
+}
+
+// matches a chunk of functions against the index, the hits are flagged
+// afterwards in the function order so the output does not depend on the threads
+static bool matchJob(void *user, int n) {
+	struct ctxMatchJob *job = (struct ctxMatchJob *)user;
+	int i, end = R_MIN ((n + 1) * ZIGN_CHUNK, job->count);
+	for (i = n * ZIGN_CHUNK; i < end; i++) {
+		ZignFcnMatch *m = &job->fcns[i];
+		if (job->use[ZIGN_MATCH_GRAPH]) {
+			r_sign_index_match_graph (job->idx, m->fcn, job->mincc, collectHitCB, &m->hits[ZIGN_MATCH_GRAPH]);
 		}
-		rlen = R_MIN (core->blocksize, to - at);
-		if (!r_io_is_valid_offset (core->io, at, 0)) {
-			retval = false;
-			break;
+		if (job->use[ZIGN_MATCH_OFFSET]) {
+			r_sign_index_match_addr (job->idx, m->fcn, collectHitCB, &m->hits[ZIGN_MATCH_OFFSET]);
 		}
-		(void)r_io_read_at (core->io, at, buf, rlen);
-		if (r_sign_search_update (core->anal, ss, &at, buf, rlen) == -1) {
-			eprintf ("search: update read error at 0x%08"PFMT64x"\n", at);
-			retval = false;
-			break;
+		if (job->use[ZIGN_MATCH_REFS]) {
+			r_sign_index_match_refs (job->idx, m->fcn, m->refs, collectHitCB, &m->hits[ZIGN_MATCH_REFS]);
+		}
+		if (job->use[ZIGN_MATCH_HASH]) {
+			r_sign_index_match_hash (job->idx, m->fcn, m->bbhash, collectHitCB, &m->hits[ZIGN_MATCH_HASH]);
 		}
 	}
-	r_cons_break_pop ();
-	free (buf);
-
-	return retval;
+	return true;
 }
 
 static bool search(RCore *core, bool rad, bool only_func) {
@@ -825,16 +840,20 @@ static bool search(RCore *core, bool rad, bool only_func) {
 		}
 	}
 
-	// Bytes search
+	// Bytes search, the signatures are compiled once for all the maps
 	if (useBytes && !only_func) {
 		list = r_core_get_boundaries_prot (core, -1, mode, "search");
 		if (!list) {
 			return false;
 		}
+		RSignSearch *ss = r_sign_search_new ();
+		ss->search->align = r_config_get_i (core->config, "search.align");
+		r_sign_search_init (core->anal, ss, r_config_get_i (core->config, "zign.minsz"), searchHitCB, &bytes_search_ctx);
 		r_list_foreach (list, iter, map) {
 			eprintf ("[+] searching 0x%08"PFMT64x" - 0x%08"PFMT64x"\n", map->itv.addr, r_itv_end (map->itv));
-			retval &= searchRange (core, map->itv.addr, r_itv_end (map->itv), rad, &bytes_search_ctx);
+			retval &= searchRange (core, ss, map->itv.addr, r_itv_end (map->itv), rad, &bytes_search_ctx);
 		}
+		r_sign_search_free (ss);
 		r_list_free (list);
 	}
 
@@ -842,7 +861,12 @@ static bool search(RCore *core, bool rad, bool only_func) {
 	if (useGraph || useOffset || useRefs || useHash || (useBytes && only_func)) {
 		eprintf ("[+] searching function metrics\n");
 		r_cons_break_push (NULL, NULL);
+		struct ctxSearchCB *match_ctx[ZIGN_MATCH_LAST] = {
+			&graph_match_ctx, &offset_match_ctx, &refs_match_ctx, &hash_match_ctx
+		};
+		struct ctxMatchJob job = { 0 };
 		int count = 0;
+		int i, k;
 
 		RSignSearch *ss = NULL;
 
@@ -852,28 +876,57 @@ static bool search(RCore *core, bool rad, bool only_func) {
 			int minsz = r_config_get_i (core->config, "zign.minsz");
 			r_sign_search_init (core->anal, ss, minsz, searchHitCB, &bytes_search_ctx);
 		}
+		if (useGraph || useOffset || useRefs || useHash) {
+			job.idx = r_sign_index_new (core->anal);
+			job.fcns = calloc (R_MAX (r_list_length (core->anal->fcns), 1), sizeof (ZignFcnMatch));
+			if (!job.idx || !job.fcns) {
+				retval = false;
+			}
+		}
+		job.mincc = mincc;
+		job.use[ZIGN_MATCH_GRAPH] = useGraph && r_sign_index_count (job.idx, R_SIGN_GRAPH);
+		job.use[ZIGN_MATCH_OFFSET] = useOffset && r_sign_index_count (job.idx, R_SIGN_OFFSET);
+		job.use[ZIGN_MATCH_REFS] = useRefs && r_sign_index_count (job.idx, R_SIGN_REFS);
+		job.use[ZIGN_MATCH_HASH] = useHash && r_sign_index_count (job.idx, R_SIGN_BBHASH);
+		if (job.fcns) {
+			// the features reading io and flags are computed here, the
+			// index lookups run in the thread pool
+			r_list_foreach (core->anal->fcns, iter, fcni) {
+				ZignFcnMatch *m = &job.fcns[job.count++];
+				m->fcn = fcni;
+				if (job.use[ZIGN_MATCH_HASH]) {
+					m->bbhash = r_sign_calc_bbhash (core->anal, fcni);
+				}
+				if (job.use[ZIGN_MATCH_REFS]) {
+					m->refs = r_sign_fcn_refs (core->anal, fcni);
+				}
+				for (k = 0; k < ZIGN_MATCH_LAST; k++) {
+					r_pvector_init (&m->hits[k], NULL);
+				}
+			}
+			RThreadPool *pool = r_th_pool_new (r_config_get_i (core->config, "zign.jobs"));
+			r_th_pool_run (pool, (job.count + ZIGN_CHUNK - 1) / ZIGN_CHUNK, matchJob, &job);
+			r_th_pool_free (pool);
+		}
 
 		r_list_foreach (core->anal->fcns, iter, fcni) {
 			if (r_cons_is_breaked ()) {
 				break;
 			}
-			if (useGraph) {
-				r_sign_match_graph (core->anal, fcni, mincc, fcnMatchCB, &graph_match_ctx);
-			}
-			if (useOffset) {
-				r_sign_match_addr (core->anal, fcni, fcnMatchCB, &offset_match_ctx);
-			}
-			if (useRefs) {
-				r_sign_match_refs (core->anal, fcni, fcnMatchCB, &refs_match_ctx);
-			}
-			if (useHash) {
-				r_sign_match_hash (core->anal, fcni, fcnMatchCB, &hash_match_ctx);
+			if (job.fcns) {
+				// job.fcns follows the function list
+				ZignFcnMatch *m = &job.fcns[count];
+				for (k = 0; k < ZIGN_MATCH_LAST; k++) {
+					for (i = 0; i < r_pvector_len (&m->hits[k]); i++) {
+						fcnMatchCB (r_pvector_at (&m->hits[k], i), fcni, match_ctx[k]);
+					}
+				}
 			}
 			if (useBytes && only_func) {
 				eprintf ("Matching func %d / %d (hits %d)\n", count, r_list_length (core->anal->fcns), bytes_search_ctx.count);
 				int fcnlen = r_anal_fcn_realsize (fcni);
 				int len = R_MIN (core->io->addrbytes * fcnlen, maxsz);
-				retval &= searchRange2 (core, ss, fcni->addr, fcni->addr + len, rad, &bytes_search_ctx);
+				retval &= searchRange (core, ss, fcni->addr, fcni->addr + len, rad, &bytes_search_ctx);
 			}
 			count ++;
 #if 0
@@ -882,6 +935,16 @@ TODO: add useXRefs, useName
 		}
 		r_cons_break_pop ();
 		r_sign_search_free (ss);
+		for (i = 0; i < job.count; i++) {
+			ZignFcnMatch *m = &job.fcns[i];
+			free (m->bbhash);
+			r_list_free (m->refs);
+			for (k = 0; k < ZIGN_MATCH_LAST; k++) {
+				r_pvector_clear (&m->hits[k]);
+			}
+		}
+		free (job.fcns);
+		r_sign_index_free (job.idx);
 	}
 
 	if (rad) {
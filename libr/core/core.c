@@ -2586,6 +2586,8 @@ R_API RCore *r_core_fini(RCore *c) {
 	//update_sdb (c);
 	// avoid double free
 	r_list_free (c->ropchain);
+	ht_up_free (c->disasm_cache);
+	r_list_free (c->rop_index);
 	r_event_free (c->ev);
 	R_FREE (c->cmdlog);
 	r_th_lock_free (c->lock);
@@ -267,6 +267,7 @@ typedef struct {
 	bool prev_ins_eq;
 	int prev_ins_count;
 	bool show_nodup;
+	bool use_cache;
 	bool has_description;
 	// caches
 	char *_tabsbuf;
@@ -632,6 +633,7 @@ static RDisasmState * ds_init(RCore *core) {
 	ds->pre_emu = r_config_get_i (core->config, "emu.pre");
 	ds->show_flgoff = r_config_get_i (core->config, "asm.flags.offset");
 	ds->show_nodup = r_config_get_i (core->config, "asm.nodup");
+	ds->use_cache = r_config_get_i (core->config, "asm.cache");
 	{
 		const char *ah = r_config_get (core->config, "asm.highlight");
 		ds->asm_highlight = (ah && *ah)? r_num_math (core->num, ah): UT64_MAX;
@@ -1187,6 +1189,11 @@ static void ds_begin_line(RDisasmState *ds) {
 	ds->buf_line_begin = r_cons_get_buffer_len ();
 }
 
+// scr.stream may have written out the buffer since the line began
+static int ds_line_begin(RDisasmState *ds) {
+	return ds->buf_line_begin <= r_cons_get_buffer_len ()? ds->buf_line_begin: 0;
+}
+
 static void ds_newline(RDisasmState *ds) {
 	if (ds->pj) {
 		pj_s (ds->pj, r_cons_get_buffer ());
@@ -2227,32 +2234,214 @@ static void ds_update_ref_lines(RDisasmState *ds) {
 	}
 }
 
+/* decoded instructions are kept in core->disasm_cache across calls, so
+ * redrawing a scrolled view only decodes the newly exposed lines. the
+ * entries are checked against all the bytes of the op and the arch setup
+ * on every hit, and the hints are applied after the lookup */
+#define DS_CACHE_BYTES 32
+#define DS_CACHE_MAX 16384
+
+typedef struct {
+	ut8 *bytes;
+	int nbytes; // grows to the size of the decoded ops
+	int window; // bytes available when the entry was made, up to DS_CACHE_BYTES
+	bool has_asm;
+	int asm_ret;
+	int asm_bits;
+	int asm_syntax;
+	RAsmPlugin *asm_cur;
+	RAsmOp asmop;
+	bool has_anal;
+	int anal_ret;
+	int anal_bits;
+	RAnalPlugin *anal_cur;
+	RAnalOp analop;
+} DisasmCacheItem;
+
+static void ds_cache_kv_free(HtUPKv *kv) {
+	DisasmCacheItem *ci = kv->value;
+	r_asm_op_fini (&ci->asmop);
+	r_anal_op_fini (&ci->analop);
+	free (ci->bytes);
+	free (ci);
+}
+
+// drop the cache when any option changing the decoding did
+static void ds_cache_sync(RDisasmState *ds) {
+	const char *keys[] = {
+		"asm.arch", "asm.cpu", "asm.features", "asm.syntax", "asm.invhex",
+		"asm.imm.arm", "asm.pcalign", "asm.seggrn", "cfg.bigendian",
+		"anal.arch", "anal.cpu", "anal.gp", NULL
+	};
+	RCore *core = ds->core;
+	ut32 sig = 0;
+	int i;
+	if (!ds->use_cache) {
+		return;
+	}
+	for (i = 0; keys[i]; i++) {
+		const char *v = r_config_get (core->config, keys[i]);
+		sig = (sig * 31) ^ r_str_hash (v? v: "");
+	}
+	if (core->disasm_cache && core->disasm_cache_sig == sig) {
+		return;
+	}
+	ht_up_free (core->disasm_cache);
+	core->disasm_cache = ht_up_new (NULL, ds_cache_kv_free, NULL);
+	core->disasm_cache_sig = sig;
+}
+
+static DisasmCacheItem *ds_cache_item(RDisasmState *ds, const ut8 *buf, int len) {
+	RCore *core = ds->core;
+	if (!ds->use_cache || !core->disasm_cache || len < 1) {
+		return NULL;
+	}
+	int n = R_MIN (len, DS_CACHE_BYTES);
+	DisasmCacheItem *ci = ht_up_find (core->disasm_cache, ds->at, NULL);
+	if (ci) {
+		if (ci->window == n && ci->nbytes <= len && !memcmp (ci->bytes, buf, ci->nbytes)) {
+			return ci;
+		}
+		ht_up_delete (core->disasm_cache, ds->at);
+	} else if (core->disasm_cache->count >= DS_CACHE_MAX) {
+		ht_up_free (core->disasm_cache);
+		core->disasm_cache = ht_up_new (NULL, ds_cache_kv_free, NULL);
+	}
+	ci = R_NEW0 (DisasmCacheItem);
+	if (!ci) {
+		return NULL;
+	}
+	ci->bytes = r_mem_dup (buf, n);
+	if (!ci->bytes) {
+		free (ci);
+		return NULL;
+	}
+	ci->nbytes = ci->window = n;
+	ht_up_insert (core->disasm_cache, ds->at, ci);
+	return ci;
+}
+
+// make the entry cover the whole decoded op, false if the buffer is too short for it
+static bool ds_cache_cover(DisasmCacheItem *ci, const ut8 *buf, int len, int size) {
+	if (size <= ci->nbytes) {
+		return true;
+	}
+	if (size > len) {
+		return false;
+	}
+	ut8 *bytes = realloc (ci->bytes, size);
+	if (!bytes) {
+		return false;
+	}
+	memcpy (bytes + ci->nbytes, buf + ci->nbytes, size - ci->nbytes);
+	ci->bytes = bytes;
+	ci->nbytes = size;
+	return true;
+}
+
+static void ds_cache_anal_op_copy(RAnalOp *dst, RAnalOp *src) {
+	int i;
+	*dst = *src;
+	dst->mnemonic = src->mnemonic? strdup (src->mnemonic): NULL;
+	for (i = 0; i < R_ARRAY_SIZE (src->src); i++) {
+		dst->src[i] = src->src[i]? r_anal_value_copy (src->src[i]): NULL;
+	}
+	dst->dst = src->dst? r_anal_value_copy (src->dst): NULL;
+	dst->var = NULL;
+	r_strbuf_init (&dst->esil);
+	r_strbuf_set (&dst->esil, r_strbuf_get (&src->esil));
+	r_strbuf_init (&dst->opex);
+	r_strbuf_set (&dst->opex, r_strbuf_get (&src->opex));
+}
+
+static void ds_cache_asm_op_copy(RAsmOp *dst, RAsmOp *src) {
+	int len = 0;
+	ut8 *bin = r_strbuf_getbin (&src->buf, &len);
+	r_asm_op_init (dst);
+	dst->size = src->size;
+	dst->bitsize = src->bitsize;
+	dst->payload = src->payload;
+	if (bin) {
+		r_strbuf_setbin (&dst->buf, bin, len);
+	}
+	r_strbuf_set (&dst->buf_asm, r_strbuf_get (&src->buf_asm));
+}
+
+// r_anal_op() for ds->at, the vars used by the instruction are not resolved on cache hits
+static int ds_anal_op(RDisasmState *ds, const ut8 *buf, int len) {
+	RAnal *anal = ds->core->anal;
+	DisasmCacheItem *ci = ds_cache_item (ds, buf, len);
+	if (!ci) {
+		return r_anal_op (anal, &ds->analop, ds->at, buf, len, R_ANAL_OP_MASK_ALL);
+	}
+	if (!ci->has_anal || ci->anal_bits != anal->bits || ci->anal_cur != anal->cur) {
+		r_anal_op_fini (&ci->analop);
+		ci->anal_ret = r_anal_op (anal, &ci->analop, ds->at, buf, len,
+			R_ANAL_OP_MASK_ALL & ~R_ANAL_OP_MASK_HINT);
+		r_anal_var_free (ci->analop.var);
+		ci->analop.var = NULL;
+		ci->anal_bits = anal->bits;
+		ci->anal_cur = anal->cur;
+		ci->has_anal = !ci->analop.switch_op && !ci->analop.next
+			&& ds_cache_cover (ci, buf, len, ci->analop.size);
+		if (!ci->has_anal) {
+			ds->analop = ci->analop;
+			r_anal_op_init (&ci->analop);
+			r_anal_op_hint (&ds->analop, ds->hint);
+			return ci->anal_ret;
+		}
+	}
+	ds_cache_anal_op_copy (&ds->analop, &ci->analop);
+	r_anal_op_hint (&ds->analop, ds->hint);
+	return ci->anal_ret;
+}
+
+static int ds_asm_disassemble(RDisasmState *ds, const ut8 *buf, int len) {
+	RAsm *a = ds->core->assembler;
+	DisasmCacheItem *ci = NULL;
+	// bit shifted and filtered output depend on more than the bytes
+	if (!a->bitshift && !a->ofilter && a->pc == ds->at) {
+		ci = ds_cache_item (ds, buf, len);
+	}
+	if (!ci) {
+		return r_asm_disassemble (a, &ds->asmop, buf, len);
+	}
+	if (!ci->has_asm || ci->asm_bits != a->bits || ci->asm_syntax != a->syntax || ci->asm_cur != a->cur) {
+		r_asm_op_fini (&ci->asmop);
+		ci->asm_ret = r_asm_disassemble (a, &ci->asmop, buf, len);
+		ci->asm_bits = a->bits;
+		ci->asm_syntax = a->syntax;
+		ci->asm_cur = a->cur;
+		ci->has_asm = !ci->asmop.bitsize && !ci->asmop.buf_inc
+			&& ds_cache_cover (ci, buf, len, ci->asmop.size);
+		if (!ci->has_asm) {
+			ds->asmop = ci->asmop;
+			r_asm_op_init (&ci->asmop);
+			return ci->asm_ret;
+		}
+	}
+	ds_cache_asm_op_copy (&ds->asmop, &ci->asmop);
+	return ci->asm_ret;
+}
+
 static int ds_disassemble(RDisasmState *ds, ut8 *buf, int len) {
 	RCore *core = ds->core;
 	int ret;
-	const char *info;
-	Sdb *s = core->anal->sdb_meta;
-	char key[100];
+	const int sized[] = {
+		R_META_TYPE_DATA,
+		R_META_TYPE_STRING,
+		R_META_TYPE_FORMAT,
+		R_META_TYPE_MAGIC,
+		R_META_TYPE_HIDE,
+	};
 	ut64 mt_sz = UT64_MAX;
+	int t;
 
 	//handle meta info to fix ds->oplen
-	snprintf (key, sizeof (key) - 1, "meta.0x%"PFMT64x, ds->at);
-	info = sdb_const_get (s, key, 0);
-	if (info) {
-		for (;*info; info++) {
-			switch (*info) {
-			case R_META_TYPE_DATA:
-			case R_META_TYPE_STRING:
-			case R_META_TYPE_FORMAT:
-			case R_META_TYPE_MAGIC:
-			case R_META_TYPE_HIDE:
-				snprintf (key, sizeof (key) - 1,
-						"meta.%c.0x%"PFMT64x, *info, ds->at);
-				sdb_const_get (s, key, 0);
-				mt_sz = sdb_array_get_num (s, key, 0, 0);
-				//if (mt_sz) { break; }
-				break;
-			}
+	for (t = 0; t < R_ARRAY_SIZE (sized); t++) {
+		RAnalMetaItem *mi = r_meta_find (core->anal, ds->at, sized[t], R_META_WHERE_HERE);
+		if (mi) {
+			mt_sz = mi->size;
 		}
 	}
 	if (ds->hint && ds->hint->bits) {
@@ -2268,7 +2457,7 @@ static int ds_disassemble(RDisasmState *ds, ut8 *buf, int len) {
 		ds->opstr = strdup (ds->hint->opcode);
 	}
 	r_asm_op_fini (&ds->asmop);
-	ret = r_asm_disassemble (core->assembler, &ds->asmop, buf, len);
+	ret = ds_asm_disassemble (ds, buf, len);
 	if (ds->asmop.size < 1) {
 		ds->asmop.size = 1;
 	}
@@ -2376,7 +2565,7 @@ static int ds_disassemble(RDisasmState *ds, ut8 *buf, int len) {
 		char *ba = r_asm_op_get_asm (&ds->asmop);
 		*ba = toupper ((ut8)*ba);
 	}
-	if (info && mt_sz != UT64_MAX) {
+	if (mt_sz != UT64_MAX) {
 		ds->oplen = mt_sz;
 	}
 	return ret;
@@ -3441,7 +3630,7 @@ static void ds_align_comment(RDisasmState *ds) {
 	if (!ll) {
 		return;
 	}
-	ll += ds->buf_line_begin;
+	ll += ds_line_begin (ds);
 	int cells = r_str_len_utf8_ansi (ll);
 	int cols = ds->interactive ? ds->core->cons->columns : 1024;
 	if (cells < cmtcol) {
@@ -4290,7 +4479,7 @@ static void delete_last_comment(RDisasmState *ds) {
 	if (!ll) {
 		return;
 	}
-	ll += ds->buf_line_begin;
+	ll += ds_line_begin (ds);
 	const char *begin = ll;
 	if (begin) {
 		ds_newline (ds);
@@ -4311,20 +4500,12 @@ static void delete_last_comment(RDisasmState *ds) {
 
 static bool can_emulate_metadata(RCore * core, ut64 at) {
 	const char *emuskipmeta = r_config_get (core->config, "emu.skip");
-	char key[32];
-	Sdb *s = core->anal->sdb_meta;
-	snprintf (key, sizeof (key)-1, "meta.0x%"PFMT64x, at);
-	const char *infos = sdb_const_get (s, key, 0);
-	if (!infos) {
-		/* no metadata: let's emulate this */
-		return true;
-	}
-	for (; *infos; infos++) {
+	for (; *emuskipmeta; emuskipmeta++) {
 		/*
 		 * don't emulate if at least one metadata type
 		 * can't be emulated
 		 */
-		if (*infos != ',' && strchr(emuskipmeta, *infos)) {
+		if (r_meta_find (core->anal, at, *emuskipmeta, R_META_WHERE_HERE)) {
 			return false;
 		}
 	}
@@ -4825,6 +5006,7 @@ R_API int r_core_print_disasm(RPrint *p, RCore *core, ut64 addr, ut8 *buf, int l
 	ds->hint = NULL;
 	ds->buf_line_begin = 0;
 	ds->pdf = pdf;
+	ds_cache_sync (ds);
 
 	if (json) {
 		ds->pj = pj ? pj : pj_new ();
@@ -4936,7 +5118,7 @@ toro:
 		r_asm_set_pc (core->assembler, ds->at);
 		ds_update_ref_lines (ds);
 		r_anal_op_fini (&ds->analop);
-		r_anal_op (core->anal, &ds->analop, ds->at, buf + addrbytes * idx, (int)(len - addrbytes * idx), R_ANAL_OP_MASK_ALL);
+		ds_anal_op (ds, buf + addrbytes * idx, (int)(len - addrbytes * idx));
 		if (ds_must_strip (ds)) {
 			inc = ds->analop.size;
 			// inc = ds->asmop.payload + (ds->asmop.payload % ds->core->assembler->dataalign);
@@ -5036,7 +5218,7 @@ toro:
 #else
 		if (ds->analop.addr != ds->at) {
 			r_anal_op_fini (&ds->analop);
-			r_anal_op (core->anal, &ds->analop, ds->at, buf + addrbytes * idx, (int)(len - addrbytes * idx), R_ANAL_OP_MASK_ALL);
+			ds_anal_op (ds, buf + addrbytes * idx, (int)(len - addrbytes * idx));
 		}
 #endif
 		if (ret < 1) {
@@ -175,6 +175,13 @@ R_API int r_core_project_delete(RCore *core, const char *prjfile) {
 		}
 		free(notes_txt);
 
+		char *snapshot = r_str_newf ("%s%s%s", prjDir, R_SYS_DIR, "snapshot");
+		if (r_file_exists (snapshot)) {
+			r_file_rm (snapshot);
+			eprintf ("rm %s\n", snapshot);
+		}
+		free (snapshot);
+
 		char *rop_d = r_str_newf ("%s%s%s", prjDir, R_SYS_DIR, "rop.d");
 
 		if (r_file_is_directory (rop_d)) {
@@ -678,13 +685,13 @@ static bool projectSaveScript(RCore *core, const char *file, int opts) {
 	{
 		r_core_cmd (core, "fz*", 0);
 		r_cons_flush ();
+		r_core_cmd (core, "fV*", 0);
+		r_cons_flush ();
 	}
 	if (opts & R_CORE_PRJ_META) {
 		r_str_write (fd, "# meta\n");
 		r_meta_list (core->anal, R_META_TYPE_ANY, 1);
 		r_cons_flush ();
-		r_core_cmd (core, "fV*", 0);
-		r_cons_flush ();
 	}
 	if (opts & R_CORE_PRJ_XREFS) {
 		r_core_cmd (core, "ax*", 0);
@@ -745,6 +752,16 @@ R_API bool r_core_project_save_rdb(RCore *core, const char *file, int opts) {
 
 #define TRANSITION 1
 
+static char *projectSnapshotPath(const char *scriptPath) {
+	if (r_str_endswith (scriptPath, R_SYS_DIR "rc")) {
+		char *prjDir = r_file_dirname (scriptPath);
+		char *path = r_str_newf ("%s" R_SYS_DIR "snapshot", prjDir);
+		free (prjDir);
+		return path;
+	}
+	return r_str_newf ("%s.d" R_SYS_DIR "snapshot", scriptPath);
+}
+
 R_API bool r_core_project_save(RCore *core, const char *prjName) {
 	bool scr_null = false;
 	bool ret = true;
@@ -824,7 +841,19 @@ R_API bool r_core_project_save(RCore *core, const char *prjName) {
 			ret = false;
 		}
 	} else {
-		if (!projectSaveScript (core, scriptPath, R_CORE_PRJ_ALL)) {
+		char *snapPath = projectSnapshotPath (scriptPath);
+		int opts = R_CORE_PRJ_ALL;
+		if (r_config_get_i (core->config, "prj.snapshot")) {
+			// the analysis goes into the snapshot instead of the script
+			opts &= ~R_CORE_PRJ_SNAPSHOT;
+			if (!r_core_project_snapshot_save (core, snapPath)) {
+				ret = false;
+			}
+		} else if (r_file_exists (snapPath)) {
+			r_file_rm (snapPath);
+		}
+		free (snapPath);
+		if (!projectSaveScript (core, scriptPath, opts)) {
 			eprintf ("Cannot open '%s' for writing\n", prjName);
 			ret = false;
 		}
@@ -905,6 +934,12 @@ R_API bool r_core_project_load(RCore *core, const char *prjName, const char *rcp
 	const bool scr_prompt = r_config_get_i (core->config, "scr.prompt");
 	(void) projectLoadRop (core, prjName);
 	bool ret = r_core_cmd_file (core, rcpath);
+	char *snapPath = projectSnapshotPath (rcpath);
+	if (r_file_exists (snapPath) && !r_core_project_snapshot_load (core, snapPath)) {
+		eprintf ("Cannot load project snapshot '%s'\n", snapPath);
+		ret = false;
+	}
+	free (snapPath);
 	r_config_set_i (core->config, "cfg.fortunes", cfg_fortunes);
 	r_config_set_i (core->config, "scr.interactive", scr_interactive);
 	r_config_set_i (core->config, "scr.prompt", scr_prompt);
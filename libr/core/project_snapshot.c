@@ -0,0 +1,529 @@
+/* radare - LGPL - Copyright 2019 - pancake */
+
+#include <r_core.h>
+
+/* Binary project snapshots
+ *
+ * The analysis results of a project (functions, basic blocks, xrefs, flags
+ * and the meta, vars, types and hints databases) are stored as flat tables
+ * of fixed size records that are memory mapped and bulk loaded, instead of
+ * being replayed as r2 commands. All the strings live in a single pool and
+ * the records reference them by offset, 0 meaning NULL.
+ *
+ *   header | table directory | STRS | FCNS | BBS | OPPOS | REFS | FLAGS | KVS
+ *
+ * Every table starts 8 byte aligned. Records are in host byte order, the
+ * endian field of the header is used to reject snapshots from other hosts.
+ */
+
+#define SNAP_MAGIC "R2PS"
+#define SNAP_VERSION 1
+#define SNAP_ENDIAN 0x01020304
+#define SNAP_ALIGN(x) (((x) + 7) & ~(ut64)7)
+
+enum {
+	SNAP_STRS = 1,
+	SNAP_FCNS,
+	SNAP_BBS,
+	SNAP_OPPOS,
+	SNAP_REFS,
+	SNAP_FLAGS,
+	SNAP_KVS,
+	SNAP_LAST
+};
+
+typedef struct {
+	char magic[4];
+	ut32 version;
+	ut32 endian;
+	ut32 ntables;
+} SnapHeader;
+
+typedef struct {
+	ut32 kind;
+	ut32 entsize;
+	ut64 count;
+	ut64 offset;
+} SnapTable;
+
+typedef struct {
+	ut64 addr;
+	ut64 diff_addr;
+	ut32 size;
+	ut32 name;
+	ut32 cc;
+	ut32 bb_first;
+	ut32 bb_count;
+	st32 bits;
+	st32 type;
+	st32 stack;
+	st32 maxstack;
+	st32 ninstr;
+	ut32 diff_type;
+	ut8 folded;
+	ut8 bp_frame;
+	ut8 pad[2];
+} SnapFcn;
+
+typedef struct {
+	ut64 addr;
+	ut64 jump;
+	ut64 fail;
+	st32 size;
+	st32 type;
+	st32 ninstr;
+	ut32 op_first;
+	ut32 op_count;
+	ut32 diff; // diff type + 1, 0 when the block has no diff
+} SnapBlock;
+
+typedef struct {
+	ut64 from;
+	ut64 to;
+	ut32 type;
+	ut32 pad;
+} SnapRef;
+
+typedef struct {
+	ut64 offset;
+	ut64 size;
+	ut32 name;
+	ut32 realname;
+	ut32 space;
+	ut32 color;
+	ut32 comment;
+	ut32 alias;
+} SnapFlag;
+
+typedef struct {
+	ut32 db;
+	ut32 key;
+	ut32 value;
+} SnapKv;
+
+/* the sdb databases of RAnal stored in the KVS table, the index is the db
+ * field of the records so only append to this list */
+static const char *snap_dbs[] = { "meta", "fcns", "types", "hints" };
+
+static Sdb *snap_db(RAnal *anal, ut32 db) {
+	return db < R_ARRAY_SIZE (snap_dbs)? sdb_ns (anal->sdb, snap_dbs[db], false): NULL;
+}
+
+typedef struct {
+	RCore *core;
+	RVector tables[SNAP_LAST]; // the STRS one is the string pool
+	HtPP *strs_ht; // string -> offset in the pool
+	ut32 db;
+} SnapWriter;
+
+static ut32 snap_str(SnapWriter *w, const char *s) {
+	bool found;
+	if (!s) {
+		return 0;
+	}
+	ut32 off = (ut32)(size_t)ht_pp_find (w->strs_ht, s, &found);
+	if (found) {
+		return off;
+	}
+	RVector *strs = &w->tables[SNAP_STRS];
+	off = (ut32)strs->len;
+	r_vector_insert_range (strs, strs->len, (void *)s, strlen (s) + 1);
+	ht_pp_insert (w->strs_ht, s, (void *)(size_t)off);
+	return off;
+}
+
+static void snap_save_fcns(SnapWriter *w) {
+	RAnal *anal = w->core->anal;
+	RAnalFunction *fcn;
+	RAnalBlock *bb;
+	RListIter *iter, *iter2;
+	r_list_foreach (anal->fcns, iter, fcn) {
+		SnapFcn sf;
+		memset (&sf, 0, sizeof (sf));
+		sf.addr = fcn->addr;
+		sf.size = r_anal_fcn_size (fcn);
+		sf.name = snap_str (w, fcn->name);
+		sf.cc = snap_str (w, fcn->cc);
+		sf.bits = fcn->bits;
+		sf.type = fcn->type;
+		sf.stack = fcn->stack;
+		sf.maxstack = fcn->maxstack;
+		sf.ninstr = fcn->ninstr;
+		sf.folded = fcn->folded;
+		sf.bp_frame = fcn->bp_frame;
+		if (fcn->diff) {
+			sf.diff_type = fcn->diff->type;
+			sf.diff_addr = fcn->diff->addr;
+		}
+		sf.bb_first = (ut32)w->tables[SNAP_BBS].len;
+		r_list_foreach (fcn->bbs, iter2, bb) {
+			SnapBlock sb;
+			memset (&sb, 0, sizeof (sb));
+			sb.addr = bb->addr;
+			sb.jump = bb->jump;
+			sb.fail = bb->fail;
+			sb.size = bb->size;
+			sb.type = bb->type;
+			sb.ninstr = bb->ninstr;
+			sb.diff = bb->diff? bb->diff->type + 1: 0;
+			// the offset of the first instruction is always 0 and not stored
+			sb.op_first = (ut32)w->tables[SNAP_OPPOS].len;
+			if (bb->op_pos && bb->ninstr > 1) {
+				sb.op_count = R_MIN (bb->ninstr - 1, bb->op_pos_size);
+				r_vector_insert_range (&w->tables[SNAP_OPPOS], w->tables[SNAP_OPPOS].len,
+					bb->op_pos, sb.op_count);
+			}
+			r_vector_push (&w->tables[SNAP_BBS], &sb);
+		}
+		sf.bb_count = (ut32)w->tables[SNAP_BBS].len - sf.bb_first;
+		r_vector_push (&w->tables[SNAP_FCNS], &sf);
+	}
+}
+
+static bool snap_save_ref(void *user, const ut64 k, const void *v) {
+	SnapWriter *w = user;
+	const RAnalRef *ref = v;
+	SnapRef sr;
+	memset (&sr, 0, sizeof (sr));
+	sr.from = ref->at;
+	sr.to = ref->addr;
+	sr.type = ref->type;
+	r_vector_push (&w->tables[SNAP_REFS], &sr);
+	return true;
+}
+
+static bool snap_save_refs(void *user, const ut64 k, const void *v) {
+	ht_up_foreach ((HtUP *)v, snap_save_ref, user);
+	return true;
+}
+
+static bool snap_save_flag(RFlagItem *fi, void *user) {
+	SnapWriter *w = user;
+	SnapFlag sf;
+	memset (&sf, 0, sizeof (sf));
+	sf.offset = fi->offset;
+	sf.size = fi->size;
+	sf.name = snap_str (w, fi->name);
+	sf.realname = snap_str (w, fi->realname);
+	sf.space = snap_str (w, fi->space? fi->space->name: NULL);
+	sf.color = snap_str (w, fi->color);
+	sf.comment = snap_str (w, fi->comment);
+	sf.alias = snap_str (w, fi->alias);
+	r_vector_push (&w->tables[SNAP_FLAGS], &sf);
+	return true;
+}
+
+static int snap_save_kv(void *user, const char *k, const char *v) {
+	SnapWriter *w = user;
+	SnapKv kv = { w->db, snap_str (w, k), snap_str (w, v) };
+	r_vector_push (&w->tables[SNAP_KVS], &kv);
+	return 1;
+}
+
+static bool snap_write(int fd, const void *buf, ut64 len, ut64 *off) {
+	static const ut8 zeros[8] = {0};
+	if (len && write (fd, buf, len) != (st64)len) {
+		return false;
+	}
+	*off += len;
+	ut64 pad = SNAP_ALIGN (*off) - *off;
+	if (pad && write (fd, zeros, pad) != (st64)pad) {
+		return false;
+	}
+	*off += pad;
+	return true;
+}
+
+/* save the analysis of the core into a binary snapshot file */
+R_API bool r_core_project_snapshot_save(RCore *core, const char *file) {
+	r_return_val_if_fail (core && file, false);
+	const size_t entsizes[SNAP_LAST] = {
+		0, 1, sizeof (SnapFcn), sizeof (SnapBlock), sizeof (ut16),
+		sizeof (SnapRef), sizeof (SnapFlag), sizeof (SnapKv)
+	};
+	SnapWriter w = { .core = core };
+	bool ret = false;
+	int i;
+
+	w.strs_ht = ht_pp_new0 ();
+	if (!w.strs_ht) {
+		return false;
+	}
+	for (i = 1; i < SNAP_LAST; i++) {
+		r_vector_init (&w.tables[i], entsizes[i], NULL, NULL);
+	}
+	// offset 0 is reserved for NULL
+	r_vector_push (&w.tables[SNAP_STRS], "");
+
+	snap_save_fcns (&w);
+	ht_up_foreach (core->anal->dict_refs, snap_save_refs, &w);
+	r_flag_foreach (core->flags, snap_save_flag, &w);
+	for (w.db = 0; w.db < R_ARRAY_SIZE (snap_dbs); w.db++) {
+		sdb_foreach (snap_db (core->anal, w.db), snap_save_kv, &w);
+	}
+	if (w.tables[SNAP_STRS].len > UT32_MAX) {
+		eprintf ("Project snapshot string pool is too big\n");
+		goto beach;
+	}
+	int fd = r_sandbox_open (file, O_BINARY | O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1) {
+		eprintf ("Cannot open '%s' for writing\n", file);
+		goto beach;
+	}
+	SnapHeader hdr;
+	SnapTable dir[SNAP_LAST - 1];
+	memcpy (hdr.magic, SNAP_MAGIC, sizeof (hdr.magic));
+	hdr.version = SNAP_VERSION;
+	hdr.endian = SNAP_ENDIAN;
+	hdr.ntables = SNAP_LAST - 1;
+	ut64 off = SNAP_ALIGN (sizeof (hdr) + sizeof (dir));
+	for (i = 1; i < SNAP_LAST; i++) {
+		SnapTable *t = &dir[i - 1];
+		t->kind = i;
+		t->entsize = entsizes[i];
+		t->count = w.tables[i].len;
+		t->offset = off;
+		off = SNAP_ALIGN (off + t->count * t->entsize);
+	}
+	off = 0;
+	ret = snap_write (fd, &hdr, sizeof (hdr), &off) && snap_write (fd, dir, sizeof (dir), &off);
+	for (i = 1; ret && i < SNAP_LAST; i++) {
+		ret = snap_write (fd, w.tables[i].a, w.tables[i].len * entsizes[i], &off);
+	}
+	close (fd);
+	if (!ret) {
+		eprintf ("Cannot write project snapshot '%s'\n", file);
+	}
+beach:
+	for (i = 1; i < SNAP_LAST; i++) {
+		r_vector_clear (&w.tables[i]);
+	}
+	ht_pp_free (w.strs_ht);
+	return ret;
+}
+
+typedef struct {
+	const ut8 *buf;
+	ut64 len;
+	const char *strs;
+	ut64 strs_len;
+	SnapTable tables[SNAP_LAST];
+} SnapReader;
+
+static const char *snap_get_str(SnapReader *r, ut32 id) {
+	return (id && id < r->strs_len)? r->strs + id: NULL;
+}
+
+static const void *snap_rec(SnapReader *r, int kind, ut64 i) {
+	return r->buf + r->tables[kind].offset + i * r->tables[kind].entsize;
+}
+
+static bool snap_open(SnapReader *r, const ut8 *buf, ut64 len) {
+	const size_t minsizes[SNAP_LAST] = {
+		0, 1, sizeof (SnapFcn), sizeof (SnapBlock), sizeof (ut16),
+		sizeof (SnapRef), sizeof (SnapFlag), sizeof (SnapKv)
+	};
+	SnapHeader hdr;
+	ut32 i;
+
+	memset (r, 0, sizeof (*r));
+	if (len < sizeof (hdr)) {
+		return false;
+	}
+	memcpy (&hdr, buf, sizeof (hdr));
+	if (memcmp (hdr.magic, SNAP_MAGIC, 4)) {
+		eprintf ("Invalid project snapshot magic\n");
+		return false;
+	}
+	if (hdr.endian != SNAP_ENDIAN) {
+		eprintf ("Project snapshot was saved on a host with a different endianness\n");
+		return false;
+	}
+	if (hdr.version != SNAP_VERSION) {
+		eprintf ("Unsupported project snapshot version %d\n", hdr.version);
+		return false;
+	}
+	if (hdr.ntables > (len - sizeof (hdr)) / sizeof (SnapTable)) {
+		eprintf ("Truncated project snapshot\n");
+		return false;
+	}
+	r->buf = buf;
+	r->len = len;
+	for (i = 0; i < hdr.ntables; i++) {
+		SnapTable t;
+		memcpy (&t, buf + sizeof (hdr) + i * sizeof (t), sizeof (t));
+		if (t.kind >= SNAP_LAST) {
+			// tables from newer writers are skipped
+			continue;
+		}
+		if (!t.kind || !t.entsize || t.entsize < minsizes[t.kind]
+				|| t.offset > len || t.offset & 7
+				|| t.count > (len - t.offset) / t.entsize) {
+			eprintf ("Invalid table %d in project snapshot\n", t.kind);
+			return false;
+		}
+		r->tables[t.kind] = t;
+	}
+	r->strs = (const char *)buf + r->tables[SNAP_STRS].offset;
+	r->strs_len = r->tables[SNAP_STRS].count;
+	if (r->strs_len && r->strs[r->strs_len - 1]) {
+		eprintf ("Unterminated string pool in project snapshot\n");
+		return false;
+	}
+	return true;
+}
+
+static void snap_load_kvs(SnapReader *r, RAnal *anal) {
+	ut64 i;
+	for (i = 0; i < r->tables[SNAP_KVS].count; i++) {
+		const SnapKv *kv = snap_rec (r, SNAP_KVS, i);
+		Sdb *db = snap_db (anal, kv->db);
+		const char *k = snap_get_str (r, kv->key);
+		if (db && k) {
+			sdb_set (db, k, snap_get_str (r, kv->value), 0);
+		}
+	}
+	// the typed stores are loaded back from the sdb view
+	r_meta_rebuild (anal);
+	r_anal_var_rebuild (anal);
+}
+
+static RAnalBlock *snap_load_block(SnapReader *r, const SnapBlock *sb) {
+	RAnalBlock *bb = r_anal_bb_new ();
+	if (!bb) {
+		return NULL;
+	}
+	bb->addr = sb->addr;
+	bb->jump = sb->jump;
+	bb->fail = sb->fail;
+	bb->size = sb->size;
+	bb->type = sb->type;
+	bb->ninstr = sb->ninstr;
+	if (sb->diff) {
+		bb->diff = r_anal_diff_new ();
+		if (bb->diff) {
+			bb->diff->type = sb->diff - 1;
+		}
+	}
+	const SnapTable *t = &r->tables[SNAP_OPPOS];
+	if (sb->op_count && (ut64)sb->op_first + sb->op_count <= t->count) {
+		ut16 *op_pos = realloc (bb->op_pos, sb->op_count * sizeof (ut16));
+		if (op_pos) {
+			ut64 i;
+			for (i = 0; i < sb->op_count; i++) {
+				memcpy (op_pos + i, snap_rec (r, SNAP_OPPOS, sb->op_first + i), sizeof (ut16));
+			}
+			bb->op_pos = op_pos;
+			bb->op_pos_size = sb->op_count;
+		}
+	}
+	return bb;
+}
+
+static void snap_load_fcns(SnapReader *r, RAnal *anal) {
+	const SnapTable *bbs = &r->tables[SNAP_BBS];
+	ut64 i, j;
+	for (i = 0; i < r->tables[SNAP_FCNS].count; i++) {
+		SnapFcn sf;
+		memcpy (&sf, snap_rec (r, SNAP_FCNS, i), sizeof (sf));
+		const char *name = snap_get_str (r, sf.name);
+		if (!name || (ut64)sf.bb_first + sf.bb_count > bbs->count) {
+			continue;
+		}
+		RAnalFunction *fcn = r_anal_fcn_new ();
+		if (!fcn) {
+			break;
+		}
+		fcn->addr = fcn->meta.min = sf.addr;
+		fcn->name = strdup (name);
+		fcn->cc = r_str_const (snap_get_str (r, sf.cc));
+		fcn->bits = sf.bits;
+		fcn->type = sf.type;
+		fcn->stack = sf.stack;
+		fcn->maxstack = sf.maxstack;
+		fcn->ninstr = sf.ninstr;
+		fcn->folded = sf.folded;
+		fcn->bp_frame = sf.bp_frame;
+		fcn->diff->type = sf.diff_type;
+		fcn->diff->addr = sf.diff_addr;
+		r_anal_fcn_set_size (NULL, fcn, sf.size);
+		for (j = 0; j < sf.bb_count; j++) {
+			SnapBlock sb;
+			memcpy (&sb, snap_rec (r, SNAP_BBS, sf.bb_first + j), sizeof (sb));
+			RAnalBlock *bb = snap_load_block (r, &sb);
+			if (bb) {
+				r_anal_fcn_bbadd (fcn, bb);
+				r_anal_bb_tree_insert (anal, bb);
+			}
+		}
+		r_anal_fcn_update_tinyrange_bbs (fcn);
+		if (!r_anal_fcn_insert (anal, fcn)) {
+			r_anal_fcn_free (fcn);
+		}
+	}
+}
+
+static void snap_load_refs(SnapReader *r, RAnal *anal) {
+	ut64 i;
+	for (i = 0; i < r->tables[SNAP_REFS].count; i++) {
+		SnapRef sr;
+		memcpy (&sr, snap_rec (r, SNAP_REFS, i), sizeof (sr));
+		r_anal_xrefs_set (anal, sr.from, sr.to, sr.type);
+	}
+}
+
+static void snap_load_flags(SnapReader *r, RFlag *f) {
+	ut32 space = UT32_MAX;
+	ut64 i;
+	r_flag_space_push (f, NULL);
+	for (i = 0; i < r->tables[SNAP_FLAGS].count; i++) {
+		SnapFlag sf;
+		memcpy (&sf, snap_rec (r, SNAP_FLAGS, i), sizeof (sf));
+		const char *name = snap_get_str (r, sf.name);
+		if (!name) {
+			continue;
+		}
+		if (sf.space != space) {
+			r_flag_space_set (f, snap_get_str (r, sf.space));
+			space = sf.space;
+		}
+		RFlagItem *fi = r_flag_set (f, name, sf.offset - f->base, sf.size);
+		if (!fi) {
+			continue;
+		}
+		// r_flag_set keeps the space of already existing flags
+		fi->space = r_flag_space_cur (f);
+		r_flag_item_set_realname (fi, snap_get_str (r, sf.realname));
+		if (sf.color) {
+			r_flag_color (f, fi, snap_get_str (r, sf.color));
+		}
+		if (sf.comment) {
+			r_flag_item_set_comment (fi, snap_get_str (r, sf.comment));
+		}
+		if (sf.alias) {
+			r_flag_item_set_alias (fi, snap_get_str (r, sf.alias));
+		}
+	}
+	r_flag_space_pop (f);
+}
+
+/* load a snapshot saved with r_core_project_snapshot_save on top of the
+ * current analysis */
+R_API bool r_core_project_snapshot_load(RCore *core, const char *file) {
+	r_return_val_if_fail (core && file, false);
+	SnapReader r;
+	RMmap *m = r_file_mmap (file, false, 0);
+	if (!m) {
+		return false;
+	}
+	bool ret = m->buf && m->len > 0 && snap_open (&r, m->buf, m->len);
+	if (ret) {
+		// types and vars first, functions reference them
+		snap_load_kvs (&r, core->anal);
+		snap_load_fcns (&r, core->anal);
+		snap_load_refs (&r, core->anal);
+		snap_load_flags (&r, core->flags);
+	}
+	r_file_mmap_free (m);
+	return ret;
+}
@@ -9,6 +9,14 @@
 #include <uv.h>
 #endif
 
+#if __UNIX__
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#endif
+
 #if 0
 SECURITY IMPLICATIONS
 =====================
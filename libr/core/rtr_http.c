@@ -1,21 +1,674 @@
 // included from rtr.c
 
+typedef struct {
+	RCore *core;
+	RSocket *s;
+	RSocketHTTPOptions *so;
+	char port[32];
+	int workers;
+	// worker mode: channel of a worker process to the main core, -1 in the main core
+	int chan;
+	// worker mode: bumped by the main core after each command that may change it
+	volatile int *gen;
+	int mygen; // value of gen when the worker was forked
+	int ppid;
+	bool stop;
+	int ret;
+} HttpServer;
+
+typedef struct {
+	ut64 started;
+	ut64 stopped;
+	ut64 requests;
+	ut64 total;
+	ut64 min;
+	ut64 max;
+	ut64 hist[32]; // requests per log2 bucket of the latency in microseconds
+	int workers;
+} HttpStats;
+
+static HttpStats http_stats = {0};
+static RThreadLock *http_stats_lock = NULL;
+
+static void http_stats_reset(int workers) {
+	if (!http_stats_lock) {
+		http_stats_lock = r_th_lock_new (false);
+	}
+	r_th_lock_enter (http_stats_lock);
+	memset (&http_stats, 0, sizeof (http_stats));
+	http_stats.started = r_sys_now ();
+	http_stats.workers = workers;
+	r_th_lock_leave (http_stats_lock);
+}
+
+// dt is the time in microseconds taken to serve one request
+static void http_stats_add(ut64 dt) {
+	int bucket = 0;
+	while (bucket < 31 && (dt >> (bucket + 1))) {
+		bucket++;
+	}
+	r_th_lock_enter (http_stats_lock);
+	if (!http_stats.requests || dt < http_stats.min) {
+		http_stats.min = dt;
+	}
+	if (dt > http_stats.max) {
+		http_stats.max = dt;
+	}
+	http_stats.requests++;
+	http_stats.total += dt;
+	http_stats.hist[bucket]++;
+	r_th_lock_leave (http_stats_lock);
+}
+
+static void http_stats_stop(void) {
+	r_th_lock_enter (http_stats_lock);
+	http_stats.stopped = r_sys_now ();
+	r_th_lock_leave (http_stats_lock);
+}
+
+/* upper bound in microseconds of the latency of the given percentage of requests */
+static ut64 http_stats_percentile(HttpStats *st, int pc) {
+	ut64 want = (st->requests * pc + 99) / 100;
+	ut64 seen = 0;
+	int i;
+	for (i = 0; i < 32; i++) {
+		seen += st->hist[i];
+		if (seen >= want) {
+			return R_MIN (st->max, (2ULL << i) - 1);
+		}
+	}
+	return st->max;
+}
+
+static char *http_cmd(RCore *core, const char *cmd) {
+	if (*cmd == ':') {
+		/* commands in /cmd/: starting with : do not show any output */
+		r_core_cmd0 (core, cmd + 1);
+		return NULL;
+	}
+	return r_core_cmd_str_pipe (core, cmd);
+}
+
+/* commands known to leave the core as it was, the worker processes run them on
+ * their own copy of it. anything else runs on the main core */
+static bool http_cmd_readonly(const char *cmd) {
+	// families taking any argument
+	static const char *prefixes[] = {
+		"p", "x", "i", NULL
+	};
+	// commands that only list what is there when given no argument
+	static const char *names[] = {
+		"afl", "aflj", "afll", "afllj", "aflq", "aflc", "afi", "afij",
+		"afbj", "afbi", "axt", "axtj", "axf", "axfj", "agf", "agfj",
+		"agc", "agcj", "agj", "ao", "aoj", "f", "fj", "f*", "fs", "fsj",
+		"s", "sj", "e", "ej", "?", "?v", "?vi", "?x", "?e", NULL
+	};
+	int i;
+	while (*cmd == ' ') {
+		cmd++;
+	}
+	// chains, pipes, redirections, subcommands and assignments
+	if (!*cmd || strpbrk (cmd, ";|><`=!(\n")) {
+		return false;
+	}
+	size_t n = strcspn (cmd, " ~@");
+	for (i = 0; names[i]; i++) {
+		if (strlen (names[i]) == n && !strncmp (cmd, names[i], n)) {
+			const char *arg = cmd + n;
+			while (*arg == ' ') {
+				arg++;
+			}
+			return !*arg || *arg == '~' || (*arg == '@' && (*cmd == 'a' || *cmd == '?'));
+		}
+	}
+	// pf.name defines and pfo loads formats, io opens a bin
+	if (!strncmp (cmd, "pf", 2) || !strncmp (cmd, "io", 2)) {
+		return false;
+	}
+	for (i = 0; prefixes[i]; i++) {
+		if (*cmd == *prefixes[i]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+#if __UNIX__
+typedef struct {
+	int type; // 'c' command to run on the main core, 'o' its output, 's' request served
+	int len; // bytes following the message, -1 for no output
+	ut64 dt; // latency of the served request
+} HttpMsg;
+
+static bool http_chan_write(int fd, const void *buf, size_t len) {
+	const ut8 *p = buf;
+	while (len > 0) {
+		ssize_t n = write (fd, p, len);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		p += n;
+		len -= n;
+	}
+	return true;
+}
+
+static bool http_chan_read(int fd, void *buf, size_t len) {
+	ut8 *p = buf;
+	while (len > 0) {
+		ssize_t n = read (fd, p, len);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		p += n;
+		len -= n;
+	}
+	return true;
+}
+
+static bool http_msg_send(int fd, int type, const char *data, int len, ut64 dt) {
+	HttpMsg m = { type, len, dt };
+	return http_chan_write (fd, &m, sizeof (m)) && (len < 1 || http_chan_write (fd, data, len));
+}
+
+// returns the data following the message, m->type is 0 on errors
+static char *http_msg_recv(int fd, HttpMsg *m) {
+	char *data = NULL;
+	if (!http_chan_read (fd, m, sizeof (*m))) {
+		m->type = 0;
+		return NULL;
+	}
+	if (m->len >= 0) {
+		data = malloc (m->len + 1);
+		if (!data || !http_chan_read (fd, data, m->len)) {
+			free (data);
+			m->type = 0;
+			return NULL;
+		}
+		data[m->len] = 0;
+	}
+	return data;
+}
+
+// run cmd on the main core from a worker process
+static char *http_worker_forward(HttpServer *hs, const char *cmd) {
+	HttpMsg m;
+	if (!http_msg_send (hs->chan, 'c', cmd, strlen (cmd), 0)) {
+		hs->stop = true;
+		return NULL;
+	}
+	char *out = http_msg_recv (hs->chan, &m);
+	if (m.type != 'o') {
+		hs->stop = true;
+	}
+	return out;
+}
+#endif
+
+/* serve one request, return -1 to keep serving or the exit code of the server */
+static int http_request(HttpServer *hs, RSocketHTTPRequest *rs) {
+	RCore *core = hs->core;
+	const char *allow = r_config_get (core->config, "http.allow");
+	const char *port = hs->port;
+	char headers[128] = R_EMPTY;
+	char *dir;
+	void *bed;
+
+	if (allow && *allow) {
+		bool accepted = false;
+		const char *allows_host;
+		char *p, *peer = r_socket_to_string (rs->s);
+		char *allows = strdup (allow);
+		//eprintf ("Firewall (%s)\n", allows);
+		int i, count = r_str_split (allows, ',');
+		p = strchr (peer, ':');
+		if (p) {
+			*p = 0;
+		}
+		for (i = 0; i < count; i++) {
+			allows_host = r_str_word_get0 (allows, i);
+			//eprintf ("--- (%s) (%s)\n", host, peer);
+			if (!strcmp (allows_host, peer)) {
+				accepted = true;
+				break;
+			}
+		}
+		free (peer);
+		free (allows);
+		if (!accepted) {
+			r_socket_http_close (rs);
+			return -1;
+		}
+	}
+	if (!rs->method || !rs->path) {
+		http_logf (core, "Invalid http headers received from client\n");
+		r_socket_http_close (rs);
+		return -1;
+	}
+	dir = NULL;
+
+	if (!rs->auth) {
+		r_socket_http_response (rs, 401, "", 0, NULL);
+	}
+
+	if (r_config_get_i (core->config, "http.verbose")) {
+		char *peer = r_socket_to_string (rs->s);
+		http_logf (core, "[HTTP] %s %s\n", peer, rs->path);
+		free (peer);
+	}
+	if (r_config_get_i (core->config, "http.dirlist")) {
+		if (r_file_is_directory (rs->path)) {
+			dir = strdup (rs->path);
+		}
+	}
+	if (r_config_get_i (core->config, "http.cors")) {
+		strcpy (headers, "Access-Control-Allow-Origin: *\n"
+			"Access-Control-Allow-Headers: Origin, "
+			"X-Requested-With, Content-Type, Accept\n");
+	}
+	if (!strcmp (rs->method, "OPTIONS")) {
+		r_socket_http_response (rs, 200, "", 0, headers);
+	} else if (!strcmp (rs->method, "GET")) {
+		if (!strncmp (rs->path, "/up/", 4)) {
+			if (r_config_get_i (core->config, "http.upget")) {
+				const char *uproot = r_config_get (core->config, "http.uproot");
+				if (!rs->path[3] || (rs->path[3]=='/' && !rs->path[4])) {
+					char *ptr = rtr_dir_files (uproot);
+					r_socket_http_response (rs, 200, ptr, 0, headers);
+					free (ptr);
+				} else {
+					char *path = r_file_root (uproot, rs->path + 4);
+					if (r_file_exists (path)) {
+						int sz = 0;
+						char *f = r_file_slurp (path, &sz);
+						if (f) {
+							r_socket_http_response (rs, 200, f, sz, headers);
+							free (f);
+						} else {
+							r_socket_http_response (rs, 403, "Permission denied", 0, headers);
+							http_logf (core, "http: Cannot open '%s'\n", path);
+						}
+					} else {
+						if (dir) {
+							char *resp = rtr_dir_files (dir);
+							r_socket_http_response (rs, 404, resp, 0, headers);
+							free (resp);
+						} else {
+							http_logf (core, "File '%s' not found\n", path);
+							r_socket_http_response (rs, 404, "File not found\n", 0, headers);
+						}
+					}
+					free (path);
+				}
+			} else {
+				r_socket_http_response (rs, 403, "", 0, NULL);
+			}
+		} else if (!strncmp (rs->path, "/cmd/", 5)) {
+			const bool colon = r_config_get_i (core->config, "http.colon");
+			if (colon && rs->path[5] != ':') {
+				r_socket_http_response (rs, 403, "Permission denied", 0, headers);
+			} else {
+				char *cmd = rs->path + 5;
+				const char *httpcmd = r_config_get (core->config, "http.uri");
+				const char *httpref = r_config_get (core->config, "http.referer");
+				const bool httpref_enabled = (httpref && *httpref);
+				char *refstr = NULL;
+				if (httpref_enabled) {
+					if (strstr (httpref, "http")) {
+						refstr = strdup (httpref);
+					} else {
+						refstr = r_str_newf ("http://localhost:%d/", atoi (port));
+					}
+				}
+
+				while (*cmd == '/') {
+					cmd++;
+				}
+				if (httpref_enabled && (!rs->referer || (refstr && !strstr (rs->referer, refstr)))) {
+					r_socket_http_response (rs, 503, "", 0, headers);
+				} else {
+					if (httpcmd && *httpcmd) {
+						int len; // do remote http query and proxy response
+						char *res, *bar = r_str_newf ("%s/%s", httpcmd, cmd);
+						bed = r_cons_sleep_begin ();
+						res = r_socket_http_get (bar, NULL, &len);
+						r_cons_sleep_end (bed);
+						if (res) {
+							res[len] = 0;
+							r_cons_println (res);
+						}
+						free (bar);
+					} else {
+						char *out, *cmd = rs->path + 5;
+						r_str_uri_decode (cmd);
+						r_config_set (core->config, "scr.interactive", "false");
+#if __UNIX__
+						if (hs->chan != -1 && (*hs->gen != hs->mygen || !http_cmd_readonly (cmd))) {
+							out = http_worker_forward (hs, cmd);
+						} else
+#endif
+						if (!r_sandbox_enable (0) &&
+								(!strcmp (cmd, "=h*") ||
+								 !strcmp (cmd, "=h--"))) {
+							out = NULL;
+						} else {
+							out = http_cmd (core, cmd);
+						}
+
+						if (out) {
+							char *res = r_str_uri_encode (out);
+							char *newheaders = r_str_newf (
+									"Content-Type: text/plain\n%s", headers);
+							r_socket_http_response (rs, 200, out, 0, newheaders);
+							free (out);
+							free (newheaders);
+							free (res);
+						} else {
+							r_socket_http_response (rs, 200, "", 0, headers);
+						}
+
+						if (!r_sandbox_enable (0)) {
+							if (!strcmp (cmd, "=h*")) {
+								/* do stuff */
+								r_socket_http_close (rs);
+								free (dir);
+								free (refstr);
+								return -2;
+							} else if (!strcmp (cmd, "=h--")) {
+								r_socket_http_close (rs);
+								free (dir);
+								free (refstr);
+								return 0;
+							}
+						}
+					}
+				}
+				free (refstr);
+			}
+		} else {
+			const char *root = r_config_get (core->config, "http.root");
+			const char *homeroot = r_config_get (core->config, "http.homeroot");
+			char *path;
+			if (!strcmp (rs->path, "/")) {
+				free (rs->path);
+				rs->path = strdup ("/index.html");
+			}
+			if (homeroot && *homeroot) {
+				char *homepath = r_file_abspath (homeroot);
+				path = r_file_root (homepath, rs->path);
+				free (homepath);
+				if (!r_file_exists (path) && !r_file_is_directory (path)) {
+					free (path);
+					path = r_file_root (root, rs->path);
+				}
+			} else {
+				path = r_file_root (root, rs->path);
+			}
+			// FD IS OK HERE
+			if (rs->path [strlen (rs->path) - 1] == '/') {
+				path = r_str_append (path, "index.html");
+				//rs->path = r_str_append (rs->path, "index.html");
+			} else {
+				//snprintf (path, sizeof (path), "%s/%s", root, rs->path);
+				if (r_file_is_directory (path)) {
+					char *res = r_str_newf ("Location: %s/\n%s", rs->path, headers);
+					r_socket_http_response (rs, 302, NULL, 0, res);
+					r_socket_http_close (rs);
+					free (path);
+					free (res);
+					R_FREE (dir);
+					return -1;
+				}
+			}
+			if (r_file_exists (path)) {
+				int sz = 0;
+				char *f = r_file_slurp (path, &sz);
+				if (f) {
+					const char *ct = NULL;
+					if (strstr (path, ".js")) {
+						ct = "Content-Type: application/javascript\n";
+					}
+					if (strstr (path, ".css")) {
+						ct = "Content-Type: text/css\n";
+					}
+					if (strstr (path, ".html")) {
+						ct = "Content-Type: text/html\n";
+					}
+					char *hdr = r_str_newf ("%s%s", ct, headers);
+					r_socket_http_response (rs, 200, f, sz, hdr);
+					free (hdr);
+					free (f);
+				} else {
+					r_socket_http_response (rs, 403, "Permission denied", 0, headers);
+					http_logf (core, "http: Cannot open '%s'\n", path);
+				}
+			} else {
+				if (dir) {
+					char *resp = rtr_dir_files (dir);
+					http_logf (core, "Dirlisting %s\n", dir);
+					r_socket_http_response (rs, 404, resp, 0, headers);
+					free (resp);
+				} else {
+					http_logf (core, "File '%s' not found\n", path);
+					r_socket_http_response (rs, 404, "File not found\n", 0, headers);
+				}
+			}
+			free (path);
+		}
+	} else if (!strcmp (rs->method, "POST")) {
+		ut8 *ret;
+		int retlen;
+		char buf[128];
+		if (r_config_get_i (core->config, "http.upload")) {
+			ret = r_socket_http_handle_upload (rs->data, rs->data_length, &retlen);
+			if (ret) {
+				ut64 size = r_config_get_i (core->config, "http.maxsize");
+				if (size && retlen > size) {
+					r_socket_http_response (rs, 403, "403 File too big\n", 0, headers);
+				} else {
+					char *filename = r_file_root (
+						r_config_get (core->config, "http.uproot"),
+						rs->path + 4);
+					http_logf (core, "UPLOADED '%s'\n", filename);
+					r_file_dump (filename, ret, retlen, 0);
+					free (filename);
+					snprintf (buf, sizeof (buf),
+						"<html><body><h2>uploaded %d byte(s). Thanks</h2>\n", retlen);
+						r_socket_http_response (rs, 200, buf, 0, headers);
+				}
+				free (ret);
+			}
+		} else {
+			r_socket_http_response (rs, 403, "403 Forbidden\n", 0, headers);
+		}
+	} else {
+		r_socket_http_response (rs, 404, "Invalid protocol", 0, headers);
+	}
+	r_socket_http_close (rs);
+	free (dir);
+	return -1;
+}
+
+#if __UNIX__
+typedef struct {
+	int pid;
+	int fd; // main core end of the channel, -1 for a free slot
+} HttpWorker;
+
+// loop of a worker process, it leaves once the main core changed
+static void http_worker_serve(HttpServer *hs) {
+	while (!hs->stop && *hs->gen == hs->mygen) {
+		RSocket *client = r_socket_accept_timeout (hs->s, 1);
+		if (!client) {
+			if (getppid () != hs->ppid) {
+				break;
+			}
+			continue;
+		}
+		// the listening socket does not block, the accepted one must
+		r_socket_block_time (client, 1, 0, 0);
+		RSocketHTTPRequest *rs = r_socket_http_read_request (client, hs->so);
+		if (!rs) {
+			continue;
+		}
+		ut64 t0 = r_sys_now ();
+		(void)http_request (hs, rs);
+		if (!http_msg_send (hs->chan, 's', NULL, -1, r_sys_now () - t0)) {
+			break;
+		}
+	}
+}
+
+static bool http_worker_spawn(HttpServer *hs, HttpWorker *workers, int idx) {
+	int i, sv[2];
+	if (socketpair (AF_UNIX, SOCK_STREAM, 0, sv) == -1) {
+		return false;
+	}
+	int pid = r_sys_fork ();
+	if (pid == -1) {
+		close (sv[0]);
+		close (sv[1]);
+		return false;
+	}
+	if (!pid) {
+		close (sv[0]);
+		for (i = 0; i < hs->workers; i++) {
+			if (workers[i].fd != -1) {
+				close (workers[i].fd);
+			}
+		}
+		signal (SIGINT, SIG_DFL);
+		hs->chan = sv[1];
+		hs->mygen = *hs->gen;
+		http_worker_serve (hs);
+		_exit (0);
+	}
+	close (sv[1]);
+	workers[idx].pid = pid;
+	workers[idx].fd = sv[0];
+	return true;
+}
+
+static void http_worker_kill(HttpWorker *w) {
+	kill (w->pid, SIGTERM);
+	close (w->fd);
+	waitpid (w->pid, NULL, 0);
+	w->fd = -1;
+}
+
+// handle a message of a worker, false when it is gone
+static bool http_worker_handle(HttpServer *hs, HttpWorker *w) {
+	RCore *core = hs->core;
+	HttpMsg m;
+	char *cmd = http_msg_recv (w->fd, &m);
+	if (m.type == 's') {
+		http_stats_add (m.dt);
+		return true;
+	}
+	if (m.type != 'c' || !cmd) {
+		free (cmd);
+		return false;
+	}
+	char *out = NULL;
+	if (!r_sandbox_enable (0) && (!strcmp (cmd, "=h*") || !strcmp (cmd, "=h--"))) {
+		hs->stop = true;
+		hs->ret = cmd[2] == '*'? -2: 0;
+	} else {
+		out = http_cmd (core, cmd);
+		if (!http_cmd_readonly (cmd)) {
+			// the workers forked before this run on a stale copy of the core
+			(*hs->gen)++;
+		}
+	}
+	bool ok = http_msg_send (w->fd, 'o', out, out? strlen (out): -1, 0);
+	free (out);
+	free (cmd);
+	return ok;
+}
+
+/* Serve from http.workers forked processes. Each one runs the read-only
+ * commands on its own copy of the core, sharing the opened files, maps and
+ * analysis as they were when it was forked, so several of them run at the
+ * same time. The other commands are sent to the main core and run there one
+ * at a time. Once one of them ran, the workers serve their current request
+ * and leave, and fresh ones are forked from the updated core. */
+static int http_workers_run(HttpServer *hs) {
+	RCore *core = hs->core;
+	HttpWorker *workers = R_NEWS (HttpWorker, hs->workers);
+	struct pollfd *fds = R_NEWS0 (struct pollfd, hs->workers);
+	void *gen = mmap (NULL, sizeof (int), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	int i;
+	if (!workers || !fds || gen == MAP_FAILED) {
+		free (workers);
+		free (fds);
+		if (gen != MAP_FAILED) {
+			munmap (gen, sizeof (int));
+		}
+		return 1;
+	}
+	hs->gen = gen;
+	*hs->gen = 0;
+	hs->ppid = getpid ();
+	for (i = 0; i < hs->workers; i++) {
+		workers[i].fd = -1;
+	}
+	// the workers poll the listening socket together, only one gets each client
+	r_socket_block_time (hs->s, 0, 0, 0);
+	while (!hs->stop && !r_cons_is_breaked ()) {
+		activateDieTime (core);
+		for (i = 0; i < hs->workers; i++) {
+			if (workers[i].fd == -1) {
+				(void)http_worker_spawn (hs, workers, i);
+			}
+			fds[i].fd = workers[i].fd;
+			fds[i].events = POLLIN;
+			fds[i].revents = 0;
+		}
+		void *bed = r_cons_sleep_begin ();
+		int r = poll (fds, hs->workers, 100);
+		r_cons_sleep_end (bed);
+		for (i = 0; r > 0 && i < hs->workers; i++) {
+			if (fds[i].revents && !http_worker_handle (hs, &workers[i])) {
+				http_worker_kill (&workers[i]);
+			}
+		}
+	}
+	for (i = 0; i < hs->workers; i++) {
+		if (workers[i].fd != -1) {
+			http_worker_kill (&workers[i]);
+		}
+	}
+	munmap (gen, sizeof (int));
+	hs->gen = NULL;
+	free (workers);
+	free (fds);
+	return hs->ret;
+}
+#else
+static int http_workers_run(HttpServer *hs) {
+	return 1;
+}
+#endif
+
 // return 1 on error
 static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *path) {
 	RConfig *newcfg = NULL, *origcfg = NULL;
-	char headers[128] = R_EMPTY;
 	RSocketHTTPRequest *rs;
 	char buf[32];
 	int ret = 0;
 	RSocket *s;
 	RSocketHTTPOptions so;
-	char *dir;
 	int iport;
 	const char *host = r_config_get (core->config, "http.bind");
 	const char *root = r_config_get (core->config, "http.root");
 	const char *homeroot = r_config_get (core->config, "http.homeroot");
 	const char *port = r_config_get (core->config, "http.port");
-	const char *allow = r_config_get (core->config, "http.allow");
 	const char *httpui = r_config_get (core->config, "http.ui");
 	const char *httpauthfile = r_config_get (core->config, "http.authfile");
 	char *pfile = NULL;
@@ -155,6 +808,29 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 	core->block = newblk;
 // TODO: handle mutex lock/unlock here
 	r_cons_break_push ((RConsBreak)r_core_rtr_http_stop, core);
+	HttpServer hs = {0};
+	hs.core = core;
+	hs.s = s;
+	hs.so = &so;
+	r_str_ncpy (hs.port, port, sizeof (hs.port));
+	hs.chan = -1;
+	hs.workers = R_MAX (0, (int)r_config_get_i (core->config, "http.workers"));
+#if !__UNIX__
+	if (hs.workers > 0) {
+		eprintf ("http.workers needs fork, serving one request at a time\n");
+		hs.workers = 0;
+	}
+#endif
+	http_stats_reset (hs.workers);
+	if (hs.workers > 0) {
+		eprintf ("Serving with %d worker processes\n", hs.workers);
+		ret = http_workers_run (&hs);
+		free (core->block);
+		core->offset = origoff;
+		core->block = origblk;
+		core->blocksize = origblksz;
+		goto the_end;
+	}
 	while (!r_cons_is_breaked ()) {
 		/* restore environment */
 		core->config = origcfg;
@@ -200,280 +876,13 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 			r_cons_sleep_end (bed);
 			continue;
 		}
-		if (allow && *allow) {
-			bool accepted = false;
-			const char *allows_host;
-			char *p, *peer = r_socket_to_string (rs->s);
-			char *allows = strdup (allow);
-			//eprintf ("Firewall (%s)\n", allows);
-			int i, count = r_str_split (allows, ',');
-			p = strchr (peer, ':');
-			if (p) {
-				*p = 0;
-			}
-			for (i = 0; i < count; i++) {
-				allows_host = r_str_word_get0 (allows, i);
-				//eprintf ("--- (%s) (%s)\n", host, peer);
-				if (!strcmp (allows_host, peer)) {
-					accepted = true;
-					break;
-				}
-			}
-			free (peer);
-			free (allows);
-			if (!accepted) {
-				r_socket_http_close (rs);
-				continue;
-			}
-		}
-		if (!rs->method || !rs->path) {
-			http_logf (core, "Invalid http headers received from client\n");
-			r_socket_http_close (rs);
-			continue;
+		ut64 t0 = r_sys_now ();
+		int res = http_request (&hs, rs);
+		http_stats_add (r_sys_now () - t0);
+		if (res != -1) {
+			ret = res;
+			break;
 		}
-		dir = NULL;
-
-		if (!rs->auth) {
-			r_socket_http_response (rs, 401, "", 0, NULL);
-		}
-
-		if (r_config_get_i (core->config, "http.verbose")) {
-			char *peer = r_socket_to_string (rs->s);
-			http_logf (core, "[HTTP] %s %s\n", peer, rs->path);
-			free (peer);
-		}
-		if (r_config_get_i (core->config, "http.dirlist")) {
-			if (r_file_is_directory (rs->path)) {
-				dir = strdup (rs->path);
-			}
-		}
-		if (r_config_get_i (core->config, "http.cors")) {
-			strcpy (headers, "Access-Control-Allow-Origin: *\n"
-				"Access-Control-Allow-Headers: Origin, "
-				"X-Requested-With, Content-Type, Accept\n");
-		}
-		if (!strcmp (rs->method, "OPTIONS")) {
-			r_socket_http_response (rs, 200, "", 0, headers);
-		} else if (!strcmp (rs->method, "GET")) {
-			if (!strncmp (rs->path, "/up/", 4)) {
-				if (r_config_get_i (core->config, "http.upget")) {
-					const char *uproot = r_config_get (core->config, "http.uproot");
-					if (!rs->path[3] || (rs->path[3]=='/' && !rs->path[4])) {
-						char *ptr = rtr_dir_files (uproot);
-						r_socket_http_response (rs, 200, ptr, 0, headers);
-						free (ptr);
-					} else {
-						char *path = r_file_root (uproot, rs->path + 4);
-						if (r_file_exists (path)) {
-							int sz = 0;
-							char *f = r_file_slurp (path, &sz);
-							if (f) {
-								r_socket_http_response (rs, 200, f, sz, headers);
-								free (f);
-							} else {
-								r_socket_http_response (rs, 403, "Permission denied", 0, headers);
-								http_logf (core, "http: Cannot open '%s'\n", path);
-							}
-						} else {
-							if (dir) {
-								char *resp = rtr_dir_files (dir);
-								r_socket_http_response (rs, 404, resp, 0, headers);
-								free (resp);
-							} else {
-								http_logf (core, "File '%s' not found\n", path);
-								r_socket_http_response (rs, 404, "File not found\n", 0, headers);
-							}
-						}
-						free (path);
-					}
-				} else {
-					r_socket_http_response (rs, 403, "", 0, NULL);
-				}
-			} else if (!strncmp (rs->path, "/cmd/", 5)) {
-				const bool colon = r_config_get_i (core->config, "http.colon");
-				if (colon && rs->path[5] != ':') {
-					r_socket_http_response (rs, 403, "Permission denied", 0, headers);
-				} else {
-					char *cmd = rs->path + 5;
-					const char *httpcmd = r_config_get (core->config, "http.uri");
-					const char *httpref = r_config_get (core->config, "http.referer");
-					const bool httpref_enabled = (httpref && *httpref);
-					char *refstr = NULL;
-					if (httpref_enabled) {
-						if (strstr (httpref, "http")) {
-							refstr = strdup (httpref);
-						} else {
-							refstr = r_str_newf ("http://localhost:%d/", atoi (port));
-						}
-					}
-
-					while (*cmd == '/') {
-						cmd++;
-					}
-					if (httpref_enabled && (!rs->referer || (refstr && !strstr (rs->referer, refstr)))) {
-						r_socket_http_response (rs, 503, "", 0, headers);
-					} else {
-						if (httpcmd && *httpcmd) {
-							int len; // do remote http query and proxy response
-							char *res, *bar = r_str_newf ("%s/%s", httpcmd, cmd);
-							bed = r_cons_sleep_begin ();
-							res = r_socket_http_get (bar, NULL, &len);
-							r_cons_sleep_end (bed);
-							if (res) {
-								res[len] = 0;
-								r_cons_println (res);
-							}
-							free (bar);
-						} else {
-							char *out, *cmd = rs->path + 5;
-							r_str_uri_decode (cmd);
-							r_config_set (core->config, "scr.interactive", "false");
-
-							if (!r_sandbox_enable (0) &&
-									(!strcmp (cmd, "=h*") ||
-									 !strcmp (cmd, "=h--"))) {
-								out = NULL;
-							} else if (*cmd == ':') {
-								/* commands in /cmd/: starting with : do not show any output */
-								r_core_cmd0 (core, cmd + 1);
-								out = NULL;
-							} else {
-								out = r_core_cmd_str_pipe (core, cmd);
-							}
-
-							if (out) {
-								char *res = r_str_uri_encode (out);
-								char *newheaders = r_str_newf (
-										"Content-Type: text/plain\n%s", headers);
-								r_socket_http_response (rs, 200, out, 0, newheaders);
-								free (out);
-								free (newheaders);
-								free (res);
-							} else {
-								r_socket_http_response (rs, 200, "", 0, headers);
-							}
-
-							if (!r_sandbox_enable (0)) {
-								if (!strcmp (cmd, "=h*")) {
-									/* do stuff */
-									r_socket_http_close (rs);
-									free (dir);
-									free (refstr);
-									ret = -2;
-									goto the_end;
-								} else if (!strcmp (cmd, "=h--")) {
-									r_socket_http_close (rs);
-									free (dir);
-									free (refstr);
-									ret = 0;
-									goto the_end;
-								}
-							}
-						}
-					}
-					free (refstr);
-				}
-			} else {
-				const char *root = r_config_get (core->config, "http.root");
-				const char *homeroot = r_config_get (core->config, "http.homeroot");
-				char *path;
-				if (!strcmp (rs->path, "/")) {
-					free (rs->path);
-					rs->path = strdup ("/index.html");
-				}
-				if (homeroot && *homeroot) {
-					char *homepath = r_file_abspath (homeroot);
-					path = r_file_root (homepath, rs->path);
-					free (homepath);
-					if (!r_file_exists (path) && !r_file_is_directory (path)) {
-						free (path);
-						path = r_file_root (root, rs->path);
-					}
-				} else {
-					path = r_file_root (root, rs->path);
-				}
-				// FD IS OK HERE
-				if (rs->path [strlen (rs->path) - 1] == '/') {
-					path = r_str_append (path, "index.html");
-					//rs->path = r_str_append (rs->path, "index.html");
-				} else {
-					//snprintf (path, sizeof (path), "%s/%s", root, rs->path);
-					if (r_file_is_directory (path)) {
-						char *res = r_str_newf ("Location: %s/\n%s", rs->path, headers);
-						r_socket_http_response (rs, 302, NULL, 0, res);
-						r_socket_http_close (rs);
-						free (path);
-						free (res);
-						R_FREE (dir);
-						continue;
-					}
-				}
-				if (r_file_exists (path)) {
-					int sz = 0;
-					char *f = r_file_slurp (path, &sz);
-					if (f) {
-						const char *ct = NULL;
-						if (strstr (path, ".js")) {
-							ct = "Content-Type: application/javascript\n";
-						}
-						if (strstr (path, ".css")) {
-							ct = "Content-Type: text/css\n";
-						}
-						if (strstr (path, ".html")) {
-							ct = "Content-Type: text/html\n";
-						}
-						char *hdr = r_str_newf ("%s%s", ct, headers);
-						r_socket_http_response (rs, 200, f, sz, hdr);
-						free (hdr);
-						free (f);
-					} else {
-						r_socket_http_response (rs, 403, "Permission denied", 0, headers);
-						http_logf (core, "http: Cannot open '%s'\n", path);
-					}
-				} else {
-					if (dir) {
-						char *resp = rtr_dir_files (dir);
-						http_logf (core, "Dirlisting %s\n", dir);
-						r_socket_http_response (rs, 404, resp, 0, headers);
-						free (resp);
-					} else {
-						http_logf (core, "File '%s' not found\n", path);
-						r_socket_http_response (rs, 404, "File not found\n", 0, headers);
-					}
-				}
-				free (path);
-			}
-		} else if (!strcmp (rs->method, "POST")) {
-			ut8 *ret;
-			int retlen;
-			char buf[128];
-			if (r_config_get_i (core->config, "http.upload")) {
-				ret = r_socket_http_handle_upload (rs->data, rs->data_length, &retlen);
-				if (ret) {
-					ut64 size = r_config_get_i (core->config, "http.maxsize");
-					if (size && retlen > size) {
-						r_socket_http_response (rs, 403, "403 File too big\n", 0, headers);
-					} else {
-						char *filename = r_file_root (
-							r_config_get (core->config, "http.uproot"),
-							rs->path + 4);
-						http_logf (core, "UPLOADED '%s'\n", filename);
-						r_file_dump (filename, ret, retlen, 0);
-						free (filename);
-						snprintf (buf, sizeof (buf),
-							"<html><body><h2>uploaded %d byte(s). Thanks</h2>\n", retlen);
-							r_socket_http_response (rs, 200, buf, 0, headers);
-					}
-					free (ret);
-				}
-			} else {
-				r_socket_http_response (rs, 403, "403 Forbidden\n", 0, headers);
-			}
-		} else {
-			r_socket_http_response (rs, 404, "Invalid protocol", 0, headers);
-		}
-		r_socket_http_close (rs);
-		free (dir);
 	}
 the_end:
 	{
@@ -492,6 +901,7 @@ the_end:
 		r_config_set (core->config, "http.ui", httpui);
 	}
 	r_cons_break_pop ();
+	http_stats_stop ();
 	core->http_up = false;
 	free (pfile);
 	r_socket_free (s);
@@ -584,3 +994,62 @@ R_API int r_core_rtr_http(RCore *core, int launch, int browse, const char *path)
 	} while (ret == -2);
 	return ret;
 }
+
+R_API void r_core_rtr_http_stats(RCore *core, int mode) {
+	HttpStats st;
+	if (!http_stats_lock) {
+		if (mode != '-') {
+			eprintf ("The http server was not started\n");
+		}
+		return;
+	}
+	r_th_lock_enter (http_stats_lock);
+	if (mode == '-') {
+		ut64 stopped = http_stats.stopped;
+		int workers = http_stats.workers;
+		memset (&http_stats, 0, sizeof (http_stats));
+		http_stats.started = r_sys_now ();
+		http_stats.stopped = stopped? http_stats.started: 0;
+		http_stats.workers = workers;
+	}
+	st = http_stats;
+	r_th_lock_leave (http_stats_lock);
+	if (mode == '-') {
+		return;
+	}
+	ut64 uptime = (st.stopped? st.stopped: r_sys_now ()) - st.started;
+	double rps = uptime? st.requests * 1000000.0 / uptime: 0;
+	ut64 avg = st.requests? st.total / st.requests: 0;
+	if (mode == 'j') {
+		PJ *pj = pj_new ();
+		if (!pj) {
+			return;
+		}
+		pj_o (pj);
+		pj_kb (pj, "running", !st.stopped);
+		pj_ki (pj, "workers", st.workers);
+		pj_kn (pj, "uptime", uptime);
+		pj_kn (pj, "requests", st.requests);
+		pj_kd (pj, "rps", rps);
+		pj_kn (pj, "avg", avg);
+		pj_kn (pj, "min", st.min);
+		pj_kn (pj, "max", st.max);
+		pj_kn (pj, "p50", http_stats_percentile (&st, 50));
+		pj_kn (pj, "p90", http_stats_percentile (&st, 90));
+		pj_kn (pj, "p99", http_stats_percentile (&st, 99));
+		pj_end (pj);
+		r_cons_println (pj_string (pj));
+		pj_free (pj);
+		return;
+	}
+	// latencies are in microseconds, shown in milliseconds
+	r_cons_printf ("server   %s (%d workers)\n", st.stopped? "stopped": "running", st.workers);
+	r_cons_printf ("uptime   %.3fs\n", uptime / 1000000.0);
+	r_cons_printf ("requests %"PFMT64d"\n", st.requests);
+	r_cons_printf ("req/s    %.2f\n", rps);
+	r_cons_printf ("latency  avg %.3fms min %.3fms max %.3fms\n",
+		avg / 1000.0, st.min / 1000.0, st.max / 1000.0);
+	r_cons_printf ("p50      <%.3fms\n", http_stats_percentile (&st, 50) / 1000.0);
+	r_cons_printf ("p90      <%.3fms\n", http_stats_percentile (&st, 90) / 1000.0);
+	r_cons_printf ("p99      <%.3fms\n", http_stats_percentile (&st, 99) / 1000.0);
+}
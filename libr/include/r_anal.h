@@ -646,6 +646,8 @@ typedef struct r_anal_t {
 	RList *fcns;
 	RBNode *fcn_tree; // keyed on meta.min
 	RBNode *fcn_addr_tree; // keyed on addr
+	RBNode *bb_tree; // blocks of all functions keyed on addr, for r_anal_bb_from_offset
+	struct r_anal_read_ahead_t *read_ahead; // pages of code read by the function analysis
 	RListRange *fcnstore;
 	RList *refs;
 	RList *vartypes;
@@ -656,6 +658,7 @@ typedef struct r_anal_t {
 	int diff_ops;
 	double diff_thbb;
 	double diff_thfcn;
+	int diff_jobs;
 	RIOBind iob;
 	RFlagBind flb;
 	RFlagSet flg_class_set;
@@ -666,6 +669,7 @@ typedef struct r_anal_t {
 	int maxreflines;
 	int trace;
 	int esil_goto_limit;
+	bool esil_compile; // evaluate esil expressions through the compiled code cache
 	int pcalign;
 	int bitshift;
 	//struct r_anal_ctx_t *ctx;
@@ -675,7 +679,8 @@ typedef struct r_anal_t {
 	RList *plugins;
 	Sdb *sdb_types;
 	Sdb *sdb_fmts;
-	Sdb *sdb_meta; // TODO: Future r_meta api
+	Sdb *sdb_meta; // serialized view of meta_tree, for k queries and projects
+	RBNode *meta_tree[256]; // typed metadata store, one interval tree per meta type
 	Sdb *sdb_zigns;
 	HtUP *dict_refs;
 	HtUP *dict_xrefs;
@@ -683,10 +688,13 @@ typedef struct r_anal_t {
 	RSpaces meta_spaces;
 	RSpaces zign_spaces;
 	char *zign_path;
+	char *zign_file; // last file loaded with r_sign_load
+	bool zign_cache; // keep the compiled byte zignatures next to zign_file
 	PrintfCallback cb_printf;
 	//moved from RAnalFcn
 	Sdb *sdb; // root
 	Sdb *sdb_fcns;
+	HtUP *fcn_vars; // fcn addr -> RList<RAnalVar>, typed view of the vars in sdb_fcns
 	Sdb *sdb_pins;
 #define DEPRECATE 1
 #if DEPRECATE
@@ -703,6 +711,7 @@ typedef struct r_anal_t {
 	RAnalCallbacks cb;
 	RAnalOptions opt;
 	RList *reflines;
+	HtUP *refline_ops; // addr -> ReflineOp, branches decoded by the reflines sweep
 	//RList *noreturn;
 	RBNode *rb_hints_ranges; // <RAnalRange>
 	bool merge_hints;
@@ -906,6 +915,11 @@ typedef struct r_anal_bb_t {
 	bool folded;
 	ut64 cmpval;
 	const char *cmpreg;
+	RBNode rb;
+	ut64 rb_max_addr; // maximum of rb_addr + rb_size - 1 in the subtree, for bb interval tree
+	ut64 rb_addr; // range the block is indexed with in anal->bb_tree
+	int rb_size;
+	struct r_anal_t *rb_anal; // set while the block is in anal->bb_tree
 #undef RAnalBlock
 } RAnalBlock;
 
@@ -1134,9 +1148,25 @@ typedef struct r_anal_esil_callbacks_t {
 	int (*reg_write)(ESIL *esil, const char *name, ut64 val);
 } RAnalEsilCallbacks;
 
+/* esil stack entries */
+enum {
+	R_ANAL_ESIL_VAL_NONE = 0,
+	R_ANAL_ESIL_VAL_STR, // plain word, parsed when popped
+	R_ANAL_ESIL_VAL_NUM, // immediate or computed number
+	R_ANAL_ESIL_VAL_REG, // register name, read when popped
+};
+
+typedef struct r_anal_esil_value_t {
+	int type;
+	ut64 num;
+	char *str; // heap copy of words that do not fit in text
+	char text[32]; // word as pushed, empty for computed numbers
+} RAnalEsilValue;
+
 typedef struct r_anal_esil_t {
 	RAnal *anal;
-	char **stack;
+	RAnalEsilValue *stack;
+	bool stack_typed; // keep numbers and registers as tagged values
 	ut64 addrmask;
 	int stacksize;
 	int stackptr;
@@ -1185,12 +1215,42 @@ typedef struct r_anal_esil_t {
 	void *user;
 	int stack_fd;	// ahem, let's not do this
 	RList *sessions; // <RAnalEsilSession*>
+	HtUP *code_cache; // <ut64 addr, RAnalEsilCode*>
 } RAnalEsil;
 
 #undef ESIL
 
 typedef int (*RAnalEsilOp)(RAnalEsil *esil);
 
+/* compiled esil expressions */
+enum {
+	R_ANAL_ESIL_CODE_OP = 0, // resolved operator
+	R_ANAL_ESIL_CODE_IF,     // ?{
+	R_ANAL_ESIL_CODE_ELSE,   // }{
+	R_ANAL_ESIL_CODE_ENDIF,  // }
+	R_ANAL_ESIL_CODE_REG,    // register operand
+	R_ANAL_ESIL_CODE_NUM,    // immediate operand
+	R_ANAL_ESIL_CODE_STR,    // anything else, pushed as is
+};
+
+typedef struct r_anal_esil_code_word_t {
+	int type;
+	const char *str; // word text, used for hooks and string pushes
+	RAnalEsilOp op;
+	RAnalEsilValue val; // preclassified operand, pushed as is
+} RAnalEsilCodeWord;
+
+typedef struct r_anal_esil_code_t {
+	ut64 addr;
+	char *expr; // source expression, the cache key is validated against it
+	char *buf; // tokenized copy of expr, words point inside
+	RAnalEsilCodeWord *words;
+	int len;
+	RReg *reg; // register profile used to resolve the operands
+	ut32 reg_gen;
+	int refs;
+} RAnalEsilCode;
+
 typedef int (*RAnalCmdExt)(/* Rcore */RAnal *anal, const char* input);
 typedef int (*RAnalAnalyzeFunctions)(RAnal *a, ut64 at, ut64 from, int reftype, int depth);
 typedef int (*RAnalExCallback)(RAnal *a, struct r_anal_state_type_t *state, ut64 addr);
@@ -1230,6 +1290,7 @@ typedef struct r_anal_plugin_t {
 	int esil; // can do esil or not
 	int fileformat_type;
 	int custom_fn_anal;
+	int threadsafe; // op can be called from several threads at once
 	int (*init)(void *user);
 	int (*fini)(void *user);
 	int (*reset_counter) (RAnal *anal, ut64 start_addr);
@@ -1363,6 +1424,9 @@ R_API RList *r_anal_bb_list_new(void);
 R_API void r_anal_bb_free(RAnalBlock *bb);
 R_API int r_anal_bb(RAnal *anal, RAnalBlock *bb, ut64 addr, ut8 *buf, ut64 len, int head);
 R_API RAnalBlock *r_anal_bb_from_offset(RAnal *anal, ut64 off);
+R_API void r_anal_bb_tree_insert(RAnal *anal, RAnalBlock *bb);
+R_API void r_anal_bb_tree_delete(RAnalBlock *bb);
+R_API void r_anal_bb_tree_update(RAnalBlock *bb);
 R_API int r_anal_bb_is_in_offset(RAnalBlock *bb, ut64 addr);
 R_API bool r_anal_bb_set_offset(RAnalBlock *bb, int i, ut16 v);
 R_API ut16 r_anal_bb_offset_inst(RAnalBlock *bb, int i);
@@ -1405,12 +1469,20 @@ R_API int r_anal_esil_reg_write(RAnalEsil *esil, const char *dst, ut64 num);
 R_API int r_anal_esil_pushnum(RAnalEsil *esil, ut64 num);
 R_API bool r_anal_esil_push(RAnalEsil *esil, const char *str);
 R_API char *r_anal_esil_pop(RAnalEsil *esil);
+R_API bool r_anal_esil_push_value(RAnalEsil *esil, const RAnalEsilValue *val);
 R_API int r_anal_esil_set_op(RAnalEsil *esil, const char *op, RAnalEsilOp code);
 R_API void r_anal_esil_stack_free(RAnalEsil *esil);
 R_API int r_anal_esil_get_parm_type(RAnalEsil *esil, const char *str);
 R_API int r_anal_esil_get_parm(RAnalEsil *esil, const char *str, ut64 *num);
 R_API int r_anal_esil_condition(RAnalEsil *esil, const char *str);
 
+// esil_compile.c
+R_API RAnalEsilCode *r_anal_esil_compile(RAnalEsil *esil, const char *expr);
+R_API void r_anal_esil_code_free(RAnalEsilCode *code);
+R_API int r_anal_esil_code_run(RAnalEsil *esil, RAnalEsilCode *code);
+R_API RAnalEsilCode *r_anal_esil_code_get(RAnalEsil *esil, ut64 addr, const char *expr);
+R_API void r_anal_esil_code_flush(RAnalEsil *esil);
+
 // esil_interrupt.c
 R_API void r_anal_esil_interrupts_init(RAnalEsil *esil);
 R_API RAnalEsilInterrupt *r_anal_esil_interrupt_new(RAnalEsil *esil, ut32 src_id, RAnalEsilInterruptHandler *ih);
@@ -1463,7 +1535,8 @@ R_API bool r_anal_fcn_add_bb(RAnal *anal, RAnalFunction *fcn,
 		ut64 jump, ut64 fail, int type, RAnalDiff *diff);
 R_API bool r_anal_check_fcn(RAnal *anal, ut8 *buf, ut16 bufsz, ut64 addr, ut64 low, ut64 high);
 R_API void r_anal_fcn_update_tinyrange_bbs(RAnalFunction *fcn);
-R_API void r_anal_fcn_invalidate_read_ahead_cache(void);
+R_API void r_anal_fcn_update_bb_tree(RAnal *anal, RAnalFunction *fcn);
+R_API void r_anal_fcn_invalidate_read_ahead_cache(RAnal *anal);
 R_API void r_anal_fcn_check_bp_use(RAnal *anal, RAnalFunction *fcn);
 
 
@@ -1563,6 +1636,7 @@ R_API int r_anal_var_access_add(RAnal *anal, RAnalVar *var, ut64 from, int set);
 R_API int r_anal_var_access_del(RAnal *anal, RAnalVar *var, ut64 from);
 R_API RAnalVarAccess *r_anal_var_access_get(RAnal *anal, RAnalVar *var, ut64 from);
 R_API RAnalVar *r_anal_var_get_byname (RAnal *anal, ut64 addr, const char* name);
+R_API void r_anal_var_rebuild(RAnal *a);
 R_API void r_anal_extract_vars(RAnal *anal, RAnalFunction *fcn, RAnalOp *op);
 R_API void r_anal_extract_rarg(RAnal *anal, RAnalOp *op, RAnalFunction *fcn, int *reg_set, int *count);
 
@@ -1658,6 +1732,8 @@ R_API void r_anal_data_free (RAnalData *d);
 R_API char *r_anal_data_to_string(RAnalData *d, RConsPrintablePalette *pal);
 
 R_API void r_meta_free(RAnal *m);
+R_API void r_meta_fini(RAnal *a);
+R_API void r_meta_rebuild(RAnal *a);
 R_API RList *r_meta_find_list_in(RAnal *a, ut64 at, int type, int where);
 R_API void r_meta_space_unset_for(RAnal *a, const RSpace *space);
 R_API int r_meta_space_count_for(RAnal *a, const RSpace *space_name);
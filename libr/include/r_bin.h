@@ -256,6 +256,8 @@ typedef struct r_bin_object_t {
 	RBinAddr *binsym[R_BIN_SYM_LAST];
 	struct r_bin_plugin_t *plugin;
 	int lang;
+	bool swift;
+	ut64 pending; // R_BIN_REQ_* items not loaded yet, see bin.lazy
 	Sdb *kv;
 	Sdb *addr2klassmethod;
 	void *bin_obj; // internal pointer used by formats
@@ -323,9 +325,11 @@ typedef struct r_bin_t {
 	int filter; // symbol filtering
 	char strfilter; // string filtering
 	char *strpurge; // purge false positive strings
+	int strjobs; // threads used to scan strings
 	char *srcdir; // dir.source
 	char *prefix; // bin.prefix
 	ut64 filter_rules;
+	bool lazy; // load symbols, strings, classes.. on first use
 	bool demanglercmd;
 	bool verbose;
 	bool use_xtr; // use extract plugins when loading a file?
@@ -733,6 +737,7 @@ R_API void r_bin_file_hash_free(RBinFileHash *fhash);
 
 // binobject functions
 R_API int r_bin_object_set_items(RBinFile *binfile, RBinObject *o);
+R_API void r_bin_object_load_items(RBinFile *binfile, RBinObject *o, ut64 req);
 R_API bool r_bin_object_delete(RBin *bin, ut32 binfile_id);
 R_API void r_bin_mem_free(void *data);
 
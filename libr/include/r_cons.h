@@ -44,6 +44,7 @@ extern "C" {
 
 /* constants */
 #define CONS_MAX_USER 102400
+#define CONS_STREAM_CHUNK 0x40000
 #define CONS_BUFSZ 0x4f00
 #define STR_IS_NULL(x) (!x || !x[0])
 
@@ -403,6 +404,8 @@ typedef enum { COLOR_MODE_DISABLED = 0, COLOR_MODE_16, COLOR_MODE_256, COLOR_MOD
 
 typedef struct r_cons_context_t {
 	RConsGrep grep;
+	const char *grep_pending; // grep of the running command, parsed when it ends
+	int grep_depth;
 	RStack *cons_stack;
 	char *buffer;
 	int buffer_len;
@@ -482,6 +485,9 @@ typedef struct r_cons_t {
 	int ansicon;
 #endif
 	bool flush;
+	int stream; // 0: off, 1: on, 2: only when stdout is not a tty
+	bool streamed; // part of the output was already written by stream
+	int stream_hold; // set while running a command line whose grep spans several commands
 	bool use_utf8; // use utf8 features
 	bool use_utf8_curvy; // use utf8 curved corners
 	bool dotted_lines;
@@ -322,6 +322,9 @@ typedef struct r_core_t {
 	bool scr_gadgets;
 	bool log_events; // core.c:cb_event_handler : log actions from events if cfg.log.events is set
 	RList *ropchain;
+	HtUP *disasm_cache; // decoded instructions by address, see disasm.c
+	ut32 disasm_cache_sig;
+	RList *rop_index; // gadget indexes of the searched ranges, see cmd_search_rop.c
 } RCore;
 
 R_API int r_core_bind(RCore *core, RCoreBind *bnd);
@@ -647,6 +650,8 @@ R_API int r_core_project_delete(RCore *core, const char *prjfile);
 R_API int r_core_project_list(RCore *core, int mode);
 R_API bool r_core_project_save_rdb(RCore *core, const char *file, int opts);
 R_API bool r_core_project_save(RCore *core, const char *file);
+R_API bool r_core_project_snapshot_save(RCore *core, const char *file);
+R_API bool r_core_project_snapshot_load(RCore *core, const char *file);
 R_API char *r_core_project_info(RCore *core, const char *file);
 R_API char *r_core_project_notes_file (RCore *core, const char *file);
 
@@ -695,6 +700,9 @@ R_API void r_core_recover_vars(RCore *core, RAnalFunction *fcn, bool argonly);
 #define R_CORE_PRJ_ANAL_SEEK	0x0400
 #define R_CORE_PRJ_DBG_BREAK   0x0800
 #define R_CORE_PRJ_ALL		0xFFFF
+/* the parts of a project stored in the binary snapshot */
+#define R_CORE_PRJ_SNAPSHOT	(R_CORE_PRJ_FLAGS | R_CORE_PRJ_META | R_CORE_PRJ_XREFS | \
+	R_CORE_PRJ_FCNS | R_CORE_PRJ_ANAL_HINTS | R_CORE_PRJ_ANAL_TYPES)
 
 typedef struct r_core_bin_filter_t {
 	ut64 offset;
@@ -719,6 +727,7 @@ R_API void r_core_rtr_session(RCore *core, const char *input);
 R_API void r_core_rtr_cmd(RCore *core, const char *input);
 R_API int r_core_rtr_http(RCore *core, int launch, int browse, const char *path);
 R_API int r_core_rtr_http_stop(RCore *u);
+R_API void r_core_rtr_http_stats(RCore *core, int mode);
 R_API int r_core_rtr_gdb(RCore *core, int launch, const char *path);
 
 R_API int r_core_visual_prevopsz(RCore *core, ut64 addr);
@@ -88,6 +88,7 @@ typedef struct r_io_t {
 	bool cachemode; // write in cache all the read operations (EXPERIMENTAL)
 	int p_cache;
 	int debug;
+	ut32 gen; // bumped on writes and map changes, readers can use it to drop stale caches
 //#warning remove debug from RIO
 	RIDPool *map_ids;
 	SdbList *maps; //from tail backwards maps with higher priority are found
@@ -95,8 +96,7 @@ typedef struct r_io_t {
 	RPVector map_skyline_shadow; // map parts that are not covered by others
 	RIDStorage *files;
 	RCache *buffer;
-	RList *cache;	//sdblist?
-	RBNode cacheTree;
+	RBTree cache; // RIOCache items sorted by address, never overlapping
 	ut8 *write_mask;
 	int write_mask_len;
 	RIOUndo undo;
@@ -120,7 +120,7 @@ typedef struct r_io_desc_t {
 	char *uri;
 	char *name;
 	char *referer;
-	Sdb *cache;
+	struct r_io_desc_cache_table_t *cache;
 	void *data;
 	struct r_io_plugin_t *plugin;
 	RIO *io;
@@ -167,6 +167,8 @@ typedef struct r_io_plugin_t {
 	RIODesc* (*open)(RIO *io, const char *, int rw, int mode);
 	RList* /*RIODesc* */ (*open_many)(RIO *io, const char *, int rw, int mode);
 	int (*read)(RIO *io, RIODesc *fd, ut8 *buf, int count);
+	// borrow count bytes at addr from a mapped view, NULL if not possible
+	const ut8 *(*read_ptr)(RIO *io, RIODesc *fd, ut64 addr, int count);
 	ut64 (*lseek)(RIO *io, RIODesc *fd, ut64 offset, int whence);
 	int (*write)(RIO *io, RIODesc *fd, const ut8 *buf, int count);
 	int (*close)(RIODesc *desc);
@@ -201,6 +203,7 @@ typedef struct r_io_cache_t {
 	ut8 *data;
 	ut8 *odata;
 	int written;
+	RBNode rb;
 } RIOCache;
 
 #define R_IO_DESC_CACHE_SIZE (sizeof(ut64) * 8)
@@ -209,6 +212,14 @@ typedef struct r_io_desc_cache_t {
 	ut8 cdata[R_IO_DESC_CACHE_SIZE];
 } RIODescCache;
 
+// radix page table indexed by paddr / R_IO_DESC_CACHE_SIZE
+#define R_IO_DESC_CACHE_BITS 8
+#define R_IO_DESC_CACHE_FANOUT (1 << R_IO_DESC_CACHE_BITS)
+typedef struct r_io_desc_cache_table_t {
+	int height; // inner levels above the leaves holding RIODescCache pointers
+	void **root;
+} RIODescCacheTable;
+
 struct r_io_bind_t;
 
 typedef bool (*RIODescUse) (RIO *io, int fd);
@@ -337,6 +348,7 @@ R_API bool r_io_vread_at_mapped(RIO* io, ut64 vaddr, ut8* buf, int len);
 R_API bool r_io_read_at (RIO *io, ut64 addr, ut8 *buf, int len);
 R_API bool r_io_read_at_mapped(RIO *io, ut64 addr, ut8 *buf, int len);
 R_API int r_io_nread_at (RIO *io, ut64 addr, ut8 *buf, int len);
+R_API const ut8 *r_io_read_at_ptr(RIO *io, ut64 addr, ut8 *buf, int len);
 R_API void r_io_alprint(RList *ls);
 R_API bool r_io_write_at (RIO *io, ut64 addr, const ut8 *buf, int len);
 R_API bool r_io_read (RIO *io, ut8 *buf, int len);
@@ -420,6 +432,7 @@ R_API bool r_io_desc_fini (RIO *io);
 /* io/cache.c */
 R_API int r_io_cache_invalidate(RIO *io, ut64 from, ut64 to);
 R_API bool r_io_cache_at(RIO *io, ut64 addr);
+R_API bool r_io_cache_overlap(RIO *io, ut64 addr, int len);
 R_API void r_io_cache_commit(RIO *io, ut64 from, ut64 to);
 R_API void r_io_cache_init(RIO *io);
 R_API void r_io_cache_fini (RIO *io);
@@ -123,6 +123,7 @@ typedef struct r_reg_t {
 	int arch;
 	int bits;
 	int size;
+	ut32 profile_gen; // bumped every time the register items are released
 	bool is_thumb;
 	bool big_endian;
 } RReg;
@@ -50,6 +50,8 @@ typedef struct r_search_hit_t {
 
 typedef int (*RSearchCallback)(RSearchKeyword *kw, void *user, ut64 where);
 
+typedef struct r_search_multi_t RSearchMulti;
+
 typedef struct r_search_t {
 	int n_kws; // hit${n_kws}_${count}
 	int mode;
@@ -71,6 +73,7 @@ typedef struct r_search_t {
 	RList *kws; // TODO: Use r_search_kw_new ()
 	RIOBind iob;
 	char bckwrds;
+	RSearchMulti *multi; // keyword automaton, built on the first update
 } RSearch;
 
 #ifdef R_API
@@ -105,6 +108,13 @@ R_API int r_search_range_set(RSearch *s, ut64 from, ut64 to);
 R_API int r_search_range_reset(RSearch *s);
 R_API int r_search_set_blocksize(RSearch *s, ut32 bsize);
 
+/* multi keyword matcher */
+R_API RSearchMulti *r_search_multi_new(RList *kws);
+R_API void r_search_multi_free(RSearchMulti *m);
+R_API int r_search_multi_count(RSearchMulti *m);
+R_API bool r_search_multi_scan(RSearchMulti *m, const ut8 *buf, int len);
+R_API int r_search_multi_hits(RSearchMulti *m, int idx, const int **at);
+
 R_API int r_search_bmh(const RSearchKeyword *kw, const ut64 from, const ut8 *buf, const int len, ut64 *out);
 
 // TODO: is this an internal API?
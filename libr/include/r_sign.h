@@ -74,13 +74,18 @@ typedef int (*RSignHashMatchCallback)(RSignItem *it, RAnalFunction *fcn, void *u
 typedef int (*RSignRefsMatchCallback)(RSignItem *it, RAnalFunction *fcn, void *user);
 typedef int (*RSignVarsMatchCallback)(RSignItem *it, RAnalFunction *fcn, void *user);
 
+typedef struct r_sign_trie_t RSignTrie;
+
 typedef struct r_sign_search_t {
 	RSearch *search;
 	RList *items;
 	RSignSearchCallback cb;
 	void *user;
+	RSignTrie *trie; // compiled byte patterns, the keywords are only scanned without it
 } RSignSearch;
 
+typedef struct r_sign_index_t RSignIndex;
+
 typedef struct r_sign_options_t {
 	double bytes_diff_threshold;
 	double graph_diff_threshold;
@@ -114,6 +119,15 @@ R_API bool r_sign_match_graph(RAnal *a, RAnalFunction *fcn, int mincc, RSignGrap
 R_API bool r_sign_match_addr(RAnal *a, RAnalFunction *fcn, RSignOffsetMatchCallback cb, void *user);
 R_API bool r_sign_match_hash(RAnal *a, RAnalFunction *fcn, RSignHashMatchCallback cb, void *user);
 R_API bool r_sign_match_refs(RAnal *a, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user);
+R_API bool r_sign_match_vars(RAnal *a, RAnalFunction *fcn, RSignVarsMatchCallback cb, void *user);
+
+R_API RSignIndex *r_sign_index_new(RAnal *a);
+R_API void r_sign_index_free(RSignIndex *idx);
+R_API int r_sign_index_count(RSignIndex *idx, int type);
+R_API bool r_sign_index_match_graph(RSignIndex *idx, RAnalFunction *fcn, int mincc, RSignGraphMatchCallback cb, void *user);
+R_API bool r_sign_index_match_addr(RSignIndex *idx, RAnalFunction *fcn, RSignOffsetMatchCallback cb, void *user);
+R_API bool r_sign_index_match_hash(RSignIndex *idx, RAnalFunction *fcn, const char *bbhash, RSignHashMatchCallback cb, void *user);
+R_API bool r_sign_index_match_refs(RSignIndex *idx, RAnalFunction *fcn, RList *refs, RSignRefsMatchCallback cb, void *user);
 
 R_API bool r_sign_load(RAnal *a, const char *file);
 R_API bool r_sign_load_gz(RAnal *a, const char *filename);
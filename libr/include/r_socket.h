@@ -151,6 +151,7 @@ typedef struct r_socket_http_request {
 } RSocketHTTPRequest;
 
 R_API RSocketHTTPRequest *r_socket_http_accept(RSocket *s, RSocketHTTPOptions *so);
+R_API RSocketHTTPRequest *r_socket_http_read_request(RSocket *client, RSocketHTTPOptions *so);
 R_API void r_socket_http_response(RSocketHTTPRequest *rs, int code, const char *out, int x, const char *headers);
 R_API void r_socket_http_close(RSocketHTTPRequest *rs);
 R_API ut8 *r_socket_http_handle_upload(const ut8 *str, int len, int *olen);
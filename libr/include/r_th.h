@@ -70,9 +70,17 @@ typedef struct r_th_t {
 	int ready;     // thread is properly setup
 } RThread;
 
+typedef bool (*RThreadPoolJob)(void *user, int job);
+
 typedef struct r_th_pool_t {
 	int size;
 	RThread **threads;
+	RThreadLock *lock;
+	RThreadPoolJob fun;
+	void *user;
+	int jobs;
+	int next; // next job to hand out
+	bool breaked;
 } RThreadPool;
 
 #ifdef R_API
@@ -102,6 +110,10 @@ R_API int r_th_lock_enter(RThreadLock *thl);
 R_API int r_th_lock_leave(RThreadLock *thl);
 R_API void *r_th_lock_free(RThreadLock *thl);
 
+R_API RThreadPool *r_th_pool_new(int size);
+R_API void r_th_pool_free(RThreadPool *pool);
+R_API bool r_th_pool_run(RThreadPool *pool, int jobs, RThreadPoolJob fun, void *user);
+
 R_API RThreadCond *r_th_cond_new(void);
 R_API void r_th_cond_signal(RThreadCond *cond);
 R_API void r_th_cond_signal_all(RThreadCond *cond);
@@ -0,0 +1,75 @@
+#ifndef R_PROF_H
+#define R_PROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* hot path counters, only compiled in with R_PROF (make PROF=1) */
+#ifndef R_PROF
+#define R_PROF 0
+#endif
+
+/* threads past the first 63 share the last slot */
+#define R_PROF_SLOTS 64
+
+typedef enum {
+	R_PROF_IO_READ = 0,
+	R_PROF_IO_BYTES,
+	R_PROF_ANAL_OP,
+	R_PROF_ESIL_STEP,
+	R_PROF_SDB_GET,
+	R_PROF_SDB_SET,
+	R_PROF_HT_OP,
+	R_PROF_CONS_BYTES,
+	R_PROF_LAST
+} RProfCounter;
+
+typedef struct r_prof_counters_t {
+	ut64 count[R_PROF_LAST];
+	ut64 ticks[R_PROF_LAST]; // inclusive, only for the timed counters
+} RProfCounters;
+
+/* the cheapest monotonic clock around, see r_prof_ticks_to_ms */
+static inline ut64 r_prof_ticks(void) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	return __builtin_ia32_rdtsc ();
+#elif defined(__GNUC__) && defined(__aarch64__)
+	ut64 t;
+	__asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r" (t));
+	return t;
+#else
+	return r_sys_now ();
+#endif
+}
+
+#if R_PROF
+#define R_PROF_ADD(c, n) (r_prof_counters ()->count[(c)] += (n))
+#define R_PROF_BEGIN(c) const ut64 r_prof_t0_##c = r_prof_ticks ()
+#define R_PROF_END(c) do { \
+		RProfCounters *r_prof_c_ = r_prof_counters (); \
+		r_prof_c_->count[(c)]++; \
+		r_prof_c_->ticks[(c)] += r_prof_ticks () - r_prof_t0_##c; \
+	} while (0)
+#else
+#define R_PROF_ADD(c, n)
+#define R_PROF_BEGIN(c)
+#define R_PROF_END(c)
+#endif
+
+R_API bool r_prof_enabled(void);
+R_API const char *r_prof_clock(void);
+R_API const char *r_prof_name(RProfCounter c);
+R_API bool r_prof_timed(RProfCounter c);
+R_API RProfCounters *r_prof_counters(void);
+R_API void r_prof_thread_fini(void);
+R_API RProfCounters *r_prof_slot(int idx);
+R_API void r_prof_total(RProfCounters *out);
+R_API void r_prof_reset(void);
+R_API double r_prof_ticks_to_ms(ut64 ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
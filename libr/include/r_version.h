@@ -0,0 +1,8 @@
+#ifndef R_VERSION_H
+#define R_VERSION_H 1
+#define R2_VERSION_COMMIT 1
+#define R2_VERSION "3.6.0-git"
+#define R2_GITTAP "3.6.0-git"
+#define R2_GITTIP "607b0c7b9eb1425e18641855ba89298b69fbc627"
+#define R2_BIRTH "2026-10-17__03:36:54"
+#endif
@@ -82,6 +82,10 @@ typedef struct Ht_(t) {
 	HT_(Bucket)* table;  // Actual table.
 	ut32 prime_idx;
 	HT_(Options) opt;
+	// swiss table backend (SDB_HT_SWISS): size is the number of slots
+	ut8 *ctrl;	  // one control byte per slot, 7 bits of the hash or empty/deleted
+	void *slots;	  // elements stored inline, opt.elem_size bytes each
+	ut32 growth_left; // empty slots that can still be filled before rehashing
 } HtName_(Ht);
 
 // Create a new Ht with the provided Options
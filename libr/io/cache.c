@@ -1,16 +1,12 @@
 /* radare - LGPL - Copyright 2008-2018 - pancake */
 
-// TODO: implement a more inteligent way to store cached memory
+/* Cached writes are kept in a red-black tree of non-overlapping items
+ * sorted by address. Writes touching existing items are coalesced into a
+ * single one, so lookups only visit the items that overlap the range. */
 
 #include "r_io.h"
 
-#if 0
-#define CACHE_CONTAINER(x) container_of ((RBNode*)x, RCache, rb)
-
-static void _fcn_tree_calc_max_addr(RBNode *node) {
-	RIOCache *c = CACHE_CONTAINER (node);
-}
-#endif // 0
+#define CACHE_CONTAINER(x) container_of ((RBNode*)(x), RIOCache, rb)
 
 static void cache_item_free(RIOCache *cache) {
 	if (!cache) {
@@ -21,25 +17,57 @@ static void cache_item_free(RIOCache *cache) {
 	free (cache);
 }
 
+static void _cache_item_free(RBNode *node) {
+	cache_item_free (CACHE_CONTAINER (node));
+}
+
+static int _cache_cmp(const void *incoming, const RBNode *in_tree) {
+	const ut64 addr = *(const ut64 *)incoming;
+	const ut64 begin = CACHE_CONTAINER (in_tree)->itv.addr;
+	return addr < begin? -1: addr > begin? 1: 0;
+}
+
+// lower bound is the first item that ends after the incoming address
+static int _cache_cmp_end(const void *incoming, const RBNode *in_tree) {
+	const ut64 addr = *(const ut64 *)incoming;
+	RIOCache *c = CACHE_CONTAINER (in_tree);
+	return (addr < c->itv.addr || addr - c->itv.addr < c->itv.size)? -1: 1;
+}
+
+static inline ut64 cache_last(RIOCache *c) {
+	return c->itv.addr + c->itv.size - 1;
+}
+
+static void cache_read_orig(RIO *io, ut64 addr, ut8 *buf, int len) {
+	int cached = io->cached;
+	bool cm = io->cachemode;
+	io->cached = 0;
+	io->cachemode = false;
+	r_io_read_at (io, addr, buf, len);
+	io->cached = cached;
+	io->cachemode = cm;
+}
+
 R_API bool r_io_cache_at(RIO *io, ut64 addr) {
-	RIOCache *c;
-	RListIter *iter;
-	r_list_foreach (io->cache, iter, c) {
-		if (r_itv_contain (c->itv, addr)) {
-			return true;
-		}
-	}
-	return false;
+	RBNode *node = r_rbtree_lower_bound (io->cache, &addr, _cache_cmp_end);
+	return node && r_itv_contain (CACHE_CONTAINER (node)->itv, addr);
+}
+
+// true if any cached write overlaps [addr, addr + len)
+R_API bool r_io_cache_overlap(RIO *io, ut64 addr, int len) {
+	RBNode *node = r_rbtree_lower_bound (io->cache, &addr, _cache_cmp_end);
+	return node && r_itv_overlap (CACHE_CONTAINER (node)->itv, (RInterval){ addr, len });
 }
 
 R_API void r_io_cache_init(RIO *io) {
-	io->cache = r_list_newf ((RListFree)cache_item_free);
+	io->cache = NULL;
 	io->buffer = r_cache_new ();
 	io->cached = 0;
 }
 
 R_API void r_io_cache_fini (RIO *io) {
-	r_list_free (io->cache);
+	io->gen++;
+	r_rbtree_free (io->cache, _cache_item_free);
 	r_cache_free (io->buffer);
 	io->cache = NULL;
 	io->buffer = NULL;
@@ -47,57 +75,67 @@ R_API void r_io_cache_fini (RIO *io) {
 }
 
 R_API void r_io_cache_commit(RIO *io, ut64 from, ut64 to) {
-	RListIter *iter;
 	RIOCache *c;
 	RInterval range = (RInterval){from, to - from};
-	r_list_foreach (io->cache, iter, c) {
-		// if (from <= c->to - 1 && c->from <= to - 1) {
-		if (r_itv_overlap (c->itv, range)) {
-			int cached = io->cached;
-			io->cached = 0;
-			if (r_io_write_at (io, r_itv_begin (c->itv), c->data, r_itv_size (c->itv))) {
-				c->written = true;
-			} else {
-				eprintf ("Error writing change at 0x%08"PFMT64x"\n", r_itv_begin (c->itv));
-			}
-			io->cached = cached;
-			break; // XXX old behavior, revisit this
+	RBIter it = r_rbtree_lower_bound_forward (io->cache, &from, _cache_cmp_end);
+	r_rbtree_iter_while (it, c, RIOCache, rb) {
+		if (!r_itv_overlap (c->itv, range)) {
+			break;
+		}
+		int cached = io->cached;
+		io->cached = 0;
+		if (r_io_write_at (io, r_itv_begin (c->itv), c->data, r_itv_size (c->itv))) {
+			c->written = true;
+		} else {
+			eprintf ("Error writing change at 0x%08"PFMT64x"\n", r_itv_begin (c->itv));
 		}
+		io->cached = cached;
 	}
 }
 
 R_API void r_io_cache_reset(RIO *io, int set) {
+	io->gen++;
 	io->cached = set;
-	r_list_purge (io->cache);
+	r_rbtree_free (io->cache, _cache_item_free);
+	io->cache = NULL;
 }
 
 R_API int r_io_cache_invalidate(RIO *io, ut64 from, ut64 to) {
-	int invalidated = 0;
-	RListIter *iter, *tmp;
+	int i, invalidated = 0;
 	RIOCache *c;
+	RPVector dead;
 	RInterval range = (RInterval){from, to - from};
-	r_list_foreach_prev_safe (io->cache, iter, tmp, c) {
-		if (r_itv_overlap (c->itv, range)) {
-			int cached = io->cached;
-			io->cached = 0;
-			r_io_write_at (io, r_itv_begin (c->itv), c->odata, r_itv_size (c->itv));
-			io->cached = cached;
-			c->written = false;
-			r_list_delete (io->cache, iter);
-			invalidated++;
+	io->gen++;
+	r_pvector_init (&dead, NULL);
+	RBIter it = r_rbtree_lower_bound_forward (io->cache, &from, _cache_cmp_end);
+	r_rbtree_iter_while (it, c, RIOCache, rb) {
+		if (!r_itv_overlap (c->itv, range)) {
+			break;
 		}
+		r_pvector_push (&dead, c);
+	}
+	for (i = 0; i < r_pvector_len (&dead); i++) {
+		c = r_pvector_at (&dead, i);
+		int cached = io->cached;
+		io->cached = 0;
+		r_io_write_at (io, r_itv_begin (c->itv), c->odata, r_itv_size (c->itv));
+		io->cached = cached;
+		ut64 addr = r_itv_begin (c->itv);
+		r_rbtree_delete (&io->cache, &addr, _cache_cmp, _cache_item_free);
+		invalidated++;
 	}
+	r_pvector_clear (&dead);
 	return invalidated;
 }
 
 R_API int r_io_cache_list(RIO *io, int rad) {
 	int i, j = 0;
-	RListIter *iter;
+	RBIter iter;
 	RIOCache *c;
 	if (rad == 2) {
 		io->cb_printf ("[");
 	}
-	r_list_foreach (io->cache, iter, c) {
+	r_rbtree_foreach (io->cache, iter, c, RIOCache, rb) {
 		const int dataSize = r_itv_size (c->itv);
 		if (rad == 1) {
 			io->cb_printf ("wx ");
@@ -111,8 +149,8 @@ R_API int r_io_cache_list(RIO *io, int rad) {
 			}
 			io->cb_printf ("\n");
 		} else if (rad == 2) {
-			io->cb_printf ("{\"idx\":%"PFMT64d",\"addr\":%"PFMT64d",\"size\":%d,",
-				j, r_itv_begin (c->itv), dataSize);
+			io->cb_printf ("%s{\"idx\":%"PFMT64d",\"addr\":%"PFMT64d",\"size\":%d,",
+				j? ",": "", j, r_itv_begin (c->itv), dataSize);
 			io->cb_printf ("\"before\":\"");
 		  	for (i = 0; i < dataSize; i++) {
 				io->cb_printf ("%02x", c->odata[i]);
@@ -121,8 +159,7 @@ R_API int r_io_cache_list(RIO *io, int rad) {
 		  	for (i = 0; i < dataSize; i++) {
 				io->cb_printf ("%02x", c->data[i]);
 			}
-			io->cb_printf ("\",\"written\":%s}%s", c->written
-				? "true": "false", iter->n? ",": "");
+			io->cb_printf ("\",\"written\":%s}", c->written? "true": "false");
 		} else if (rad == 0) {
 			io->cb_printf ("idx=%d addr=0x%08"PFMT64x" size=%d ", j, r_itv_begin (c->itv), dataSize);
 			for (i = 0; i < dataSize; i++) {
@@ -143,54 +180,116 @@ R_API int r_io_cache_list(RIO *io, int rad) {
 }
 
 R_API bool r_io_cache_write(RIO *io, ut64 addr, const ut8 *buf, int len) {
-	RIOCache *ch;
-	ch = R_NEW0 (RIOCache);
-	if (!ch) {
+	r_return_val_if_fail (io && buf, false);
+	if (len < 1) {
 		return false;
 	}
-	ch->itv = (RInterval){addr, len};
-	ch->odata = (ut8*)calloc (1, len + 1);
-	if (!ch->odata) {
-		free (ch);
-		return false;
+	io->gen++;
+	if (addr + len - 1 < addr) {
+		len = (int)(UT64_MAX - addr + 1);
 	}
-	ch->data = (ut8*)calloc (1, len + 1);
-	if (!ch->data) {
-		free (ch->odata);
-		free (ch);
-		return false;
+	const ut64 last = addr + len - 1;
+	RIOCache *c, *base = NULL;
+	RPVector merged;
+	r_pvector_init (&merged, NULL);
+	// collect the items overlapping or adjacent to the new range
+	ut64 key = addr? addr - 1: 0;
+	RBIter it = r_rbtree_lower_bound_forward (io->cache, &key, _cache_cmp_end);
+	r_rbtree_iter_while (it, c, RIOCache, rb) {
+		if (last != UT64_MAX && c->itv.addr > last + 1) {
+			break;
+		}
+		r_pvector_push (&merged, c);
 	}
-	ch->written = false;
-	{
-		bool cm = io->cachemode;
-		io->cachemode = false;
-		r_io_read_at (io, addr, ch->odata, len);
-		io->cachemode = cm;
+	ut64 from = addr, to = last;
+	size_t i = 0;
+	if (!r_pvector_empty (&merged)) {
+		RIOCache *head = r_pvector_at (&merged, 0);
+		RIOCache *tail = r_pvector_at (&merged, r_pvector_len (&merged) - 1);
+		if (head->itv.addr <= addr) {
+			// the item keeps its address, so it can grow in place
+			base = head;
+			from = head->itv.addr;
+			i = 1;
+		}
+		to = R_MAX (last, cache_last (tail));
 	}
-	memcpy (ch->data, buf, len);
-	r_list_append (io->cache, ch);
+	const size_t size = to - from + 1;
+	ut8 *data, *odata;
+	if (base) {
+		data = realloc (base->data, size);
+		if (!data) {
+			goto fail;
+		}
+		base->data = data;
+		odata = realloc (base->odata, size);
+		if (!odata) {
+			goto fail;
+		}
+		base->odata = odata;
+	} else {
+		c = R_NEW0 (RIOCache);
+		data = malloc (size);
+		odata = malloc (size);
+		if (!c || !data || !odata) {
+			free (c);
+			free (data);
+			free (odata);
+			goto fail;
+		}
+		c->data = data;
+		c->odata = odata;
+	}
+	// original bytes of the part not cached yet, other items provide theirs
+	if (!base || cache_last (base) < last) {
+		const ut64 orig = base? R_MAX (addr, cache_last (base) + 1): addr;
+		cache_read_orig (io, orig, odata + (orig - from), (int)(last - orig + 1));
+	}
+	for (; i < r_pvector_len (&merged); i++) {
+		RIOCache *m = r_pvector_at (&merged, i);
+		const ut64 delta = m->itv.addr - from;
+		memcpy (data + delta, m->data, m->itv.size);
+		memcpy (odata + delta, m->odata, m->itv.size);
+		ut64 maddr = m->itv.addr;
+		r_rbtree_delete (&io->cache, &maddr, _cache_cmp, _cache_item_free);
+	}
+	memcpy (data + (addr - from), buf, len);
+	if (base) {
+		base->itv.size = size;
+		base->written = false;
+	} else {
+		c->itv = (RInterval){from, size};
+		c->written = false;
+		r_rbtree_insert (&io->cache, &from, &c->rb, _cache_cmp);
+	}
+	r_pvector_clear (&merged);
 	return true;
+fail:
+	r_pvector_clear (&merged);
+	return false;
 }
 
 R_API bool r_io_cache_read(RIO *io, ut64 addr, ut8 *buf, int len) {
-	int l, covered = 0;
-	RListIter *iter;
+	int l;
+	bool covered = false;
 	RIOCache *c;
 	RInterval range = (RInterval){ addr, len };
-	r_list_foreach (io->cache, iter, c) {
-		if (r_itv_overlap (c->itv, range)) {
-			const ut64 begin = r_itv_begin (c->itv);
-			if (addr < begin) {
-				l = R_MIN (addr + len - begin, r_itv_size (c->itv));
-				memcpy (buf + begin - addr, c->data, l);
-			} else {
-				l = R_MIN (r_itv_end (c->itv) - addr, len);
-				memcpy (buf, c->data + addr - begin, l);
-			}
-			covered += l;
+	RBIter it = r_rbtree_lower_bound_forward (io->cache, &addr, _cache_cmp_end);
+	r_rbtree_iter_while (it, c, RIOCache, rb) {
+		if (!r_itv_overlap (c->itv, range)) {
+			break;
+		}
+		const ut64 begin = r_itv_begin (c->itv);
+		if (addr < begin) {
+			l = R_MIN (addr + len - begin, r_itv_size (c->itv));
+			memcpy (buf + begin - addr, c->data, l);
+		} else {
+			l = R_MIN (r_itv_end (c->itv) - addr, len);
+			memcpy (buf, c->data + addr - begin, l);
 		}
+		covered = true;
 	}
-	return (covered == 0) ? false: true;
+	return covered;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -166,6 +166,9 @@ R_API int r_io_desc_write(RIODesc *desc, const ut8* buf, int len) {
 	if (!buf || !desc || !desc->plugin || len < 1) {
 		return 0;
 	}
+	if (desc->io) {
+		desc->io->gen++;
+	}
 	//check pointers and pcache
 	if (desc->io && (desc->io->p_cache & 2)) {
 		return r_io_desc_cache_write (desc,
@@ -217,6 +220,9 @@ R_API ut64 r_io_desc_size(RIODesc* desc) {
 R_API bool r_io_desc_resize(RIODesc *desc, ut64 newsize) {
 	if (desc && desc->plugin && desc->plugin->resize) {
 		bool ret = desc->plugin->resize (desc->io, desc, newsize);
+		if (desc->io) {
+			desc->io->gen++;
+		}
 		if (desc->io && desc->io->p_cache) {
 			r_io_desc_cache_cleanup (desc);
 		}
@@ -248,10 +254,11 @@ R_API bool r_io_desc_exchange(RIO* io, int fd, int fdx) {
 	}
 	desc->fd = fdx;
 	descx->fd = fd;
+	io->gen++;
 	r_id_storage_set (io->files, desc,  fdx);
 	r_id_storage_set (io->files, descx, fd);
 	if (io->p_cache) {
-		Sdb* cache = desc->cache;
+		RIODescCacheTable *cache = desc->cache;
 		desc->cache = descx->cache;
 		descx->cache = cache;
 		r_io_desc_cache_cleanup (desc);
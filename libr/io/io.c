@@ -279,12 +279,15 @@ R_API bool r_io_read_at(RIO *io, ut64 addr, ut8 *buf, int len) {
 	if (len == 0) {
 		return false;
 	}
+	R_PROF_BEGIN (R_PROF_IO_READ);
 	bool ret = (io->va)
 		? r_io_vread_at_mapped (io, addr, buf, len)
 		: r_io_pread_at (io, addr, buf, len) > 0;
 	if (io->cached & R_PERM_R) {
 		(void)r_io_cache_read (io, addr, buf, len);
 	}
+	R_PROF_END (R_PROF_IO_READ);
+	R_PROF_ADD (R_PROF_IO_BYTES, len);
 	return ret;
 }
 
@@ -295,6 +298,7 @@ R_API bool r_io_read_at(RIO *io, ut64 addr, ut8 *buf, int len) {
 R_API bool r_io_read_at_mapped(RIO *io, ut64 addr, ut8 *buf, int len) {
 	bool ret;
 	r_return_val_if_fail (io && buf, false);
+	R_PROF_BEGIN (R_PROF_IO_READ);
 	if (io->ff) {
 		memset (buf, io->Oxff, len);
 	}
@@ -306,6 +310,8 @@ R_API bool r_io_read_at_mapped(RIO *io, ut64 addr, ut8 *buf, int len) {
 	if (io->cached & R_PERM_R) {
 		(void)r_io_cache_read(io, addr, buf, len);
 	}
+	R_PROF_END (R_PROF_IO_READ);
+	R_PROF_ADD (R_PROF_IO_BYTES, len);
 	return ret;
 }
 
@@ -318,6 +324,7 @@ R_API int r_io_nread_at(RIO *io, ut64 addr, ut8 *buf, int len) {
 	if (len == 0) {
 		return 0;
 	}
+	R_PROF_BEGIN (R_PROF_IO_READ);
 	if (io->va) {
 		if (io->ff) {
 			memset (buf, io->Oxff, len);
@@ -329,9 +336,65 @@ R_API int r_io_nread_at(RIO *io, ut64 addr, ut8 *buf, int len) {
 	if (ret > 0 && io->cached & R_PERM_R) {
 		(void)r_io_cache_read (io, addr, buf, len);
 	}
+	R_PROF_END (R_PROF_IO_READ);
+	R_PROF_ADD (R_PROF_IO_BYTES, R_MAX (ret, 0));
 	return ret;
 }
 
+static const ut8 *desc_read_ptr(RIODesc *desc, ut64 paddr, int len) {
+	if (!desc || !desc->plugin || !desc->plugin->read_ptr || !(desc->perm & R_PERM_R)) {
+		return NULL;
+	}
+	return desc->plugin->read_ptr (desc->io, desc, paddr, len);
+}
+
+static const ut8 *vread_ptr(RIO *io, ut64 vaddr, int len) {
+	const RPVector *skyline = &io->map_skyline;
+	size_t i;
+#define CMP(addr, part) ((addr) < r_itv_end (((RIOMapSkyline *)(part))->itv) - 1 ? -1 : \
+			(addr) > r_itv_end (((RIOMapSkyline *)(part))->itv) - 1 ? 1 : 0)
+	r_pvector_lower_bound (skyline, vaddr, i, CMP);
+#undef CMP
+	if (i == r_pvector_len (skyline)) {
+		return NULL;
+	}
+	// the whole range must be covered by the visible part of a single map
+	const RIOMapSkyline *part = r_pvector_at (skyline, i);
+	RInterval range = { vaddr, len };
+	if (!r_itv_include (part->itv, range) || !(part->map->perm & R_PERM_R)) {
+		return NULL;
+	}
+	RIOMap *map = part->map;
+	return desc_read_ptr (r_io_desc_get (io, map->fd), map->delta + vaddr - map->itv.addr, len);
+}
+
+/* Borrows len bytes at addr from the mapped view of the file behind them,
+ * without copying. This works when the range lies inside a single map whose
+ * descriptor can hand out pointers (the default plugin when the file is
+ * mmapped) and no cache layer sits on top of it. Otherwise the bytes are
+ * read into buf and buf is returned, or NULL if buf is NULL.
+ * Borrowed memory is read-only and stays valid until the next write or map
+ * change, that is, while io->gen does not change. */
+R_API const ut8 *r_io_read_at_ptr(RIO *io, ut64 addr, ut8 *buf, int len) {
+	r_return_val_if_fail (io && len > 0, NULL);
+	const ut8 *ptr = NULL;
+	bool cached = io->cachemode || (io->p_cache & 1)
+		|| ((io->cached & R_PERM_R) && r_io_cache_overlap (io, addr, len));
+	if (!cached && addr + len - 1 >= addr) {
+		ptr = io->va
+			? vread_ptr (io, addr, len)
+			: desc_read_ptr (io->desc, addr, len);
+	}
+	if (!ptr && buf) {
+		(void)r_io_read_at (io, addr, buf, len);
+		ptr = buf;
+	} else if (ptr) {
+		R_PROF_ADD (R_PROF_IO_READ, 1);
+		R_PROF_ADD (R_PROF_IO_BYTES, len);
+	}
+	return ptr;
+}
+
 R_API bool r_io_write_at(RIO* io, ut64 addr, const ut8* buf, int len) {
 	int i;
 	bool ret = false;
@@ -661,7 +724,7 @@ R_API int r_io_fini(RIO* io) {
 	r_io_desc_fini (io);
 	r_io_map_fini (io);
 	ls_free (io->plugins);
-	r_list_free (io->cache);
+	r_io_cache_fini (io);
 	r_list_free (io->undo.w_list);
 	if (io->runprofile) {
 		R_FREE (io->runprofile);
@@ -358,6 +358,16 @@ static int __write(RIO *io, RIODesc *fd, const ut8 *buf, int len) {
 	return r_io_def_mmap_write(io, fd, buf, len);
 }
 
+static const ut8 *__read_ptr(RIO *io, RIODesc *fd, ut64 addr, int len) {
+	RIOMMapFileObj *mmo = fd->data;
+	if (!mmo || mmo->rawio || !mmo->buf) {
+		return NULL;
+	}
+	ut64 size;
+	const ut8 *data = r_buf_data (mmo->buf, &size);
+	return (data && addr < size && len <= size - addr)? data + addr: NULL;
+}
+
 static ut64 __lseek(RIO *io, RIODesc *fd, ut64 offset, int whence) {
 	return r_io_def_mmap_lseek (io, fd, offset, whence);
 }
@@ -399,6 +409,7 @@ RIOPlugin r_io_plugin_default = {
 	.open = __open_default,
 	.close = __close,
 	.read = __read,
+	.read_ptr = __read_ptr,
 	.check = __plugin_open_default,
 	.lseek = __lseek,
 	.write = __write,
@@ -174,6 +174,16 @@ static int __write(RIO *io, RIODesc *fd, const ut8 *buf, int len) {
 	return r_io_mmap_write(io, fd, buf, len);
 }
 
+static const ut8 *__read_ptr(RIO *io, RIODesc *fd, ut64 addr, int len) {
+	RIOMMapFileObj *mmo = fd->data;
+	if (!mmo || !mmo->buf) {
+		return NULL;
+	}
+	ut64 size;
+	const ut8 *data = r_buf_data (mmo->buf, &size);
+	return (data && addr < size && len <= size - addr)? data + addr: NULL;
+}
+
 static ut64 __lseek(RIO *io, RIODesc *fd, ut64 offset, int whence) {
 	return r_io_mmap_lseek (io, fd, offset, whence);
 }
@@ -197,6 +207,7 @@ struct r_io_plugin_t r_io_plugin_mmap = {
 	.open = __open,
 	.close = __close,
 	.read = __read,
+	.read_ptr = __read_ptr,
 	.check = __plugin_open,
 	.lseek = __lseek,
 	.write = __write,
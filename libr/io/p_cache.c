@@ -70,17 +70,112 @@ const ut64 cleanup_masks[] = {
 	0x7fffffffffffffff
 };
 
+#define PCACHE_MASK (R_IO_DESC_CACHE_FANOUT - 1)
+// enough levels to index any 64 bit paddr
+#define PCACHE_MAX_HEIGHT 7
+
+typedef bool (*PCacheCb)(void *user, ut64 idx, RIODescCache **slot);
+
+static void **pcache_node_new(void) {
+	return R_NEWS0 (void *, R_IO_DESC_CACHE_FANOUT);
+}
+
+static void pcache_node_free(void **node, int level) {
+	int i;
+	if (!node) {
+		return;
+	}
+	for (i = 0; i < R_IO_DESC_CACHE_FANOUT; i++) {
+		if (level > 0) {
+			pcache_node_free (node[i], level - 1);
+		} else {
+			free (node[i]);
+		}
+	}
+	free (node);
+}
+
+// returns the leaf slot of the chunk at idx, missing levels are only created if asked
+static RIODescCache **pcache_slot(RIODescCacheTable *t, ut64 idx, bool create) {
+	int level;
+	while (t->height < PCACHE_MAX_HEIGHT && (idx >> (R_IO_DESC_CACHE_BITS * (t->height + 1)))) {
+		if (!create) {
+			return NULL;
+		}
+		void **root = pcache_node_new ();
+		if (!root) {
+			return NULL;
+		}
+		root[0] = t->root;
+		t->root = root;
+		t->height++;
+	}
+	void **node = t->root;
+	for (level = t->height; level > 0; level--) {
+		void **slot = &node[(idx >> (R_IO_DESC_CACHE_BITS * level)) & PCACHE_MASK];
+		if (!*slot && (!create || !(*slot = pcache_node_new ()))) {
+			return NULL;
+		}
+		node = *slot;
+	}
+	return (RIODescCache **)&node[idx & PCACHE_MASK];
+}
+
+// visits the allocated chunks in address order
+static bool pcache_walk(void **node, int level, ut64 base, PCacheCb cb, void *user) {
+	int i;
+	for (i = 0; i < R_IO_DESC_CACHE_FANOUT; i++) {
+		if (!node[i]) {
+			continue;
+		}
+		const ut64 idx = (base << R_IO_DESC_CACHE_BITS) | i;
+		if (level > 0) {
+			if (!pcache_walk (node[i], level - 1, idx, cb, user)) {
+				return false;
+			}
+		} else if (!cb (user, idx, (RIODescCache **)&node[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static inline ut64 pcache_mask(int from, int n) {
+	return (n < R_IO_DESC_CACHE_SIZE? (1ULL << n) - 1: UT64_MAX) << from;
+}
+
+// finds the next run of cached bytes starting at or after *at and returns its length
+static int pcache_run(ut64 cached, int *at) {
+	int i = *at;
+	while (i < R_IO_DESC_CACHE_SIZE && !(cached & (1ULL << i))) {
+		i++;
+	}
+	*at = i;
+	while (i < R_IO_DESC_CACHE_SIZE && (cached & (1ULL << i))) {
+		i++;
+	}
+	return i - *at;
+}
+
 R_API bool r_io_desc_cache_init(RIODesc *desc) {
 	if (!desc || desc->cache) {
 		return false;
 	}
-	return (desc->cache = sdb_new0 ()) ? true : false;
+	RIODescCacheTable *t = R_NEW0 (RIODescCacheTable);
+	if (!t) {
+		return false;
+	}
+	if (!(t->root = pcache_node_new ())) {
+		free (t);
+		return false;
+	}
+	desc->cache = t;
+	return true;
 }
 
 R_API int r_io_desc_cache_write(RIODesc *desc, ut64 paddr, const ut8 *buf, int len) {
-	RIODescCache *cache;
+	RIODescCache *cache, **slot;
 	ut64 caddr, desc_sz = r_io_desc_size (desc);
-	char k[64];
 	int cbaddr, written = 0;
 	if ((len < 1) || !desc || (desc_sz <= paddr) ||
 	    !desc->io || (!desc->cache && !r_io_desc_cache_init (desc))) {
@@ -95,38 +190,18 @@ R_API int r_io_desc_cache_write(RIODesc *desc, ut64 paddr, const ut8 *buf, int l
 	caddr = paddr / R_IO_DESC_CACHE_SIZE;
 	cbaddr = paddr % R_IO_DESC_CACHE_SIZE;
 	while (written < len) {
-		sdb_itoa (caddr, k, 10);
-		//get an existing desc-cache, if it exists
-		if (!(cache = (RIODescCache *)(size_t)sdb_num_get (desc->cache, k, NULL))) {
-			//create new desc-cache
-			cache = R_NEW0 (RIODescCache);
-			if (!cache) {
-				return 0;
-			}
-			//feed sdb with the new desc-cache
-			sdb_num_set (desc->cache, k, (ut64)(size_t)cache, 0);
+		if (!(slot = pcache_slot (desc->cache, caddr, true))) {
+			break;
 		}
-		//check if the remaining data fits into the cache
-		if ((len - written) > (R_IO_DESC_CACHE_SIZE - cbaddr)) {
-			written += (R_IO_DESC_CACHE_SIZE - cbaddr);
-			//this can be optimized
-			for (; cbaddr < R_IO_DESC_CACHE_SIZE; cbaddr++) {
-				//write to cache
-				cache->cdata[cbaddr] = *buf;
-				//save, that its cached
-				cache->cached |= (0x1ULL << cbaddr);
-				buf++;
-			}
-		} else {
-			//XXX this looks like very suspicious
-			do {
-				cache->cdata[cbaddr] = *buf;
-				cache->cached |= (0x1ULL << cbaddr);
-				buf++;
-				written++;
-				cbaddr++;
-			} while (len > written);
+		if (!*slot && !(*slot = R_NEW0 (RIODescCache))) {
+			break;
 		}
+		cache = *slot;
+		const int n = R_MIN (len - written, R_IO_DESC_CACHE_SIZE - cbaddr);
+		memcpy (cache->cdata + cbaddr, buf, n);
+		cache->cached |= pcache_mask (cbaddr, n);
+		buf += n;
+		written += n;
 		caddr++;
 		cbaddr = 0;
 	}
@@ -134,11 +209,10 @@ R_API int r_io_desc_cache_write(RIODesc *desc, ut64 paddr, const ut8 *buf, int l
 }
 
 R_API int r_io_desc_cache_read(RIODesc *desc, ut64 paddr, ut8 *buf, int len) {
-	RIODescCache *cache;
-	char k[64];
+	RIODescCache **slot;
 	ut8 *ptr = buf;
 	ut64 caddr, desc_sz = r_io_desc_size (desc);
-	int cbaddr, amount = 0;
+	int i, cbaddr, amount = 0;
 	if ((len < 1) || !desc || (desc_sz <= paddr) || !desc->io || !desc->cache) {
 		return 0;
 	}
@@ -151,32 +225,23 @@ R_API int r_io_desc_cache_read(RIODesc *desc, ut64 paddr, ut8 *buf, int len) {
 	caddr = paddr / R_IO_DESC_CACHE_SIZE;
 	cbaddr = paddr % R_IO_DESC_CACHE_SIZE;
 	while (amount < len) {
-		sdb_itoa (caddr, k, 10);
-		// get an existing desc-cache, if it exists
-		if (!(cache = (RIODescCache *)(size_t)sdb_num_get (desc->cache, k, NULL))) {	
-			amount += (R_IO_DESC_CACHE_SIZE - cbaddr);
-			ptr += (R_IO_DESC_CACHE_SIZE - cbaddr);
-			goto beach;
-		}
-		if ((len - amount) > (R_IO_DESC_CACHE_SIZE - cbaddr)) {
-			amount += (R_IO_DESC_CACHE_SIZE - cbaddr);
-			for (; cbaddr < R_IO_DESC_CACHE_SIZE; cbaddr++) {
-				if (cache->cached & (0x1ULL << cbaddr)) {
-					*ptr = cache->cdata[cbaddr];
+		const int n = R_MIN (len - amount, R_IO_DESC_CACHE_SIZE - cbaddr);
+		slot = pcache_slot (desc->cache, caddr, false);
+		if (slot && *slot) {
+			RIODescCache *cache = *slot;
+			const ut64 mask = pcache_mask (cbaddr, n);
+			if ((cache->cached & mask) == mask) {
+				memcpy (ptr, cache->cdata + cbaddr, n);
+			} else if (cache->cached & mask) {
+				for (i = 0; i < n; i++) {
+					if (cache->cached & (1ULL << (cbaddr + i))) {
+						ptr[i] = cache->cdata[cbaddr + i];
+					}
 				}
-				ptr++;
 			}
-		} else {
-			do {
-				if (cache->cached & (0x1ULL << cbaddr)) {
-					*ptr = cache->cdata[cbaddr];
-				}
-				ptr++;
-				amount++;
-				cbaddr++;
-			} while (len > amount);
 		}
-beach:
+		ptr += n;
+		amount += n;
 		caddr++;
 		cbaddr = 0;
 	}
@@ -192,56 +257,24 @@ static void __riocache_free(void *user) {
 	free (cache);
 }
 
-static int __desc_cache_list_cb(void *user, const char *k, const char *v) {
+static bool __desc_cache_list_cb(void *user, ut64 idx, RIODescCache **slot) {
 	RList *writes = (RList *)user;
-	RIODescCache *dcache;
-	RIOCache *cache = NULL;
-	ut64 blockaddr;
-	int byteaddr, i;
-	if (!writes) {
-		return false;
-	}
-	dcache = (RIODescCache *)(size_t)sdb_atoi (v);
-	if (!dcache) {
-		return false;
-	}
-	blockaddr = sdb_atoi (k) * R_IO_DESC_CACHE_SIZE;
-	for (i = byteaddr = 0; byteaddr < R_IO_DESC_CACHE_SIZE; byteaddr++) {
-		if (dcache->cached & (0x1LL << byteaddr)) {
-			if (!cache) {
-				cache = R_NEW0 (RIOCache);
-				if (!cache) {
-					return false;
-				}
-				cache->data = malloc (R_IO_DESC_CACHE_SIZE - byteaddr);
-				if (!cache->data) {
-					free (cache);
-					return false;
-				}
-				cache->itv.addr = blockaddr + byteaddr;
-			}
-			cache->data[i] = dcache->cdata[byteaddr];
-			i++;
-		} else if (cache) {
-			ut8 *data = realloc (cache->data, i);
-			if (!data) {
-				__riocache_free ((void *) cache);
-				return false;
-			}
-			cache->data = data;
-			cache->itv.size = i;
-			i = 0;
-			r_list_push (writes, cache);
-			cache = NULL;
+	RIODescCache *dcache = *slot;
+	const ut64 blockaddr = idx * R_IO_DESC_CACHE_SIZE;
+	int n, byteaddr = 0;
+	while ((n = pcache_run (dcache->cached, &byteaddr)) > 0) {
+		RIOCache *cache = R_NEW0 (RIOCache);
+		if (!cache) {
+			return false;
 		}
-	}
-	if (cache) {
-#if 0
-		cache->size = i;
-		cache->to = blockaddr + R_IO_DESC_CACHE_SIZE;
-#endif
-		cache->itv.size = i;
+		cache->data = r_mem_dup (dcache->cdata + byteaddr, n);
+		if (!cache->data) {
+			free (cache);
+			return false;
+		}
+		cache->itv = (RInterval){blockaddr + byteaddr, n};
 		r_list_push (writes, cache);
+		byteaddr += n;
 	}
 	return true;
 }
@@ -254,7 +287,7 @@ R_API RList *r_io_desc_cache_list(RIODesc *desc) {
 	if (!writes) {
 		return NULL;
 	}
-	sdb_foreach (desc->cache, __desc_cache_list_cb, writes);
+	pcache_walk (desc->cache->root, desc->cache->height, 0, __desc_cache_list_cb, writes);
 	RIODesc *current = desc->io->desc;
 	desc->io->desc = desc;
 	desc->io->p_cache = false;
@@ -275,35 +308,26 @@ R_API RList *r_io_desc_cache_list(RIODesc *desc) {
 	return writes;
 }
 
-static int __desc_cache_commit_cb(void *user, const char *k, const char *v) {
+static bool __desc_cache_commit_cb(void *user, ut64 idx, RIODescCache **slot) {
 	RIODesc *desc = (RIODesc *)user;
-	ut64 blockaddr;
-	int byteaddr, i;
-	ut8 buf[R_IO_DESC_CACHE_SIZE] = {0};
-	if (!desc || !desc->io) {
-		return false;
-	}
-	RIODescCache *dcache = (RIODescCache *)(size_t)sdb_atoi (v);
-	if (!dcache) {
-		return false;
-	}
-	blockaddr = R_IO_DESC_CACHE_SIZE * sdb_atoi (k);
-	for (i = byteaddr = 0; byteaddr < R_IO_DESC_CACHE_SIZE; byteaddr++) {
-		if (dcache->cached & (0x1LL << byteaddr)) {
-			buf[i] = dcache->cdata[byteaddr];
-			i++;
-		} else if (i > 0) {
-			r_io_pwrite_at (desc->io, blockaddr + byteaddr - i, buf, i);
-			i = 0;
-		}
-	}
-	if (i > 0) {
-		r_io_pwrite_at (desc->io, blockaddr + R_IO_DESC_CACHE_SIZE - i, buf, i);
+	RIODescCache *dcache = *slot;
+	const ut64 blockaddr = R_IO_DESC_CACHE_SIZE * idx;
+	int n, byteaddr = 0;
+	while ((n = pcache_run (dcache->cached, &byteaddr)) > 0) {
+		r_io_pwrite_at (desc->io, blockaddr + byteaddr, dcache->cdata + byteaddr, n);
+		byteaddr += n;
 	}
-	free (dcache);
+	R_FREE (*slot);
 	return true;
 }
 
+static void __desc_cache_table_free(RIODesc *desc) {
+	if (desc->cache) {
+		pcache_node_free (desc->cache->root, desc->cache->height);
+		R_FREE (desc->cache);
+	}
+}
+
 R_API bool r_io_desc_cache_commit(RIODesc *desc) {
 	RIODesc *current;
 	if (!desc || !(desc->perm & R_PERM_W) || !desc->io || !desc->io->files || !desc->io->p_cache) {
@@ -314,58 +338,44 @@ R_API bool r_io_desc_cache_commit(RIODesc *desc) {
 	}
 	current = desc->io->desc;
 	desc->io->desc = desc;
+	desc->io->gen++;
 	desc->io->p_cache = false;
-	sdb_foreach (desc->cache, __desc_cache_commit_cb, desc);
-	sdb_free (desc->cache);
-	desc->cache = NULL;
+	pcache_walk (desc->cache->root, desc->cache->height, 0, __desc_cache_commit_cb, desc);
+	__desc_cache_table_free (desc);
 	desc->io->p_cache = true;
 	desc->io->desc = current;
 	return true;
 }
 
-static int __desc_cache_cleanup_cb(void *user, const char *k, const char *v) {
-	RIODesc *desc = (RIODesc *)user;
-	RIODescCache *cache;
-	ut64 size, blockaddr;
-	int byteaddr;
-	if (!desc || !desc->cache) {
-		return false;
-	}
-	cache = (RIODescCache *) (size_t)sdb_atoi (v);
-	blockaddr = R_IO_DESC_CACHE_SIZE * sdb_atoi (k);
-	size = r_io_desc_size (desc);
+static bool __desc_cache_cleanup_cb(void *user, ut64 idx, RIODescCache **slot) {
+	const ut64 size = *(ut64 *)user;
+	const ut64 blockaddr = R_IO_DESC_CACHE_SIZE * idx;
 	if (size <= blockaddr) {
-		free (cache);
-		sdb_unset (desc->cache, k, 0);
+		R_FREE (*slot);
 		return true;
 	}
 	if (size <= (blockaddr + R_IO_DESC_CACHE_SIZE - 1)) {
 		//this looks scary, but it isn't
-		byteaddr = (int)(size - blockaddr) - 1;		
-		cache->cached &= cleanup_masks[byteaddr];
+		int byteaddr = (int)(size - blockaddr) - 1;
+		(*slot)->cached &= cleanup_masks[byteaddr];
 	}
 	return true;
 }
 
 R_API void r_io_desc_cache_cleanup(RIODesc *desc) {
 	if (desc && desc->cache) {
-		sdb_foreach (desc->cache, __desc_cache_cleanup_cb, desc);
+		ut64 size = r_io_desc_size (desc);
+		desc->io->gen++;
+		pcache_walk (desc->cache->root, desc->cache->height, 0, __desc_cache_cleanup_cb, &size);
 	}
 }
 
-static int __desc_cache_free_cb(void *user, const char* k, const char *v) {
-	RIODescCache *cache = (RIODescCache *)(size_t)sdb_atoi (v);
-	free (cache);
-	return true;
-}
-
 static bool __desc_fini_cb (void *user, void *data, ut32 id) {
 	RIODesc *desc = (RIODesc *)data;
-	if (desc->cache) {
-		sdb_foreach (desc->cache, __desc_cache_free_cb, NULL);
-		sdb_free (desc->cache);
-		desc->cache = NULL;
+	if (desc->io) {
+		desc->io->gen++;
 	}
+	__desc_cache_table_free (desc);
 	return true;
 }
 
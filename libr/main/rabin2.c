@@ -94,7 +94,9 @@ static int rabin_show_help(int v) {
 		" RABIN2_MAXSTRBUF: e bin.maxstrbuf    # specify maximum buffer size\n"
 		" RABIN2_STRFILTER: e bin.str.filter   #  r2 -qc 'e bin.str.filter=?" "?' -\n"
 		" RABIN2_STRPURGE:  e bin.str.purge    # try to purge false positives\n"
+		" RABIN2_STRJOBS:   e bin.str.jobs     # threads used to scan strings\n"
 		" RABIN2_DEBASE64:  e bin.debase64     # try to debase64 all strings\n"
+		" RABIN2_LAZY=0:    e bin.lazy         # load all the bin items upfront\n"
 		" RABIN2_DMNGLRCMD: e bin.demanglercmd # try to purge false positives\n"
 		" RABIN2_PDBSERVER: e pdb.server       # use alternative PDB server\n"
 		" RABIN2_SYMSTORE:  e pdb.symstore     # path to downstream symbol store\n"
@@ -613,10 +615,20 @@ R_API int r_main_rabin2(int argc, char **argv) {
 		r_config_set (core.config, "bin.str.purge", tmp);
 		free (tmp);
 	}
+	if ((tmp = r_sys_getenv ("RABIN2_STRJOBS"))) {
+		r_config_set (core.config, "bin.str.jobs", tmp);
+		free (tmp);
+	}
 	if ((tmp = r_sys_getenv ("RABIN2_DEBASE64"))) {
 		r_config_set (core.config, "bin.debase64", tmp);
 		free (tmp);
 	}
+	// only parse what the requested actions use
+	r_config_set (core.config, "bin.lazy", "true");
+	if ((tmp = r_sys_getenv ("RABIN2_LAZY"))) {
+		r_config_set (core.config, "bin.lazy", tmp);
+		free (tmp);
+	}
 	if ((tmp = r_sys_getenv ("RABIN2_PDBSERVER"))) {
 		r_config_set (core.config, "pdb.server", tmp);
 		free (tmp);
@@ -189,8 +189,8 @@ static int do_hash(const char *file, const char *algo, RIO *io, int bsize, int r
 				}
 				for (j = from; j < to; j += bsize) {
 					int len = ((j + bsize) > to)? (to - j): bsize;
-					r_io_pread_at (io, j, buf, len);
-					do_hash_internal (ctx, hashbit, buf, len, rad, 0, ule);
+					const ut8 *data = r_io_read_at_ptr (io, j, buf, len);
+					do_hash_internal (ctx, hashbit, data, len, rad, 0, ule);
 				}
 				if (s.buf && !s.prefix) {
 					do_hash_internal (ctx, hashbit, s.buf, s.len, rad, 0, ule);
@@ -240,13 +240,13 @@ static int do_hash(const char *file, const char *algo, RIO *io, int bsize, int r
 				t = to;
 				for (j = f; j < t; j += bsize) {
 					int nsize = (j + bsize < fsize)? bsize: (fsize - j);
-					r_io_pread_at (io, j, buf, bsize);
+					const ut8 *data = r_io_read_at_ptr (io, j, buf, nsize);
 					from = j;
 					to = j + bsize;
 					if (to > fsize) {
 						to = fsize;
 					}
-					do_hash_internal (ctx, hashbit, buf, nsize, rad, 1, ule);
+					do_hash_internal (ctx, hashbit, data, nsize, rad, 1, ule);
 				}
 				do_hash_internal (ctx, hashbit, NULL, 0, rad, 1, ule);
 				from = ofrom;
@@ -156,6 +156,8 @@ R_API const char *r_reg_get_role(int role) {
 R_API void r_reg_free_internal(RReg *reg, bool init) {
 	ut32 i;
 
+	// invalidate any RRegItem pointer cached by the users of this instance
+	reg->profile_gen++;
 	r_list_free (reg->roregs);
 	reg->roregs = NULL;
 	R_FREE (reg->reg_profile_str);
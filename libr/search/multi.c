@@ -0,0 +1,296 @@
+/* radare - LGPL - Copyright 2019 - pancake */
+
+#include <r_search.h>
+#include <ctype.h>
+
+/* Multi keyword matcher
+ *
+ * An Aho-Corasick automaton is built over one anchor per keyword: the
+ * longest run of bytes not touched by the binmask, capped to ANCHOR_MAX.
+ * One pass over the buffer yields the candidate offsets of every keyword,
+ * the caller confirms them with the same comparison the brute force search
+ * does, so binmasks, icase and the order of the hits are kept as they were.
+ * While the automaton sits in the root state the scan skips ahead to the
+ * next byte (or byte pair) that can start an anchor.
+ */
+
+#define ANCHOR_MAX 16
+// give up on keyword sets needing more transition tables than this
+#define STATES_MAX 0x10000
+
+typedef struct {
+	int *at;
+	int len;
+	int size;
+} MultiHits;
+
+struct r_search_multi_t {
+	int nkws;
+	int *kwlen;
+	int *anchor; // offset of the anchor in the keyword, -1 when it has none
+	int *anchor_len;
+	int *next_out; // next keyword ending in the same state
+	MultiHits *hits;
+	int nstates;
+	int *go; // nstates * 256 transitions
+	int *out; // first keyword ending in each state or -1
+	int *dict; // closest state in the fail chain with keywords or -1
+	ut8 fold[256];
+	bool first[256]; // bytes that can start an anchor
+	int nfirst;
+	ut8 first_byte;
+	ut8 *pairs; // first two bytes of the anchors, NULL if any anchor is 1 byte
+};
+
+static bool kw_exact_at(RSearchKeyword *kw, int j) {
+	return !kw->binmask_length || kw->bin_binmask[j % kw->binmask_length] == 0xff;
+}
+
+static void kw_anchor(RSearchKeyword *kw, int *off, int *len) {
+	int j, run = 0;
+	*off = -1;
+	*len = 0;
+	for (j = 0; j < kw->keyword_length; j++) {
+		run = kw_exact_at (kw, j)? run + 1: 0;
+		if (run > *len) {
+			*len = run;
+			*off = j + 1 - run;
+		}
+	}
+	if (*len > ANCHOR_MAX) {
+		*len = ANCHOR_MAX;
+	}
+}
+
+static bool hits_push(MultiHits *h, int at) {
+	if (h->len == h->size) {
+		int size = h->size? h->size * 2: 64;
+		int *a = realloc (h->at, size * sizeof (int));
+		if (!a) {
+			return false;
+		}
+		h->at = a;
+		h->size = size;
+	}
+	h->at[h->len++] = at;
+	return true;
+}
+
+static bool multi_build(RSearchMulti *m, RList *kws) {
+	RListIter *iter;
+	RSearchKeyword *kw;
+	int i, c, k = 0, maxstates = 1;
+	bool icase = false;
+	r_list_foreach (kws, iter, kw) {
+		kw_anchor (kw, &m->anchor[k], &m->anchor_len[k]);
+		m->kwlen[k] = kw->keyword_length;
+		maxstates += m->anchor_len[k];
+		icase |= kw->icase;
+		k++;
+	}
+	if (maxstates > STATES_MAX) {
+		return false;
+	}
+	for (c = 0; c < 256; c++) {
+		m->fold[c] = icase? tolower (c): c;
+	}
+	m->go = malloc (sizeof (int) * 256 * maxstates);
+	m->out = malloc (sizeof (int) * maxstates);
+	m->dict = malloc (sizeof (int) * maxstates);
+	int *fail = calloc (maxstates, sizeof (int));
+	int *queue = malloc (sizeof (int) * maxstates);
+	m->pairs = calloc (1, 0x10000 / 8);
+	if (!m->go || !m->out || !m->dict || !fail || !queue || !m->pairs) {
+		free (fail);
+		free (queue);
+		return false;
+	}
+	memset (m->go, -1, sizeof (int) * 256);
+	m->out[0] = -1;
+	m->nstates = 1;
+	bool anchored = false, pairs = true;
+	k = 0;
+	r_list_foreach (kws, iter, kw) {
+		if (m->anchor[k] < 0) {
+			k++;
+			continue;
+		}
+		const ut8 *a = kw->bin_keyword + m->anchor[k];
+		int state = 0, n = m->anchor_len[k];
+		for (i = 0; i < n; i++) {
+			int *t = &m->go[state * 256 + m->fold[a[i]]];
+			if (*t < 0) {
+				*t = m->nstates++;
+				memset (&m->go[*t * 256], -1, sizeof (int) * 256);
+				m->out[*t] = -1;
+			}
+			state = *t;
+		}
+		m->next_out[k] = m->out[state];
+		m->out[state] = k;
+		ut8 b0 = m->fold[a[0]];
+		for (c = 0; c < 256; c++) {
+			if (m->fold[c] == b0) {
+				m->first[c] = true;
+			}
+		}
+		if (n > 1) {
+			int pair = (b0 << 8) | m->fold[a[1]];
+			m->pairs[pair >> 3] |= 1 << (pair & 7);
+		} else {
+			pairs = false;
+		}
+		anchored = true;
+		k++;
+	}
+	if (!anchored) {
+		free (fail);
+		free (queue);
+		return false;
+	}
+	if (!pairs) {
+		R_FREE (m->pairs);
+	}
+	for (c = 0; c < 256; c++) {
+		if (m->first[c]) {
+			m->first_byte = c;
+			m->nfirst++;
+		}
+	}
+	// breadth first pass filling the fail links and the missing transitions
+	int head = 0, tail = 0;
+	m->dict[0] = -1;
+	for (c = 0; c < 256; c++) {
+		int v = m->go[c];
+		if (v < 0) {
+			m->go[c] = 0;
+		} else {
+			fail[v] = 0;
+			m->dict[v] = -1;
+			queue[tail++] = v;
+		}
+	}
+	while (head < tail) {
+		int u = queue[head++];
+		for (c = 0; c < 256; c++) {
+			int v = m->go[u * 256 + c];
+			int f = m->go[fail[u] * 256 + c];
+			if (v < 0) {
+				m->go[u * 256 + c] = f;
+				continue;
+			}
+			fail[v] = f;
+			m->dict[v] = m->out[f] >= 0? f: m->dict[f];
+			queue[tail++] = v;
+		}
+	}
+	free (fail);
+	free (queue);
+	return true;
+}
+
+/* Returns NULL when no keyword has bytes the automaton can match on, or when
+ * the keyword set is too large, the brute force search must be used then. */
+R_API RSearchMulti *r_search_multi_new(RList *kws) {
+	r_return_val_if_fail (kws, NULL);
+	RSearchMulti *m = R_NEW0 (RSearchMulti);
+	if (!m) {
+		return NULL;
+	}
+	m->nkws = r_list_length (kws);
+	m->kwlen = calloc (m->nkws, sizeof (int));
+	m->anchor = calloc (m->nkws, sizeof (int));
+	m->anchor_len = calloc (m->nkws, sizeof (int));
+	m->next_out = calloc (m->nkws, sizeof (int));
+	m->hits = R_NEWS0 (MultiHits, m->nkws);
+	if (!m->nkws || !m->kwlen || !m->anchor || !m->anchor_len || !m->next_out || !m->hits
+			|| !multi_build (m, kws)) {
+		r_search_multi_free (m);
+		return NULL;
+	}
+	return m;
+}
+
+R_API void r_search_multi_free(RSearchMulti *m) {
+	if (m) {
+		int i;
+		for (i = 0; m->hits && i < m->nkws; i++) {
+			free (m->hits[i].at);
+		}
+		free (m->hits);
+		free (m->kwlen);
+		free (m->anchor);
+		free (m->anchor_len);
+		free (m->next_out);
+		free (m->go);
+		free (m->out);
+		free (m->dict);
+		free (m->pairs);
+		free (m);
+	}
+}
+
+R_API int r_search_multi_count(RSearchMulti *m) {
+	return m? m->nkws: 0;
+}
+
+// skip to the next offset where an anchor may start, len when there is none
+static int multi_skip(RSearchMulti *m, const ut8 *buf, int i, int len) {
+	if (m->nfirst == 1) {
+		const ut8 *p = memchr (buf + i, m->first_byte, len - i);
+		return p? (int)(p - buf): len;
+	}
+	if (m->pairs) {
+		for (; i + 1 < len; i++) {
+			int pair = (m->fold[buf[i]] << 8) | m->fold[buf[i + 1]];
+			if (m->pairs[pair >> 3] & (1 << (pair & 7))) {
+				return i;
+			}
+		}
+		return len;
+	}
+	while (i < len && !m->first[buf[i]]) {
+		i++;
+	}
+	return i;
+}
+
+/* Collects the candidate offsets of every keyword in buf, they must be
+ * confirmed by the caller. */
+R_API bool r_search_multi_scan(RSearchMulti *m, const ut8 *buf, int len) {
+	r_return_val_if_fail (m && buf, false);
+	int i, k, s, state = 0;
+	for (k = 0; k < m->nkws; k++) {
+		m->hits[k].len = 0;
+	}
+	for (i = 0; i < len; i++) {
+		if (!state) {
+			i = multi_skip (m, buf, i, len);
+			if (i >= len) {
+				break;
+			}
+		}
+		state = m->go[state * 256 + m->fold[buf[i]]];
+		for (s = state; s >= 0; s = m->dict[s]) {
+			for (k = m->out[s]; k >= 0; k = m->next_out[k]) {
+				int at = i + 1 - m->anchor_len[k] - m->anchor[k];
+				if (at >= 0 && at + m->kwlen[k] <= len && !hits_push (&m->hits[k], at)) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+/* Sorted candidate offsets found by the last scan for the keyword at index
+ * idx of the list. Returns -1 for keywords without an anchor, those must be
+ * searched by brute force. */
+R_API int r_search_multi_hits(RSearchMulti *m, int idx, const int **at) {
+	r_return_val_if_fail (m && at, -1);
+	if (idx < 0 || idx >= m->nkws || m->anchor[idx] < 0) {
+		return -1;
+	}
+	*at = m->hits[idx].at;
+	return m->hits[idx].len;
+}
@@ -54,6 +54,7 @@ R_API RSearch *r_search_free(RSearch *s) {
 	}
 	r_list_free (s->hits);
 	r_list_free (s->kws);
+	r_search_multi_free (s->multi);
 	//r_io_free(s->iob.io); this is suposed to be a weak reference
 	free (s->data);
 	free (s);
@@ -95,6 +96,8 @@ R_API int r_search_set_mode(RSearch *s, int mode) {
 R_API int r_search_begin(RSearch *s) {
 	RListIter *iter;
 	RSearchKeyword *kw;
+	r_search_multi_free (s->multi);
+	s->multi = NULL;
 	r_list_foreach (s->kws, iter, kw) {
 		kw->count = 0;
 		kw->last = 0;
@@ -354,12 +357,28 @@ static bool brute_force_match(RSearch *s, RSearchKeyword *kw, const ut8 *buf, in
 	return j == kw->keyword_length;
 }
 
+// candidates of each keyword come from the automaton when several are loaded
+static bool multi_scan(RSearch *s, const ut8 *buf, int len) {
+	int nkws = r_list_length (s->kws);
+	if (s->inverse || s->distance || nkws < 2) {
+		return false;
+	}
+	if (s->multi && r_search_multi_count (s->multi) != nkws) {
+		r_search_multi_free (s->multi);
+		s->multi = NULL;
+	}
+	if (!s->multi) {
+		s->multi = r_search_multi_new (s->kws);
+	}
+	return s->multi && r_search_multi_scan (s->multi, buf, len);
+}
+
 // Supported search variants: backward, binmask, icase, inverse, overlap
 R_API int r_search_mybinparse_update(RSearch *s, ut64 from, const ut8 *buf, int len) {
 	RSearchKeyword *kw;
 	RListIter *iter;
 	RSearchLeftover *left;
-	int longest = 0, i;
+	int longest = 0, i, kwi = 0;
 	const int old_nhits = s->nhits;
 
 	r_list_foreach (s->kws, iter, kw) {
@@ -393,7 +412,11 @@ R_API int r_search_mybinparse_update(RSearch *s, ut64 from, const ut8 *buf, int
 
 	ut64 len1 = left->len + R_MIN (longest - 1, len);
 	memcpy (left->data + left->len, buf, len1 - left->len);
+	bool multi = multi_scan (s, buf, len);
 	r_list_foreach (s->kws, iter, kw) {
+		const int *at = NULL;
+		int h, nat = multi? r_search_multi_hits (s->multi, kwi, &at): -1;
+		kwi++;
 		i = s->overlap || !kw->count ? 0 :
 				s->bckwrds
 				? kw->last - from < left->len ? from + left->len - kw->last : 0
@@ -416,7 +439,20 @@ R_API int r_search_mybinparse_update(RSearch *s, ut64 from, const ut8 *buf, int
 				s->bckwrds
 				? from > kw->last ? from - kw->last : 0
 				: from < kw->last ? kw->last - from : 0;
-		for (; i + kw->keyword_length <= len; i++) {
+		for (h = 0; h < nat; h++) {
+			if (at[h] < i || !brute_force_match (s, kw, buf, at[h])) {
+				continue;
+			}
+			int t = r_search_hit_new (s, kw, s->bckwrds ? from - kw->keyword_length - at[h] : from + at[h]);
+			if (!t) {
+				return -1;
+			}
+			if (t > 1) {
+				return s->nhits - old_nhits;
+			}
+			i = at[h] + (s->overlap? 1: kw->keyword_length);
+		}
+		for (; nat < 0 && i + kw->keyword_length <= len; i++) {
 			if (brute_force_match (s, kw, buf, i) != s->inverse) {
 				int t = r_search_hit_new (s, kw, s->bckwrds ? from - kw->keyword_length - i : from + i);
 				if (!t) {
@@ -511,6 +547,8 @@ R_API int r_search_kw_add(RSearch *s, RSearchKeyword *kw) {
 	if (!kw || !kw->keyword_length) {
 		return false;
 	}
+	r_search_multi_free (s->multi);
+	s->multi = NULL;
 	kw->kwidx = s->n_kws++;
 	r_list_append (s->kws, kw);
 	return true;
@@ -520,6 +558,8 @@ R_API int r_search_kw_add(RSearch *s, RSearchKeyword *kw) {
 R_API void r_search_string_prepare_backward(RSearch *s) {
 	RListIter *iter;
 	RSearchKeyword *kw;
+	r_search_multi_free (s->multi);
+	s->multi = NULL;
 	// Precondition: !kw->binmask_length || kw->keyword_length % kw->binmask_length == 0
 	r_list_foreach (s->kws, iter, kw) {
 		ut8 *i = kw->bin_keyword, *j = kw->bin_keyword + kw->keyword_length;
@@ -549,4 +589,6 @@ R_API void r_search_kw_reset(RSearch *s) {
 	r_list_purge (s->kws);
 	r_list_purge (s->hits);
 	R_FREE (s->data);
+	r_search_multi_free (s->multi);
+	s->multi = NULL;
 }
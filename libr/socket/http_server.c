@@ -10,22 +10,23 @@ R_API void r_socket_http_server_set_breaked(bool *b) {
 }
 
 R_API RSocketHTTPRequest *r_socket_http_accept (RSocket *s, RSocketHTTPOptions *so) {
+	RSocket *client = so->accept_timeout
+		? r_socket_accept_timeout (s, 1)
+		: r_socket_accept (s);
+	return client? r_socket_http_read_request (client, so): NULL;
+}
+
+/* parse the request sent by an already accepted client, which is owned by the request */
+R_API RSocketHTTPRequest *r_socket_http_read_request (RSocket *client, RSocketHTTPOptions *so) {
 	int content_length = 0, xx, yy;
 	int pxx = 1, first = 0;
 	char buf[1500], *p, *q;
 	RSocketHTTPRequest *hr = R_NEW0 (RSocketHTTPRequest);
 	if (!hr) {
+		r_socket_free (client);
 		return NULL;
 	}
-	if (so->accept_timeout) {
-		hr->s = r_socket_accept_timeout (s, 1);
-	} else {
-		hr->s = r_socket_accept (s);
-	}
-	if (!hr->s) {
-		free (hr);
-		return NULL;
-	}
+	hr->s = client;
 	if (so->timeout > 0) {
 		r_socket_block_time (hr->s, 1, so->timeout, 0);
 	}
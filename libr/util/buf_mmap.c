@@ -65,4 +65,5 @@ static const RBufferMethods buffer_mmap_methods = {
 	.get_size = buf_bytes_get_size,
 	.resize = buf_mmap_resize,
 	.seek = buf_bytes_seek,
+	.get_whole_buf = buf_bytes_get_whole_buf
 };
@@ -478,6 +478,95 @@ R_API bool r_diff_buffers_distance_original(RDiff *diff, const ut8 *a, ut32 la,
 	return true;
 }
 
+// Myers' bit-parallel edit distance (Hyyro's blocked variant)
+// Same cost model and result as the original algorithm, computing 64 cells
+// of a column per step, the shorter buffer is split in 64 bit blocks
+R_API bool r_diff_buffers_distance_bitvec(RDiff *diff, const ut8 *a, ut32 la, const ut8 *b, ut32 lb, ut32 *distance, double *similarity) {
+	if (!a || !b) {
+		return false;
+	}
+	const bool verbose = diff ? diff->verbose : false;
+	const ut32 length = R_MAX (la, lb);
+	const ut8 *ea = a + la, *eb = b + lb, *t;
+	ut64 *peq, *pv, *mv;
+	ut32 i, k, nb, score;
+	// Strip prefix
+	for (; a < ea && b < eb && *a == *b; a++, b++) {}
+	// Strip suffix
+	for (; a < ea && b < eb && ea[-1] == eb[-1]; ea--, eb--) {}
+	la = ea - a;
+	lb = eb - b;
+	if (la < lb) {
+		i = la;
+		la = lb;
+		lb = i;
+		t = a;
+		a = b;
+		b = t;
+	}
+	score = la;
+	if (!lb) {
+		goto out;
+	}
+	nb = (lb + 63) / 64;
+	if (nb > SIZE_MAX / (258 * sizeof (ut64)) || !(peq = calloc ((size_t)nb * 258, sizeof (ut64)))) {
+		return false;
+	}
+	pv = peq + (size_t)nb * 256;
+	mv = pv + nb;
+	for (i = 0; i < lb; i++) {
+		peq[(size_t)b[i] * nb + i / 64] |= 1ULL << (i % 64);
+	}
+	for (k = 0; k < nb; k++) {
+		pv[k] = UT64_MAX;
+	}
+	const ut64 last = 1ULL << ((lb - 1) % 64);
+	score = lb;
+	for (i = 0; i < la; i++) {
+		const ut64 *eq = peq + (size_t)a[i] * nb;
+		// the first row of the matrix grows by one on each column
+		int hin = 1;
+		for (k = 0; k < nb; k++) {
+			const ut64 high = k + 1 < nb ? 1ULL << 63 : last;
+			ut64 e = eq[k], p = pv[k], m = mv[k];
+			ut64 xv = e | m;
+			if (hin < 0) {
+				e |= 1;
+			}
+			ut64 xh = (((e & p) + p) ^ p) | e;
+			ut64 ph = m | ~(xh | p);
+			ut64 mh = p & xh;
+			int hout = (ph & high) ? 1 : (mh & high) ? -1 : 0;
+			ph <<= 1;
+			mh <<= 1;
+			if (hin < 0) {
+				mh |= 1;
+			} else if (hin > 0) {
+				ph |= 1;
+			}
+			pv[k] = mh | ~(xv | ph);
+			mv[k] = ph & xv;
+			hin = hout;
+		}
+		score += hin;
+		if (verbose && i % 10000 == 0) {
+			eprintf ("\rProcessing %" PFMT32u " of %" PFMT32u "\r", i, la);
+		}
+	}
+	if (verbose) {
+		eprintf ("\n");
+	}
+	free (peq);
+out:
+	if (distance) {
+		*distance = score;
+	}
+	if (similarity) {
+		*similarity = length ? 1.0 - (double)score / length : 1.0;
+	}
+	return true;
+}
+
 R_API bool r_diff_buffers_distance(RDiff *d, const ut8 *a, ut32 la, const ut8 *b, ut32 lb, ut32 *distance, double *similarity) {
 	if (d) {
 		switch (d->type) {
@@ -489,5 +578,5 @@ R_API bool r_diff_buffers_distance(RDiff *d, const ut8 *a, ut32 la, const ut8 *b
 			break;
 		}
 	}
-	return r_diff_buffers_distance_original (d, a, la, b, lb, distance, similarity);
+	return r_diff_buffers_distance_bitvec (d, a, la, b, lb, distance, similarity);
 }
@@ -1,6 +1,7 @@
 /* radare - LGPL - Copyright 2009-2012 - pancake */
 
 #include "r_util.h"
+#include <sdb.h>
 typedef struct timeval tv;
 
 // Subtract the 'tv' values begin from end, storing result in RESULT
@@ -41,3 +42,157 @@ R_API double r_prof_end(struct r_prof_t *p) {
 		+ ((double)diff.tv_usec / 1000000.)));
 	return R_ABS (sign);
 }
+
+/* hot path counters, see r_prof.h. Every thread gets its own slot, so the
+ * increments are plain stores. When all slots are taken, the remaining
+ * threads share the last one and its numbers become approximate. */
+enum {
+	SLOT_FREE = 0,
+	SLOT_USED,
+	SLOT_DONE,
+};
+
+static const char *prof_names[R_PROF_LAST] = {
+	"io.read", "io.bytes", "anal.op", "esil.step",
+	"sdb.get", "sdb.set", "ht.op", "cons.bytes"
+};
+
+static RProfCounters prof_slots[R_PROF_SLOTS];
+static volatile int prof_state[R_PROF_SLOTS];
+static ut64 prof_t0_ticks = 0;
+static ut64 prof_t0_us = 0;
+
+#if R_PROF
+#if defined(_MSC_VER)
+static __declspec(thread) RProfCounters *prof_mine = NULL;
+#else
+static __thread RProfCounters *prof_mine = NULL;
+#endif
+
+static bool prof_cas(volatile int *p, int old, int val) {
+#if defined(_MSC_VER)
+	return InterlockedCompareExchange ((volatile LONG *)p, val, old) == old;
+#else
+	return __sync_bool_compare_and_swap (p, old, val);
+#endif
+}
+
+static void prof_sdb_cb(int what) {
+	RProfCounters *c = r_prof_counters ();
+	switch (what) {
+	case SDB_PROF_GET: c->count[R_PROF_SDB_GET]++; break;
+	case SDB_PROF_SET: c->count[R_PROF_SDB_SET]++; break;
+	case SDB_PROF_HT: c->count[R_PROF_HT_OP]++; break;
+	}
+}
+
+static RProfCounters *prof_claim(void) {
+	int i;
+	if (!prof_t0_us) {
+		prof_t0_ticks = r_prof_ticks ();
+		prof_t0_us = r_sys_now ();
+		sdb_prof_cb = prof_sdb_cb;
+	}
+	for (i = 0; i < R_PROF_SLOTS - 1; i++) {
+		int st = prof_state[i];
+		if (st != SLOT_USED && prof_cas (&prof_state[i], st, SLOT_USED)) {
+			return &prof_slots[i];
+		}
+	}
+	prof_state[R_PROF_SLOTS - 1] = SLOT_USED;
+	return &prof_slots[R_PROF_SLOTS - 1];
+}
+#endif
+
+R_API bool r_prof_enabled(void) {
+	return R_PROF;
+}
+
+/* what r_prof_ticks counts */
+R_API const char *r_prof_clock(void) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	return "tsc";
+#elif defined(__GNUC__) && defined(__aarch64__)
+	return "cntvct";
+#else
+	return "us";
+#endif
+}
+
+R_API const char *r_prof_name(RProfCounter c) {
+	return (c >= 0 && c < R_PROF_LAST)? prof_names[c]: NULL;
+}
+
+/* only the calls wrapped in R_PROF_BEGIN/END account time */
+R_API bool r_prof_timed(RProfCounter c) {
+	return c == R_PROF_IO_READ || c == R_PROF_ANAL_OP || c == R_PROF_ESIL_STEP;
+}
+
+/* counters of the calling thread */
+R_API RProfCounters *r_prof_counters(void) {
+#if R_PROF
+	if (!prof_mine) {
+		prof_mine = prof_claim ();
+	}
+	return prof_mine;
+#else
+	return &prof_slots[R_PROF_SLOTS - 1];
+#endif
+}
+
+/* give the slot of an exiting thread to the next one, its numbers are
+ * kept until then */
+R_API void r_prof_thread_fini(void) {
+#if R_PROF
+	if (prof_mine) {
+		int idx = prof_mine - prof_slots;
+		if (idx < R_PROF_SLOTS - 1) {
+			prof_state[idx] = SLOT_DONE;
+		}
+		prof_mine = NULL;
+	}
+#endif
+}
+
+/* NULL for the slots no thread ever used */
+R_API RProfCounters *r_prof_slot(int idx) {
+	if (idx < 0 || idx >= R_PROF_SLOTS || prof_state[idx] == SLOT_FREE) {
+		return NULL;
+	}
+	return &prof_slots[idx];
+}
+
+R_API void r_prof_total(RProfCounters *out) {
+	int i, j;
+	r_return_if_fail (out);
+	memset (out, 0, sizeof (*out));
+	for (i = 0; i < R_PROF_SLOTS; i++) {
+		if (prof_state[i] == SLOT_FREE) {
+			continue;
+		}
+		for (j = 0; j < R_PROF_LAST; j++) {
+			out->count[j] += prof_slots[i].count[j];
+			out->ticks[j] += prof_slots[i].ticks[j];
+		}
+	}
+}
+
+R_API void r_prof_reset(void) {
+	int i;
+	for (i = 0; i < R_PROF_SLOTS; i++) {
+		memset (&prof_slots[i], 0, sizeof (prof_slots[i]));
+#if R_PROF
+		prof_cas (&prof_state[i], SLOT_DONE, SLOT_FREE);
+#endif
+	}
+}
+
+/* the tick rate is measured against the wall clock since the first count */
+R_API double r_prof_ticks_to_ms(ut64 ticks) {
+	ut64 us = r_sys_now () - prof_t0_us;
+	ut64 elapsed = r_prof_ticks () - prof_t0_ticks;
+	if (!prof_t0_us || !us || !elapsed) {
+		return 0.0;
+	}
+	return (double)ticks * ((double)us / elapsed) / 1000.0;
+}
@@ -0,0 +1,169 @@
+/* radare - LGPL - Copyright 2019 - pancake */
+
+// Compares the buffer distance algorithms on the function fingerprints
+// of a binary (or on random buffers when no file is given)
+// $ ./bench-diff [-e k=v]... [-c cmd] [-n pairs] [file]
+
+#include <r_core.h>
+#include <r_getopt.h>
+
+typedef bool (*DistanceCb)(RDiff *d, const ut8 *a, ut32 la, const ut8 *b, ut32 lb, ut32 *distance, double *similarity);
+
+typedef struct {
+	const ut8 *buf;
+	ut32 len;
+} Fp;
+
+static const struct {
+	const char *name;
+	DistanceCb cb;
+} algos[] = {
+	{ "original", r_diff_buffers_distance_original },
+	{ "bitvec", r_diff_buffers_distance_bitvec },
+	{ "myers", r_diff_buffers_distance_myers },
+	{ "levenstein", r_diff_buffers_distance_levenstein },
+};
+
+#define NALGOS (sizeof (algos) / sizeof (algos[0]))
+
+static void bench(Fp *fps, int count, int npairs) {
+	ut32 *ref = calloc (npairs, sizeof (ut32));
+	int i, k;
+	if (!ref) {
+		return;
+	}
+	for (k = 0; k < NALGOS; k++) {
+		int bad = 0;
+		ut64 total = 0;
+		ut64 t0 = r_sys_now ();
+		for (i = 0; i < npairs; i++) {
+			// neighbour functions tend to be of similar size
+			const Fp *a = &fps[i % count];
+			const Fp *b = &fps[(i + 1 + i / count) % count];
+			ut32 dist = 0;
+			algos[k].cb (NULL, a->buf, a->len, b->buf, b->len, &dist, NULL);
+			if (!k) {
+				ref[i] = dist;
+			} else if (ref[i] != dist) {
+				bad++;
+			}
+			total += dist;
+		}
+		ut64 t1 = r_sys_now ();
+		printf ("%-12s %8.2f ms  sum %"PFMT64u"  mismatch %d\n",
+			algos[k].name, (t1 - t0) / 1000.0, total, bad);
+	}
+	free (ref);
+}
+
+static int random_fps(Fp **fps, int count) {
+	Fp *f = calloc (count, sizeof (Fp));
+	int i, j;
+	if (!f) {
+		return 0;
+	}
+	for (i = 0; i < count; i++) {
+		ut32 len = 1 + rand () % 4096;
+		ut8 *buf = malloc (len);
+		if (!buf) {
+			break;
+		}
+		// small alphabet so the pairs share some structure
+		for (j = 0; j < len; j++) {
+			buf[j] = rand () % 8;
+		}
+		f[i].buf = buf;
+		f[i].len = len;
+	}
+	*fps = f;
+	return i;
+}
+
+static int function_fps(RCore *core, Fp **fps) {
+	int count = r_list_length (core->anal->fcns);
+	RAnalFunction *fcn;
+	RAnalBlock *bb;
+	RListIter *iter, *iter2;
+	Fp *f = calloc (R_MAX (count, 1), sizeof (Fp));
+	int n = 0;
+	if (!f) {
+		return 0;
+	}
+	r_list_foreach (core->anal->fcns, iter, fcn) {
+		r_list_foreach (fcn->bbs, iter2, bb) {
+			r_anal_diff_fingerprint_bb (core->anal, bb);
+		}
+		int len = r_anal_diff_fingerprint_fcn (core->anal, fcn);
+		if (len > 0 && fcn->fingerprint) {
+			f[n].buf = fcn->fingerprint;
+			f[n].len = len;
+			n++;
+		}
+	}
+	*fps = f;
+	return n;
+}
+
+int main(int argc, char **argv) {
+	const char *cmd = "aaa";
+	int c, count, npairs = 0;
+	RCore *core = r_core_new ();
+	RList *evals = r_list_new ();
+	RListIter *iter;
+	const char *ev;
+	Fp *fps = NULL;
+	if (!core || !evals) {
+		return 1;
+	}
+	r_core_loadlibs (core, R_CORE_LOADLIBS_ALL, NULL);
+	r_config_set_i (core->config, "scr.interactive", false);
+	while ((c = r_getopt (argc, argv, "c:e:n:")) != -1) {
+		switch (c) {
+		case 'c':
+			cmd = r_optarg;
+			break;
+		case 'e':
+			r_list_append (evals, r_optarg);
+			break;
+		case 'n':
+			npairs = atoi (r_optarg);
+			break;
+		default:
+			eprintf ("Usage: bench-diff [-e k=v]... [-c cmd] [-n pairs] [file]\n");
+			return 1;
+		}
+	}
+	if (r_optind < argc) {
+		r_list_foreach (evals, iter, ev) {
+			r_config_eval (core->config, ev);
+		}
+		if (!r_core_file_open (core, argv[r_optind], R_PERM_R, 0)) {
+			eprintf ("Cannot open %s\n", argv[r_optind]);
+			return 1;
+		}
+		r_core_bin_load (core, NULL, UT64_MAX);
+		if (r_list_empty (r_bin_get_sections (core->bin))) {
+			r_config_set_i (core->config, "io.va", false);
+		}
+		// the bin info overrides the asm and anal setup
+		r_list_foreach (evals, iter, ev) {
+			r_config_eval (core->config, ev);
+		}
+		r_core_cmd0 (core, cmd);
+		count = function_fps (core, &fps);
+	} else {
+		count = random_fps (&fps, 256);
+	}
+	if (count < 1) {
+		eprintf ("No fingerprints\n");
+		return 1;
+	}
+	if (npairs < 1) {
+		npairs = count;
+	}
+	printf ("%d fingerprints, %d pairs\n", count, npairs);
+	bench (fps, count, npairs);
+	r_list_free (evals);
+	r_core_free (core);
+	return 0;
+}
@@ -1,6 +1,7 @@
 /* radare - LGPL - Copyright 2009-2018 - pancake */
 
 #include <r_th.h>
+#include <r_util.h>
 
 #if __WINDOWS__
 static DWORD WINAPI _r_th_launcher(void *_th) {
@@ -28,11 +29,13 @@ static void *_r_th_launcher(void *_th) {
 		ret = th->fun (th);
 		if (ret < 0) {
 			// th has been freed
+			r_prof_thread_fini ();
 			return 0;
 		}
 		th->running = false;
 		r_th_lock_enter (th->lock);
 	} while (ret);
+	r_prof_thread_fini ();
 #if HAVE_PTHREAD
 	pthread_exit (&ret);
 #endif
@@ -0,0 +1,83 @@
+/* radare - LGPL - Copyright 2019 - pancake */
+
+#include <r_th.h>
+#include <r_util.h>
+
+/* Workers pick the next pending job index under the pool lock, so fast
+ * threads keep taking work while slow ones are busy with a big job. */
+
+static RThreadFunctionRet _pool_worker(RThread *th) {
+	RThreadPool *pool = th->user;
+	for (;;) {
+		r_th_lock_enter (pool->lock);
+		int job = pool->breaked? pool->jobs: pool->next++;
+		r_th_lock_leave (pool->lock);
+		if (job >= pool->jobs) {
+			break;
+		}
+		if (!pool->fun (pool->user, job)) {
+			r_th_lock_enter (pool->lock);
+			pool->breaked = true;
+			r_th_lock_leave (pool->lock);
+		}
+	}
+	return R_TH_STOP;
+}
+
+R_API RThreadPool *r_th_pool_new(int size) {
+	RThreadPool *pool = R_NEW0 (RThreadPool);
+	if (!pool) {
+		return NULL;
+	}
+	pool->size = R_MAX (size, 1);
+	pool->threads = R_NEWS0 (RThread *, pool->size);
+	pool->lock = r_th_lock_new (false);
+	if (!pool->threads || !pool->lock) {
+		r_th_pool_free (pool);
+		return NULL;
+	}
+	return pool;
+}
+
+R_API void r_th_pool_free(RThreadPool *pool) {
+	if (pool) {
+		r_th_lock_free (pool->lock);
+		free (pool->threads);
+		free (pool);
+	}
+}
+
+/* Runs fun (user, job) for every job in [0, jobs) and returns when all of
+ * them are done. A job returning false stops handing out the pending ones.
+ * Pools of size 1 run the jobs in order on the calling thread. */
+R_API bool r_th_pool_run(RThreadPool *pool, int jobs, RThreadPoolJob fun, void *user) {
+	r_return_val_if_fail (pool && fun, false);
+	int i, n = R_MIN (pool->size, jobs);
+	pool->fun = fun;
+	pool->user = user;
+	pool->jobs = jobs;
+	pool->next = 0;
+	pool->breaked = false;
+	if (n < 2) {
+		for (i = 0; i < jobs && !pool->breaked; i++) {
+			pool->breaked = !fun (user, i);
+		}
+		return !pool->breaked;
+	}
+	for (i = 0; i < n; i++) {
+		pool->threads[i] = r_th_new (_pool_worker, pool, 0);
+		if (!pool->threads[i]) {
+			break;
+		}
+	}
+	n = i;
+	if (!n) {
+		// no threads available, do the work here
+		_pool_worker (&(RThread){ .user = pool });
+	}
+	for (i = 0; i < n; i++) {
+		r_th_wait (pool->threads[i]);
+		pool->threads[i] = r_th_free (pool->threads[i]);
+	}
+	return !pool->breaked;
+}
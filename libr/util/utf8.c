@@ -738,7 +738,8 @@ R_API int *r_utf_block_list(const ut8 *str, int len) {
 	if (len < 0) {
 		len = strlen ((const char *)str);
 	}
-	static bool has_block[r_utf_blocks_count] = {0};
+	// not static, strings are scanned in threads
+	ut32 has_block[(r_utf_blocks_count + 31) / 32] = {0};
 	int *list = R_NEWS (int, len + 1);
 	if (!list) {
 		return NULL;
@@ -756,16 +757,13 @@ R_API int *r_utf_block_list(const ut8 *str, int len) {
 		} else {
 			block_idx = r_utf_block_idx (ch);
 		}
-		if (!has_block[block_idx]) {
-			has_block[block_idx] = true;
+		if (!(has_block[block_idx / 32] & (1U << (block_idx % 32)))) {
+			has_block[block_idx / 32] |= 1U << (block_idx % 32);
 			*list_ptr = block_idx;
 			list_ptr++;
 		}
 		str_ptr += ch_bytes;
 	}
 	*list_ptr = -1;
-	for (list_ptr = list; *list_ptr != -1; list_ptr++) {
-		has_block[*list_ptr] = false;
-	}
 	return list;
 }
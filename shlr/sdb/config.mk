@@ -45,6 +45,18 @@ CFLAGS+=-Wsign-compare
 # CFLAGS+=-Wmissing-field-initializers
 #CFLAGS+=-O3
 CFLAGS+=-g -Wall -O0
+
+# use the open addressing swiss table for ht_pp, ht_up and ht_uu
+HT_SWISS?=0
+ifeq ($(HT_SWISS),1)
+CFLAGS+=-DSDB_HT_SWISS=1
+endif
+
+# count the sdb and hashtable operations through sdb_prof_cb
+PROF?=0
+ifeq ($(PROF),1)
+CFLAGS+=-DSDB_PROF=1
+endif
 #CFLAGS+=-g
 #LDFLAGS+=-g -flto
 
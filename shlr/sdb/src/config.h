@@ -4,6 +4,14 @@
 #define SDB_KEYSIZE 32
 /* only available on linux, and some distros require -lrt */
 #define USE_MONOTONIC_CLOCK 0
+/* use the open addressing swiss table for ht_pp, ht_up and ht_uu */
+#ifndef SDB_HT_SWISS
+#define SDB_HT_SWISS 0
+#endif
+/* count the sdb and hashtable operations through sdb_prof_cb */
+#ifndef SDB_PROF
+#define SDB_PROF 0
+#endif
 
 #if SDB_KEYSIZE == 32
 #define SDB_KT ut32
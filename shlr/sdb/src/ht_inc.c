@@ -71,6 +71,10 @@ static inline bool is_kv_equal(HtName_(Ht) *ht, const KEY_TYPE key, const ut32 k
 	return res;
 }
 
+#if SDB_HT_SWISS
+#include "ht_swiss.c"
+#else
+
 static inline HT_(Kv) *kv_at(HtName_(Ht) *ht, HT_(Bucket) *bt, ut32 i) {
 	return (HT_(Kv) *)((char *)bt->arr + i * ht->opt.elem_size);
 }
@@ -187,6 +191,7 @@ static void check_growing(HtName_(Ht) *ht) {
 }
 
 static HT_(Kv) *reserve_kv(HtName_(Ht) *ht, const KEY_TYPE key, const int key_len, bool update) {
+	SDB_PROF_INC (SDB_PROF_HT);
 	HT_(Bucket) *bt = &ht->table[bucketfn (ht, key)];
 	HT_(Kv) *kvtmp;
 	ut32 j;
@@ -298,6 +303,7 @@ SDB_API bool Ht_(update_key)(HtName_(Ht)* ht, const KEY_TYPE old_key, const KEY_
 // If `found` is not NULL, it will be set to true if the entry was found, false
 // otherwise.
 SDB_API HT_(Kv)* Ht_(find_kv)(HtName_(Ht)* ht, const KEY_TYPE key, bool* found) {
+	SDB_PROF_INC (SDB_PROF_HT);
 	if (found) {
 		*found = false;
 	}
@@ -328,6 +334,7 @@ SDB_API VALUE_TYPE Ht_(find)(HtName_(Ht)* ht, const KEY_TYPE key, bool* found) {
 
 // Deletes a entry from the hash table from the key, if the pair exists.
 SDB_API bool Ht_(delete)(HtName_(Ht)* ht, const KEY_TYPE key) {
+	SDB_PROF_INC (SDB_PROF_HT);
 	HT_(Bucket) *bt = &ht->table[bucketfn (ht, key)];
 	ut32 key_len = calcsize_key (ht, key);
 	HT_(Kv) *kv;
@@ -361,3 +368,5 @@ SDB_API void Ht_(foreach)(HtName_(Ht) *ht, HT_(ForeachCallback) cb, void *user)
 		}
 	}
 }
+
+#endif
@@ -0,0 +1,369 @@
+/* radare2 - BSD 3 Clause License - 2019 */
+
+/*
+ * Open addressing backend for ht_inc.c, selected with SDB_HT_SWISS.
+ *
+ * Every slot has a control byte holding the low 7 bits of the hash of its
+ * key, or CTRL_EMPTY/CTRL_DELETED. Lookups compare the control bytes of a
+ * whole group of slots at once (SSE2/NEON when available) and only look at
+ * the keys whose 7 bits match. Groups are probed quadratically in a table
+ * whose size is a power of two, and it is kept at most 7/8 full.
+ */
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HT_GROUP_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define HT_GROUP_NEON 1
+#endif
+
+#define GROUP_SIZE 16
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xfe
+#define CTRL_FREE(c) ((c) & 0x80)
+#define MAX_LOAD(size) ((size) - (size) / 8)
+
+// bitmask of the control bytes in the group equal to c
+static inline ut32 group_match(const ut8 *g, ut8 c) {
+#if HT_GROUP_SSE2
+	__m128i ctrl = _mm_loadu_si128 ((const __m128i *)g);
+	return (ut32)_mm_movemask_epi8 (_mm_cmpeq_epi8 (ctrl, _mm_set1_epi8 ((char)c)));
+#elif HT_GROUP_NEON
+	static const ut8 bits[GROUP_SIZE] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint8x16_t m = vandq_u8 (vceqq_u8 (vld1q_u8 (g), vdupq_n_u8 (c)), vld1q_u8 (bits));
+	return (ut32)vaddv_u8 (vget_low_u8 (m)) | ((ut32)vaddv_u8 (vget_high_u8 (m)) << 8);
+#else
+	ut32 i, m = 0;
+	for (i = 0; i < GROUP_SIZE; i++) {
+		if (g[i] == c) {
+			m |= 1U << i;
+		}
+	}
+	return m;
+#endif
+}
+
+// bitmask of the empty or deleted slots in the group
+static inline ut32 group_match_free(const ut8 *g) {
+#if HT_GROUP_SSE2
+	return (ut32)_mm_movemask_epi8 (_mm_loadu_si128 ((const __m128i *)g));
+#elif HT_GROUP_NEON
+	static const ut8 bits[GROUP_SIZE] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint8x16_t m = vandq_u8 (vtstq_u8 (vld1q_u8 (g), vdupq_n_u8 (0x80)), vld1q_u8 (bits));
+	return (ut32)vaddv_u8 (vget_low_u8 (m)) | ((ut32)vaddv_u8 (vget_high_u8 (m)) << 8);
+#else
+	ut32 i, m = 0;
+	for (i = 0; i < GROUP_SIZE; i++) {
+		if (CTRL_FREE (g[i])) {
+			m |= 1U << i;
+		}
+	}
+	return m;
+#endif
+}
+
+static inline ut32 first_bit(ut32 m) {
+#if defined(__GNUC__)
+	return (ut32)__builtin_ctz (m);
+#else
+	ut32 i = 0;
+	while (!(m & 1)) {
+		m >>= 1;
+		i++;
+	}
+	return i;
+#endif
+}
+
+// the hash functions of ht_up and ht_uu are the identity, spread the bits
+// so that the position and the control byte do not depend on a few of them
+static inline ut32 swiss_hash(HtName_(Ht) *ht, const KEY_TYPE k) {
+	ut32 h = hashfn (ht, k);
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return h;
+}
+
+static inline ut32 probe_start(HtName_(Ht) *ht, ut32 h) {
+	return (h >> 7) & (ht->size - 1) & ~(GROUP_SIZE - 1);
+}
+
+static inline HT_(Kv) *slot_at(HtName_(Ht) *ht, ut32 i) {
+	return (HT_(Kv) *)((char *)ht->slots + (size_t)i * ht->opt.elem_size);
+}
+
+static bool table_alloc(HtName_(Ht) *ht, ut32 size) {
+	ut8 *ctrl = malloc (size);
+	void *slots = calloc (size, ht->opt.elem_size);
+	if (!ctrl || !slots) {
+		free (ctrl);
+		free (slots);
+		return false;
+	}
+	memset (ctrl, CTRL_EMPTY, size);
+	ht->ctrl = ctrl;
+	ht->slots = slots;
+	ht->size = size;
+	ht->count = 0;
+	ht->growth_left = MAX_LOAD (size);
+	return true;
+}
+
+// index of the slot holding key, or UT32_MAX
+static ut32 find_slot(HtName_(Ht) *ht, const KEY_TYPE key, ut32 key_len, ut32 h) {
+	const ut32 mask = ht->size - 1;
+	ut32 pos = probe_start (ht, h);
+	ut32 step = 0;
+	for (;;) {
+		const ut8 *g = ht->ctrl + pos;
+		ut32 m = group_match (g, h & 0x7f);
+		while (m) {
+			ut32 i = pos + first_bit (m);
+			if (is_kv_equal (ht, key, key_len, slot_at (ht, i))) {
+				return i;
+			}
+			m &= m - 1;
+		}
+		// a key is never stored past a group that had an empty slot
+		if (group_match (g, CTRL_EMPTY)) {
+			return UT32_MAX;
+		}
+		step += GROUP_SIZE;
+		if (step >= ht->size) {
+			return UT32_MAX;
+		}
+		pos = (pos + step) & mask;
+	}
+}
+
+// index of the first empty or deleted slot in the probe sequence of h
+static ut32 find_free(HtName_(Ht) *ht, ut32 h) {
+	const ut32 mask = ht->size - 1;
+	ut32 pos = probe_start (ht, h);
+	ut32 step = 0;
+	for (;;) {
+		ut32 m = group_match_free (ht->ctrl + pos);
+		if (m) {
+			return pos + first_bit (m);
+		}
+		step += GROUP_SIZE;
+		if (step >= ht->size) {
+			return UT32_MAX;
+		}
+		pos = (pos + step) & mask;
+	}
+}
+
+static void erase_slot(HtName_(Ht) *ht, ut32 i) {
+	// the slot can become empty again only if no probe went through its
+	// group looking for a key stored further, which means the group has
+	// never been full since the last rehash
+	if (group_match (ht->ctrl + (i & ~(GROUP_SIZE - 1)), CTRL_EMPTY)) {
+		ht->ctrl[i] = CTRL_EMPTY;
+		ht->growth_left++;
+	} else {
+		ht->ctrl[i] = CTRL_DELETED;
+	}
+	ht->count--;
+}
+
+static HtName_(Ht)* internal_ht_new(ut32 size, ut32 prime_idx, HT_(Options) *opt) {
+	HtName_(Ht)* ht = calloc (1, sizeof (*ht));
+	if (!ht) {
+		return NULL;
+	}
+	ht->prime_idx = prime_idx;
+	ht->opt = *opt;
+	if (ht->opt.elem_size == 0) {
+		ht->opt.elem_size = sizeof (HT_(Kv));
+	}
+	// size is the number of elements expected by the callers
+	ut32 sz = GROUP_SIZE;
+	while (MAX_LOAD (sz) < size && sz < 0x80000000U) {
+		sz <<= 1;
+	}
+	if (!table_alloc (ht, sz)) {
+		free (ht);
+		return NULL;
+	}
+	return ht;
+}
+
+SDB_API HtName_(Ht) *Ht_(new_opt)(HT_(Options) *opt) {
+	return internal_ht_new (ht_primes_sizes[0], 0, opt);
+}
+
+SDB_API void Ht_(free)(HtName_(Ht)* ht) {
+	if (!ht) {
+		return;
+	}
+	if (ht->opt.freefn) {
+		ut32 i;
+		for (i = 0; i < ht->size; i++) {
+			if (!CTRL_FREE (ht->ctrl[i])) {
+				ht->opt.freefn (slot_at (ht, i));
+			}
+		}
+	}
+	free (ht->ctrl);
+	free (ht->slots);
+	free (ht);
+}
+
+// Doubles the size of the table, or just drops the deleted slots when they
+// are the ones filling it.
+static void internal_ht_grow(HtName_(Ht)* ht) {
+	HtName_(Ht) old = *ht;
+	ut32 sz = ht->count < MAX_LOAD (ht->size) / 2? ht->size: ht->size * 2;
+	ut32 i;
+
+	if (!sz || !table_alloc (ht, sz)) {
+		// we can't grow the ht anymore, the deleted slots will be reused
+		*ht = old;
+		return;
+	}
+	for (i = 0; i < old.size; i++) {
+		if (CTRL_FREE (old.ctrl[i])) {
+			continue;
+		}
+		HT_(Kv) *kv = slot_at (&old, i);
+		ut32 h = swiss_hash (ht, kv->key);
+		ut32 j = find_free (ht, h);
+		ht->ctrl[j] = h & 0x7f;
+		ht->growth_left--;
+		ht->count++;
+		memcpy (slot_at (ht, j), kv, ht->opt.elem_size);
+	}
+	free (old.ctrl);
+	free (old.slots);
+}
+
+static HT_(Kv) *reserve_kv(HtName_(Ht) *ht, const KEY_TYPE key, const int key_len, bool update) {
+	SDB_PROF_INC (SDB_PROF_HT);
+	ut32 h = swiss_hash (ht, key);
+	ut32 i = find_slot (ht, key, key_len, h);
+	if (i != UT32_MAX) {
+		HT_(Kv) *kv = slot_at (ht, i);
+		if (update) {
+			freefn (ht, kv);
+			return kv;
+		}
+		return NULL;
+	}
+	if (!ht->growth_left) {
+		internal_ht_grow (ht);
+	}
+	i = find_free (ht, h);
+	if (i == UT32_MAX) {
+		return NULL;
+	}
+	if (ht->ctrl[i] == CTRL_EMPTY) {
+		// keep at least one empty slot, lookups stop on them
+		if (!ht->growth_left) {
+			return NULL;
+		}
+		ht->growth_left--;
+	}
+	ht->ctrl[i] = h & 0x7f;
+	ht->count++;
+	return slot_at (ht, i);
+}
+
+SDB_API bool Ht_(insert_kv)(HtName_(Ht) *ht, HT_(Kv) *kv, bool update) {
+	HT_(Kv) *kv_dst = reserve_kv (ht, kv->key, kv->key_len, update);
+	if (!kv_dst) {
+		return false;
+	}
+
+	memcpy (kv_dst, kv, ht->opt.elem_size);
+	return true;
+}
+
+static bool insert_update(HtName_(Ht) *ht, const KEY_TYPE key, VALUE_TYPE value, bool update) {
+	ut32 key_len = calcsize_key (ht, key);
+	HT_(Kv)* kv_dst = reserve_kv (ht, key, key_len, update);
+	if (!kv_dst) {
+		return false;
+	}
+
+	kv_dst->key = dupkey (ht, key);
+	kv_dst->key_len = key_len;
+	kv_dst->value = dupval (ht, value);
+	kv_dst->value_len = calcsize_val (ht, value);
+	return true;
+}
+
+SDB_API bool Ht_(insert)(HtName_(Ht)* ht, const KEY_TYPE key, VALUE_TYPE value) {
+	return insert_update (ht, key, value, false);
+}
+
+SDB_API bool Ht_(update)(HtName_(Ht)* ht, const KEY_TYPE key, VALUE_TYPE value) {
+	return insert_update (ht, key, value, true);
+}
+
+SDB_API bool Ht_(update_key)(HtName_(Ht)* ht, const KEY_TYPE old_key, const KEY_TYPE new_key) {
+	bool found;
+	VALUE_TYPE value = Ht_(find) (ht, old_key, &found);
+	if (!found) {
+		return false;
+	}
+	if (!insert_update (ht, new_key, value, false)) {
+		return false;
+	}
+	// the insertion may have moved the elements, look for old_key again
+	ut32 i = find_slot (ht, old_key, calcsize_key (ht, old_key), swiss_hash (ht, old_key));
+	if (i == UT32_MAX) {
+		return false;
+	}
+	HT_(Kv) *kv = slot_at (ht, i);
+	if (!ht->opt.dupvalue) {
+		// the value is now owned by the new key
+		kv->value = HT_NULL_VALUE;
+		kv->value_len = 0;
+	}
+	freefn (ht, kv);
+	erase_slot (ht, i);
+	return true;
+}
+
+SDB_API HT_(Kv)* Ht_(find_kv)(HtName_(Ht)* ht, const KEY_TYPE key, bool* found) {
+	SDB_PROF_INC (SDB_PROF_HT);
+	ut32 i = find_slot (ht, key, calcsize_key (ht, key), swiss_hash (ht, key));
+	if (found) {
+		*found = i != UT32_MAX;
+	}
+	return i != UT32_MAX? slot_at (ht, i): NULL;
+}
+
+SDB_API VALUE_TYPE Ht_(find)(HtName_(Ht)* ht, const KEY_TYPE key, bool* found) {
+	HT_(Kv) *res = Ht_(find_kv) (ht, key, found);
+	return res ? res->value : HT_NULL_VALUE;
+}
+
+SDB_API bool Ht_(delete)(HtName_(Ht)* ht, const KEY_TYPE key) {
+	SDB_PROF_INC (SDB_PROF_HT);
+	ut32 i = find_slot (ht, key, calcsize_key (ht, key), swiss_hash (ht, key));
+	if (i == UT32_MAX) {
+		return false;
+	}
+	freefn (ht, slot_at (ht, i));
+	erase_slot (ht, i);
+	return true;
+}
+
+// deleting the current element from cb is fine, the others do not move
+SDB_API void Ht_(foreach)(HtName_(Ht) *ht, HT_(ForeachCallback) cb, void *user) {
+	ut32 i;
+	for (i = 0; i < ht->size; i++) {
+		if (!CTRL_FREE (ht->ctrl[i])) {
+			HT_(Kv) *kv = slot_at (ht, i);
+			if (!cb (user, kv->key, kv->value)) {
+				return;
+			}
+		}
+	}
+}
@@ -8,6 +8,8 @@
 #include <sys/stat.h>
 #include "sdb.h"
 
+SDB_API SdbProfCallback sdb_prof_cb = NULL;
+
 #if 0
 static inline SdbKv *kv_at(HtPP *ht, HtPPBucket *bt, ut32 i) {
 	return (SdbKv *)((char *)bt->arr + i * ht->opt.elem_size);
@@ -31,6 +33,21 @@ static inline SdbKv *next_kv(HtPP *ht, SdbKv *kv) {
 		     (j) < (bt)->count;					\
 		     (j) = (count) == (ht)->count? j + 1: j, (kv) = (count) == (ht)->count? next_kv (ht, kv): kv, (count) = (ht)->count)
 
+#if SDB_HT_SWISS
+static inline SdbKv *slot_kv(HtPP *ht, ut32 i) {
+	// the high bit of the control byte is set for empty and deleted slots
+	return (ht->ctrl[i] & 0x80)? NULL: (SdbKv *)((char *)ht->slots + (size_t)i * ht->opt.elem_size);
+}
+
+#define HT_FOREACH_KV(ht, i, j, count, kv)				\
+	for ((i) = 0, (void)(j), (void)(count); (i) < (ht)->size; (i)++) \
+		if (((kv) = slot_kv ((ht), (i))))
+#else
+#define HT_FOREACH_KV(ht, i, j, count, kv)				\
+	for ((i) = 0; (i) < (ht)->size; (i)++)				\
+		BUCKET_FOREACH_SAFE ((ht), &(ht)->table[(i)], j, count, kv)
+#endif
+
 static inline int nextcas(void) {
 	static ut32 cas = 1;
 	if (!cas) {
@@ -233,6 +250,8 @@ SDB_API const char *sdb_const_get_len(Sdb* s, const char *key, int *vlen, ut32 *
 	SdbKv *kv;
 	bool found;
 
+	SDB_PROF_INC (SDB_PROF_GET);
+
 	if (cas) {
 		*cas = 0;
 	}
@@ -552,6 +571,7 @@ static ut32 sdb_set_internal(Sdb* s, const char *key, char *val, int owned, ut32
 	ut32 vlen, klen;
 	SdbKv *kv;
 	bool found;
+	SDB_PROF_INC (SDB_PROF_SET);
 	if (!s || !key) {
 		return 0;
 	}
@@ -792,17 +812,12 @@ SDB_API bool sdb_foreach(Sdb* s, SdbForeachCallback cb, void *user) {
 		return sdb_foreach_end (s, false);
 	}
 
-	ut32 i;
-	for (i = 0; i < s->ht->size; ++i) {
-		HtPPBucket *bt = &s->ht->table[i];
-		SdbKv *kv;
-		ut32 j, count;
-
-		BUCKET_FOREACH_SAFE (s->ht, bt, j, count, kv) {
-			if (kv && sdbkv_value (kv) && *sdbkv_value (kv)) {
-				if (!cb (user, sdbkv_key (kv), sdbkv_value (kv))) {
-					return sdb_foreach_end (s, false);
-				}
+	ut32 i, j, count;
+	SdbKv *kv;
+	HT_FOREACH_KV (s->ht, i, j, count, kv) {
+		if (kv && sdbkv_value (kv) && *sdbkv_value (kv)) {
+			if (!cb (user, sdbkv_key (kv), sdbkv_value (kv))) {
+				return sdb_foreach_end (s, false);
 			}
 		}
 	}
@@ -829,7 +844,8 @@ static int _remove_afer_insert(void *user, const char *k, const char *v) {
 
 SDB_API bool sdb_sync(Sdb* s) {
 	bool result;
-	ut32 i;
+	ut32 i, j, count;
+	SdbKv *kv;
 
 	if (!s || !sdb_disk_create (s)) {
 		return false;
@@ -840,16 +856,10 @@ SDB_API bool sdb_sync(Sdb* s) {
 	}
 
 	/* append new keyvalues */
-	for (i = 0; i < s->ht->size; ++i) {
-		HtPPBucket *bt = &s->ht->table[i];
-		SdbKv *kv;
-		ut32 j, count;
-
-		BUCKET_FOREACH_SAFE (s->ht, bt, j, count, kv) {
-			if (sdbkv_key (kv) && sdbkv_value (kv) && *sdbkv_value (kv) && !kv->expire) {
-				if (sdb_disk_insert (s, sdbkv_key (kv), sdbkv_value (kv))) {
-					sdb_remove (s, sdbkv_key (kv), 0);
-				}
+	HT_FOREACH_KV (s->ht, i, j, count, kv) {
+		if (sdbkv_key (kv) && sdbkv_value (kv) && *sdbkv_value (kv) && !kv->expire) {
+			if (sdb_disk_insert (s, sdbkv_key (kv), sdbkv_value (kv))) {
+				sdb_remove (s, sdbkv_key (kv), 0);
 			}
 		}
 	}
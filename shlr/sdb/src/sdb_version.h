@@ -0,0 +1 @@
+#define SDB_VERSION "1.4.0"
@@ -6,11 +6,18 @@ void sdbkv_fini(SdbKv *kv) {
 }
 
 SDB_API HtPP* sdb_ht_new() {
-	HtPP *ht = ht_pp_new ((HtPPDupValue)strdup, (HtPPKvFreeFunc)sdbkv_fini, (HtPPCalcSizeV)strlen);
-	if (ht) {
-		ht->opt.elem_size = sizeof (SdbKv);
-	}
-	return ht;
+	// elem_size must be known when the table is allocated
+	HtPPOptions opt = {
+		.cmp = (HtPPListComparator)strcmp,
+		.hashfn = (HtPPHashFunction)sdb_hash,
+		.dupkey = (HtPPDupKey)strdup,
+		.dupvalue = (HtPPDupValue)strdup,
+		.calcsizeK = (HtPPCalcSizeK)strlen,
+		.calcsizeV = (HtPPCalcSizeV)strlen,
+		.freefn = (HtPPKvFreeFunc)sdbkv_fini,
+		.elem_size = sizeof (SdbKv),
+	};
+	return ht_pp_new_opt (&opt);
 }
 
 static bool sdb_ht_internal_insert(HtPP* ht, const char* key,
@@ -98,6 +98,16 @@
 
 #include "config.h"
 
+/* profiling hook for the embedder, only called when built with SDB_PROF */
+enum { SDB_PROF_GET, SDB_PROF_SET, SDB_PROF_HT };
+typedef void (*SdbProfCallback)(int what);
+extern SDB_API SdbProfCallback sdb_prof_cb;
+#if SDB_PROF
+#define SDB_PROF_INC(x) do { if (sdb_prof_cb) { sdb_prof_cb (x); } } while (0)
+#else
+#define SDB_PROF_INC(x)
+#endif
+
 static inline int seek_set(int fd, off_t pos) {
 	return ((fd == -1) || (lseek (fd, (off_t) pos, SEEK_SET) == -1))? 0:1;
 }
@@ -0,0 +1,170 @@
+/* sdb - MIT - Copyright 2019 */
+
+/* Throughput of insert/lookup/delete and memory per entry of ht_up and
+ * ht_pp, build it with and without SDB_HT_SWISS to compare the backends */
+
+#include <time.h>
+#include <malloc.h>
+#include "ht_up.h"
+#include "ht_pp.h"
+
+#if SDB_HT_SWISS
+#define BACKEND "swiss"
+#else
+#define BACKEND "chained"
+#endif
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t heap_used(void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+	struct mallinfo2 mi = mallinfo2 ();
+	return mi.uordblks + mi.hblkhd;
+#elif defined(__GLIBC__)
+	struct mallinfo mi = mallinfo ();
+	return (size_t)(unsigned int)mi.uordblks + (size_t)(unsigned int)mi.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+// the lookups of the lists of keys in random order
+static int *shuffled(int n) {
+	int i, *order = malloc (sizeof (int) * n);
+	ut32 seed = 0x1234567;
+	if (!order) {
+		return NULL;
+	}
+	for (i = 0; i < n; i++) {
+		order[i] = i;
+	}
+	for (i = n - 1; i > 0; i--) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		int j = seed % (i + 1), tmp = order[i];
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+	return order;
+}
+
+static void report(const char *ht, const char *op, int n, double t) {
+	printf ("%-8s %-6s %-8s %8.2f Mops/s\n", BACKEND, ht, op, n / t / 1e6);
+}
+
+static void bench_up(int n, const int *order) {
+	int i, hits = 0;
+	size_t mem = heap_used ();
+	HtUP *ht = ht_up_new0 ();
+	double t = now ();
+	for (i = 0; i < n; i++) {
+		// code addresses, like the keys of the xrefs
+		ht_up_insert (ht, 0x400000 + (ut64)i * 4, (void *)(size_t)(i + 1));
+	}
+	report ("ht_up", "insert", n, now () - t);
+	mem = heap_used () - mem;
+	t = now ();
+	for (i = 0; i < n; i++) {
+		hits += ht_up_find (ht, 0x400000 + (ut64)i * 4, NULL) != NULL;
+	}
+	report ("ht_up", "hit", n, now () - t);
+	t = now ();
+	for (i = 0; i < n; i++) {
+		hits += ht_up_find (ht, 0x400000 + (ut64)order[i] * 4, NULL) != NULL;
+	}
+	report ("ht_up", "hit-rnd", n, now () - t);
+	t = now ();
+	for (i = 0; i < n; i++) {
+		hits += ht_up_find (ht, 0x400002 + (ut64)i * 4, NULL) != NULL;
+	}
+	report ("ht_up", "miss", n, now () - t);
+	t = now ();
+	for (i = 0; i < n; i++) {
+		ht_up_delete (ht, 0x400000 + (ut64)i * 4);
+	}
+	report ("ht_up", "delete", n, now () - t);
+	if (hits != 2 * n || ht->count) {
+		printf ("ht_up: wrong results\n");
+	}
+	printf ("%-8s %-6s %-8s %8.2f bytes/entry\n", BACKEND, "ht_up", "memory", (double)mem / n);
+	ht_up_free (ht);
+}
+
+static void bench_pp(int n, const int *order) {
+	int i, hits = 0;
+	char **keys = malloc (sizeof (char *) * n);
+	char **miss = malloc (sizeof (char *) * n);
+	if (!keys || !miss) {
+		free (keys);
+		free (miss);
+		return;
+	}
+	for (i = 0; i < n; i++) {
+		char buf[32];
+		snprintf (buf, sizeof (buf), "sym.func_%08x", i);
+		keys[i] = strdup (buf);
+		snprintf (buf, sizeof (buf), "str.miss_%08x", i);
+		miss[i] = strdup (buf);
+	}
+	size_t mem = heap_used ();
+	HtPP *ht = ht_pp_new0 ();
+	double t = now ();
+	for (i = 0; i < n; i++) {
+		ht_pp_insert (ht, keys[i], (void *)(size_t)(i + 1));
+	}
+	report ("ht_pp", "insert", n, now () - t);
+	mem = heap_used () - mem;
+	t = now ();
+	for (i = 0; i < n; i++) {
+		hits += ht_pp_find (ht, keys[i], NULL) != NULL;
+	}
+	report ("ht_pp", "hit", n, now () - t);
+	t = now ();
+	for (i = 0; i < n; i++) {
+		hits += ht_pp_find (ht, keys[order[i]], NULL) != NULL;
+	}
+	report ("ht_pp", "hit-rnd", n, now () - t);
+	t = now ();
+	for (i = 0; i < n; i++) {
+		hits += ht_pp_find (ht, miss[i], NULL) != NULL;
+	}
+	report ("ht_pp", "miss", n, now () - t);
+	t = now ();
+	for (i = 0; i < n; i++) {
+		ht_pp_delete (ht, keys[i]);
+	}
+	report ("ht_pp", "delete", n, now () - t);
+	if (hits != 2 * n || ht->count) {
+		printf ("ht_pp: wrong results\n");
+	}
+	// the keys are duplicated by the table, count them too
+	printf ("%-8s %-6s %-8s %8.2f bytes/entry\n", BACKEND, "ht_pp", "memory", (double)mem / n);
+	ht_pp_free (ht);
+	for (i = 0; i < n; i++) {
+		free (keys[i]);
+		free (miss[i]);
+	}
+	free (keys);
+	free (miss);
+}
+
+int main(int argc, char **argv) {
+	int n = argc > 1? atoi (argv[1]): 1000000;
+	if (n < 1) {
+		printf ("Usage: bench-ht [entries]\n");
+		return 1;
+	}
+	int *order = shuffled (n);
+	if (!order) {
+		return 1;
+	}
+	bench_up (n, order);
+	bench_pp (n, order);
+	free (order);
+	return 0;
+}